@@ -0,0 +1,129 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__ALLOCATION_ACCOUNTING_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__ALLOCATION_ACCOUNTING_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Opt-in accounting of heap allocations, split by the kind of operation that caused them
+/**
+ * Accounting is per serialization support impl and disabled by default. It has two modes:
+ *
+ * LIBRARY counts what the library hands out and takes back: type handles, dynamic data, grown
+ * serialization buffers and the strings getters return. Allocations fastrtps and the standard
+ * library make for their own use within an operation are not visible in this mode.
+ *
+ * HOOKED counts everything the process allocates and frees while one of the operations below runs,
+ * fastrtps internals included. It relies on process-wide allocation hooks (e.g. a replaced global
+ * operator new, or a malloc interposer) reporting to
+ * rosidl_dynamic_typesupport_fastrtps_allocation_accounting_on_allocation() and _on_free(). Each
+ * report is attributed to the operation running on the reporting thread, if any. Nested operations
+ * count toward the outermost one, e.g. building a lazily built type when data is first created from
+ * it counts as data creation.
+ *
+ * Counters are only ever added to, so steady state can be checked by comparing two snapshots.
+ */
+typedef enum rosidl_dynamic_typesupport_fastrtps_allocation_accounting_mode_e
+{
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_DISABLED = 0,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_LIBRARY,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_HOOKED,
+} rosidl_dynamic_typesupport_fastrtps_allocation_accounting_mode_t;
+
+typedef enum rosidl_dynamic_typesupport_fastrtps_allocation_category_e
+{
+  // Type builders, adding members, building and finalizing types
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_TYPE_BUILD = 0,
+  // Creating and finalizing dynamic data
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_DATA_CREATE,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_CLONE,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_SERIALIZE,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_DESERIALIZE,
+  // Strings and names returned by getters, which the caller frees
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_GETTER_OUTPUT,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_COUNT,
+} rosidl_dynamic_typesupport_fastrtps_allocation_category_t;
+
+typedef struct rosidl_dynamic_typesupport_fastrtps_allocation_counters_s
+{
+  uint64_t allocations;
+  uint64_t frees;
+  uint64_t bytes_allocated;
+  // Only includes the frees that were reported with their size
+  uint64_t bytes_freed;
+} rosidl_dynamic_typesupport_fastrtps_allocation_counters_t;
+
+typedef struct rosidl_dynamic_typesupport_fastrtps_allocation_accounting_snapshot_s
+{
+  rosidl_dynamic_typesupport_fastrtps_allocation_accounting_mode_t mode;
+  // Indexed by rosidl_dynamic_typesupport_fastrtps_allocation_category_t
+  rosidl_dynamic_typesupport_fastrtps_allocation_counters_t
+    categories[ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_COUNT];
+} rosidl_dynamic_typesupport_fastrtps_allocation_accounting_snapshot_t;
+
+/// Switch allocation accounting on or off, counters are kept
+/// Operations already running when the mode changes may be counted partially
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_set_allocation_accounting(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_allocation_accounting_mode_t mode);
+
+/// Copy the current counters
+/// Counters are read one by one, a snapshot taken while operations run is not atomic as a whole
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_get_allocation_accounting(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_allocation_accounting_snapshot_t * snapshot);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_reset_allocation_accounting(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl);
+
+/// Report an allocation of `size` bytes from a process-wide allocation hook
+/**
+ * Counted only if the calling thread is running an operation on a serialization support impl in
+ * HOOKED mode. Does not allocate, lock or set error messages, so it can be called from within an
+ * allocator.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+rosidl_dynamic_typesupport_fastrtps_allocation_accounting_on_allocation(size_t size);
+
+/// Report a free from a process-wide allocation hook, `size` may be 0 if it is not known
+/// Same rules as rosidl_dynamic_typesupport_fastrtps_allocation_accounting_on_allocation()
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+rosidl_dynamic_typesupport_fastrtps_allocation_accounting_on_free(size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__ALLOCATION_ACCOUNTING_H_
@@ -0,0 +1,152 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__COLUMNAR_BATCH_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__COLUMNAR_BATCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Batch of samples of one struct type, stored column by column
+/**
+ * Every member of the type gets its own column, in the Apache Arrow memory layout (without any
+ * null bitmaps, since members are never null):
+ *
+ * - primitives are fixed width columns of values in host byte order, and bool columns are bitmaps
+ *   with the least significant bit first
+ * - strings are an offsets buffer of length + 1 int32 offsets into a buffer of UTF-8 bytes
+ * - wide strings are lists of WCHAR (UTF-32) code units
+ * - sequences are lists: an offsets buffer of length + 1 int32 offsets into their child column
+ * - arrays are fixed size lists, whose child column has `width` entries per array
+ * - nested structs are struct columns, whose children are the columns of their members
+ *
+ * Columns are numbered in pre-order. Column 0 is the struct column for the whole sample, whose
+ * children are the top level members; each column records the index of its parent.
+ */
+typedef enum rosidl_dynamic_typesupport_fastrtps_column_type_e
+{
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_BOOL,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_BYTE,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_CHAR,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_WCHAR,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT16,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_UINT16,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT32,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_UINT32,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT64,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_UINT64,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FLOAT32,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FLOAT64,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FLOAT128,  // 16 byte fixed size binary
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRING,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_LIST,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FIXED_SIZE_LIST,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRUCT,
+} rosidl_dynamic_typesupport_fastrtps_column_type_t;
+
+/// View of one column, valid until the batch is next appended to, cleared or finalized
+typedef struct rosidl_dynamic_typesupport_fastrtps_column_s
+{
+  const char * name;  // Member name, "item" for list children, "" for the root column
+  rosidl_dynamic_typesupport_fastrtps_column_type_t type;
+  size_t parent;  // Index of the parent column, 0 for the root column itself
+  size_t length;  // Number of entries
+
+  // Bytes per value for fixed width columns, entries per list for fixed size lists, 0 otherwise
+  size_t width;
+
+  const int32_t * offsets;  // STRING and LIST only, length + 1 offsets
+  const uint8_t * values;  // Values, bitmap for BOOL, bytes for STRING, NULL for nested columns
+  size_t values_length;  // In bytes
+} rosidl_dynamic_typesupport_fastrtps_column_t;
+
+typedef struct rosidl_dynamic_typesupport_fastrtps_columnar_batch_s
+{
+  rcutils_allocator_t allocator;
+  void * handle;
+} rosidl_dynamic_typesupport_fastrtps_columnar_batch_t;
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_columnar_batch(void);
+
+/// Set up an empty batch for samples of the struct type `type_impl`
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch);  // OUT
+
+/// Append `count` dynamic data of the batch's type as rows
+/// If a sample can't be appended, the samples before it stay in the batch
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_data(
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * const * data_impls,
+  size_t count);
+
+/// Append `count` CDR serialized samples of the batch's type as rows, without deserializing them
+/// If a sample can't be appended, the samples before it stay in the batch
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_serialized(
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch,
+  const rcutils_uint8_array_t * const * buffers,
+  size_t count);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_get_column_count(
+  const rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch,
+  size_t * column_count);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_get_column(
+  const rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch,
+  size_t index,
+  rosidl_dynamic_typesupport_fastrtps_column_t * column);  // OUT
+
+/// Drop every row, keeping the column buffers around for the next batch
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_clear(
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_fini(
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__COLUMNAR_BATCH_H_
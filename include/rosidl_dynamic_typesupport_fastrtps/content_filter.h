@@ -0,0 +1,92 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__CONTENT_FILTER_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__CONTENT_FILTER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Content filter evaluated directly on serialized data
+/**
+ * The filter expression is compiled once against a struct type, in the DDS content filter SQL
+ * subset: comparisons (=, <>, <, <=, >, >=) of fields, literals and %n parameters, combined with
+ * AND, OR, NOT and parentheses. Fields are member names, with '.' for nested members and [n] for
+ * array and sequence elements, e.g. "pose.position.x > %0 AND header.frame_id = 'map'".
+ *
+ * Evaluation reads the compared fields straight out of the serialized message, without
+ * deserializing it. A comparison on a sequence element the message doesn't have never matches.
+ *
+ * Byte, int8 and uint8 fields all compare as unsigned values from 0 to 255: fastrtps builds int8
+ * members as bytes, and the type does not record their signedness. An int8 field holding -1
+ * compares equal to 255, and never to -1.
+ */
+typedef struct rosidl_dynamic_typesupport_fastrtps_content_filter_s
+{
+  rcutils_allocator_t allocator;
+  void * handle;
+} rosidl_dynamic_typesupport_fastrtps_content_filter_t;
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_content_filter_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_content_filter(void);
+
+/// Compile `expression` against the struct type `type_impl`
+/**
+ * Parameters are substituted as literals at compile time, so changing them means compiling a new
+ * filter. Returns RCUTILS_RET_INVALID_ARGUMENT if the expression does not parse, names a member
+ * the type doesn't have, compares a string with a number, or nests deeper than 1024 levels (every
+ * NOT, parenthesis and chained AND or OR counts as one).
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_content_filter_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const char * expression,
+  const char * const * parameters, size_t parameter_count,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_content_filter_t * filter);  // OUT
+
+/// Evaluate the filter on a CDR serialized message of the type it was compiled against
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_content_filter_evaluate(
+  const rosidl_dynamic_typesupport_fastrtps_content_filter_t * filter,
+  const rcutils_uint8_array_t * serialized,
+  bool * match);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_content_filter_fini(
+  rosidl_dynamic_typesupport_fastrtps_content_filter_t * filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__CONTENT_FILTER_H_
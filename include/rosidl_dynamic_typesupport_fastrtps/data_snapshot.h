@@ -0,0 +1,114 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__DATA_SNAPSHOT_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__DATA_SNAPSHOT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+/// An immutable dynamic data, shared between threads by reference count
+/**
+ * Handing one sample to several threads otherwise takes a clone per thread, since loaning values
+ * out of a dynamic data changes it. A snapshot is never changed again once frozen: any number of
+ * threads can read it at once through the dynamic data getters (and serialize it), without locks
+ * or copies.
+ *
+ * Nested structs, arrays and sequences are reached through
+ * rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_nested_data instead of loans. The data
+ * views a snapshot hands out must not be loaned from, changed or finalized.
+ *
+ * Safe on views, from any number of threads at once: the value getters (get_bool_value through
+ * get_wstring_value, including the fixed and bounded string ones), get_item_count,
+ * get_member_id_by_name, get_member_id_at_index, get_array_index, get_name, equals and serialize.
+ *
+ * Not safe on views: loan_value and return_loaned_value (they change the data, use
+ * get_nested_data instead), get_complex_value (it copies the member out through the data factory
+ * instead of reading it in place), rosidl_dynamic_typesupport_fastrtps_dynamic_data_hash (it loans
+ * nested members), and every function that changes or finalizes the data.
+ *
+ * Each thread holds its own reference, and the data is finalized when the last one is released.
+ * Every reference must be released before the serialization support impl the data was created
+ * with is finalized.
+ */
+typedef struct rosidl_dynamic_typesupport_fastrtps_data_snapshot_s
+{
+  rcutils_allocator_t allocator;
+  void * handle;
+} rosidl_dynamic_typesupport_fastrtps_data_snapshot_t;
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_data_snapshot(void);
+
+/// Freeze a dynamic data into a snapshot holding the first reference to it
+/**
+ * The snapshot takes the data over without copying it. On success, data_impl's handle is cleared
+ * and the data must not be used or finalized through it any more. Freezing walks the data once to
+ * index its nested values, and fails if any of them is still loaned.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_freeze(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot);  // OUT
+
+/// Take another reference to `snapshot`, e.g. to hand it to another thread
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_acquire(
+  const rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot,
+  rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * reference);  // OUT
+
+/// Read-only view of the frozen data, valid for as long as the reference is held
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_data(
+  const rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl);  // OUT
+
+/// Read-only view of the struct, array or sequence member `id` of a view of the snapshot
+/**
+ * `id` is an element index for arrays and sequences. Stands in for loan_value, there is nothing to
+ * return. Returns RCUTILS_RET_NOT_FOUND if `data_impl` holds no nested data under `id`.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_nested_data(
+  const rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  rosidl_dynamic_typesupport_member_id_t id,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * nested_data_impl);  // OUT
+
+/// Release this reference, finalizing the data if it was the last one
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_release(
+  rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__DATA_SNAPSHOT_H_
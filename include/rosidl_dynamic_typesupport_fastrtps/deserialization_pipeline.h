@@ -0,0 +1,108 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__DESERIALIZATION_PIPELINE_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__DESERIALIZATION_PIPELINE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Gets the data deserialized from the buffer submitted as `sequence`, and must finalize it
+/**
+ * On failure `ret` is the error, and `data_impl` is NULL. The error message is not kept, it is
+ * the worker thread's.
+ */
+typedef void (* rosidl_dynamic_typesupport_fastrtps_deserialization_callback_t)(
+  void * user_data,
+  uint64_t sequence,
+  rcutils_ret_t ret,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl);
+
+/// Deserializes a stream of serialized buffers on a pool of worker threads
+/**
+ * Buffers can be of any mix of types. Workers that run out of work take queued buffers from the
+ * others, so one large message does not hold up the ones queued behind it. Data of flat types is
+ * recycled from data finalized earlier where possible.
+ *
+ * The data is delivered in the order the buffers were submitted, numbered from 0, through the
+ * callback. The callback is called from the worker threads, one call at a time, and must not
+ * submit to or wait on its own pipeline.
+ *
+ * At most `capacity` buffers are in flight (submitted and not yet delivered), submitting more
+ * blocks until there is room. This bounds the memory held by buffers and undelivered data.
+ */
+typedef struct rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_s
+{
+  rcutils_allocator_t allocator;
+  void * handle;
+} rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t;
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_deserialization_pipeline(void);
+
+/// Start a pipeline with `worker_count` worker threads, or one per hardware thread for 0
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  size_t worker_count,
+  size_t capacity,
+  rosidl_dynamic_typesupport_fastrtps_deserialization_callback_t callback,
+  void * user_data,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t * pipeline);  // OUT
+
+/// Queue `buffer` to be deserialized into data of `type_impl`
+/**
+ * The buffer is copied, and can be reused as soon as this returns. The type must stay alive until
+ * the data is delivered. `sequence` (optional) is set to the number the data is delivered with.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_submit(
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t * pipeline,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const rcutils_uint8_array_t * buffer,
+  uint64_t * sequence);  // OUT
+
+/// Block until the data of every buffer submitted so far is delivered
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_wait(
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t * pipeline);
+
+/// Deliver the data of every buffer submitted, then stop the workers
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_fini(
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t * pipeline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__DESERIALIZATION_PIPELINE_H_
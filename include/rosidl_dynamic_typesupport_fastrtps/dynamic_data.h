@@ -0,0 +1,86 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__DYNAMIC_DATA_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__DYNAMIC_DATA_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Hash the value held by a dynamic data
+/**
+ * The hash is cheap to compare against before falling back to the dynamic_data_equals interface
+ * function, e.g. to deduplicate samples: data that compare equal always hash the same, so a hash
+ * mismatch means the data are not equal.
+ *
+ * Floating point values are hashed by value, so -0.0 hashes like 0.0, and every NaN hashes the
+ * same (though a NaN never compares equal). Data of different types may hash the same.
+ *
+ * Nested members are loaned while they are hashed, so the data must not be used from other threads
+ * meanwhile.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_hash(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  uint64_t * hash);  // OUT
+
+/// Write the changes that turn `from_data_impl` into `to_data_impl` into `delta`
+/**
+ * Both data must be of the same type. The delta lists the path and new value of every changed
+ * member, so it is usually much smaller than the serialized data when only a few members changed.
+ * It is encoded independently of the host, and can be sent to be applied somewhere else.
+ *
+ * `delta` must be initialized, and is resized as needed. `change_count` is set to the number of
+ * changed members, 0 if both data hold the same values.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_diff(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * from_data_impl,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * to_data_impl,
+  rcutils_uint8_array_t * delta,  // OUT
+  size_t * change_count);  // OUT
+
+/// Apply the changes in `delta` to a dynamic data of the type it was made from
+/**
+ * Every change is checked against the data before any is applied: its path must lead to an
+ * existing member of the kind the change says it has, and its value must be readable. If any
+ * change fails, RCUTILS_RET_ERROR is returned and the data is left untouched.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_patch(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  const rcutils_uint8_array_t * delta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__DYNAMIC_DATA_H_
@@ -0,0 +1,98 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__FOOTPRINT_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__FOOTPRINT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stddef.h>
+
+/// Approximate heap footprint of a dynamic data tree or of a dynamic type, by member
+/**
+ * Estimated by walking the data or type and applying a model of how fastrtps lays them out on
+ * the heap: every object, map node and string fastrtps allocates for them counts as one heap
+ * block, rounded up like glibc malloc does (16 byte granularity, 8 byte chunk header, 32 byte
+ * minimum). Strings short enough to be stored inline take no block of their own.
+ *
+ * For data, every value counts, down to each element of a sequence, which fastrtps keeps as a
+ * dynamic data of its own. Array elements only count once they have been set, fastrtps does not
+ * allocate them before. Members loaned out while the footprint is taken cannot be walked, and
+ * count as nothing.
+ *
+ * For types, member types count too. Types used by several members, or shared with other types
+ * through the type cache, are counted once, under the first member using them.
+ */
+typedef struct rosidl_dynamic_typesupport_fastrtps_member_footprint_s
+{
+  char * name;
+  // The member value (data) or the member entry and its type (types), nested members included
+  size_t heap_bytes;
+} rosidl_dynamic_typesupport_fastrtps_member_footprint_t;
+
+typedef struct rosidl_dynamic_typesupport_fastrtps_footprint_s
+{
+  rcutils_allocator_t allocator;
+
+  // Everything, members included
+  size_t heap_bytes;
+  // CDR serialized size, encapsulation header included. Data only, 0 for types
+  size_t serialized_bytes;
+
+  // Top level members, in member order
+  size_t member_count;
+  rosidl_dynamic_typesupport_fastrtps_member_footprint_t * members;
+} rosidl_dynamic_typesupport_fastrtps_footprint_t;
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_footprint_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_footprint(void);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_get_footprint(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_footprint_t * footprint);  // OUT
+
+/// Types built in lazy mode are built first
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_type_get_footprint(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_footprint_t * footprint);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_footprint_fini(
+  rosidl_dynamic_typesupport_fastrtps_footprint_t * footprint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__FOOTPRINT_H_
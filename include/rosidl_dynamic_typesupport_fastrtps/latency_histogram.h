@@ -0,0 +1,104 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__LATENCY_HISTOGRAM_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__LATENCY_HISTOGRAM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Latency histograms of the main operations of a serialization support impl
+/**
+ * Disabled by default. Once enabled, every operation below is timed with a steady clock and
+ * recorded into a log-linear histogram (HDR-style: 16 buckets per power of two, so each bucket is
+ * within ~6% of the values in it, up to ~68 seconds). Recording is lock-free: threads record into
+ * one of a few cache-line separated shards, which are merged when the histograms are read.
+ *
+ * Histograms are kept when disabled again, until reset or until the serialization support impl is
+ * finalized.
+ */
+typedef enum rosidl_dynamic_typesupport_fastrtps_latency_operation_e
+{
+  // Building a type from a type builder
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_TYPE_BUILD = 0,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_DATA_INIT,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_DATA_FINI,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_CLONE,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_SERIALIZE,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_DESERIALIZE,
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_COUNT,
+} rosidl_dynamic_typesupport_fastrtps_latency_operation_t;
+
+typedef enum rosidl_dynamic_typesupport_fastrtps_latency_dump_format_e
+{
+  // One summary line per operation, then its non-empty buckets
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_DUMP_FORMAT_TEXT = 0,
+  // {"<operation>": {"count": ..., "mean_ns": ..., "p50_ns": ..., ..., "max_ns": ...,
+  //                  "buckets": [[<lowest value in ns>, <count>], ...]}, ...}
+  ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_DUMP_FORMAT_JSON,
+} rosidl_dynamic_typesupport_fastrtps_latency_dump_format_t;
+
+/// Start or stop recording latencies
+/// Enabling for the first time allocates the histograms, a few hundred KiB
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_set_latency_histograms(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  bool enabled);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_reset_latency_histograms(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl);
+
+/// Get the latency at `percentile` (0 to 100) of an operation, and how many were recorded
+/**
+ * The latency is the highest value of the bucket the percentile falls in, except for the 100th
+ * percentile, which is the exact maximum. Both are 0 if nothing was recorded.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_get_latency_percentile(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_latency_operation_t operation,
+  double percentile,
+  uint64_t * count,  // OUT
+  uint64_t * nanoseconds);  // OUT
+
+/// Dump every histogram, as a null terminated string allocated with `allocator`
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_dump_latency_histograms(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_latency_dump_format_t format,
+  rcutils_allocator_t * allocator,
+  char ** dump);  // OUT
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__LATENCY_HISTOGRAM_H_
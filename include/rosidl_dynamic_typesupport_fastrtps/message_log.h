@@ -0,0 +1,175 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__MESSAGE_LOG_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__MESSAGE_LOG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Append-only log of serialized messages
+/**
+ * Messages are appended, in timestamp order, to a memory-mapped file at `path`, and indexed by
+ * timestamp and type fingerprint in a sidecar file at `path`.idx. Both files grow in large steps,
+ * so appending a message is a copy into the mapping rather than a write call, and dynamic data is
+ * serialized straight into the log.
+ *
+ * Readers map both files and hand out views into the mapping, without copying the messages.
+ *
+ * Message logs are POSIX-only: they are built on mmap, and on Windows opening a writer or a reader
+ * always fails with RCUTILS_RET_ERROR.
+ */
+typedef struct rosidl_dynamic_typesupport_fastrtps_message_log_writer_s
+{
+  rcutils_allocator_t allocator;
+  void * handle;
+} rosidl_dynamic_typesupport_fastrtps_message_log_writer_t;
+
+typedef struct rosidl_dynamic_typesupport_fastrtps_message_log_reader_s
+{
+  rcutils_allocator_t allocator;
+  void * handle;
+} rosidl_dynamic_typesupport_fastrtps_message_log_reader_t;
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_message_log_writer(void);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_message_log_reader(void);
+
+
+// WRITER ==========================================================================================
+/// Create a new message log at `path`, replacing any existing one
+/// POSIX-only, always returns RCUTILS_RET_ERROR on Windows
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_message_log_writer_t * writer);  // OUT
+
+/// Serialize `data_impl` into the log
+/**
+ * The message is serialized the same way the serialize interface function would serialize it.
+ * Returns RCUTILS_RET_INVALID_ARGUMENT if `timestamp` is older than the last appended message.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_append_data(
+  rosidl_dynamic_typesupport_fastrtps_message_log_writer_t * writer,
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  int64_t timestamp);
+
+/// Copy an already serialized message of type `type_impl` into the log
+/// Returns RCUTILS_RET_INVALID_ARGUMENT if `timestamp` is older than the last appended message
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_append_serialized(
+  rosidl_dynamic_typesupport_fastrtps_message_log_writer_t * writer,
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const rcutils_uint8_array_t * buffer,
+  int64_t timestamp);
+
+/// Trim the files to their contents and close them
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_close(
+  rosidl_dynamic_typesupport_fastrtps_message_log_writer_t * writer);
+
+
+// READER ==========================================================================================
+/// Map the message log at `path` for reading
+/**
+ * Returns RCUTILS_RET_NOT_FOUND if the log does not exist, and RCUTILS_RET_ERROR if it is not a
+ * valid message log for this library version.
+ * A log that is still being written can be opened, the reader sees the messages indexed so far.
+ * POSIX-only, always returns RCUTILS_RET_ERROR on Windows.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_get_message_count(
+  const rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader,
+  size_t * count);  // OUT
+
+/// Get the message at `index`, in timestamp order
+/**
+ * `message` is set to a view into the mapped log, valid until the reader is closed. It must not be
+ * finalized or resized. `timestamp` and `fingerprint` (two entries) may be NULL.
+ * Compare `fingerprint` with rosidl_dynamic_typesupport_fastrtps_message_log_get_type_fingerprint
+ * to find the type of a message.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_get_message(
+  const rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader,
+  size_t index,
+  int64_t * timestamp,  // OUT
+  uint64_t * fingerprint,  // OUT
+  rcutils_uint8_array_t * message);  // OUT
+
+/// Find the messages with a timestamp in [`start`, `end`)
+/// They are the `count` messages from index `first` on
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_find_time_range(
+  const rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader,
+  int64_t start, int64_t end,
+  size_t * first,  // OUT
+  size_t * count);  // OUT
+
+/// Unmap the log, invalidating every message view handed out
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_close(
+  rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader);
+
+
+/// Get the fingerprint messages of type `type_impl` are indexed with (two entries)
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_get_type_fingerprint(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  uint64_t * fingerprint);  // OUT
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__MESSAGE_LOG_H_
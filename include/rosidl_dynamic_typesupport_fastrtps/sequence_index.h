@@ -0,0 +1,106 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__SEQUENCE_INDEX_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__SEQUENCE_INDEX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stddef.h>
+
+/// Random access to the elements of a sequence inside serialized data
+/**
+ * Compiled once against a struct type and one of its array or sequence members, given as a path
+ * with '.' for nested members and [n] for array and sequence elements, e.g. "markers[2].points".
+ *
+ * Building the index walks a serialized message once and records where every element of the
+ * member starts. After that, each element is found in constant time, which makes repeated random
+ * access, or handing elements out to several threads, cheap even when elements are of variable
+ * size (strings, structs holding strings or sequences).
+ */
+typedef struct rosidl_dynamic_typesupport_fastrtps_sequence_index_s
+{
+  rcutils_allocator_t allocator;
+  void * handle;
+} rosidl_dynamic_typesupport_fastrtps_sequence_index_t;
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_sequence_index_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_sequence_index(void);
+
+/// Compile an index for the array or sequence member `path` of the struct type `type_impl`
+/// Returns RCUTILS_RET_INVALID_ARGUMENT if the path does not lead to an array or sequence
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const char * path,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index);  // OUT
+
+/// Index the elements of the member in a CDR serialized message, replacing the previous index
+/**
+ * The index only holds offsets, so it stays valid for as long as the message is left unchanged,
+ * and can be rebuilt for every new message without allocating once it has grown large enough.
+ * Returns RCUTILS_RET_ERROR if the message ends before the member does.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_build(
+  rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index,
+  const rcutils_uint8_array_t * serialized);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_get_element_count(
+  const rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index,
+  size_t * count);  // OUT
+
+/// Where element `element_index` is in the message the index was last built for
+/**
+ * `offset` is counted from the start of the message, encapsulation header included, and the
+ * element takes `length` bytes from there, including any alignment padding ahead of it. Values
+ * inside the element are aligned relative to the end of the encapsulation header, as everywhere
+ * else in the message.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_get_element(
+  const rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index,
+  size_t element_index,
+  size_t * offset,  // OUT
+  size_t * length);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_fini(
+  rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__SEQUENCE_INDEX_H_
@@ -24,6 +24,8 @@ extern "C" {
 
 #include <rosidl_dynamic_typesupport/api/serialization_support_interface.h>
 
+#include <stdbool.h>
+
 /// This is the main file to include
 
 // CORE ============================================================================================
@@ -39,6 +41,20 @@ rosidl_dynamic_typesupport_fastrtps_init_serialization_support_interface(
   rcutils_allocator_t * allocator,
   rosidl_dynamic_typesupport_serialization_support_interface_t * serialization_support_interface);
 
+// OPTIONS =========================================================================================
+/// Defer building nested types until they are used (off by default)
+/**
+ * While enabled, nested members added from type builders are recorded instead of being built, and
+ * types that have such members are only built the first time they are needed, e.g. when dynamic
+ * data is first created from them. Branches of big type graphs that are never used are never
+ * built.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_set_lazy_nested_types(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  bool lazy_nested_types);
+
 #ifdef __cplusplus
 }
 #endif
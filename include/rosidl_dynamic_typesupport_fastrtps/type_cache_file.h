@@ -0,0 +1,102 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__TYPE_CACHE_FILE_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__TYPE_CACHE_FILE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <stddef.h>
+
+/// Persistent cache of built dynamic types
+/**
+ * A process that brings up many types can write them to a cache file once, and on the next start
+ * map that file and get the types back without going through the type builder interface again.
+ *
+ * The file is versioned: files written by a different format version or fastrtps version are
+ * rejected on open, and the caller is expected to rebuild its types and rewrite the file.
+ *
+ * Types are looked up by their (unmangled) type name, e.g. "std_msgs/msg/String".
+ */
+typedef struct rosidl_dynamic_typesupport_fastrtps_type_cache_file_s
+{
+  rcutils_allocator_t allocator;
+  void * handle;
+} rosidl_dynamic_typesupport_fastrtps_type_cache_file_t;
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_type_cache_file(void);
+
+/// Write `type_count` built types to a new cache file at `path`, replacing any existing file
+/**
+ * The file is written next to `path` first and then renamed over it, so concurrent readers never
+ * see a partially written cache.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_write(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  const char * path,
+  const rosidl_dynamic_typesupport_dynamic_type_impl_t * const * type_impls,
+  size_t type_count);
+
+/// Map the cache file at `path` for reading
+/**
+ * Returns RCUTILS_RET_NOT_FOUND if the file does not exist, and RCUTILS_RET_ERROR if it is not a
+ * valid cache file for this library version.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t * cache_file);  // OUT
+
+/// Rehydrate the type called `name` from an opened cache file
+/**
+ * Returns RCUTILS_RET_NOT_FOUND if the file does not contain the type.
+ * The returned type impl is finalized like any other, with the dynamic_type_fini interface
+ * function.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_get_type(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t * cache_file,
+  const char * name, size_t name_length,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl);  // OUT
+
+/// Unmap the cache file
+/// Must be called before the serialization support impl used to get types from it is finalized
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_fini(
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t * cache_file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__TYPE_CACHE_FILE_H_
@@ -0,0 +1,94 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__TYPE_CONVERTER_H_
+#define ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__TYPE_CONVERTER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+/// Converter between two versions of a struct type
+/**
+ * The conversion plan is compiled once: members of the target type are matched to members of the
+ * source type by name. Members whose type is unchanged are copied, nested structs that changed are
+ * converted member by member in turn, and every other target member keeps its default value.
+ * Source members that are not in the target type are dropped.
+ *
+ * Sequences and arrays of a changed struct are converted element by element, as long as the target
+ * can hold every source element: arrays must keep their bounds, and a bounded sequence can't get a
+ * smaller bound. Members whose type changed in any other way (e.g. int32 to int64) are not
+ * converted, and keep their default value.
+ */
+typedef struct rosidl_dynamic_typesupport_fastrtps_type_converter_s
+{
+  rcutils_allocator_t allocator;
+  void * handle;
+} rosidl_dynamic_typesupport_fastrtps_type_converter_t;
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rosidl_dynamic_typesupport_fastrtps_type_converter_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_type_converter(void);
+
+/// Compile the conversion plan from the struct type `from_type_impl` to `to_type_impl`
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_converter_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * from_type_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * to_type_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_type_converter_t * converter);  // OUT
+
+/// Convert `from_data_impl`, of the source type, into `to_data_impl`, of the target type
+/// Every member of `to_data_impl` is overwritten, so it can be reused across conversions
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_converter_convert_data(
+  const rosidl_dynamic_typesupport_fastrtps_type_converter_t * converter,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * from_data_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * to_data_impl);  // OUT
+
+/// Convert CDR serialized data of the source type into serialized data of the target type
+/**
+ * The conversion happens in one pass over `from`, without deserializing it. `to` is resized if it
+ * is too small, and gets the same byte order as `from`.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_converter_convert_serialized(
+  const rosidl_dynamic_typesupport_fastrtps_type_converter_t * converter,
+  const rcutils_uint8_array_t * from,
+  rcutils_uint8_array_t * to);  // OUT
+
+/// Must be called before the serialization support impl used to init the converter is finalized
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_converter_fini(
+  rosidl_dynamic_typesupport_fastrtps_type_converter_t * converter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS__TYPE_CONVERTER_H_
@@ -0,0 +1,99 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <atomic>
+
+#include "rosidl_dynamic_typesupport_fastrtps/allocation_accounting.h"
+
+#include "detail/fastrtps_allocation_accounting.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+
+
+// =================================================================================================
+// ALLOCATION ACCOUNTING
+// =================================================================================================
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_set_allocation_accounting(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_allocation_accounting_mode_t mode)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  switch (mode) {
+    case ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_DISABLED:
+    case ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_LIBRARY:
+    case ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_HOOKED:
+      break;
+    default:
+      RCUTILS_SET_ERROR_MSG("Unknown allocation accounting mode");
+      return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+
+  static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle)->allocation_accounting_.mode_.store(
+    mode, std::memory_order_relaxed);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_get_allocation_accounting(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_allocation_accounting_snapshot_t * snapshot)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(snapshot, RCUTILS_RET_INVALID_ARGUMENT);
+
+  fastrtps__allocation_accounting_snapshot(
+    &static_cast<fastrtps__serialization_support_impl_handle_t *>(
+      serialization_support_impl->handle)->allocation_accounting_,
+    snapshot);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_reset_allocation_accounting(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+
+  fastrtps__allocation_accounting_reset(
+    &static_cast<fastrtps__serialization_support_impl_handle_t *>(
+      serialization_support_impl->handle)->allocation_accounting_);
+  return RCUTILS_RET_OK;
+}
+
+
+// HOOKS ===========================================================================================
+void
+rosidl_dynamic_typesupport_fastrtps_allocation_accounting_on_allocation(size_t size)
+{
+  fastrtps__allocation_scope_report(false, size);
+}
+
+
+void
+rosidl_dynamic_typesupport_fastrtps_allocation_accounting_on_free(size_t size)
+{
+  fastrtps__allocation_scope_report(true, size);
+}
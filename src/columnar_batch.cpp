@@ -0,0 +1,199 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <fastrtps/types/DynamicData.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <vector>
+
+#include "rosidl_dynamic_typesupport_fastrtps/columnar_batch.h"
+
+#include "detail/fastrtps_columnar_batch.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+
+
+using eprosima::fastrtps::types::DynamicData;
+
+
+// =================================================================================================
+// COLUMNAR BATCH
+// =================================================================================================
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_columnar_batch(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t batch;
+  batch.allocator = rcutils_get_zero_initialized_allocator();
+  batch.handle = NULL;
+  return batch;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch, RCUTILS_RET_INVALID_ARGUMENT);
+
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  const auto & type = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle));
+  if (!type) {
+    RCUTILS_SET_ERROR_MSG("Could not build type for columnar batch");
+    return RCUTILS_RET_ERROR;
+  }
+
+  fastrtps__columnar_batch_t * handle = NULL;
+  rcutils_ret_t ret = fastrtps__columnar_batch_init(type, allocator, &handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  batch->allocator = *allocator;
+  batch->handle = handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_data(
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * const * data_impls,
+  size_t count)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  if (count > 0) {
+    RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impls, RCUTILS_RET_INVALID_ARGUMENT);
+  }
+
+  std::vector<const DynamicData *> data(count);
+  for (size_t i = 0; i < count; ++i) {
+    RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+      data_impls[i], "data impl is null", return RCUTILS_RET_INVALID_ARGUMENT);
+    data[i] = static_cast<const DynamicData *>(data_impls[i]->handle);
+  }
+  return fastrtps__columnar_batch_append_data(
+    static_cast<fastrtps__columnar_batch_t *>(batch->handle), data.data(), count);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_serialized(
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch,
+  const rcutils_uint8_array_t * const * buffers,
+  size_t count)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  if (count > 0) {
+    RCUTILS_CHECK_ARGUMENT_FOR_NULL(buffers, RCUTILS_RET_INVALID_ARGUMENT);
+  }
+
+  std::vector<const uint8_t *> data(count);
+  std::vector<size_t> lengths(count);
+  for (size_t i = 0; i < count; ++i) {
+    RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+      buffers[i], "buffer is null", return RCUTILS_RET_INVALID_ARGUMENT);
+    data[i] = buffers[i]->buffer;
+    lengths[i] = buffers[i]->buffer_length;
+  }
+  return fastrtps__columnar_batch_append_serialized(
+    static_cast<fastrtps__columnar_batch_t *>(batch->handle), data.data(), lengths.data(), count);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_get_column_count(
+  const rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch,
+  size_t * column_count)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(column_count, RCUTILS_RET_INVALID_ARGUMENT);
+  *column_count = static_cast<const fastrtps__columnar_batch_t *>(batch->handle)->columns_.size();
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_get_column(
+  const rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch,
+  size_t index,
+  rosidl_dynamic_typesupport_fastrtps_column_t * column)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(column, RCUTILS_RET_INVALID_ARGUMENT);
+
+  auto handle = static_cast<const fastrtps__columnar_batch_t *>(batch->handle);
+  if (index >= handle->columns_.size()) {
+    RCUTILS_SET_ERROR_MSG("Column index out of range");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  const fastrtps__columnar_column_t * source = handle->columns_[index].get();
+  column->name = source->name_.c_str();
+  column->type = source->type_;
+  column->parent = source->parent_;
+  column->length = source->length_;
+  column->width = source->type_ == ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FIXED_SIZE_LIST ?
+    source->list_size_ : source->width_;
+  column->offsets = source->offsets_.empty() ? NULL : source->offsets_.data();
+  column->values = source->values_.empty() ? NULL : source->values_.data();
+  column->values_length = source->values_.size();
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_clear(
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  fastrtps__columnar_batch_clear(static_cast<fastrtps__columnar_batch_t *>(batch->handle));
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_columnar_batch_fini(
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t * batch)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(batch, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!batch->handle) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = fastrtps__columnar_batch_fini(
+    static_cast<fastrtps__columnar_batch_t *>(batch->handle));
+  batch->handle = NULL;
+  return ret;
+}
@@ -0,0 +1,118 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include "rosidl_dynamic_typesupport_fastrtps/content_filter.h"
+
+#include "detail/fastrtps_content_filter.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+
+
+// =================================================================================================
+// CONTENT FILTER
+// =================================================================================================
+rosidl_dynamic_typesupport_fastrtps_content_filter_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_content_filter(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_content_filter_t filter;
+  filter.allocator = rcutils_get_zero_initialized_allocator();
+  filter.handle = NULL;
+  return filter;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_content_filter_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const char * expression,
+  const char * const * parameters, size_t parameter_count,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_content_filter_t * filter)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(expression, RCUTILS_RET_INVALID_ARGUMENT);
+  if (parameter_count > 0) {
+    RCUTILS_CHECK_ARGUMENT_FOR_NULL(parameters, RCUTILS_RET_INVALID_ARGUMENT);
+    for (size_t i = 0; i < parameter_count; ++i) {
+      RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+        parameters[i], "parameter is null", return RCUTILS_RET_INVALID_ARGUMENT);
+    }
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(filter, RCUTILS_RET_INVALID_ARGUMENT);
+
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  const auto & type = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle));
+  if (!type) {
+    RCUTILS_SET_ERROR_MSG("Could not build type for content filter");
+    return RCUTILS_RET_ERROR;
+  }
+
+  fastrtps__content_filter_t * handle = NULL;
+  rcutils_ret_t ret = fastrtps__content_filter_init(
+    type, expression, parameters, parameter_count, allocator, &handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  filter->allocator = *allocator;
+  filter->handle = handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_content_filter_evaluate(
+  const rosidl_dynamic_typesupport_fastrtps_content_filter_t * filter,
+  const rcutils_uint8_array_t * serialized,
+  bool * match)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(filter, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(filter->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialized, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(match, RCUTILS_RET_INVALID_ARGUMENT);
+  return fastrtps__content_filter_evaluate(
+    static_cast<const fastrtps__content_filter_t *>(filter->handle),
+    serialized->buffer, serialized->buffer_length, match);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_content_filter_fini(
+  rosidl_dynamic_typesupport_fastrtps_content_filter_t * filter)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(filter, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!filter->handle) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = fastrtps__content_filter_fini(
+    static_cast<fastrtps__content_filter_t *>(filter->handle));
+  filter->handle = NULL;
+  return ret;
+}
@@ -0,0 +1,136 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include "rosidl_dynamic_typesupport_fastrtps/data_snapshot.h"
+
+#include "detail/fastrtps_data_snapshot.hpp"
+#include "detail/utils.hpp"
+
+
+// =================================================================================================
+// DATA SNAPSHOTS
+// =================================================================================================
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_data_snapshot(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_data_snapshot_t snapshot;
+  snapshot.allocator = rcutils_get_zero_initialized_allocator();
+  snapshot.handle = NULL;
+  return snapshot;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_freeze(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(snapshot, RCUTILS_RET_INVALID_ARGUMENT);
+
+  fastrtps__data_snapshot_t * handle = NULL;
+  rcutils_ret_t ret = fastrtps__data_snapshot_freeze(
+    serialization_support_impl, data_impl, allocator, &handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  snapshot->allocator = *allocator;
+  snapshot->handle = handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_acquire(
+  const rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot,
+  rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * reference)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(snapshot, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(snapshot->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(reference, RCUTILS_RET_INVALID_ARGUMENT);
+  fastrtps__data_snapshot_acquire(static_cast<fastrtps__data_snapshot_t *>(snapshot->handle));
+  *reference = *snapshot;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_data(
+  const rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(snapshot, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(snapshot->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  data_impl->allocator = snapshot->allocator;
+  data_impl->handle = static_cast<const fastrtps__data_snapshot_t *>(snapshot->handle)->data_;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_nested_data(
+  const rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  rosidl_dynamic_typesupport_member_id_t id,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * nested_data_impl)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(snapshot, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(snapshot->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(nested_data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+
+  const eprosima::fastrtps::types::DynamicData * nested = fastrtps__data_snapshot_get_nested(
+    static_cast<const fastrtps__data_snapshot_t *>(snapshot->handle),
+    static_cast<const eprosima::fastrtps::types::DynamicData *>(data_impl->handle),
+    fastrtps__size_t_to_uint32_t(id));
+  if (!nested) {
+    RCUTILS_SET_ERROR_MSG("No nested data under this member id in the snapshot");
+    return RCUTILS_RET_NOT_FOUND;
+  }
+  nested_data_impl->allocator = snapshot->allocator;
+  // Views are only handed to the getters, which do not change the data
+  nested_data_impl->handle = const_cast<eprosima::fastrtps::types::DynamicData *>(nested);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_data_snapshot_release(
+  rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(snapshot, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!snapshot->handle) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = fastrtps__data_snapshot_release(
+    static_cast<fastrtps__data_snapshot_t *>(snapshot->handle));
+  snapshot->handle = NULL;
+  return ret;
+}
@@ -0,0 +1,112 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include "rosidl_dynamic_typesupport_fastrtps/deserialization_pipeline.h"
+
+#include "detail/fastrtps_deserialization_pipeline.hpp"
+
+
+// =================================================================================================
+// DESERIALIZATION PIPELINE
+// =================================================================================================
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_deserialization_pipeline(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t pipeline;
+  pipeline.allocator = rcutils_get_zero_initialized_allocator();
+  pipeline.handle = NULL;
+  return pipeline;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  size_t worker_count,
+  size_t capacity,
+  rosidl_dynamic_typesupport_fastrtps_deserialization_callback_t callback,
+  void * user_data,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t * pipeline)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(callback, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(pipeline, RCUTILS_RET_INVALID_ARGUMENT);
+
+  fastrtps__deserialization_pipeline_t * handle = NULL;
+  rcutils_ret_t ret = fastrtps__deserialization_pipeline_init(
+    serialization_support_impl, worker_count, capacity, callback, user_data, allocator, &handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  pipeline->allocator = *allocator;
+  pipeline->handle = handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_submit(
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t * pipeline,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const rcutils_uint8_array_t * buffer,
+  uint64_t * sequence)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(pipeline, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(pipeline->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(buffer, RCUTILS_RET_INVALID_ARGUMENT);
+  return fastrtps__deserialization_pipeline_submit(
+    static_cast<fastrtps__deserialization_pipeline_t *>(pipeline->handle), type_impl,
+    buffer->buffer, buffer->buffer_length, sequence);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_wait(
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t * pipeline)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(pipeline, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(pipeline->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  fastrtps__deserialization_pipeline_wait(
+    static_cast<fastrtps__deserialization_pipeline_t *>(pipeline->handle));
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_fini(
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t * pipeline)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(pipeline, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!pipeline->handle) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = fastrtps__deserialization_pipeline_fini(
+    static_cast<fastrtps__deserialization_pipeline_t *>(pipeline->handle));
+  pipeline->handle = NULL;
+  return ret;
+}
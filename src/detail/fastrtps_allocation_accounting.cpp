@@ -0,0 +1,85 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastrtps_allocation_accounting.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+
+// =================================================================================================
+// ALLOCATION ACCOUNTING
+// =================================================================================================
+
+// Counters of the scope open on this thread, if any. A plain pointer: allocation hooks read it
+// from within the allocator, so touching it must never allocate
+static thread_local fastrtps__allocation_counters_t * fastrtps__allocation_scope_counters = nullptr;
+
+
+void
+fastrtps__allocation_accounting_snapshot(
+  const fastrtps__allocation_accounting_t * accounting,
+  rosidl_dynamic_typesupport_fastrtps_allocation_accounting_snapshot_t * snapshot)
+{
+  snapshot->mode = accounting->mode_.load(std::memory_order_relaxed);
+  for (int i = 0; i < ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_COUNT; ++i) {
+    const fastrtps__allocation_counters_t & counters = accounting->categories_[i];
+    snapshot->categories[i].allocations = counters.allocations_.load(std::memory_order_relaxed);
+    snapshot->categories[i].frees = counters.frees_.load(std::memory_order_relaxed);
+    snapshot->categories[i].bytes_allocated =
+      counters.bytes_allocated_.load(std::memory_order_relaxed);
+    snapshot->categories[i].bytes_freed = counters.bytes_freed_.load(std::memory_order_relaxed);
+  }
+}
+
+
+void
+fastrtps__allocation_accounting_reset(fastrtps__allocation_accounting_t * accounting)
+{
+  for (auto & counters : accounting->categories_) {
+    counters.allocations_.store(0, std::memory_order_relaxed);
+    counters.frees_.store(0, std::memory_order_relaxed);
+    counters.bytes_allocated_.store(0, std::memory_order_relaxed);
+    counters.bytes_freed_.store(0, std::memory_order_relaxed);
+  }
+}
+
+
+// SCOPES ==========================================================================================
+bool
+fastrtps__allocation_scope_enter(fastrtps__allocation_counters_t * counters)
+{
+  if (fastrtps__allocation_scope_counters) {
+    return false;
+  }
+  fastrtps__allocation_scope_counters = counters;
+  return true;
+}
+
+
+void
+fastrtps__allocation_scope_exit()
+{
+  fastrtps__allocation_scope_counters = nullptr;
+}
+
+
+void
+fastrtps__allocation_scope_report(bool is_free, size_t size)
+{
+  if (fastrtps__allocation_scope_counters) {
+    fastrtps__allocation_counters_add(fastrtps__allocation_scope_counters, is_free, size);
+  }
+}
@@ -0,0 +1,153 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DETAIL__FASTRTPS_ALLOCATION_ACCOUNTING_HPP_
+#define DETAIL__FASTRTPS_ALLOCATION_ACCOUNTING_HPP_
+
+#include <rosidl_dynamic_typesupport_fastrtps/allocation_accounting.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+// =================================================================================================
+// ALLOCATION ACCOUNTING
+// =================================================================================================
+//
+// In LIBRARY mode, the places that hand out or take back memory record it themselves with
+// fastrtps__allocation_accounting_record_*. In HOOKED mode, operations open a scope instead, and
+// allocation hooks report to whichever scope is open on their thread. Either way, the cost while
+// disabled is one relaxed load per operation.
+
+typedef struct fastrtps__allocation_counters_s
+{
+  std::atomic<uint64_t> allocations_{0};
+  std::atomic<uint64_t> frees_{0};
+  std::atomic<uint64_t> bytes_allocated_{0};
+  std::atomic<uint64_t> bytes_freed_{0};
+} fastrtps__allocation_counters_t;
+
+typedef struct fastrtps__allocation_accounting_s
+{
+  std::atomic<rosidl_dynamic_typesupport_fastrtps_allocation_accounting_mode_t> mode_{
+    ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_DISABLED};
+  fastrtps__allocation_counters_t
+    categories_[ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_COUNT];
+} fastrtps__allocation_accounting_t;
+
+
+inline void
+fastrtps__allocation_counters_add(
+  fastrtps__allocation_counters_t * counters, bool is_free, size_t size)
+{
+  if (is_free) {
+    counters->frees_.fetch_add(1, std::memory_order_relaxed);
+    counters->bytes_freed_.fetch_add(size, std::memory_order_relaxed);
+  } else {
+    counters->allocations_.fetch_add(1, std::memory_order_relaxed);
+    counters->bytes_allocated_.fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+/// Record memory handed out by the library, in LIBRARY mode
+inline void
+fastrtps__allocation_accounting_record_allocation(
+  fastrtps__allocation_accounting_t * accounting,
+  rosidl_dynamic_typesupport_fastrtps_allocation_category_t category,
+  size_t size)
+{
+  if (accounting->mode_.load(std::memory_order_relaxed) ==
+    ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_LIBRARY)
+  {
+    fastrtps__allocation_counters_add(&accounting->categories_[category], false, size);
+  }
+}
+
+/// Record memory taken back by the library, in LIBRARY mode
+inline void
+fastrtps__allocation_accounting_record_free(
+  fastrtps__allocation_accounting_t * accounting,
+  rosidl_dynamic_typesupport_fastrtps_allocation_category_t category,
+  size_t size)
+{
+  if (accounting->mode_.load(std::memory_order_relaxed) ==
+    ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_LIBRARY)
+  {
+    fastrtps__allocation_counters_add(&accounting->categories_[category], true, size);
+  }
+}
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__allocation_accounting_snapshot(
+  const fastrtps__allocation_accounting_t * accounting,
+  rosidl_dynamic_typesupport_fastrtps_allocation_accounting_snapshot_t * snapshot);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__allocation_accounting_reset(fastrtps__allocation_accounting_t * accounting);
+
+
+// SCOPES ==========================================================================================
+/// Open a scope on this thread, reports from allocation hooks go to `counters` until it is exited
+/// Returns false, and opens nothing, if a scope is already open on this thread
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__allocation_scope_enter(fastrtps__allocation_counters_t * counters);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__allocation_scope_exit();
+
+/// Count an allocation or free reported by an allocation hook, if a scope is open on this thread
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__allocation_scope_report(bool is_free, size_t size);
+
+/// Attributes what allocation hooks report on this thread to `category` while it lives, in HOOKED
+/// mode. Only the outermost scope on a thread counts
+class fastrtps__allocation_scope_t
+{
+public:
+  fastrtps__allocation_scope_t(
+    fastrtps__allocation_accounting_t * accounting,
+    rosidl_dynamic_typesupport_fastrtps_allocation_category_t category)
+  : entered_(false)
+  {
+    if (accounting->mode_.load(std::memory_order_relaxed) ==
+      ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_HOOKED)
+    {
+      entered_ = fastrtps__allocation_scope_enter(&accounting->categories_[category]);
+    }
+  }
+
+  ~fastrtps__allocation_scope_t()
+  {
+    if (entered_) {
+      fastrtps__allocation_scope_exit();
+    }
+  }
+
+  fastrtps__allocation_scope_t(const fastrtps__allocation_scope_t &) = delete;
+  fastrtps__allocation_scope_t & operator=(const fastrtps__allocation_scope_t &) = delete;
+
+private:
+  bool entered_;
+};
+
+
+#endif  // DETAIL__FASTRTPS_ALLOCATION_ACCOUNTING_HPP_
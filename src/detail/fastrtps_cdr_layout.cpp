@@ -0,0 +1,341 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_cdr_layout.hpp"
+
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypeMember.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypeDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::DynamicTypeMember;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::TypeDescriptor;
+using eprosima::fastrtps::types::TypeKind;
+
+
+// =================================================================================================
+// CDR LAYOUT
+// =================================================================================================
+
+// INIT ============================================================================================
+// Alignment and size of each primitive kind, as fastcdr serializes them
+static bool
+fastrtps__cdr_layout_get_primitive(TypeKind kind, uint32_t * align, uint32_t * size)
+{
+  switch (kind) {
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+    case eprosima::fastrtps::types::TK_BYTE:
+    case eprosima::fastrtps::types::TK_CHAR8:
+      *align = *size = 1;
+      return true;
+    case eprosima::fastrtps::types::TK_INT16:
+    case eprosima::fastrtps::types::TK_UINT16:
+      *align = *size = 2;
+      return true;
+    case eprosima::fastrtps::types::TK_CHAR16:  // wchar_t is always sent as 4 bytes
+    case eprosima::fastrtps::types::TK_INT32:
+    case eprosima::fastrtps::types::TK_UINT32:
+    case eprosima::fastrtps::types::TK_FLOAT32:
+      *align = *size = 4;
+      return true;
+    case eprosima::fastrtps::types::TK_INT64:
+    case eprosima::fastrtps::types::TK_UINT64:
+    case eprosima::fastrtps::types::TK_FLOAT64:
+      *align = *size = 8;
+      return true;
+    case eprosima::fastrtps::types::TK_FLOAT128:
+      *align = 8;
+      *size = 16;
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+void
+fastrtps__cdr_layout_compose_phases(const uint32_t * a, const uint32_t * b, uint32_t * out)
+{
+  for (uint32_t phase = 0; phase < FASTRTPS_CDR_LAYOUT_PHASES; ++phase) {
+    out[phase] = a[phase] + b[(phase + a[phase]) % FASTRTPS_CDR_LAYOUT_PHASES];
+  }
+}
+
+
+static const fastrtps__cdr_layout_node_t *
+fastrtps__cdr_layout_add_node(fastrtps__cdr_layout_t * layout, const DynamicType_ptr & type)
+{
+  auto it = layout->nodes_by_type_.find(type.get());
+  if (it != layout->nodes_by_type_.end()) {
+    return it->second;
+  }
+
+  auto node = std::make_unique<fastrtps__cdr_layout_node_t>();
+  TypeDescriptor descriptor;
+  type->get_descriptor(&descriptor);
+  node->kind_ = descriptor.get_kind();
+  node->align_ = 0;
+  node->size_ = 0;
+  node->flat_ = false;
+  node->element_count_ = 0;
+  node->element_ = nullptr;
+  for (uint32_t & size : node->size_by_phase_) {
+    size = 0;
+  }
+
+  switch (node->kind_) {
+    case eprosima::fastrtps::types::TK_STRING8:
+    case eprosima::fastrtps::types::TK_STRING16:
+      break;
+
+    case eprosima::fastrtps::types::TK_ARRAY:
+    case eprosima::fastrtps::types::TK_SEQUENCE: {
+        node->element_ = fastrtps__cdr_layout_add_node(layout, descriptor.get_element_type());
+        if (!node->element_) {
+          return nullptr;
+        }
+        if (node->kind_ == eprosima::fastrtps::types::TK_SEQUENCE) {
+          break;
+        }
+        node->element_count_ = descriptor.get_total_bounds();
+        node->flat_ = node->element_->flat_;
+        if (!node->flat_) {
+          break;
+        }
+        for (uint32_t phase = 0; phase < FASTRTPS_CDR_LAYOUT_PHASES; ++phase) {
+          size_t offset = phase;
+          for (uint32_t i = 0; i < node->element_count_; ++i) {
+            offset += node->element_->size_by_phase_[offset % FASTRTPS_CDR_LAYOUT_PHASES];
+          }
+          node->size_by_phase_[phase] = static_cast<uint32_t>(offset - phase);
+        }
+        break;
+      }
+
+    case eprosima::fastrtps::types::TK_STRUCTURE: {
+        // Member ids are handed out in insertion order, which is also the serialization order
+        std::map<MemberId, DynamicTypeMember *> members;
+        type->get_all_members(members);
+        node->flat_ = true;
+        for (const auto & member : members) {
+          MemberDescriptor member_descriptor;
+          member.second->get_descriptor(&member_descriptor);
+          const fastrtps__cdr_layout_node_t * member_node =
+            fastrtps__cdr_layout_add_node(layout, member_descriptor.get_type());
+          if (!member_node) {
+            return nullptr;
+          }
+          node->members_.push_back({member_descriptor.get_name(), member_node});
+          if (node->flat_ && member_node->flat_) {
+            uint32_t size_by_phase[FASTRTPS_CDR_LAYOUT_PHASES];
+            fastrtps__cdr_layout_compose_phases(
+              node->size_by_phase_, member_node->size_by_phase_, size_by_phase);
+            std::copy(
+              size_by_phase, size_by_phase + FASTRTPS_CDR_LAYOUT_PHASES, node->size_by_phase_);
+          } else {
+            node->flat_ = false;
+          }
+        }
+        break;
+      }
+
+    default:
+      if (!fastrtps__cdr_layout_get_primitive(node->kind_, &node->align_, &node->size_)) {
+        return nullptr;
+      }
+      node->flat_ = true;
+      for (uint32_t phase = 0; phase < FASTRTPS_CDR_LAYOUT_PHASES; ++phase) {
+        node->size_by_phase_[phase] = (node->align_ - phase % node->align_) % node->align_ +
+          node->size_;
+      }
+      break;
+  }
+
+  const fastrtps__cdr_layout_node_t * out = node.get();
+  layout->nodes_.push_back(std::move(node));
+  layout->nodes_by_type_.emplace(type.get(), out);
+  return out;
+}
+
+
+rcutils_ret_t
+fastrtps__cdr_layout_init(const DynamicType_ptr & type, fastrtps__cdr_layout_t * layout)
+{
+  layout->root_ = fastrtps__cdr_layout_add_node(layout, type);
+  if (!layout->root_) {
+    RCUTILS_SET_ERROR_MSG("Type has members that can't be laid out in serialized form");
+    return RCUTILS_RET_ERROR;
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+// READ ============================================================================================
+bool
+fastrtps__cdr_reader_init(fastrtps__cdr_reader_t * reader, const uint8_t * buffer, size_t length)
+{
+  // Encapsulation kind is a big-endian u16: CDR_BE (0) or CDR_LE (1), the next 2 bytes are options
+  if (length < 4 || buffer[0] != 0 || buffer[1] > 1) {
+    return false;
+  }
+  const uint16_t probe = 1;
+  bool host_little_endian = *reinterpret_cast<const uint8_t *>(&probe) == 1;
+
+  reader->data_ = buffer + 4;
+  reader->length_ = length - 4;
+  reader->swap_ = (buffer[1] == 1) != host_little_endian;
+  return true;
+}
+
+
+bool
+fastrtps__cdr_layout_skip(
+  const fastrtps__cdr_layout_node_t * node, const fastrtps__cdr_reader_t * reader, size_t * offset)
+{
+  if (node->flat_) {
+    *offset += node->size_by_phase_[*offset % FASTRTPS_CDR_LAYOUT_PHASES];
+    return *offset <= reader->length_;
+  }
+
+  uint32_t length;
+  switch (node->kind_) {
+    case eprosima::fastrtps::types::TK_STRING8:
+    case eprosima::fastrtps::types::TK_STRING16:
+      if (!fastrtps__cdr_reader_read(reader, offset, 4, 4, &length)) {
+        return false;
+      }
+      // Strings include their terminator, wide strings are sent as 4 byte characters without one
+      *offset += node->kind_ == eprosima::fastrtps::types::TK_STRING8 ?
+        static_cast<size_t>(length) : static_cast<size_t>(length) * 4;
+      return *offset <= reader->length_;
+
+    case eprosima::fastrtps::types::TK_SEQUENCE:
+      if (!fastrtps__cdr_reader_read(reader, offset, 4, 4, &length)) {
+        return false;
+      }
+      if (length == 0) {
+        return true;
+      }
+      if (node->element_->size_) {
+        *offset = (*offset + node->element_->align_ - 1) & ~static_cast<size_t>(
+          node->element_->align_ - 1);
+        if ((reader->length_ - std::min(*offset, reader->length_)) / node->element_->size_ <
+          length)
+        {
+          return false;
+        }
+        *offset += static_cast<size_t>(length) * node->element_->size_;
+        return true;
+      }
+      for (uint32_t i = 0; i < length; ++i) {
+        if (!fastrtps__cdr_layout_skip(node->element_, reader, offset)) {
+          return false;
+        }
+      }
+      return true;
+
+    case eprosima::fastrtps::types::TK_ARRAY:
+      for (uint32_t i = 0; i < node->element_count_; ++i) {
+        if (!fastrtps__cdr_layout_skip(node->element_, reader, offset)) {
+          return false;
+        }
+      }
+      return true;
+
+    case eprosima::fastrtps::types::TK_STRUCTURE:
+      for (const auto & member : node->members_) {
+        if (!fastrtps__cdr_layout_skip(member.node_, reader, offset)) {
+          return false;
+        }
+      }
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+
+bool
+fastrtps__cdr_layout_seek_element(
+  const fastrtps__cdr_layout_node_t * node, const fastrtps__cdr_reader_t * reader,
+  uint32_t index, size_t * offset)
+{
+  uint32_t element_count = node->element_count_;
+  if (node->kind_ == eprosima::fastrtps::types::TK_SEQUENCE &&
+    !fastrtps__cdr_reader_read(reader, offset, 4, 4, &element_count))
+  {
+    return false;
+  }
+  if (index >= element_count) {
+    return false;
+  }
+
+  // Primitive elements are laid out back to back once the first one is aligned
+  const fastrtps__cdr_layout_node_t * element = node->element_;
+  if (element->size_) {
+    *offset = (*offset + element->align_ - 1) & ~static_cast<size_t>(element->align_ - 1);
+    *offset += static_cast<size_t>(index) * element->size_;
+    return *offset <= reader->length_;
+  }
+  for (uint32_t i = 0; i < index; ++i) {
+    if (!fastrtps__cdr_layout_skip(element, reader, offset)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool
+fastrtps__cdr_layout_index_elements(
+  const fastrtps__cdr_layout_node_t * node, const fastrtps__cdr_reader_t * reader,
+  size_t * offset, std::vector<size_t> * offsets)
+{
+  offsets->clear();
+  uint32_t element_count = node->element_count_;
+  if (node->kind_ == eprosima::fastrtps::types::TK_SEQUENCE &&
+    !fastrtps__cdr_reader_read(reader, offset, 4, 4, &element_count))
+  {
+    return false;
+  }
+  // A corrupt length prefix must not reserve more than the buffer could possibly hold
+  offsets->reserve(
+    std::min<size_t>(element_count, reader->length_ - std::min(*offset, reader->length_)) + 1);
+  for (uint32_t i = 0; i < element_count; ++i) {
+    offsets->push_back(*offset);
+    if (!fastrtps__cdr_layout_skip(node->element_, reader, offset)) {
+      return false;
+    }
+  }
+  offsets->push_back(*offset);
+  return true;
+}
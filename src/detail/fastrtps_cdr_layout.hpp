@@ -0,0 +1,180 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_CDR_LAYOUT_HPP_
+#define DETAIL__FASTRTPS_CDR_LAYOUT_HPP_
+
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// =================================================================================================
+// CDR LAYOUT
+// =================================================================================================
+//
+// Where the members of a dynamic type are in its serialized form, so serialized data can be read
+// without deserializing it into a DynamicData first.
+//
+// fastrtps serializes dynamic data as plain (XCDR1) CDR: a 4 byte encapsulation header, then
+// every member in member id order, each primitive aligned to its size (at most 8) relative to the
+// end of the header. Strings and sequences are prefixed with a u32 length, arrays are not.
+//
+// Because of alignment, how many bytes a member takes depends on where it starts. For members
+// whose size doesn't depend on their value (flat members), that only depends on the start offset
+// modulo 8, so their size is precomputed for all 8 phases, and skipping over them costs nothing.
+
+#define FASTRTPS_CDR_LAYOUT_PHASES 8
+
+struct fastrtps__cdr_layout_node_s;
+
+typedef struct fastrtps__cdr_layout_member_s
+{
+  std::string name_;
+  const struct fastrtps__cdr_layout_node_s * node_;
+} fastrtps__cdr_layout_member_t;
+
+typedef struct fastrtps__cdr_layout_node_s
+{
+  eprosima::fastrtps::types::TypeKind kind_;
+
+  // Primitives only
+  uint32_t align_;
+  uint32_t size_;
+
+  // Whether the serialized size only depends on the start phase, and if so, that size per phase
+  bool flat_;
+  uint32_t size_by_phase_[FASTRTPS_CDR_LAYOUT_PHASES];
+
+  // Arrays (total element count) and sequences
+  uint32_t element_count_;
+  const struct fastrtps__cdr_layout_node_s * element_;
+
+  // Structs
+  std::vector<fastrtps__cdr_layout_member_t> members_;
+} fastrtps__cdr_layout_node_t;
+
+typedef struct fastrtps__cdr_layout_s
+{
+  const fastrtps__cdr_layout_node_t * root_;
+
+  std::vector<std::unique_ptr<fastrtps__cdr_layout_node_t>> nodes_;
+  // Nested types used several times only get one node
+  std::unordered_map<
+    const eprosima::fastrtps::types::DynamicType *, const fastrtps__cdr_layout_node_t *
+  > nodes_by_type_;
+} fastrtps__cdr_layout_t;
+
+/// A serialized buffer, with offsets counted from the end of the encapsulation header
+typedef struct fastrtps__cdr_reader_s
+{
+  const uint8_t * data_;
+  size_t length_;
+  bool swap_;
+} fastrtps__cdr_reader_t;
+
+
+/// Compute the layout of `type`
+/// Returns RCUTILS_RET_ERROR if the type has members that can't be laid out
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__cdr_layout_init(
+  const eprosima::fastrtps::types::DynamicType_ptr & type,
+  fastrtps__cdr_layout_t * layout);  // OUT
+
+/// Size of flat `a` followed by flat `b`, per start phase
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__cdr_layout_compose_phases(
+  const uint32_t * a, const uint32_t * b,
+  uint32_t * out);  // OUT
+
+/// Set up `reader` over a serialized buffer, starting with its encapsulation header
+/// Returns false if the buffer is not plain CDR
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__cdr_reader_init(
+  fastrtps__cdr_reader_t * reader,  // OUT
+  const uint8_t * buffer, size_t length);
+
+/// Advance `offset` past a value of `node` starting there
+/// Returns false if the buffer ends first
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__cdr_layout_skip(
+  const fastrtps__cdr_layout_node_t * node,
+  const fastrtps__cdr_reader_t * reader,
+  size_t * offset);  // IN/OUT
+
+/// Advance `offset` to element `index` of the array or sequence `node` starting there
+/// Returns false if the buffer ends first, or the sequence has no such element
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__cdr_layout_seek_element(
+  const fastrtps__cdr_layout_node_t * node,
+  const fastrtps__cdr_reader_t * reader,
+  uint32_t index,
+  size_t * offset);  // IN/OUT
+
+/// Record where every element of the array or sequence `node` starting at `offset` starts, in one
+/// pass, followed by where the last one ends, and advance `offset` past it
+/// Returns false if the buffer ends first
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__cdr_layout_index_elements(
+  const fastrtps__cdr_layout_node_t * node,
+  const fastrtps__cdr_reader_t * reader,
+  size_t * offset,  // IN/OUT
+  std::vector<size_t> * offsets);  // OUT
+
+
+
+/// Read a primitive of `size` bytes at `offset`, aligning it first, and advance past it
+/// Returns false if the buffer ends first
+inline bool
+fastrtps__cdr_reader_read(
+  const fastrtps__cdr_reader_t * reader,
+  size_t * offset,  // IN/OUT
+  uint32_t align, uint32_t size,
+  void * out)  // OUT
+{
+  size_t start = (*offset + align - 1) & ~static_cast<size_t>(align - 1);
+  if (start > reader->length_ || reader->length_ - start < size) {
+    return false;
+  }
+  uint8_t * bytes = static_cast<uint8_t *>(out);
+  if (reader->swap_) {
+    for (uint32_t i = 0; i < size; ++i) {
+      bytes[i] = reader->data_[start + size - 1 - i];
+    }
+  } else {
+    std::memcpy(bytes, reader->data_ + start, size);
+  }
+  *offset = start + size;
+  return true;
+}
+
+
+#endif  // DETAIL__FASTRTPS_CDR_LAYOUT_HPP_
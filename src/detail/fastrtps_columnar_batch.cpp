@@ -0,0 +1,491 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastrtps_columnar_batch.hpp"
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport_fastrtps/columnar_batch.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "fastrtps_cdr_layout.hpp"
+#include "fastrtps_dynamic_data_image.hpp"
+
+
+using eprosima::fastrtps::types::DynamicData;
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::TypeKind;
+
+
+// =================================================================================================
+// COLUMNAR BATCH
+// =================================================================================================
+
+// COLUMNS =========================================================================================
+static bool
+fastrtps__columnar_get_primitive_type(
+  TypeKind kind, rosidl_dynamic_typesupport_fastrtps_column_type_t * type)
+{
+  switch (kind) {
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_BOOL;
+      return true;
+    case eprosima::fastrtps::types::TK_BYTE:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_BYTE;
+      return true;
+    case eprosima::fastrtps::types::TK_CHAR8:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_CHAR;
+      return true;
+    case eprosima::fastrtps::types::TK_CHAR16:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_WCHAR;
+      return true;
+    case eprosima::fastrtps::types::TK_INT16:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT16;
+      return true;
+    case eprosima::fastrtps::types::TK_UINT16:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_UINT16;
+      return true;
+    case eprosima::fastrtps::types::TK_INT32:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT32;
+      return true;
+    case eprosima::fastrtps::types::TK_UINT32:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_UINT32;
+      return true;
+    case eprosima::fastrtps::types::TK_INT64:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT64;
+      return true;
+    case eprosima::fastrtps::types::TK_UINT64:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_UINT64;
+      return true;
+    case eprosima::fastrtps::types::TK_FLOAT32:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FLOAT32;
+      return true;
+    case eprosima::fastrtps::types::TK_FLOAT64:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FLOAT64;
+      return true;
+    case eprosima::fastrtps::types::TK_FLOAT128:
+      *type = ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FLOAT128;
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+static fastrtps__columnar_column_t *
+fastrtps__columnar_add_column(
+  fastrtps__columnar_batch_t * batch,
+  const std::string & name, rosidl_dynamic_typesupport_fastrtps_column_type_t type,
+  size_t parent, size_t per_row)
+{
+  auto column_ptr = std::make_unique<fastrtps__columnar_column_t>();
+  fastrtps__columnar_column_t * column = column_ptr.get();
+  batch->columns_.push_back(std::move(column_ptr));
+  column->name_ = name;
+  column->type_ = type;
+  column->parent_ = parent;
+  column->align_ = 0;
+  column->width_ = 0;
+  column->list_size_ = 0;
+  column->per_row_ = per_row;
+  column->length_ = 0;
+  if (type == ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRING ||
+    type == ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_LIST)
+  {
+    column->offsets_.push_back(0);
+  }
+  return column;
+}
+
+
+static fastrtps__columnar_column_t *
+fastrtps__columnar_add_node_column(
+  fastrtps__columnar_batch_t * batch,
+  const fastrtps__cdr_layout_node_t * node, const std::string & name,
+  size_t parent, size_t per_row)
+{
+  size_t index = batch->columns_.size();
+  fastrtps__columnar_column_t * column = nullptr;
+  fastrtps__columnar_column_t * child = nullptr;
+  switch (node->kind_) {
+    case eprosima::fastrtps::types::TK_STRUCTURE:
+      column = fastrtps__columnar_add_column(
+        batch, name, ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRUCT, parent, per_row);
+      for (const auto & member : node->members_) {
+        child = fastrtps__columnar_add_node_column(
+          batch, member.node_, member.name_, index, per_row);
+        if (!child) {
+          return nullptr;
+        }
+        column->children_.push_back(child);
+      }
+      return column;
+
+    case eprosima::fastrtps::types::TK_SEQUENCE:
+      column = fastrtps__columnar_add_column(
+        batch, name, ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_LIST, parent, per_row);
+      child = fastrtps__columnar_add_node_column(batch, node->element_, "item", index, 0);
+      break;
+
+    case eprosima::fastrtps::types::TK_ARRAY:
+      column = fastrtps__columnar_add_column(
+        batch, name, ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FIXED_SIZE_LIST,
+        parent, per_row);
+      column->list_size_ = node->element_count_;
+      child = fastrtps__columnar_add_node_column(
+        batch, node->element_, "item", index, per_row * node->element_count_);
+      break;
+
+    case eprosima::fastrtps::types::TK_STRING8:
+      return fastrtps__columnar_add_column(
+        batch, name, ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRING, parent, per_row);
+
+    case eprosima::fastrtps::types::TK_STRING16:
+      // Serialized like a sequence of 4 byte characters
+      column = fastrtps__columnar_add_column(
+        batch, name, ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_LIST, parent, per_row);
+      child = fastrtps__columnar_add_column(
+        batch, "item", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_WCHAR, index, 0);
+      child->align_ = child->width_ = 4;
+      break;
+
+    default: {
+        rosidl_dynamic_typesupport_fastrtps_column_type_t type;
+        if (!fastrtps__columnar_get_primitive_type(node->kind_, &type)) {
+          RCUTILS_SET_ERROR_MSG("Type has members that can't be stored in columns");
+          return nullptr;
+        }
+        column = fastrtps__columnar_add_column(batch, name, type, parent, per_row);
+        if (type != ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_BOOL) {
+          column->align_ = node->align_;
+          column->width_ = node->size_;
+        }
+        return column;
+      }
+  }
+
+  if (!child) {
+    return nullptr;
+  }
+  column->children_.push_back(child);
+  return column;
+}
+
+
+// APPEND ==========================================================================================
+static bool
+fastrtps__columnar_append(
+  fastrtps__columnar_column_t * column, const fastrtps__cdr_reader_t * reader, size_t * offset);
+
+
+static void
+fastrtps__columnar_append_bit(fastrtps__columnar_column_t * column, bool bit)
+{
+  if (column->length_ % 8 == 0) {
+    column->values_.push_back(0);
+  }
+  uint8_t mask = static_cast<uint8_t>(1u << (column->length_ % 8));
+  // Bits past the end may be left over from a rolled back row, so clear as well as set
+  if (bit) {
+    column->values_.back() |= mask;
+  } else {
+    column->values_.back() &= static_cast<uint8_t>(~mask);
+  }
+  ++column->length_;
+}
+
+
+// Append `count` consecutive values to `column`
+static bool
+fastrtps__columnar_append_run(
+  fastrtps__columnar_column_t * column, uint32_t count,
+  const fastrtps__cdr_reader_t * reader, size_t * offset)
+{
+  if (count == 0 || column->width_ == 0) {
+    for (uint32_t i = 0; i < count; ++i) {
+      if (!fastrtps__columnar_append(column, reader, offset)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Primitives are back to back once the first one is aligned, so they are copied in one go
+  *offset = (*offset + column->align_ - 1) & ~static_cast<size_t>(column->align_ - 1);
+  if (*offset > reader->length_ || (reader->length_ - *offset) / column->width_ < count) {
+    return false;
+  }
+  size_t size = static_cast<size_t>(count) * column->width_;
+  const uint8_t * source = reader->data_ + *offset;
+  if (!reader->swap_) {
+    column->values_.insert(column->values_.end(), source, source + size);
+  } else {
+    size_t start = column->values_.size();
+    column->values_.resize(start + size);
+    uint8_t * target = column->values_.data() + start;
+    for (size_t value = 0; value < size; value += column->width_) {
+      for (uint32_t i = 0; i < column->width_; ++i) {
+        target[value + i] = source[value + column->width_ - 1 - i];
+      }
+    }
+  }
+  *offset += size;
+  column->length_ += count;
+  return true;
+}
+
+
+static bool
+fastrtps__columnar_push_offset(std::vector<int32_t> & offsets, size_t offset)
+{
+  // Offsets are int32, like in the default (non large) Arrow list and string layouts
+  if (offset > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    return false;
+  }
+  offsets.push_back(static_cast<int32_t>(offset));
+  return true;
+}
+
+
+static bool
+fastrtps__columnar_append(
+  fastrtps__columnar_column_t * column, const fastrtps__cdr_reader_t * reader, size_t * offset)
+{
+  uint32_t length;
+  switch (column->type_) {
+    case ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_BOOL: {
+        uint8_t value;
+        if (!fastrtps__cdr_reader_read(reader, offset, 1, 1, &value)) {
+          return false;
+        }
+        fastrtps__columnar_append_bit(column, value != 0);
+        return true;
+      }
+
+    case ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRING:
+      if (!fastrtps__cdr_reader_read(reader, offset, 4, 4, &length) ||
+        reader->length_ - *offset < length)
+      {
+        return false;
+      }
+      // Serialized strings include their terminator
+      if (length > 0) {
+        column->values_.insert(
+          column->values_.end(), reader->data_ + *offset, reader->data_ + *offset + length - 1);
+      }
+      *offset += length;
+      break;
+
+    case ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_LIST:
+      if (!fastrtps__cdr_reader_read(reader, offset, 4, 4, &length) ||
+        !fastrtps__columnar_append_run(column->children_[0], length, reader, offset))
+      {
+        return false;
+      }
+      break;
+
+    case ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FIXED_SIZE_LIST:
+      if (!fastrtps__columnar_append_run(
+          column->children_[0], column->list_size_, reader, offset))
+      {
+        return false;
+      }
+      break;
+
+    case ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRUCT:
+      for (fastrtps__columnar_column_t * child : column->children_) {
+        if (!fastrtps__columnar_append(child, reader, offset)) {
+          return false;
+        }
+      }
+      break;
+
+    default:
+      return fastrtps__columnar_append_run(column, 1, reader, offset);
+  }
+
+  if (column->type_ == ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRING &&
+    !fastrtps__columnar_push_offset(column->offsets_, column->values_.size()))
+  {
+    return false;
+  }
+  if (column->type_ == ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_LIST &&
+    !fastrtps__columnar_push_offset(column->offsets_, column->children_[0]->length_))
+  {
+    return false;
+  }
+  ++column->length_;
+  return true;
+}
+
+
+// Append one sample, leaving every column as it was if it can't be appended whole
+static bool
+fastrtps__columnar_batch_append_row(
+  fastrtps__columnar_batch_t * batch, const fastrtps__cdr_reader_t * reader)
+{
+  for (size_t i = 0; i < batch->columns_.size(); ++i) {
+    const fastrtps__columnar_column_t * column = batch->columns_[i].get();
+    batch->marks_[i] = {column->length_, column->offsets_.size(), column->values_.size()};
+  }
+
+  size_t offset = 0;
+  if (fastrtps__columnar_append(batch->columns_.front().get(), reader, &offset)) {
+    return true;
+  }
+
+  for (size_t i = 0; i < batch->columns_.size(); ++i) {
+    fastrtps__columnar_column_t * column = batch->columns_[i].get();
+    column->length_ = batch->marks_[i].length_;
+    column->offsets_.resize(batch->marks_[i].offsets_size_);
+    column->values_.resize(batch->marks_[i].values_size_);
+  }
+  return false;
+}
+
+
+// Make room for `count` more rows in every column whose size per row is known
+static void
+fastrtps__columnar_batch_reserve(fastrtps__columnar_batch_t * batch, size_t count)
+{
+  for (const auto & column : batch->columns_) {
+    size_t values = column->length_ + count * column->per_row_;
+    if (column->width_) {
+      column->values_.reserve(values * column->width_);
+    } else if (column->type_ == ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_BOOL) {
+      column->values_.reserve((values + 7) / 8);
+    } else if (!column->offsets_.empty()) {
+      column->offsets_.reserve(values + 1);
+    }
+  }
+}
+
+
+rcutils_ret_t
+fastrtps__columnar_batch_append_data(
+  fastrtps__columnar_batch_t * batch, const DynamicData * const * data, size_t count)
+{
+  fastrtps__columnar_batch_reserve(batch, count);
+
+  // Kept across calls, so steady state appends don't allocate for the image
+  thread_local std::vector<char> image;
+  for (size_t i = 0; i < count; ++i) {
+    if (!fastrtps__dynamic_data_image_write(data[i], image)) {
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING("Could not serialize dynamic data %zu", i);
+      return RCUTILS_RET_ERROR;
+    }
+    fastrtps__cdr_reader_t reader{reinterpret_cast<const uint8_t *>(image.data()), image.size(),
+      false};
+    if (!fastrtps__columnar_batch_append_row(batch, &reader)) {
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "Could not append dynamic data %zu to batch, is it of the batch's type?", i);
+      return RCUTILS_RET_ERROR;
+    }
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__columnar_batch_append_serialized(
+  fastrtps__columnar_batch_t * batch,
+  const uint8_t * const * buffers, const size_t * lengths,
+  size_t count)
+{
+  fastrtps__columnar_batch_reserve(batch, count);
+
+  for (size_t i = 0; i < count; ++i) {
+    fastrtps__cdr_reader_t reader;
+    if (!fastrtps__cdr_reader_init(&reader, buffers[i], lengths[i])) {
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING("Sample %zu is not plain CDR serialized data", i);
+      return RCUTILS_RET_INVALID_ARGUMENT;
+    }
+    if (!fastrtps__columnar_batch_append_row(batch, &reader)) {
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "Could not append sample %zu to batch, is it truncated or of another type?", i);
+      return RCUTILS_RET_ERROR;
+    }
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+// CORE ============================================================================================
+rcutils_ret_t
+fastrtps__columnar_batch_init(
+  const DynamicType_ptr & type,
+  rcutils_allocator_t * allocator,
+  fastrtps__columnar_batch_t ** batch)
+{
+  fastrtps__cdr_layout_t layout;
+  rcutils_ret_t ret = fastrtps__cdr_layout_init(type, &layout);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  if (layout.root_->kind_ != eprosima::fastrtps::types::TK_STRUCTURE) {
+    RCUTILS_SET_ERROR_MSG("Columnar batches can only hold struct types");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+
+  void * batch_mem = allocator->allocate(sizeof(fastrtps__columnar_batch_t), allocator->state);
+  if (!batch_mem) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate columnar batch");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  // Holds C++ members, so it must be constructed in place
+  auto out = new (batch_mem) fastrtps__columnar_batch_t();
+  out->allocator_ = *allocator;
+
+  if (!fastrtps__columnar_add_node_column(out, layout.root_, "", 0, 1)) {
+    fastrtps__columnar_batch_fini(out);
+    return RCUTILS_RET_ERROR;
+  }
+  out->marks_.resize(out->columns_.size());
+  *batch = out;
+  return RCUTILS_RET_OK;
+}
+
+
+void
+fastrtps__columnar_batch_clear(fastrtps__columnar_batch_t * batch)
+{
+  for (const auto & column : batch->columns_) {
+    column->length_ = 0;
+    column->offsets_.resize(column->offsets_.empty() ? 0 : 1);
+    column->values_.clear();
+  }
+}
+
+
+rcutils_ret_t
+fastrtps__columnar_batch_fini(fastrtps__columnar_batch_t * batch)
+{
+  rcutils_allocator_t allocator = batch->allocator_;
+  batch->~fastrtps__columnar_batch_t();
+  allocator.deallocate(batch, allocator.state);
+  return RCUTILS_RET_OK;
+}
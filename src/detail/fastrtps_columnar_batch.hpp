@@ -0,0 +1,116 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DETAIL__FASTRTPS_COLUMNAR_BATCH_HPP_
+#define DETAIL__FASTRTPS_COLUMNAR_BATCH_HPP_
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport_fastrtps/columnar_batch.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// =================================================================================================
+// COLUMNAR BATCH
+// =================================================================================================
+//
+// Samples are appended straight from their serialized form (dynamic data is serialized to its
+// image first), walking the CDR layout of the type once per sample and appending every value to
+// the end of its column. Runs of primitives (sequences and arrays of them) are copied in bulk.
+
+typedef struct fastrtps__columnar_column_s
+{
+  std::string name_;
+  rosidl_dynamic_typesupport_fastrtps_column_type_t type_;
+  size_t parent_;
+
+  // Fixed width columns only, 0 for every other column (including bool bitmaps)
+  uint32_t align_;
+  uint32_t width_;
+
+  // Fixed size lists only
+  uint32_t list_size_;
+
+  // Lists and fixed size lists have one child, structs one per member
+  std::vector<struct fastrtps__columnar_column_s *> children_;
+
+  // Values this column gets per row, when that doesn't depend on the row (0 inside lists)
+  size_t per_row_;
+
+  size_t length_;
+  std::vector<int32_t> offsets_;
+  std::vector<uint8_t> values_;
+} fastrtps__columnar_column_t;
+
+/// Where a column ended before the row being appended, to roll it back if the row fails
+typedef struct fastrtps__columnar_mark_s
+{
+  size_t length_;
+  size_t offsets_size_;
+  size_t values_size_;
+} fastrtps__columnar_mark_t;
+
+typedef struct fastrtps__columnar_batch_s
+{
+  rcutils_allocator_t allocator_;
+
+  // In pre-order, the root struct column first
+  std::vector<std::unique_ptr<fastrtps__columnar_column_t>> columns_;
+  std::vector<fastrtps__columnar_mark_t> marks_;
+} fastrtps__columnar_batch_t;
+
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__columnar_batch_init(
+  const eprosima::fastrtps::types::DynamicType_ptr & type,
+  rcutils_allocator_t * allocator,
+  fastrtps__columnar_batch_t ** batch);  // OUT
+
+/// Append each of the `count` dynamic data as a row
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__columnar_batch_append_data(
+  fastrtps__columnar_batch_t * batch,
+  const eprosima::fastrtps::types::DynamicData * const * data,
+  size_t count);
+
+/// Append each of the `count` serialized samples as a row
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__columnar_batch_append_serialized(
+  fastrtps__columnar_batch_t * batch,
+  const uint8_t * const * buffers, const size_t * lengths,
+  size_t count);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__columnar_batch_clear(fastrtps__columnar_batch_t * batch);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__columnar_batch_fini(fastrtps__columnar_batch_t * batch);
+
+
+#endif  // DETAIL__FASTRTPS_COLUMNAR_BATCH_HPP_
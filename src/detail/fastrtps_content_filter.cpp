@@ -0,0 +1,897 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_content_filter.hpp"
+
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "fastrtps_cdr_layout.hpp"
+
+
+using eprosima::fastrtps::types::DynamicType_ptr;
+
+
+typedef enum fastrtps__content_filter_token_kind_e
+{
+  FASTRTPS_CONTENT_FILTER_TOKEN_END,
+  FASTRTPS_CONTENT_FILTER_TOKEN_NAME,
+  FASTRTPS_CONTENT_FILTER_TOKEN_NUMBER,
+  FASTRTPS_CONTENT_FILTER_TOKEN_STRING,
+  FASTRTPS_CONTENT_FILTER_TOKEN_PARAMETER,
+  FASTRTPS_CONTENT_FILTER_TOKEN_OPERATOR,
+  FASTRTPS_CONTENT_FILTER_TOKEN_PUNCTUATION,  // ( ) . [ ]
+} fastrtps__content_filter_token_kind_t;
+
+typedef struct fastrtps__content_filter_token_s
+{
+  fastrtps__content_filter_token_kind_t kind_;
+  std::string text_;
+  size_t position_;
+} fastrtps__content_filter_token_t;
+
+typedef struct fastrtps__content_filter_parser_s
+{
+  const char * expression_;
+  size_t position_;
+  const char * const * parameters_;
+  size_t parameter_count_;
+  const fastrtps__cdr_layout_t * layout_;
+  size_t depth_;  // Of the expression tree around what is being parsed
+} fastrtps__content_filter_parser_t;
+
+// A value read from a buffer, or taken from a literal
+typedef struct fastrtps__content_filter_value_s
+{
+  fastrtps__content_filter_value_kind_t kind_;
+  int64_t int_;
+  uint64_t uint_;
+  double double_;
+  std::string_view string_;
+} fastrtps__content_filter_value_t;
+
+
+// =================================================================================================
+// CONTENT FILTER
+// =================================================================================================
+
+// TOKENS ==========================================================================================
+// Returns false, with the error message set, if there is no valid token at the current position
+static bool
+fastrtps__content_filter_next_token(
+  fastrtps__content_filter_parser_t * parser, fastrtps__content_filter_token_t * token)
+{
+  const char * expression = parser->expression_;
+  size_t & position = parser->position_;
+  while (std::isspace(static_cast<unsigned char>(expression[position]))) {
+    ++position;
+  }
+
+  token->position_ = position;
+  token->text_.clear();
+  char c = expression[position];
+
+  if (c == '\0') {
+    token->kind_ = FASTRTPS_CONTENT_FILTER_TOKEN_END;
+    return true;
+  }
+
+  if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+    token->kind_ = FASTRTPS_CONTENT_FILTER_TOKEN_NAME;
+    while (std::isalnum(static_cast<unsigned char>(expression[position])) ||
+      expression[position] == '_')
+    {
+      token->text_.push_back(expression[position++]);
+    }
+    return true;
+  }
+
+  if (std::isdigit(static_cast<unsigned char>(c)) ||
+    ((c == '-' || c == '+') && std::isdigit(static_cast<unsigned char>(expression[position + 1]))))
+  {
+    token->kind_ = FASTRTPS_CONTENT_FILTER_TOKEN_NUMBER;
+    const char * start = expression + position;
+    char * end = nullptr;
+    std::strtod(start, &end);
+    token->text_.assign(start, static_cast<size_t>(end - start));
+    position += token->text_.size();
+    return true;
+  }
+
+  if (c == '\'') {
+    token->kind_ = FASTRTPS_CONTENT_FILTER_TOKEN_STRING;
+    ++position;
+    while (true) {
+      if (expression[position] == '\0') {
+        RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "Unterminated string in filter expression at %zu", token->position_);
+        return false;
+      }
+      // Quotes are escaped by doubling them
+      if (expression[position] == '\'') {
+        if (expression[position + 1] != '\'') {
+          ++position;
+          return true;
+        }
+        ++position;
+      }
+      token->text_.push_back(expression[position++]);
+    }
+  }
+
+  if (c == '%' && std::isdigit(static_cast<unsigned char>(expression[position + 1]))) {
+    token->kind_ = FASTRTPS_CONTENT_FILTER_TOKEN_PARAMETER;
+    ++position;
+    while (std::isdigit(static_cast<unsigned char>(expression[position]))) {
+      token->text_.push_back(expression[position++]);
+    }
+    return true;
+  }
+
+  static const char * const operators[] = {"<>", "!=", "<=", ">=", "=", "<", ">"};
+  for (const char * op : operators) {
+    size_t op_length = std::strlen(op);
+    if (std::strncmp(expression + position, op, op_length) == 0) {
+      token->kind_ = FASTRTPS_CONTENT_FILTER_TOKEN_OPERATOR;
+      token->text_ = op;
+      position += op_length;
+      return true;
+    }
+  }
+
+  if (std::strchr("().[]", c)) {
+    token->kind_ = FASTRTPS_CONTENT_FILTER_TOKEN_PUNCTUATION;
+    token->text_ = c;
+    ++position;
+    return true;
+  }
+
+  RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+    "Unexpected character '%c' in filter expression at %zu", c, position);
+  return false;
+}
+
+
+static bool
+fastrtps__content_filter_peek_token(
+  fastrtps__content_filter_parser_t * parser, fastrtps__content_filter_token_t * token)
+{
+  size_t position = parser->position_;
+  bool ok = fastrtps__content_filter_next_token(parser, token);
+  parser->position_ = position;
+  return ok;
+}
+
+
+static bool
+fastrtps__content_filter_equals_keyword(const std::string & text, const char * keyword)
+{
+  if (text.size() != std::strlen(keyword)) {
+    return false;
+  }
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (std::toupper(static_cast<unsigned char>(text[i])) != keyword[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+static bool
+fastrtps__content_filter_is_keyword(
+  const fastrtps__content_filter_token_t & token, const char * keyword)
+{
+  return token.kind_ == FASTRTPS_CONTENT_FILTER_TOKEN_NAME &&
+         fastrtps__content_filter_equals_keyword(token.text_, keyword);
+}
+
+
+static bool
+fastrtps__content_filter_is_punctuation(
+  const fastrtps__content_filter_token_t & token, char punctuation)
+{
+  return token.kind_ == FASTRTPS_CONTENT_FILTER_TOKEN_PUNCTUATION &&
+         token.text_[0] == punctuation;
+}
+
+
+// OPERANDS ========================================================================================
+// Parse a number, TRUE or FALSE literal, returning false if `text` is none of them
+static bool
+fastrtps__content_filter_parse_number(
+  const std::string & text, fastrtps__content_filter_operand_t * operand)
+{
+  if (fastrtps__content_filter_equals_keyword(text, "TRUE") ||
+    fastrtps__content_filter_equals_keyword(text, "FALSE"))
+  {
+    operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_UINT;
+    operand->uint_ = fastrtps__content_filter_equals_keyword(text, "TRUE") ? 1 : 0;
+    return true;
+  }
+  if (text.empty()) {
+    return false;
+  }
+
+  const char * start = text.c_str();
+  char * end = nullptr;
+  errno = 0;
+  if (text.find_first_of(".eE") != std::string::npos) {
+    operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_DOUBLE;
+    operand->double_ = std::strtod(start, &end);
+  } else if (text[0] == '-') {
+    operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_INT;
+    operand->int_ = std::strtoll(start, &end, 10);
+  } else {
+    operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_UINT;
+    operand->uint_ = std::strtoull(start, &end, 10);
+  }
+  return errno == 0 && end == start + text.size();
+}
+
+
+static bool
+fastrtps__content_filter_compile_field(
+  fastrtps__content_filter_parser_t * parser,
+  const fastrtps__content_filter_token_t & first_name,
+  fastrtps__content_filter_operand_t * operand)
+{
+  const fastrtps__cdr_layout_node_t * node = parser->layout_->root_;
+  std::vector<fastrtps__content_filter_step_t> & steps = operand->steps_;
+
+  // Flat members are accumulated into a single jump, until something of variable size comes up
+  fastrtps__content_filter_step_t advance = {};
+  advance.op_ = FASTRTPS_CONTENT_FILTER_STEP_ADVANCE;
+  bool advancing = false;
+  auto flush_advance = [&]() {
+      if (advancing) {
+        steps.push_back(advance);
+        advance = {};
+        advance.op_ = FASTRTPS_CONTENT_FILTER_STEP_ADVANCE;
+        advancing = false;
+      }
+    };
+
+  fastrtps__content_filter_token_t token = first_name;
+  while (true) {
+    if (token.kind_ == FASTRTPS_CONTENT_FILTER_TOKEN_NAME) {
+      if (node->kind_ != eprosima::fastrtps::types::TK_STRUCTURE) {
+        RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "'%s' in filter expression at %zu is not a struct member", token.text_.c_str(),
+          token.position_);
+        return false;
+      }
+      size_t index = 0;
+      while (index < node->members_.size() && node->members_[index].name_ != token.text_) {
+        ++index;
+      }
+      if (index == node->members_.size()) {
+        RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "No member '%s' in filter expression at %zu", token.text_.c_str(), token.position_);
+        return false;
+      }
+
+      for (size_t i = 0; i < index; ++i) {
+        const fastrtps__cdr_layout_node_t * member = node->members_[i].node_;
+        if (member->flat_) {
+          uint32_t size_by_phase[FASTRTPS_CDR_LAYOUT_PHASES];
+          fastrtps__cdr_layout_compose_phases(
+            advance.size_by_phase_, member->size_by_phase_, size_by_phase);
+          std::memcpy(advance.size_by_phase_, size_by_phase, sizeof(size_by_phase));
+          advancing = true;
+        } else {
+          flush_advance();
+          fastrtps__content_filter_step_t skip = {};
+          skip.op_ = FASTRTPS_CONTENT_FILTER_STEP_SKIP;
+          skip.node_ = member;
+          steps.push_back(skip);
+        }
+      }
+      node = node->members_[index].node_;
+    } else {
+      // '[' index ']'
+      fastrtps__content_filter_token_t index_token;
+      if (!fastrtps__content_filter_next_token(parser, &index_token) ||
+        !fastrtps__content_filter_next_token(parser, &token))
+      {
+        return false;
+      }
+      fastrtps__content_filter_operand_t index_operand;
+      if (index_token.kind_ != FASTRTPS_CONTENT_FILTER_TOKEN_NUMBER ||
+        !fastrtps__content_filter_parse_number(index_token.text_, &index_operand) ||
+        index_operand.kind_ != FASTRTPS_CONTENT_FILTER_VALUE_UINT ||
+        index_operand.uint_ > UINT32_MAX || !fastrtps__content_filter_is_punctuation(token, ']'))
+      {
+        RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "Expected an element index in filter expression at %zu", index_token.position_);
+        return false;
+      }
+      if (node->kind_ != eprosima::fastrtps::types::TK_ARRAY &&
+        node->kind_ != eprosima::fastrtps::types::TK_SEQUENCE)
+      {
+        RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "Element index in filter expression at %zu is not on an array or sequence",
+          index_token.position_);
+        return false;
+      }
+      flush_advance();
+      fastrtps__content_filter_step_t element = {};
+      element.op_ = FASTRTPS_CONTENT_FILTER_STEP_ELEMENT;
+      element.node_ = node;
+      element.index_ = static_cast<uint32_t>(index_operand.uint_);
+      steps.push_back(element);
+      node = node->element_;
+    }
+
+    // Continue with '.' name or '[' index ']'
+    fastrtps__content_filter_token_t next;
+    if (!fastrtps__content_filter_peek_token(parser, &next)) {
+      return false;
+    }
+    if (fastrtps__content_filter_is_punctuation(next, '.')) {
+      fastrtps__content_filter_next_token(parser, &next);
+      if (!fastrtps__content_filter_next_token(parser, &token)) {
+        return false;
+      }
+      if (token.kind_ != FASTRTPS_CONTENT_FILTER_TOKEN_NAME) {
+        RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "Expected a member name in filter expression at %zu", token.position_);
+        return false;
+      }
+    } else if (fastrtps__content_filter_is_punctuation(next, '[')) {
+      fastrtps__content_filter_next_token(parser, &token);
+    } else {
+      break;
+    }
+  }
+  flush_advance();
+
+  switch (node->kind_) {
+    case eprosima::fastrtps::types::TK_INT16:
+    case eprosima::fastrtps::types::TK_INT32:
+    case eprosima::fastrtps::types::TK_INT64:
+      operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_INT;
+      break;
+    // int8 members are TK_BYTE as well, so they compare unsigned too
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+    case eprosima::fastrtps::types::TK_BYTE:
+    case eprosima::fastrtps::types::TK_CHAR16:
+    case eprosima::fastrtps::types::TK_UINT16:
+    case eprosima::fastrtps::types::TK_UINT32:
+    case eprosima::fastrtps::types::TK_UINT64:
+      operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_UINT;
+      break;
+    case eprosima::fastrtps::types::TK_FLOAT32:
+    case eprosima::fastrtps::types::TK_FLOAT64:
+      operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_DOUBLE;
+      break;
+    case eprosima::fastrtps::types::TK_CHAR8:
+    case eprosima::fastrtps::types::TK_STRING8:
+      operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_STRING;
+      break;
+    default:
+      // Aggregates, and values that can't be compared portably (long doubles, wide strings)
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "Field in filter expression at %zu can't be compared", first_name.position_);
+      return false;
+  }
+  operand->leaf_ = node;
+  return true;
+}
+
+
+static bool
+fastrtps__content_filter_parse_operand(
+  fastrtps__content_filter_parser_t * parser, fastrtps__content_filter_operand_t * operand)
+{
+  operand->leaf_ = nullptr;
+
+  fastrtps__content_filter_token_t token;
+  if (!fastrtps__content_filter_next_token(parser, &token)) {
+    return false;
+  }
+
+  switch (token.kind_) {
+    case FASTRTPS_CONTENT_FILTER_TOKEN_NAME:
+      if (fastrtps__content_filter_is_keyword(token, "TRUE") ||
+        fastrtps__content_filter_is_keyword(token, "FALSE"))
+      {
+        return fastrtps__content_filter_parse_number(token.text_, operand);
+      }
+      return fastrtps__content_filter_compile_field(parser, token, operand);
+
+    case FASTRTPS_CONTENT_FILTER_TOKEN_NUMBER:
+      if (!fastrtps__content_filter_parse_number(token.text_, operand)) {
+        RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "Number out of range in filter expression at %zu", token.position_);
+        return false;
+      }
+      return true;
+
+    case FASTRTPS_CONTENT_FILTER_TOKEN_STRING:
+      operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_STRING;
+      operand->string_ = std::move(token.text_);
+      return true;
+
+    case FASTRTPS_CONTENT_FILTER_TOKEN_PARAMETER: {
+        size_t index = std::strtoul(token.text_.c_str(), nullptr, 10);
+        if (index >= parser->parameter_count_ || !parser->parameters_[index]) {
+          RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+            "Missing filter parameter %%%zu in filter expression at %zu", index,
+            token.position_);
+          return false;
+        }
+        // Parameters are literals too, quoted strings are taken without their quotes, and
+        // anything that isn't a number is taken as a string
+        std::string text = parser->parameters_[index];
+        size_t first = text.find_first_not_of(" \t\n\r");
+        size_t last = text.find_last_not_of(" \t\n\r");
+        text = first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+        if (text.size() >= 2 && text.front() == '\'' && text.back() == '\'') {
+          operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_STRING;
+          operand->string_ = text.substr(1, text.size() - 2);
+        } else if (!fastrtps__content_filter_parse_number(text, operand)) {
+          operand->kind_ = FASTRTPS_CONTENT_FILTER_VALUE_STRING;
+          operand->string_ = std::move(text);
+        }
+        return true;
+      }
+
+    default:
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "Expected a field or a value in filter expression at %zu", token.position_);
+      return false;
+  }
+}
+
+
+// EXPRESSIONS =====================================================================================
+static std::unique_ptr<fastrtps__content_filter_expression_t>
+fastrtps__content_filter_parse_expression(fastrtps__content_filter_parser_t * parser);
+
+
+// Go one level deeper into the expression tree, callers go back up by decrementing depth_
+// Returns false if that would nest the expression too deep
+static bool
+fastrtps__content_filter_enter(fastrtps__content_filter_parser_t * parser)
+{
+  if (parser->depth_ >= FASTRTPS_CONTENT_FILTER_MAX_DEPTH) {
+    RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "Filter expression nests deeper than %d levels at %zu", FASTRTPS_CONTENT_FILTER_MAX_DEPTH,
+      parser->position_);
+    return false;
+  }
+  ++parser->depth_;
+  return true;
+}
+
+
+static std::unique_ptr<fastrtps__content_filter_expression_t>
+fastrtps__content_filter_parse_factor(fastrtps__content_filter_parser_t * parser)
+{
+  fastrtps__content_filter_token_t token;
+  if (!fastrtps__content_filter_peek_token(parser, &token)) {
+    return nullptr;
+  }
+
+  if (fastrtps__content_filter_is_keyword(token, "NOT")) {
+    fastrtps__content_filter_next_token(parser, &token);
+    if (!fastrtps__content_filter_enter(parser)) {
+      return nullptr;
+    }
+    auto out = std::make_unique<fastrtps__content_filter_expression_t>();
+    out->op_ = FASTRTPS_CONTENT_FILTER_NOT;
+    out->lhs_ = fastrtps__content_filter_parse_factor(parser);
+    --parser->depth_;
+    return out->lhs_ ? std::move(out) : nullptr;
+  }
+
+  if (fastrtps__content_filter_is_punctuation(token, '(')) {
+    fastrtps__content_filter_next_token(parser, &token);
+    if (!fastrtps__content_filter_enter(parser)) {
+      return nullptr;
+    }
+    auto out = fastrtps__content_filter_parse_expression(parser);
+    --parser->depth_;
+    if (!out || !fastrtps__content_filter_next_token(parser, &token)) {
+      return nullptr;
+    }
+    if (!fastrtps__content_filter_is_punctuation(token, ')')) {
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "Expected ')' in filter expression at %zu", token.position_);
+      return nullptr;
+    }
+    return out;
+  }
+
+  auto out = std::make_unique<fastrtps__content_filter_expression_t>();
+  if (!fastrtps__content_filter_parse_operand(parser, &out->left_) ||
+    !fastrtps__content_filter_next_token(parser, &token))
+  {
+    return nullptr;
+  }
+  static const std::pair<const char *, fastrtps__content_filter_op_t> operators[] = {
+    {"=", FASTRTPS_CONTENT_FILTER_EQ}, {"<>", FASTRTPS_CONTENT_FILTER_NE},
+    {"!=", FASTRTPS_CONTENT_FILTER_NE}, {"<", FASTRTPS_CONTENT_FILTER_LT},
+    {"<=", FASTRTPS_CONTENT_FILTER_LE}, {">", FASTRTPS_CONTENT_FILTER_GT},
+    {">=", FASTRTPS_CONTENT_FILTER_GE},
+  };
+  bool found = false;
+  for (const auto & op : operators) {
+    if (token.kind_ == FASTRTPS_CONTENT_FILTER_TOKEN_OPERATOR && token.text_ == op.first) {
+      out->op_ = op.second;
+      found = true;
+    }
+  }
+  if (!found) {
+    RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "Expected a comparison operator in filter expression at %zu", token.position_);
+    return nullptr;
+  }
+  size_t right_position = parser->position_;
+  if (!fastrtps__content_filter_parse_operand(parser, &out->right_)) {
+    return nullptr;
+  }
+
+  if ((out->left_.kind_ == FASTRTPS_CONTENT_FILTER_VALUE_STRING) !=
+    (out->right_.kind_ == FASTRTPS_CONTENT_FILTER_VALUE_STRING))
+  {
+    RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "Cannot compare a string with a number in filter expression at %zu", right_position);
+    return nullptr;
+  }
+  return out;
+}
+
+
+// Parses `operand (keyword operand)*` left associatively
+static std::unique_ptr<fastrtps__content_filter_expression_t>
+fastrtps__content_filter_parse_chain(
+  fastrtps__content_filter_parser_t * parser, const char * keyword,
+  fastrtps__content_filter_op_t op,
+  std::unique_ptr<fastrtps__content_filter_expression_t>(*parse_operand)(
+    fastrtps__content_filter_parser_t *))
+{
+  auto out = parse_operand(parser);
+  fastrtps__content_filter_token_t token;
+  size_t depth = parser->depth_;
+  while (out && fastrtps__content_filter_peek_token(parser, &token) &&
+    fastrtps__content_filter_is_keyword(token, keyword))
+  {
+    fastrtps__content_filter_next_token(parser, &token);
+    // The chain is left associative, every link puts what came before one level deeper
+    if (!fastrtps__content_filter_enter(parser)) {
+      out = nullptr;
+      break;
+    }
+    auto chained = std::make_unique<fastrtps__content_filter_expression_t>();
+    chained->op_ = op;
+    chained->lhs_ = std::move(out);
+    chained->rhs_ = parse_operand(parser);
+    out = chained->rhs_ ? std::move(chained) : nullptr;
+  }
+  parser->depth_ = depth;
+  return out;
+}
+
+
+static std::unique_ptr<fastrtps__content_filter_expression_t>
+fastrtps__content_filter_parse_term(fastrtps__content_filter_parser_t * parser)
+{
+  return fastrtps__content_filter_parse_chain(
+    parser, "AND", FASTRTPS_CONTENT_FILTER_AND, fastrtps__content_filter_parse_factor);
+}
+
+
+static std::unique_ptr<fastrtps__content_filter_expression_t>
+fastrtps__content_filter_parse_expression(fastrtps__content_filter_parser_t * parser)
+{
+  return fastrtps__content_filter_parse_chain(
+    parser, "OR", FASTRTPS_CONTENT_FILTER_OR, fastrtps__content_filter_parse_term);
+}
+
+
+// EVALUATION ======================================================================================
+// Returns false if the operand is not in the buffer
+static bool
+fastrtps__content_filter_read_operand(
+  const fastrtps__content_filter_operand_t & operand,
+  const fastrtps__cdr_reader_t * reader,
+  fastrtps__content_filter_value_t * value)
+{
+  value->kind_ = operand.kind_;
+  if (!operand.leaf_) {
+    value->int_ = operand.int_;
+    value->uint_ = operand.uint_;
+    value->double_ = operand.double_;
+    value->string_ = operand.string_;
+    return true;
+  }
+
+  size_t offset = 0;
+  for (const auto & step : operand.steps_) {
+    switch (step.op_) {
+      case FASTRTPS_CONTENT_FILTER_STEP_ADVANCE:
+        offset += step.size_by_phase_[offset % FASTRTPS_CDR_LAYOUT_PHASES];
+        break;
+      case FASTRTPS_CONTENT_FILTER_STEP_SKIP:
+        if (!fastrtps__cdr_layout_skip(step.node_, reader, &offset)) {
+          return false;
+        }
+        break;
+      case FASTRTPS_CONTENT_FILTER_STEP_ELEMENT:
+        if (!fastrtps__cdr_layout_seek_element(step.node_, reader, step.index_, &offset)) {
+          return false;
+        }
+        break;
+    }
+  }
+
+  const fastrtps__cdr_layout_node_t * leaf = operand.leaf_;
+  switch (leaf->kind_) {
+    case eprosima::fastrtps::types::TK_STRING8: {
+        uint32_t length;
+        if (!fastrtps__cdr_reader_read(reader, &offset, 4, 4, &length) ||
+          length == 0 || reader->length_ - offset < length)
+        {
+          return false;
+        }
+        // The length includes the terminator
+        value->string_ = std::string_view(
+          reinterpret_cast<const char *>(reader->data_ + offset), length - 1);
+        return true;
+      }
+    case eprosima::fastrtps::types::TK_CHAR8:
+      if (offset >= reader->length_) {
+        return false;
+      }
+      value->string_ = std::string_view(reinterpret_cast<const char *>(reader->data_ + offset), 1);
+      return true;
+    default:
+      break;
+  }
+
+  union {
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+    int16_t i16;
+    int32_t i32;
+    int64_t i64;
+    float f32;
+    double f64;
+  } raw;
+  if (!fastrtps__cdr_reader_read(reader, &offset, leaf->align_, leaf->size_, &raw)) {
+    return false;
+  }
+  switch (leaf->kind_) {
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+    case eprosima::fastrtps::types::TK_BYTE:
+      value->uint_ = raw.u8;
+      break;
+    case eprosima::fastrtps::types::TK_UINT16:
+      value->uint_ = raw.u16;
+      break;
+    case eprosima::fastrtps::types::TK_CHAR16:
+    case eprosima::fastrtps::types::TK_UINT32:
+      value->uint_ = raw.u32;
+      break;
+    case eprosima::fastrtps::types::TK_UINT64:
+      value->uint_ = raw.u64;
+      break;
+    case eprosima::fastrtps::types::TK_INT16:
+      value->int_ = raw.i16;
+      break;
+    case eprosima::fastrtps::types::TK_INT32:
+      value->int_ = raw.i32;
+      break;
+    case eprosima::fastrtps::types::TK_INT64:
+      value->int_ = raw.i64;
+      break;
+    case eprosima::fastrtps::types::TK_FLOAT32:
+      value->double_ = raw.f32;
+      break;
+    case eprosima::fastrtps::types::TK_FLOAT64:
+      value->double_ = raw.f64;
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+
+static double
+fastrtps__content_filter_to_double(const fastrtps__content_filter_value_t & value)
+{
+  switch (value.kind_) {
+    case FASTRTPS_CONTENT_FILTER_VALUE_INT:
+      return static_cast<double>(value.int_);
+    case FASTRTPS_CONTENT_FILTER_VALUE_UINT:
+      return static_cast<double>(value.uint_);
+    default:
+      return value.double_;
+  }
+}
+
+
+static bool
+fastrtps__content_filter_compare(
+  fastrtps__content_filter_op_t op,
+  const fastrtps__content_filter_value_t & a,
+  const fastrtps__content_filter_value_t & b)
+{
+  int cmp;
+  if (a.kind_ == FASTRTPS_CONTENT_FILTER_VALUE_STRING) {
+    cmp = a.string_.compare(b.string_);
+  } else if (a.kind_ == FASTRTPS_CONTENT_FILTER_VALUE_DOUBLE ||
+    b.kind_ == FASTRTPS_CONTENT_FILTER_VALUE_DOUBLE)
+  {
+    double x = fastrtps__content_filter_to_double(a);
+    double y = fastrtps__content_filter_to_double(b);
+    if (std::isnan(x) || std::isnan(y)) {
+      return op == FASTRTPS_CONTENT_FILTER_NE;
+    }
+    cmp = x < y ? -1 : (x > y ? 1 : 0);
+  } else if (a.kind_ == b.kind_) {
+    cmp = a.kind_ == FASTRTPS_CONTENT_FILTER_VALUE_INT ?
+      (a.int_ < b.int_ ? -1 : (a.int_ > b.int_ ? 1 : 0)) :
+      (a.uint_ < b.uint_ ? -1 : (a.uint_ > b.uint_ ? 1 : 0));
+  } else if (a.kind_ == FASTRTPS_CONTENT_FILTER_VALUE_INT) {
+    // Mixed signedness, negative values are smaller than any unsigned value
+    cmp = a.int_ < 0 ? -1 : (static_cast<uint64_t>(a.int_) < b.uint_ ? -1 :
+      (static_cast<uint64_t>(a.int_) > b.uint_ ? 1 : 0));
+  } else {
+    cmp = b.int_ < 0 ? 1 : (a.uint_ < static_cast<uint64_t>(b.int_) ? -1 :
+      (a.uint_ > static_cast<uint64_t>(b.int_) ? 1 : 0));
+  }
+
+  switch (op) {
+    case FASTRTPS_CONTENT_FILTER_EQ:
+      return cmp == 0;
+    case FASTRTPS_CONTENT_FILTER_NE:
+      return cmp != 0;
+    case FASTRTPS_CONTENT_FILTER_LT:
+      return cmp < 0;
+    case FASTRTPS_CONTENT_FILTER_LE:
+      return cmp <= 0;
+    case FASTRTPS_CONTENT_FILTER_GT:
+      return cmp > 0;
+    case FASTRTPS_CONTENT_FILTER_GE:
+      return cmp >= 0;
+    default:
+      return false;
+  }
+}
+
+
+static bool
+fastrtps__content_filter_evaluate_expression(
+  const fastrtps__content_filter_expression_t * expression, const fastrtps__cdr_reader_t * reader)
+{
+  switch (expression->op_) {
+    case FASTRTPS_CONTENT_FILTER_OR:
+      return fastrtps__content_filter_evaluate_expression(expression->lhs_.get(), reader) ||
+             fastrtps__content_filter_evaluate_expression(expression->rhs_.get(), reader);
+    case FASTRTPS_CONTENT_FILTER_AND:
+      return fastrtps__content_filter_evaluate_expression(expression->lhs_.get(), reader) &&
+             fastrtps__content_filter_evaluate_expression(expression->rhs_.get(), reader);
+    case FASTRTPS_CONTENT_FILTER_NOT:
+      return !fastrtps__content_filter_evaluate_expression(expression->lhs_.get(), reader);
+    default: {
+        // Fields that are not in the buffer never match
+        fastrtps__content_filter_value_t left;
+        fastrtps__content_filter_value_t right;
+        return fastrtps__content_filter_read_operand(expression->left_, reader, &left) &&
+               fastrtps__content_filter_read_operand(expression->right_, reader, &right) &&
+               fastrtps__content_filter_compare(expression->op_, left, right);
+      }
+  }
+}
+
+
+// CORE ============================================================================================
+rcutils_ret_t
+fastrtps__content_filter_init(
+  const DynamicType_ptr & type,
+  const char * expression,
+  const char * const * parameters, size_t parameter_count,
+  rcutils_allocator_t * allocator,
+  fastrtps__content_filter_t ** filter)
+{
+  void * filter_mem = allocator->allocate(sizeof(fastrtps__content_filter_t), allocator->state);
+  if (!filter_mem) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate content filter");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  // Holds C++ members, so it must be constructed in place
+  auto out = new (filter_mem) fastrtps__content_filter_t();
+  out->allocator_ = *allocator;
+
+  rcutils_ret_t ret = fastrtps__cdr_layout_init(type, &out->layout_);
+  if (ret == RCUTILS_RET_OK &&
+    out->layout_.root_->kind_ != eprosima::fastrtps::types::TK_STRUCTURE)
+  {
+    RCUTILS_SET_ERROR_MSG("Content filters can only be compiled against struct types");
+    ret = RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  if (ret == RCUTILS_RET_OK) {
+    fastrtps__content_filter_parser_t parser = {
+      expression, 0, parameters, parameter_count, &out->layout_, 0};
+    out->expression_ = fastrtps__content_filter_parse_expression(&parser);
+
+    fastrtps__content_filter_token_t token;
+    if (!out->expression_) {
+      ret = RCUTILS_RET_INVALID_ARGUMENT;
+    } else if (!fastrtps__content_filter_next_token(&parser, &token)) {
+      ret = RCUTILS_RET_INVALID_ARGUMENT;
+    } else if (token.kind_ != FASTRTPS_CONTENT_FILTER_TOKEN_END) {
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "Unexpected '%s' in filter expression at %zu", token.text_.c_str(), token.position_);
+      ret = RCUTILS_RET_INVALID_ARGUMENT;
+    }
+  }
+
+  if (ret != RCUTILS_RET_OK) {
+    fastrtps__content_filter_fini(out);
+    return ret;
+  }
+  *filter = out;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__content_filter_evaluate(
+  const fastrtps__content_filter_t * filter,
+  const uint8_t * buffer, size_t length,
+  bool * match)
+{
+  fastrtps__cdr_reader_t reader;
+  if (!fastrtps__cdr_reader_init(&reader, buffer, length)) {
+    RCUTILS_SET_ERROR_MSG("Content filters can only be evaluated on plain CDR data");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  *match = fastrtps__content_filter_evaluate_expression(filter->expression_.get(), &reader);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__content_filter_fini(fastrtps__content_filter_t * filter)
+{
+  rcutils_allocator_t allocator = filter->allocator_;
+  filter->~fastrtps__content_filter_t();
+  allocator.deallocate(filter, allocator.state);
+  return RCUTILS_RET_OK;
+}
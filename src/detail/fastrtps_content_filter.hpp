@@ -0,0 +1,154 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_CONTENT_FILTER_HPP_
+#define DETAIL__FASTRTPS_CONTENT_FILTER_HPP_
+
+#include <fastrtps/types/DynamicTypePtr.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fastrtps_cdr_layout.hpp"
+
+
+// =================================================================================================
+// CONTENT FILTER
+// =================================================================================================
+//
+// Filter expressions are the DDS content filter SQL subset:
+//
+//   expression  := term (OR term)*
+//   term        := factor (AND factor)*
+//   factor      := NOT factor | '(' expression ')' | operand op operand
+//   op          := '=' | '<>' | '!=' | '<' | '<=' | '>' | '>='
+//   operand     := field | number | 'string' | TRUE | FALSE | %n
+//   field       := name ('.' name | '[' index ']')*
+//
+// where %n is replaced by the nth filter parameter. Keywords are case insensitive.
+//
+// Parsing and evaluating recurse once per level of the expression tree, so expressions nesting
+// deeper than FASTRTPS_CONTENT_FILTER_MAX_DEPTH levels are rejected. Every NOT, parenthesis and
+// chained AND or OR counts as a level.
+//
+// Byte fields compare as unsigned values (0 to 255). fastrtps builds int8 members as TK_BYTE too,
+// and the type does not tell them apart, so int8 fields compare unsigned as well.
+//
+// Each field is compiled into the steps that take a reader from the start of the serialized data
+// to the field, merging every run of flat members in between into a single precomputed jump.
+
+#define FASTRTPS_CONTENT_FILTER_MAX_DEPTH 1024
+
+typedef enum fastrtps__content_filter_step_op_e
+{
+  FASTRTPS_CONTENT_FILTER_STEP_ADVANCE,  // Jump over a run of flat members
+  FASTRTPS_CONTENT_FILTER_STEP_SKIP,  // Skip over one variable size member
+  FASTRTPS_CONTENT_FILTER_STEP_ELEMENT,  // Seek to an array or sequence element
+} fastrtps__content_filter_step_op_t;
+
+typedef struct fastrtps__content_filter_step_s
+{
+  fastrtps__content_filter_step_op_t op_;
+  uint32_t size_by_phase_[FASTRTPS_CDR_LAYOUT_PHASES];
+  const fastrtps__cdr_layout_node_t * node_;
+  uint32_t index_;
+} fastrtps__content_filter_step_t;
+
+typedef enum fastrtps__content_filter_value_kind_e
+{
+  FASTRTPS_CONTENT_FILTER_VALUE_INT,
+  FASTRTPS_CONTENT_FILTER_VALUE_UINT,
+  FASTRTPS_CONTENT_FILTER_VALUE_DOUBLE,
+  FASTRTPS_CONTENT_FILTER_VALUE_STRING,
+} fastrtps__content_filter_value_kind_t;
+
+typedef struct fastrtps__content_filter_operand_s
+{
+  // A field when `leaf_` is set, a literal otherwise
+  std::vector<fastrtps__content_filter_step_t> steps_;
+  const fastrtps__cdr_layout_node_t * leaf_;
+
+  fastrtps__content_filter_value_kind_t kind_;
+  int64_t int_;
+  uint64_t uint_;
+  double double_;
+  std::string string_;
+} fastrtps__content_filter_operand_t;
+
+typedef enum fastrtps__content_filter_op_e
+{
+  FASTRTPS_CONTENT_FILTER_OR,
+  FASTRTPS_CONTENT_FILTER_AND,
+  FASTRTPS_CONTENT_FILTER_NOT,
+  FASTRTPS_CONTENT_FILTER_EQ,
+  FASTRTPS_CONTENT_FILTER_NE,
+  FASTRTPS_CONTENT_FILTER_LT,
+  FASTRTPS_CONTENT_FILTER_LE,
+  FASTRTPS_CONTENT_FILTER_GT,
+  FASTRTPS_CONTENT_FILTER_GE,
+} fastrtps__content_filter_op_t;
+
+typedef struct fastrtps__content_filter_expression_s
+{
+  fastrtps__content_filter_op_t op_;
+
+  // OR, AND and NOT (lhs only)
+  std::unique_ptr<struct fastrtps__content_filter_expression_s> lhs_;
+  std::unique_ptr<struct fastrtps__content_filter_expression_s> rhs_;
+
+  // Comparisons
+  fastrtps__content_filter_operand_t left_;
+  fastrtps__content_filter_operand_t right_;
+} fastrtps__content_filter_expression_t;
+
+typedef struct fastrtps__content_filter_s
+{
+  rcutils_allocator_t allocator_;
+  fastrtps__cdr_layout_t layout_;
+  std::unique_ptr<fastrtps__content_filter_expression_t> expression_;
+} fastrtps__content_filter_t;
+
+
+/// Compile `expression` against `type`
+/// Returns RCUTILS_RET_INVALID_ARGUMENT if the expression is malformed or doesn't fit the type
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__content_filter_init(
+  const eprosima::fastrtps::types::DynamicType_ptr & type,
+  const char * expression,
+  const char * const * parameters, size_t parameter_count,
+  rcutils_allocator_t * allocator,
+  fastrtps__content_filter_t ** filter);  // OUT
+
+/// Evaluate `filter` on data of its type serialized into `buffer`, encapsulation header included
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__content_filter_evaluate(
+  const fastrtps__content_filter_t * filter,
+  const uint8_t * buffer, size_t length,
+  bool * match);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__content_filter_fini(fastrtps__content_filter_t * filter);
+
+
+#endif  // DETAIL__FASTRTPS_CONTENT_FILTER_HPP_
@@ -0,0 +1,212 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_data_pool.hpp"
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicDataFactory.h>
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypeMember.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypeDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+using eprosima::fastrtps::types::DynamicData;
+using eprosima::fastrtps::types::DynamicDataFactory;
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::DynamicTypeMember;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::TypeDescriptor;
+
+
+// =================================================================================================
+// DATA POOL
+// =================================================================================================
+bool
+fastrtps__data_pool_type_is_flat(const DynamicType_ptr & type)
+{
+  TypeDescriptor descriptor;
+  type->get_descriptor(&descriptor);
+
+  switch (descriptor.get_kind()) {
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+    case eprosima::fastrtps::types::TK_BYTE:
+    case eprosima::fastrtps::types::TK_CHAR8:
+    case eprosima::fastrtps::types::TK_CHAR16:
+    case eprosima::fastrtps::types::TK_FLOAT32:
+    case eprosima::fastrtps::types::TK_FLOAT64:
+    case eprosima::fastrtps::types::TK_FLOAT128:
+    case eprosima::fastrtps::types::TK_INT16:
+    case eprosima::fastrtps::types::TK_UINT16:
+    case eprosima::fastrtps::types::TK_INT32:
+    case eprosima::fastrtps::types::TK_UINT32:
+    case eprosima::fastrtps::types::TK_INT64:
+    case eprosima::fastrtps::types::TK_UINT64:
+      return true;
+
+    case eprosima::fastrtps::types::TK_ARRAY:
+      return fastrtps__data_pool_type_is_flat(descriptor.get_element_type());
+
+    case eprosima::fastrtps::types::TK_STRUCTURE: {
+        std::map<MemberId, DynamicTypeMember *> members;
+        type->get_all_members(members);
+        for (const auto & member : members) {
+          MemberDescriptor member_descriptor;
+          member.second->get_descriptor(&member_descriptor);
+          if (!fastrtps__data_pool_type_is_flat(member_descriptor.get_type())) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+    // Strings and sequences change size, everything else is not supported by the type builder
+    default:
+      return false;
+  }
+}
+
+
+DynamicData *
+fastrtps__data_pool_take(fastrtps__data_pool_t * pool, const DynamicType_ptr & type)
+{
+  std::lock_guard<std::mutex> lock(pool->mutex_);
+  auto it = pool->entries_.find(type.get());
+  if (it == pool->entries_.end()) {
+    fastrtps__data_pool_entry_t entry;
+    entry.type_ = type;
+    pool->entries_.emplace(type.get(), std::move(entry));
+    return nullptr;
+  }
+  auto & free = it->second.free_;
+  if (free.empty()) {
+    return nullptr;
+  }
+  DynamicData * data = free.back();
+  free.pop_back();
+  return data;
+}
+
+
+void
+fastrtps__data_pool_lend(
+  fastrtps__data_pool_t * pool, const DynamicType_ptr & type, DynamicData * data)
+{
+  std::lock_guard<std::mutex> lock(pool->mutex_);
+  if (pool->lent_.emplace(data, type).second) {
+    pool->lent_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+
+// Must be called with pool->mutex_ held
+// Returns the type `data` was lent out with, or an empty pointer if it was not lent out
+static DynamicType_ptr
+fastrtps__data_pool_take_back(fastrtps__data_pool_t * pool, const DynamicData * data)
+{
+  auto it = pool->lent_.find(data);
+  if (it == pool->lent_.end()) {
+    return DynamicType_ptr();
+  }
+  DynamicType_ptr type = std::move(it->second);
+  pool->lent_.erase(it);
+  pool->lent_count_.fetch_sub(1, std::memory_order_relaxed);
+  return type;
+}
+
+
+bool
+fastrtps__data_pool_give_back(fastrtps__data_pool_t * pool, DynamicData * data)
+{
+  // Data is handed between threads with synchronization of its own, so a thread finalizing lent
+  // data always sees it counted
+  if (pool->lent_count_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(pool->mutex_);
+  DynamicType_ptr type = fastrtps__data_pool_take_back(pool, data);
+  if (!type) {
+    return false;
+  }
+  auto it = pool->entries_.find(type.get());
+  if (it == pool->entries_.end() ||
+    it->second.free_.size() >= FASTRTPS_DATA_POOL_MAX_FREE_PER_TYPE)
+  {
+    return false;
+  }
+  it->second.free_.push_back(data);
+  return true;
+}
+
+
+void
+fastrtps__data_pool_forget(fastrtps__data_pool_t * pool, const DynamicData * data)
+{
+  if (pool->lent_count_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(pool->mutex_);
+  fastrtps__data_pool_take_back(pool, data);
+}
+
+
+size_t
+fastrtps__data_pool_evict(
+  fastrtps__data_pool_t * pool, const DynamicType_ptr & type, DynamicDataFactory * data_factory)
+{
+  fastrtps__data_pool_entry_t entry;
+  {
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    auto it = pool->entries_.find(type.get());
+    if (it == pool->entries_.end()) {
+      return 0;
+    }
+    entry = std::move(it->second);
+    pool->entries_.erase(it);
+  }
+  for (DynamicData * data : entry.free_) {
+    data_factory->delete_data(data);
+  }
+  return entry.free_.size();
+}
+
+
+void
+fastrtps__data_pool_clear(fastrtps__data_pool_t * pool, DynamicDataFactory * data_factory)
+{
+  decltype(pool->entries_) entries;
+  {
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    entries.swap(pool->entries_);
+    pool->lent_.clear();
+    pool->lent_count_.store(0, std::memory_order_relaxed);
+  }
+  for (auto & entry : entries) {
+    for (DynamicData * data : entry.second.free_) {
+      data_factory->delete_data(data);
+    }
+  }
+}
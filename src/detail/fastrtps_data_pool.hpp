@@ -0,0 +1,127 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_DATA_POOL_HPP_
+#define DETAIL__FASTRTPS_DATA_POOL_HPP_
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicDataFactory.h>
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+// =================================================================================================
+// DATA POOL
+// =================================================================================================
+//
+// A flat type is made only of primitives, fixed size arrays of flat types and structs of flat
+// types. Overwriting every value of a data of a flat type never allocates, so finalized data of
+// flat types is kept and handed out again to callers about to overwrite every value, e.g. to
+// deserialize into, instead of having fastrtps build a new data tree.
+//
+// Only flat types data was taken for get an entry. An entry keeps its type alive, so it is evicted
+// when the last reference to the type's handle goes.
+//
+// Data handed out this way is remembered until it is finalized, so its type is known then. No
+// other data is tracked: finalizing it only costs a load of `lent_count_`, and nothing at all
+// while no data is lent out.
+
+#define FASTRTPS_DATA_POOL_MAX_FREE_PER_TYPE 16
+
+typedef struct fastrtps__data_pool_entry_s
+{
+  // Keeps the key alive, so its address can't be reused by another type
+  eprosima::fastrtps::types::DynamicType_ptr type_;
+  std::vector<eprosima::fastrtps::types::DynamicData *> free_;
+} fastrtps__data_pool_entry_t;
+
+typedef struct fastrtps__data_pool_s
+{
+  std::mutex mutex_;
+  std::unordered_map<
+    const eprosima::fastrtps::types::DynamicType *, fastrtps__data_pool_entry_t
+  > entries_;
+
+  // Only changed with `mutex_` held, read without it
+  std::atomic<size_t> lent_count_{0};
+  std::unordered_map<
+    const eprosima::fastrtps::types::DynamicData *, eprosima::fastrtps::types::DynamicType_ptr
+  > lent_;
+} fastrtps__data_pool_t;
+
+
+/// Whether `type` is flat
+/// Walks the whole type, callers should cache the answer (see fastrtps__dynamic_type_handle_t)
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__data_pool_type_is_flat(const eprosima::fastrtps::types::DynamicType_ptr & type);
+
+/// Take a recycled data of flat `type`, holding stale values, or null if there is none
+/// Finalized data of `type` is kept for reuse from then on, until `type` is evicted
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+eprosima::fastrtps::types::DynamicData *
+fastrtps__data_pool_take(
+  fastrtps__data_pool_t * pool,
+  const eprosima::fastrtps::types::DynamicType_ptr & type);
+
+/// Remember that `data` of flat `type` was handed out, so it is kept for reuse when it is finalized
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__data_pool_lend(
+  fastrtps__data_pool_t * pool,
+  const eprosima::fastrtps::types::DynamicType_ptr & type,
+  eprosima::fastrtps::types::DynamicData * data);
+
+/// Keep `data`, which is being finalized, for reuse
+/// Returns false if `data` was not lent out, its type was evicted or enough of its data is kept
+/// already, and the caller should delete `data` itself
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__data_pool_give_back(
+  fastrtps__data_pool_t * pool,
+  eprosima::fastrtps::types::DynamicData * data);
+
+/// Forget that `data` was lent out, e.g. because another data owns it now
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__data_pool_forget(
+  fastrtps__data_pool_t * pool,
+  const eprosima::fastrtps::types::DynamicData * data);
+
+/// Delete the data kept for `type` and forget `type`
+/// Returns how many data were deleted
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+size_t
+fastrtps__data_pool_evict(
+  fastrtps__data_pool_t * pool,
+  const eprosima::fastrtps::types::DynamicType_ptr & type,
+  eprosima::fastrtps::types::DynamicDataFactory * data_factory);
+
+/// Delete every data kept for reuse, and forget every type and every data lent out
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__data_pool_clear(
+  fastrtps__data_pool_t * pool,
+  eprosima::fastrtps::types::DynamicDataFactory * data_factory);
+
+
+#endif  // DETAIL__FASTRTPS_DATA_POOL_HPP_
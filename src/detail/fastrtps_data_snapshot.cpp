@@ -0,0 +1,168 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_data_snapshot.hpp"
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+#include "fastrtps_dynamic_data.hpp"
+
+
+using eprosima::fastrtps::types::DynamicData;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::ReturnCode_t;
+using eprosima::fastrtps::types::TypeKind;
+
+
+// =================================================================================================
+// DATA SNAPSHOTS
+// =================================================================================================
+
+// INDEX ===========================================================================================
+static bool
+fastrtps__data_snapshot_is_nested_kind(TypeKind kind)
+{
+  return kind == eprosima::fastrtps::types::TK_STRUCTURE ||
+         kind == eprosima::fastrtps::types::TK_ARRAY ||
+         kind == eprosima::fastrtps::types::TK_SEQUENCE;
+}
+
+static bool
+fastrtps__data_snapshot_index(fastrtps__data_snapshot_t * snapshot, DynamicData * data);
+
+// Record the data `parent` holds under `id` if it is nested, and index it in turn. `kind` is set to
+// its kind. Returns false if it cannot be loaned
+static bool
+fastrtps__data_snapshot_index_nested(
+  fastrtps__data_snapshot_t * snapshot, DynamicData * parent, MemberId id, TypeKind * kind)
+{
+  DynamicData * nested = parent->loan_value(id);
+  if (!nested) {
+    return false;
+  }
+  *kind = nested->get_kind();
+
+  bool ok = true;
+  if (fastrtps__data_snapshot_is_nested_kind(*kind)) {
+    // The loan only guards against changes, and nothing changes the data once frozen, so the
+    // pointer stays good after the loan is returned
+    snapshot->nested_.emplace(fastrtps__data_snapshot_key_t{parent, id}, nested);
+    ok = fastrtps__data_snapshot_index(snapshot, nested);
+  }
+  parent->return_loaned_value(nested);
+  return ok;
+}
+
+static bool
+fastrtps__data_snapshot_index(fastrtps__data_snapshot_t * snapshot, DynamicData * data)
+{
+  uint32_t item_count = data->get_item_count();
+  TypeKind kind;
+
+  switch (data->get_kind()) {
+    case eprosima::fastrtps::types::TK_STRUCTURE:
+      for (uint32_t index = 0; index < item_count; ++index) {
+        MemberId id = data->get_member_id_at_index(index);
+        MemberDescriptor descriptor;
+        if (data->get_descriptor(descriptor, id) != ReturnCode_t::RETCODE_OK) {
+          return false;
+        }
+        if (fastrtps__data_snapshot_is_nested_kind(descriptor.get_kind()) &&
+          !fastrtps__data_snapshot_index_nested(snapshot, data, id, &kind))
+        {
+          return false;
+        }
+      }
+      return true;
+    // Elements all have the same kind, so a first element that is not nested settles it
+    case eprosima::fastrtps::types::TK_ARRAY:
+    case eprosima::fastrtps::types::TK_SEQUENCE:
+      for (uint32_t index = 0; index < item_count; ++index) {
+        if (!fastrtps__data_snapshot_index_nested(snapshot, data, index, &kind)) {
+          return false;
+        }
+        if (!fastrtps__data_snapshot_is_nested_kind(kind)) {
+          break;
+        }
+      }
+      return true;
+    default:
+      return true;
+  }
+}
+
+
+// SNAPSHOTS =======================================================================================
+rcutils_ret_t
+fastrtps__data_snapshot_freeze(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  rcutils_allocator_t * allocator,
+  fastrtps__data_snapshot_t ** snapshot)
+{
+  void * snapshot_mem = allocator->allocate(sizeof(fastrtps__data_snapshot_t), allocator->state);
+  if (!snapshot_mem) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate data snapshot");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  // Holds C++ members, so it must be constructed in place
+  auto out = new (snapshot_mem) fastrtps__data_snapshot_t();
+  out->allocator_ = *allocator;
+  out->reference_count_.store(1, std::memory_order_relaxed);
+  out->serialization_support_impl_ = serialization_support_impl;
+  out->data_ = static_cast<DynamicData *>(data_impl->handle);
+
+  if (!fastrtps__data_snapshot_index(out, out->data_)) {
+    out->~fastrtps__data_snapshot_t();
+    allocator->deallocate(snapshot_mem, allocator->state);
+    RCUTILS_SET_ERROR_MSG("Could not freeze dynamic data, is any of its values still loaned?");
+    return RCUTILS_RET_ERROR;
+  }
+
+  // The snapshot owns the data now, the last release finalizes it with fastrtps__dynamic_data_fini
+  data_impl->handle = nullptr;
+  *snapshot = out;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__data_snapshot_release(fastrtps__data_snapshot_t * snapshot)
+{
+  // Readers on other threads must be done with the data before it goes
+  if (snapshot->reference_count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return RCUTILS_RET_OK;
+  }
+
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data_impl;
+  data_impl.allocator = snapshot->allocator_;
+  data_impl.handle = snapshot->data_;
+  rcutils_ret_t ret = fastrtps__dynamic_data_fini(
+    snapshot->serialization_support_impl_, &data_impl);
+
+  rcutils_allocator_t allocator = snapshot->allocator_;
+  snapshot->~fastrtps__data_snapshot_t();
+  allocator.deallocate(snapshot, allocator.state);
+  return ret;
+}
@@ -0,0 +1,121 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_DATA_SNAPSHOT_HPP_
+#define DETAIL__FASTRTPS_DATA_SNAPSHOT_HPP_
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+
+
+// =================================================================================================
+// DATA SNAPSHOTS
+// =================================================================================================
+//
+// A frozen dynamic data, shared by reference count and never changed again.
+//
+// The fastrtps getters only read, so any number of threads can use them on the same data at once.
+// Reaching nested structs, arrays and sequences is what needs loans, and loans change the data. So
+// freezing loans every nested data once, up front, and records where it is; readers look nested
+// data up in that index instead of loaning it. get_complex_value is the one getter left out: it
+// copies the member out through the data factory, so snapshot views must not be handed to it.
+
+typedef struct fastrtps__data_snapshot_key_s
+{
+  const eprosima::fastrtps::types::DynamicData * parent_;
+  eprosima::fastrtps::types::MemberId id_;
+
+  bool
+  operator==(const fastrtps__data_snapshot_key_s & other) const
+  {
+    return parent_ == other.parent_ && id_ == other.id_;
+  }
+} fastrtps__data_snapshot_key_t;
+
+typedef struct fastrtps__data_snapshot_key_hash_s
+{
+  size_t
+  operator()(const fastrtps__data_snapshot_key_t & key) const
+  {
+    return std::hash<const void *>()(key.parent_) ^ (static_cast<size_t>(key.id_) * 0x9e3779b9u);
+  }
+} fastrtps__data_snapshot_key_hash_t;
+
+typedef struct fastrtps__data_snapshot_s
+{
+  rcutils_allocator_t allocator_;
+  std::atomic<size_t> reference_count_;
+
+  // The data is finalized through it when the last reference is released
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl_;
+  eprosima::fastrtps::types::DynamicData * data_;
+
+  // Every struct, array and sequence nested in data_, by the data holding it and its member id (or
+  // element index). Filled in by freeze, and only read after that
+  std::unordered_map<
+    fastrtps__data_snapshot_key_t, const eprosima::fastrtps::types::DynamicData *,
+    fastrtps__data_snapshot_key_hash_t
+  > nested_;
+} fastrtps__data_snapshot_t;
+
+
+/// Freeze `data_impl` into a new snapshot holding one reference
+/**
+ * The snapshot takes the data over: on success, data_impl's handle is cleared, and the data must
+ * not be used or finalized through it any more. Fails if any value of the data is still loaned.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__data_snapshot_freeze(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  rcutils_allocator_t * allocator,
+  fastrtps__data_snapshot_t ** snapshot);  // OUT
+
+/// Add a reference to `snapshot`
+inline void
+fastrtps__data_snapshot_acquire(fastrtps__data_snapshot_t * snapshot)
+{
+  snapshot->reference_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// Drop a reference to `snapshot`, finalizing it and its data if it was the last one
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__data_snapshot_release(fastrtps__data_snapshot_t * snapshot);
+
+/// The struct, array or sequence member `id` (or element at index `id`) of `parent`, or nullptr if
+/// `parent` holds no such nested data
+inline const eprosima::fastrtps::types::DynamicData *
+fastrtps__data_snapshot_get_nested(
+  const fastrtps__data_snapshot_t * snapshot,
+  const eprosima::fastrtps::types::DynamicData * parent,
+  eprosima::fastrtps::types::MemberId id)
+{
+  auto it = snapshot->nested_.find({parent, id});
+  return it == snapshot->nested_.end() ? nullptr : it->second;
+}
+
+
+#endif  // DETAIL__FASTRTPS_DATA_SNAPSHOT_HPP_
@@ -0,0 +1,267 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_deserialization_pipeline.hpp"
+
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "fastrtps_dynamic_data.hpp"
+
+
+// =================================================================================================
+// DESERIALIZATION PIPELINE
+// =================================================================================================
+
+// WORKERS =========================================================================================
+// Take the oldest task of worker `index`, or failing that of any other worker
+static bool
+fastrtps__deserialization_pipeline_take(
+  fastrtps__deserialization_pipeline_t * pipeline, size_t index,
+  fastrtps__deserialization_task_t * task)
+{
+  for (size_t i = 0; i < pipeline->worker_count_; ++i) {
+    fastrtps__deserialization_worker_t & worker =
+      pipeline->workers_[(index + i) % pipeline->worker_count_];
+    std::lock_guard<std::mutex> lock(worker.mutex_);
+    if (!worker.tasks_.empty()) {
+      *task = std::move(worker.tasks_.front());
+      worker.tasks_.pop_front();
+      pipeline->queued_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Park the result of task `sequence`, and deliver it along with every finished task after it if it
+// is the next one to deliver
+static void
+fastrtps__deserialization_pipeline_complete(
+  fastrtps__deserialization_pipeline_t * pipeline, uint64_t sequence, rcutils_ret_t ret,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t & data_impl)
+{
+  std::unique_lock<std::mutex> lock(pipeline->order_mutex_);
+  size_t capacity = pipeline->results_.size();
+  fastrtps__deserialization_result_t & parked = pipeline->results_[sequence % capacity];
+  parked.ready_ = true;
+  parked.ret_ = ret;
+  parked.data_impl_ = data_impl;
+
+  // Someone else is delivering, and will get to this one
+  if (pipeline->delivering_) {
+    return;
+  }
+  pipeline->delivering_ = true;
+  while (pipeline->results_[pipeline->next_delivery_ % capacity].ready_) {
+    fastrtps__deserialization_result_t & next =
+      pipeline->results_[pipeline->next_delivery_ % capacity];
+    fastrtps__deserialization_result_t result = next;
+    next.ready_ = false;
+    uint64_t delivery = pipeline->next_delivery_;
+
+    // The slot stays taken until next_delivery_ moves on, so the callback can run unlocked
+    lock.unlock();
+    pipeline->callback_(
+      pipeline->user_data_, delivery, result.ret_,
+      result.ret_ == RCUTILS_RET_OK ? &result.data_impl_ : nullptr);
+    lock.lock();
+
+    ++pipeline->next_delivery_;
+    pipeline->delivered_.notify_all();
+  }
+  pipeline->delivering_ = false;
+}
+
+static void
+fastrtps__deserialization_pipeline_run(
+  fastrtps__deserialization_pipeline_t * pipeline, fastrtps__deserialization_task_t * task)
+{
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data_impl;
+  data_impl.allocator = pipeline->allocator_;
+  data_impl.handle = nullptr;
+
+  // Every value gets overwritten, so recycled data of flat types will do
+  rcutils_ret_t ret = fastrtps__dynamic_data_init_for_overwrite(
+    pipeline->serialization_support_impl_, task->type_impl_, &pipeline->allocator_, &data_impl);
+  if (ret == RCUTILS_RET_OK) {
+    rcutils_uint8_array_t buffer = rcutils_get_zero_initialized_uint8_array();
+    buffer.buffer = task->buffer_.data();
+    buffer.buffer_length = task->buffer_.size();
+    buffer.buffer_capacity = task->buffer_.size();
+    buffer.allocator = pipeline->allocator_;
+    ret = fastrtps__dynamic_data_deserialize(
+      pipeline->serialization_support_impl_, &data_impl, &buffer);
+    if (ret != RCUTILS_RET_OK) {
+      fastrtps__dynamic_data_fini(pipeline->serialization_support_impl_, &data_impl);
+    }
+  }
+  if (ret != RCUTILS_RET_OK) {
+    // The callback only gets the return code, the error state is this thread's
+    rcutils_reset_error();
+  }
+
+  // The buffer is done with, free it before the task waits for its turn to deliver
+  std::vector<uint8_t>().swap(task->buffer_);
+  fastrtps__deserialization_pipeline_complete(pipeline, task->sequence_, ret, data_impl);
+}
+
+static void
+fastrtps__deserialization_pipeline_work(
+  fastrtps__deserialization_pipeline_t * pipeline, size_t index)
+{
+  fastrtps__deserialization_task_t task;
+  while (true) {
+    if (fastrtps__deserialization_pipeline_take(pipeline, index, &task)) {
+      fastrtps__deserialization_pipeline_run(pipeline, &task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(pipeline->idle_mutex_);
+    pipeline->idle_.wait(
+      lock, [pipeline] {
+        return pipeline->queued_.load(std::memory_order_relaxed) > 0 || pipeline->stopping_;
+      });
+    if (pipeline->stopping_ && pipeline->queued_.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+  }
+}
+
+
+// PIPELINE ========================================================================================
+rcutils_ret_t
+fastrtps__deserialization_pipeline_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  size_t worker_count,
+  size_t capacity,
+  rosidl_dynamic_typesupport_fastrtps_deserialization_callback_t callback,
+  void * user_data,
+  rcutils_allocator_t * allocator,
+  fastrtps__deserialization_pipeline_t ** pipeline)
+{
+  if (worker_count == 0) {
+    worker_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  if (capacity == 0) {
+    RCUTILS_SET_ERROR_MSG("Deserialization pipeline capacity must be at least 1");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+
+  void * pipeline_mem = allocator->allocate(
+    sizeof(fastrtps__deserialization_pipeline_t), allocator->state);
+  if (!pipeline_mem) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate deserialization pipeline");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  // Holds C++ members, so it must be constructed in place
+  auto out = new (pipeline_mem) fastrtps__deserialization_pipeline_t();
+  out->allocator_ = *allocator;
+  out->serialization_support_impl_ = serialization_support_impl;
+  out->callback_ = callback;
+  out->user_data_ = user_data;
+  out->queued_.store(0, std::memory_order_relaxed);
+  out->stopping_ = false;
+  out->results_.resize(capacity, fastrtps__deserialization_result_t{false, RCUTILS_RET_OK, {}});
+  out->next_sequence_ = 0;
+  out->next_delivery_ = 0;
+  out->delivering_ = false;
+
+  out->worker_count_ = worker_count;
+  out->workers_.reset(new fastrtps__deserialization_worker_t[worker_count]);
+  for (size_t i = 0; i < worker_count; ++i) {
+    out->workers_[i].thread_ = std::thread(fastrtps__deserialization_pipeline_work, out, i);
+  }
+
+  *pipeline = out;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__deserialization_pipeline_submit(
+  fastrtps__deserialization_pipeline_t * pipeline,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const uint8_t * buffer, size_t length,
+  uint64_t * sequence)
+{
+  fastrtps__deserialization_task_t task;
+  task.type_impl_ = type_impl;
+  task.buffer_.assign(buffer, buffer + length);
+
+  {
+    std::unique_lock<std::mutex> lock(pipeline->order_mutex_);
+    pipeline->delivered_.wait(
+      lock, [pipeline] {
+        return pipeline->next_sequence_ - pipeline->next_delivery_ < pipeline->results_.size();
+      });
+    task.sequence_ = pipeline->next_sequence_++;
+  }
+  if (sequence) {
+    *sequence = task.sequence_;
+  }
+
+  fastrtps__deserialization_worker_t & worker =
+    pipeline->workers_[task.sequence_ % pipeline->worker_count_];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex_);
+    worker.tasks_.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(pipeline->idle_mutex_);
+    pipeline->queued_.fetch_add(1, std::memory_order_relaxed);
+  }
+  pipeline->idle_.notify_one();
+  return RCUTILS_RET_OK;
+}
+
+
+void
+fastrtps__deserialization_pipeline_wait(fastrtps__deserialization_pipeline_t * pipeline)
+{
+  std::unique_lock<std::mutex> lock(pipeline->order_mutex_);
+  pipeline->delivered_.wait(
+    lock, [pipeline] {return pipeline->next_delivery_ == pipeline->next_sequence_;});
+}
+
+
+rcutils_ret_t
+fastrtps__deserialization_pipeline_fini(fastrtps__deserialization_pipeline_t * pipeline)
+{
+  fastrtps__deserialization_pipeline_wait(pipeline);
+  {
+    std::lock_guard<std::mutex> lock(pipeline->idle_mutex_);
+    pipeline->stopping_ = true;
+  }
+  pipeline->idle_.notify_all();
+  for (size_t i = 0; i < pipeline->worker_count_; ++i) {
+    pipeline->workers_[i].thread_.join();
+  }
+
+  rcutils_allocator_t allocator = pipeline->allocator_;
+  pipeline->~fastrtps__deserialization_pipeline_t();
+  allocator.deallocate(pipeline, allocator.state);
+  return RCUTILS_RET_OK;
+}
@@ -0,0 +1,137 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_DESERIALIZATION_PIPELINE_HPP_
+#define DETAIL__FASTRTPS_DESERIALIZATION_PIPELINE_HPP_
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/deserialization_pipeline.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// =================================================================================================
+// DESERIALIZATION PIPELINE
+// =================================================================================================
+//
+// Deserializes a stream of buffers on a pool of worker threads, and delivers the data in the order
+// the buffers were submitted.
+//
+// Submitted buffers are dealt out to the workers' queues in turn. A worker whose queue runs dry
+// takes work from the others, so one slow (large) message does not leave the tasks queued behind
+// it waiting. Everyone takes the oldest task first, since the oldest ones are what in order
+// delivery waits on.
+//
+// Finished data is parked in a reorder ring, one slot per task in flight. Whichever worker finishes
+// the next task to deliver also delivers every finished task after it, up to the first one still
+// running. Delivery is one task at a time, so the callback never runs concurrently with itself.
+//
+// At most `capacity` tasks are in flight (submitted and not yet delivered); submitting more blocks
+// until one is delivered.
+
+typedef struct fastrtps__deserialization_task_s
+{
+  uint64_t sequence_;
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl_;
+  std::vector<uint8_t> buffer_;
+} fastrtps__deserialization_task_t;
+
+/// One worker's queue, padded to its own cache line so workers don't false share
+typedef struct alignas(64) fastrtps__deserialization_worker_s
+{
+  std::mutex mutex_;
+  std::deque<fastrtps__deserialization_task_t> tasks_;
+  std::thread thread_;
+} fastrtps__deserialization_worker_t;
+
+typedef struct fastrtps__deserialization_result_s
+{
+  bool ready_;
+  rcutils_ret_t ret_;
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data_impl_;
+} fastrtps__deserialization_result_t;
+
+typedef struct fastrtps__deserialization_pipeline_s
+{
+  rcutils_allocator_t allocator_;
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl_;
+  rosidl_dynamic_typesupport_fastrtps_deserialization_callback_t callback_;
+  void * user_data_;
+
+  size_t worker_count_;
+  std::unique_ptr<fastrtps__deserialization_worker_t[]> workers_;
+
+  // Idle workers wait for tasks here. queued_ only goes up with idle_mutex_ held, so no wake up
+  // is lost
+  std::mutex idle_mutex_;
+  std::condition_variable idle_;
+  std::atomic<size_t> queued_;
+  bool stopping_;
+
+  // Sequence numbers, and delivery in their order. Submitters wait on `delivered_` for room in
+  // the ring, and so does pipeline_wait for it to empty
+  std::mutex order_mutex_;
+  std::condition_variable delivered_;
+  std::vector<fastrtps__deserialization_result_t> results_;  // By sequence modulo capacity
+  uint64_t next_sequence_;
+  uint64_t next_delivery_;
+  bool delivering_;
+} fastrtps__deserialization_pipeline_t;
+
+
+/// Start `worker_count` workers, or one per hardware thread for 0
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__deserialization_pipeline_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  size_t worker_count,
+  size_t capacity,
+  rosidl_dynamic_typesupport_fastrtps_deserialization_callback_t callback,
+  void * user_data,
+  rcutils_allocator_t * allocator,
+  fastrtps__deserialization_pipeline_t ** pipeline);  // OUT
+
+/// Queue a copy of `buffer` to be deserialized into data of `type_impl`, which must stay alive
+/// until the data is delivered
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__deserialization_pipeline_submit(
+  fastrtps__deserialization_pipeline_t * pipeline,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const uint8_t * buffer, size_t length,
+  uint64_t * sequence);  // OUT
+
+/// Block until everything submitted so far is delivered
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__deserialization_pipeline_wait(fastrtps__deserialization_pipeline_t * pipeline);
+
+/// Deliver everything submitted, then stop the workers
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__deserialization_pipeline_fini(fastrtps__deserialization_pipeline_t * pipeline);
+
+
+#endif  // DETAIL__FASTRTPS_DESERIALIZATION_PIPELINE_HPP_
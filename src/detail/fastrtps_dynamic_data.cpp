@@ -35,15 +35,21 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "macros.hpp"
+#include "fastrtps_data_pool.hpp"
+#include "fastrtps_dynamic_data_image.hpp"
+#include "fastrtps_dynamic_type.hpp"
 #include "fastrtps_serialization_support.hpp"
+#include "fastrtps_tracepoints.hpp"
 #include "utils.hpp"
 
 
 using eprosima::fastrtps::types::DynamicData;
 using eprosima::fastrtps::types::DynamicData_ptr;
 
+using eprosima::fastrtps::types::DynamicType_ptr;
 using eprosima::fastrtps::types::DynamicTypeBuilder;
 using eprosima::fastrtps::types::DynamicTypeBuilder_ptr;
 
@@ -108,6 +114,28 @@ fastrtps__dynamic_data_equals(
 }
 
 
+rcutils_ret_t
+fastrtps__dynamic_data_hash(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  uint64_t * hash)
+{
+  (void) serialization_support_impl;
+
+  // Hashed over the canonical image rather than the image, so that data that compare equal hash
+  // the same even when their floating point values differ bitwise (-0.0 and 0.0)
+  thread_local std::vector<char> image;
+  if (!fastrtps__dynamic_data_image_write_canonical(
+      static_cast<const DynamicData *>(data_impl->handle), image))
+  {
+    RCUTILS_SET_ERROR_MSG("Could not write dynamic data for hashing");
+    return RCUTILS_RET_ERROR;
+  }
+  *hash = fastrtps__xxh64(image.data(), image.size(), 0);
+  return RCUTILS_RET_OK;
+}
+
+
 rcutils_ret_t
 fastrtps__dynamic_data_get_item_count(
   rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
@@ -210,14 +238,23 @@ fastrtps__dynamic_data_get_name(
   const char ** name,
   size_t * name_length)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, GETTER_OUTPUT);
   std::string tmp_name = static_cast<DynamicData *>(data_impl->handle)->get_name();
   *name = rcutils_strdup(tmp_name.c_str(), rcutils_get_default_allocator());
   *name_length = tmp_name.size();
+  FASTRTPS_RECORD_ALLOCATION(serialization_support_impl, GETTER_OUTPUT, *name_length + 1);
   return RCUTILS_RET_OK;
 }
 
 
+// Name of the type `data` was created from, for tracepoints
+static std::string
+fastrtps__dynamic_data_get_type_name(const DynamicData * data)
+{
+  return const_cast<DynamicData *>(data)->get_name();
+}
+
+
 // DYNAMIC DATA CONSTRUCTION =======================================================================
 rcutils_ret_t
 fastrtps__dynamic_data_init_from_dynamic_type_builder(
@@ -227,14 +264,41 @@ fastrtps__dynamic_data_init_from_dynamic_type_builder(
   rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl)
 {
   (void) allocator;
+  FASTRTPS_LATENCY_SCOPE(serialization_support_impl, DATA_INIT);
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, DATA_CREATE);
 
-  auto out = static_cast<fastrtps__serialization_support_impl_handle_t *>(
-    serialization_support_impl->handle)->data_factory_->create_data(
-    static_cast<DynamicTypeBuilder *>(type_builder_impl->handle));
+  std::string trace_type_name;
+  if (FASTRTPS_TRACEPOINTS_ENABLED(data_init)) {
+    trace_type_name = static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->get_name();
+  }
+  FASTRTPS_TRACEPOINT(data_init_entry, trace_type_name.c_str());
+  FASTRTPS_TRACEPOINT_ON_EXIT(data_init_exit, trace_type_name.c_str());
+
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  auto type_builder = static_cast<DynamicTypeBuilder *>(type_builder_impl->handle);
+
+  // The builder alone is missing the nested members recorded in lazy mode, so build its type
+  DynamicType_ptr type;
+  auto lazy = fastrtps__lazy_builder_registry_snapshot(
+    &fastrtps_impl->lazy_builders_, fastrtps_impl->type_factory_, type_builder);
+  if (lazy) {
+    type = fastrtps__lazy_struct_build(
+      *lazy, fastrtps_impl->type_factory_, &fastrtps_impl->type_cache_);
+  } else {
+    type = type_builder->build();
+  }
+  if (!type) {
+    RCUTILS_SET_ERROR_MSG("Could not build dynamic type to init dynamic data from");
+    return RCUTILS_RET_ERROR;
+  }
+
+  auto out = fastrtps_impl->data_factory_->create_data(type);
   if (!out) {
     RCUTILS_SET_ERROR_MSG("Could not init dynamic data from dynamic type builder");
     return RCUTILS_RET_BAD_ALLOC;
   }
+  FASTRTPS_RECORD_ALLOCATION(serialization_support_impl, DATA_CREATE, sizeof(DynamicData));
 
   data_impl->handle = std::move(out);
   return RCUTILS_RET_OK;
@@ -248,25 +312,81 @@ fastrtps__dynamic_data_init_from_dynamic_type(
   rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl)
 {
   (void) allocator;
+  FASTRTPS_LATENCY_SCOPE(serialization_support_impl, DATA_INIT);
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, DATA_CREATE);
+
+  std::string trace_type_name;
+  if (FASTRTPS_TRACEPOINTS_ENABLED(data_init)) {
+    trace_type_name = fastrtps__dynamic_type_handle_get_name(
+      static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle));
+  }
+  FASTRTPS_TRACEPOINT(data_init_entry, trace_type_name.c_str());
+  FASTRTPS_TRACEPOINT_ON_EXIT(data_init_exit, trace_type_name.c_str());
+
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+
+  // Types built in lazy mode are built here, the first time data is created from them
+  const auto & type = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle));
+  if (!type) {
+    RCUTILS_SET_ERROR_MSG("Could not build lazy dynamic type");
+    return RCUTILS_RET_ERROR;
+  }
 
   // NOTE(methylDragon): All this casting is unfortunately necessary...
   //
   //                     create_data only takes DynamicType_ptr (aka shared_ptr)
   //                     And passing a heap allocated shared_ptr is the only way to make sure the
   //                     lifetime of the dynamic type is preserved
-  auto out = static_cast<fastrtps__serialization_support_impl_handle_t *>(
-    serialization_support_impl->handle)->data_factory_->create_data(
-    eprosima::fastrtps::types::DynamicType_ptr(
-      *static_cast<eprosima::fastrtps::types::DynamicType_ptr *>(type_impl->handle)));
+  auto out = fastrtps_impl->data_factory_->create_data(
+    eprosima::fastrtps::types::DynamicType_ptr(type));
   if (!out) {
     RCUTILS_SET_ERROR_MSG("Could not init dynamic data from dynamic type");
     return RCUTILS_RET_BAD_ALLOC;
   }
+  FASTRTPS_RECORD_ALLOCATION(serialization_support_impl, DATA_CREATE, sizeof(DynamicData));
 
   data_impl->handle = std::move(out);
   return RCUTILS_RET_OK;
 }
 
+
+rcutils_ret_t
+fastrtps__dynamic_data_init_for_overwrite(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl)
+{
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  auto type_handle = static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle);
+
+  if (!fastrtps__dynamic_type_handle_is_flat(fastrtps_impl, type_handle)) {
+    return fastrtps__dynamic_data_init_from_dynamic_type(
+      serialization_support_impl, type_impl, allocator, data_impl);
+  }
+
+  // Recycled data was counted when it was first created
+  auto pool = &fastrtps_impl->data_pool_;
+  DynamicData * data = fastrtps__data_pool_take(pool, type_handle->type_);
+  if (data) {
+    data_impl->handle = data;
+  } else {
+    rcutils_ret_t ret = fastrtps__dynamic_data_init_from_dynamic_type(
+      serialization_support_impl, type_impl, allocator, data_impl);
+    if (ret != RCUTILS_RET_OK) {
+      return ret;
+    }
+    data = static_cast<DynamicData *>(data_impl->handle);
+  }
+  // Either way, the data goes back to the pool when it is finalized
+  fastrtps__data_pool_lend(pool, type_handle->type_, data);
+  return RCUTILS_RET_OK;
+}
+
+
 rcutils_ret_t
 fastrtps__dynamic_data_clone(
   rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
@@ -275,13 +395,25 @@ fastrtps__dynamic_data_clone(
   rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl)
 {
   data_impl->allocator = *allocator;
-  DynamicData * data_impl_handle = static_cast<fastrtps__serialization_support_impl_handle_t *>(
-    serialization_support_impl->handle)->data_factory_->create_copy(
-    static_cast<const DynamicData *>(other_data_impl->handle));
+  FASTRTPS_LATENCY_SCOPE(serialization_support_impl, CLONE);
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, CLONE);
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  auto other = static_cast<const DynamicData *>(other_data_impl->handle);
+
+  std::string trace_type_name;
+  if (FASTRTPS_TRACEPOINTS_ENABLED(clone)) {
+    trace_type_name = fastrtps__dynamic_data_get_type_name(other);
+  }
+  FASTRTPS_TRACEPOINT(clone_entry, trace_type_name.c_str());
+  FASTRTPS_TRACEPOINT_ON_EXIT(clone_exit, trace_type_name.c_str());
+
+  DynamicData * data_impl_handle = fastrtps_impl->data_factory_->create_copy(other);
   if (!data_impl_handle) {
     RCUTILS_SET_ERROR_MSG("Could not clone struct type builder");
     return RCUTILS_RET_ERROR;
   }
+  FASTRTPS_RECORD_ALLOCATION(serialization_support_impl, CLONE, sizeof(DynamicData));
 
   data_impl->handle = std::move(data_impl_handle);
   return RCUTILS_RET_OK;
@@ -293,11 +425,28 @@ fastrtps__dynamic_data_fini(
   rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
   rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl)
 {
+  FASTRTPS_LATENCY_SCOPE(serialization_support_impl, DATA_FINI);
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, DATA_CREATE);
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  auto data = static_cast<DynamicData *>(data_impl->handle);
+
+  std::string trace_type_name;
+  if (FASTRTPS_TRACEPOINTS_ENABLED(data_fini)) {
+    trace_type_name = fastrtps__dynamic_data_get_type_name(data);
+  }
+  FASTRTPS_TRACEPOINT(data_fini_entry, trace_type_name.c_str());
+  FASTRTPS_TRACEPOINT_ON_EXIT(data_fini_exit, trace_type_name.c_str());
+
+  // Data lent out by init_for_overwrite is kept to overwrite later
+  if (fastrtps__data_pool_give_back(&fastrtps_impl->data_pool_, data)) {
+    return RCUTILS_RET_OK;
+  }
   FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
-    static_cast<fastrtps__serialization_support_impl_handle_t *>(serialization_support_impl->handle)
-    ->data_factory_->delete_data(static_cast<DynamicData *>(data_impl->handle)),
+    fastrtps_impl->data_factory_->delete_data(data),
     "Could not fini data"
   );
+  FASTRTPS_RECORD_FREE(serialization_support_impl, DATA_CREATE, sizeof(DynamicData));
   return RCUTILS_RET_OK;
 }
 
@@ -311,38 +460,47 @@ fastrtps__dynamic_data_serialize(
   rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
   rcutils_uint8_array_t * buffer)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_LATENCY_SCOPE(serialization_support_impl, SERIALIZE);
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, SERIALIZE);
+
+  std::string trace_type_name;
+  if (FASTRTPS_TRACEPOINTS_ENABLED(serialize)) {
+    trace_type_name = fastrtps__dynamic_data_get_type_name(
+      static_cast<const DynamicData *>(data_impl->handle));
+  }
+  FASTRTPS_TRACEPOINT(serialize_entry, trace_type_name.c_str());
+  FASTRTPS_TRACEPOINT_ON_EXIT(serialize_exit, trace_type_name.c_str(), buffer->buffer_length);
+
   auto m_type = std::make_shared<eprosima::fastrtps::types::DynamicPubSubType>();
   size_t data_length = static_cast<size_t>(
     m_type->getSerializedSizeProvider(static_cast<DynamicData *>(data_impl->handle))());
 
   if (buffer->buffer_capacity < data_length) {
+    size_t old_capacity = buffer->buffer_capacity;
     if (rcutils_uint8_array_resize(buffer, data_length) != RCUTILS_RET_OK) {
       RCUTILS_SET_ERROR_MSG("Could not resize buffer");
       return RCUTILS_RET_BAD_ALLOC;
     }
+    if (old_capacity > 0) {
+      FASTRTPS_RECORD_FREE(serialization_support_impl, SERIALIZE, old_capacity);
+    }
+    FASTRTPS_RECORD_ALLOCATION(serialization_support_impl, SERIALIZE, data_length);
   }
-  buffer->buffer_capacity = data_length;
-
-  auto payload = std::make_shared<eprosima::fastrtps::rtps::SerializedPayload_t>(
-    fastrtps__size_t_to_uint32_t(data_length));
-  bool success = m_type->serialize(data_impl->handle, payload.get());  // Serialize into payload
-
-  if (success) {
-    buffer->buffer_length = payload->length;
 
-    // Pass ownership of serialized buffer to buffer argument
-    // NOTE(methylDragon): Dubious cast... (we're going from octet to uint8_t, but it's just bytes?)
-    buffer->buffer = static_cast<uint8_t *>(payload->data);
-    payload->data = nullptr;
+  // Serialize straight into the buffer, so a buffer reused across messages is never reallocated
+  eprosima::fastrtps::rtps::SerializedPayload_t payload;
+  payload.data = buffer->buffer;
+  payload.max_size = fastrtps__size_t_to_uint32_t(buffer->buffer_capacity);
+  bool success = m_type->serialize(data_impl->handle, &payload);
+  uint32_t serialized_length = payload.length;
+  payload.data = nullptr;  // Owned by the buffer, the payload must not free it
 
-    return RCUTILS_RET_OK;
-  } else {
-    // We don't modify the buffer beyond expanding it up there
-    // And we leave the serialized buffer in the payload to be deallocated on its destruction
+  if (!success) {
     RCUTILS_SET_ERROR_MSG("Could not serialize dynamic data");
     return RCUTILS_RET_ERROR;
   }
+  buffer->buffer_length = serialized_length;
+  return RCUTILS_RET_OK;
 }
 
 
@@ -352,25 +510,32 @@ fastrtps__dynamic_data_deserialize(
   rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
   rcutils_uint8_array_t * buffer)
 {
-  (void) serialization_support_impl;
-  auto payload = std::make_shared<eprosima::fastrtps::rtps::SerializedPayload_t>(
-    fastrtps__size_t_to_uint32_t(buffer->buffer_length));
-
-  // NOTE(methylDragon): Deserialize should copy at this point, so this copy is not needed, I think
-  // memcpy(payload->data, buffer->buffer, buffer->buffer_length);
+  FASTRTPS_LATENCY_SCOPE(serialization_support_impl, DESERIALIZE);
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, DESERIALIZE);
 
-  payload->data = buffer->buffer;  // Use the input buffer directly without copying
-  payload->length = fastrtps__size_t_to_uint32_t(buffer->buffer_length);
+  std::string trace_type_name;
+  if (FASTRTPS_TRACEPOINTS_ENABLED(deserialize)) {
+    trace_type_name = fastrtps__dynamic_data_get_type_name(
+      static_cast<const DynamicData *>(data_impl->handle));
+  }
+  FASTRTPS_TRACEPOINT(deserialize_entry, trace_type_name.c_str(), buffer->buffer_length);
+  FASTRTPS_TRACEPOINT_ON_EXIT(deserialize_exit, trace_type_name.c_str(), buffer->buffer_length);
 
-  auto m_type = std::make_shared<eprosima::fastrtps::types::DynamicPubSubType>();
-  bool success = m_type->deserialize(payload.get(), data_impl->handle);
+  // Reads the input buffer directly, without copying. Not reserved up front, the reservation would
+  // be lost when the data pointer is swapped for the buffer's
+  eprosima::fastrtps::rtps::SerializedPayload_t payload;
+  payload.data = buffer->buffer;
+  payload.length = fastrtps__size_t_to_uint32_t(buffer->buffer_length);
+  payload.max_size = payload.length;
 
   // Deserializes payload into dynamic data. This copies!
+  eprosima::fastrtps::types::DynamicPubSubType m_type;
+  bool success = m_type.deserialize(&payload, data_impl->handle);
+  payload.data = nullptr;  // Data gets freed on buffer fini outside
+
   if (success) {
-    payload->data = nullptr;  // Data gets freed on buffer fini outside
     return RCUTILS_RET_OK;
   } else {
-    payload->data = nullptr;  // Data gets freed on buffer fini outside
     RCUTILS_SET_ERROR_MSG("Could not deserialize dynamic data");
     return RCUTILS_RET_ERROR;
   }
@@ -439,7 +604,7 @@ fastrtps__dynamic_data_get_string_value(
   const rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
   rosidl_dynamic_typesupport_member_id_t id, char ** value, size_t * value_length)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, GETTER_OUTPUT);
   std::string tmp_string;
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
@@ -453,6 +618,8 @@ fastrtps__dynamic_data_get_string_value(
   memcpy(tmp_out, tmp_string.c_str(), *value_length);
   tmp_out[*value_length] = '\0';
   *value = tmp_out;
+  FASTRTPS_RECORD_ALLOCATION(
+    serialization_support_impl, GETTER_OUTPUT, (*value_length + 1) * sizeof(*tmp_out));
   return RCUTILS_RET_OK;
 }
 
@@ -463,7 +630,7 @@ fastrtps__dynamic_data_get_wstring_value(
   const rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
   rosidl_dynamic_typesupport_member_id_t id, char16_t ** value, size_t * value_length)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, GETTER_OUTPUT);
   std::wstring tmp_wstring;
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
@@ -477,6 +644,8 @@ fastrtps__dynamic_data_get_wstring_value(
   fastrtps__ucsncpy(tmp_out, fastrtps__wstring_to_u16string(tmp_wstring).c_str(), *value_length);
   tmp_out[*value_length] = '\0';
   *value = tmp_out;
+  FASTRTPS_RECORD_ALLOCATION(
+    serialization_support_impl, GETTER_OUTPUT, (*value_length + 1) * sizeof(*tmp_out));
   return RCUTILS_RET_OK;
 }
 
@@ -488,7 +657,7 @@ fastrtps__dynamic_data_get_fixed_string_value(
   rosidl_dynamic_typesupport_member_id_t id, char ** value, size_t * value_length,
   size_t string_length)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, GETTER_OUTPUT);
   std::string tmp_string;
 
   // On the wire it's a bounded string
@@ -504,6 +673,8 @@ fastrtps__dynamic_data_get_fixed_string_value(
   memcpy(tmp_out, tmp_string.c_str(), copy_length);
   tmp_out[*value_length] = '\0';
   *value = tmp_out;
+  FASTRTPS_RECORD_ALLOCATION(
+    serialization_support_impl, GETTER_OUTPUT, (*value_length + 1) * sizeof(*tmp_out));
   return RCUTILS_RET_OK;
 }
 
@@ -515,7 +686,7 @@ fastrtps__dynamic_data_get_fixed_wstring_value(
   rosidl_dynamic_typesupport_member_id_t id, char16_t ** value, size_t * value_length,
   size_t wstring_length)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, GETTER_OUTPUT);
   std::wstring tmp_wstring;
 
   // On the wire it's a bounded string
@@ -531,6 +702,8 @@ fastrtps__dynamic_data_get_fixed_wstring_value(
   fastrtps__ucsncpy(tmp_out, fastrtps__wstring_to_u16string(tmp_wstring).c_str(), copy_length);
   tmp_out[*value_length] = '\0';
   *value = tmp_out;
+  FASTRTPS_RECORD_ALLOCATION(
+    serialization_support_impl, GETTER_OUTPUT, (*value_length + 1) * sizeof(*tmp_out));
   return RCUTILS_RET_OK;
 }
 
@@ -542,7 +715,7 @@ fastrtps__dynamic_data_get_bounded_string_value(
   rosidl_dynamic_typesupport_member_id_t id, char ** value, size_t * value_length,
   size_t string_bound)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, GETTER_OUTPUT);
   std::string tmp_string;
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
@@ -556,6 +729,8 @@ fastrtps__dynamic_data_get_bounded_string_value(
   memcpy(tmp_out, tmp_string.c_str(), *value_length);
   tmp_out[*value_length] = '\0';
   *value = tmp_out;
+  FASTRTPS_RECORD_ALLOCATION(
+    serialization_support_impl, GETTER_OUTPUT, (*value_length + 1) * sizeof(*tmp_out));
   return RCUTILS_RET_OK;
 }
 
@@ -567,7 +742,7 @@ fastrtps__dynamic_data_get_bounded_wstring_value(
   rosidl_dynamic_typesupport_member_id_t id, char16_t ** value, size_t * value_length,
   size_t wstring_bound)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, GETTER_OUTPUT);
   std::wstring tmp_wstring;
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
@@ -581,6 +756,8 @@ fastrtps__dynamic_data_get_bounded_wstring_value(
   fastrtps__ucsncpy(tmp_out, fastrtps__wstring_to_u16string(tmp_wstring).c_str(), *value_length);
   tmp_out[*value_length] = '\0';
   *value = tmp_out;
+  FASTRTPS_RECORD_ALLOCATION(
+    serialization_support_impl, GETTER_OUTPUT, (*value_length + 1) * sizeof(*tmp_out));
   return RCUTILS_RET_OK;
 }
 
@@ -953,13 +1130,18 @@ fastrtps__dynamic_data_set_complex_value(
   rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
   rosidl_dynamic_typesupport_member_id_t id, rosidl_dynamic_typesupport_dynamic_data_impl_t * value)
 {
-  (void) serialization_support_impl;
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  auto value_data = static_cast<DynamicData *>(value->handle);
 
-  FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
+  FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
     static_cast<DynamicData *>(data_impl->handle)->set_complex_value(
-      static_cast<DynamicData *>(value->handle), fastrtps__size_t_to_uint32_t(id)),
+      value_data, fastrtps__size_t_to_uint32_t(id)),
     "Could not set complex value"
   );
+  // The outer data owns the value now
+  fastrtps__data_pool_forget(&fastrtps_impl->data_pool_, value_data);
+  return RCUTILS_RET_OK;
 }
 
 
@@ -990,14 +1172,17 @@ fastrtps__dynamic_data_insert_complex_value(
   rosidl_dynamic_typesupport_dynamic_data_impl_t * value,
   rosidl_dynamic_typesupport_member_id_t * out_id)
 {
-  (void) serialization_support_impl;
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  auto value_data = static_cast<DynamicData *>(value->handle);
   eprosima::fastrtps::types::MemberId tmp_id;
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
-    static_cast<DynamicData *>(data_impl->handle)->insert_complex_value(
-      static_cast<DynamicData *>(value->handle), tmp_id),
+    static_cast<DynamicData *>(data_impl->handle)->insert_complex_value(value_data, tmp_id),
     "Could not insert complex value"
   );
+  // The outer data owns the value now
+  fastrtps__data_pool_forget(&fastrtps_impl->data_pool_, value_data);
   *out_id = tmp_id;
   return RCUTILS_RET_OK;
 }
@@ -23,6 +23,8 @@
 #include <rosidl_dynamic_typesupport/api/serialization_support_interface.h>
 #include <rosidl_dynamic_typesupport/uchar.h>
 
+#include <cstdint>
+
 
 // =================================================================================================
 // DYNAMIC DATA
@@ -57,6 +59,14 @@ fastrtps__dynamic_data_equals(
   const rosidl_dynamic_typesupport_dynamic_data_impl_t * other_data_impl,
   bool * equals);  // OUT
 
+// Hash of the value held by the data, only comparable between data of the same type
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__dynamic_data_hash(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  uint64_t * hash);  // OUT
+
 // Can be used to get sequence/array length, and also number of members for struct
 ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
 rcutils_ret_t
@@ -133,6 +143,16 @@ fastrtps__dynamic_data_init_from_dynamic_type(
   rcutils_allocator_t * allocator,
   rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl);  // OUT
 
+/// Like init_from_dynamic_type, for callers about to overwrite every value (e.g. deserialize)
+/// Data of flat types is recycled from the data pool if there is any, holding stale values
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__dynamic_data_init_for_overwrite(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl);  // OUT
+
 ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
 rcutils_ret_t
 fastrtps__dynamic_data_clone(
@@ -0,0 +1,583 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_dynamic_data_delta.hpp"
+
+#include <fastcdr/Cdr.h>
+#include <fastcdr/FastBuffer.h>
+#include <fastcdr/exceptions/Exception.h>
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicDataFactory.h>
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypeDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fastrtps_dynamic_data_image.hpp"
+#include "utils.hpp"
+
+
+using eprosima::fastcdr::Cdr;
+using eprosima::fastcdr::FastBuffer;
+using eprosima::fastrtps::types::DynamicData;
+using eprosima::fastrtps::types::DynamicDataFactory;
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::ReturnCode_t;
+using eprosima::fastrtps::types::TypeDescriptor;
+using eprosima::fastrtps::types::TypeKind;
+
+
+// Members that are diffed and set individually, with the type and DynamicData accessors of each
+#define FASTRTPS_DELTA_VALUE_KINDS(X) \
+  X(TK_BOOLEAN, bool, bool) \
+  X(TK_BYTE, eprosima::fastrtps::types::octet, byte) \
+  X(TK_CHAR8, char, char8) \
+  X(TK_CHAR16, wchar_t, char16) \
+  X(TK_FLOAT32, float, float32) \
+  X(TK_FLOAT64, double, float64) \
+  X(TK_FLOAT128, long double, float128) \
+  X(TK_INT16, int16_t, int16) \
+  X(TK_UINT16, uint16_t, uint16) \
+  X(TK_INT32, int32_t, int32) \
+  X(TK_UINT32, uint32_t, uint32) \
+  X(TK_INT64, int64_t, int64) \
+  X(TK_UINT64, uint64_t, uint64) \
+  X(TK_STRING8, std::string, string) \
+  X(TK_STRING16, std::wstring, wstring)
+
+#define FASTRTPS_DELTA_VALUE_KIND_CASE(Kind, ValueT, DataFnT) \
+  case eprosima::fastrtps::types::Kind:
+
+#define FASTRTPS_DELTA_DIFF_VALUE_CASE(Kind, ValueT, DataFnT) \
+  case eprosima::fastrtps::types::Kind: \
+    return fastrtps__dynamic_data_delta_diff_value_t<ValueT>( \
+      writer, from, to, id, kind, &DynamicData::get_ ## DataFnT ## _value);
+
+#define FASTRTPS_DELTA_PATCH_VALUE_CASE(Kind, ValueT, DataFnT) \
+  case eprosima::fastrtps::types::Kind: \
+    return fastrtps__dynamic_data_delta_patch_value_t<ValueT>( \
+      target, cdr, id, &DynamicData::set_ ## DataFnT ## _value);
+
+#define FASTRTPS_DELTA_CHECK_VALUE_CASE(Kind, ValueT, DataFnT) \
+  case eprosima::fastrtps::types::Kind: \
+    return fastrtps__dynamic_data_delta_check_value_t<ValueT>(cdr, target.type_);
+
+
+typedef struct fastrtps__dynamic_data_delta_writer_s
+{
+  Cdr & cdr_;
+  std::vector<uint32_t> path_;
+  uint32_t change_count_;
+} fastrtps__dynamic_data_delta_writer_t;
+
+
+// =================================================================================================
+// DYNAMIC DATA DELTA
+// =================================================================================================
+static bool
+fastrtps__dynamic_data_delta_is_value_kind(TypeKind kind)
+{
+  switch (kind) {
+    FASTRTPS_DELTA_VALUE_KINDS(FASTRTPS_DELTA_VALUE_KIND_CASE)
+    return true;
+    default:
+      return false;
+  }
+}
+
+
+static void
+fastrtps__dynamic_data_delta_begin_change(
+  fastrtps__dynamic_data_delta_writer_t * writer, TypeKind kind)
+{
+  writer->cdr_ << writer->path_;
+  writer->cdr_ << static_cast<uint8_t>(kind);
+  ++writer->change_count_;
+}
+
+
+// DIFF ============================================================================================
+template<typename ValueT>
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_diff_value_t(
+  fastrtps__dynamic_data_delta_writer_t * writer,
+  const DynamicData * from, const DynamicData * to, MemberId id, TypeKind kind,
+  ReturnCode_t (DynamicData::* get_value)(ValueT &, MemberId) const)
+{
+  ValueT from_value{};
+  ValueT to_value{};
+  if ((from->*get_value)(from_value, id) != ReturnCode_t::RETCODE_OK ||
+    (to->*get_value)(to_value, id) != ReturnCode_t::RETCODE_OK)
+  {
+    RCUTILS_SET_ERROR_MSG("Could not get value to diff");
+    return RCUTILS_RET_ERROR;
+  }
+  // NOTE: NaNs never compare equal, so they are always sent
+  if (!(from_value == to_value)) {
+    fastrtps__dynamic_data_delta_begin_change(writer, kind);
+    writer->cdr_ << to_value;
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_diff_value(
+  fastrtps__dynamic_data_delta_writer_t * writer,
+  const DynamicData * from, const DynamicData * to, MemberId id, TypeKind kind)
+{
+  switch (kind) {
+    FASTRTPS_DELTA_VALUE_KINDS(FASTRTPS_DELTA_DIFF_VALUE_CASE)
+    default:
+      RCUTILS_SET_ERROR_MSG("Unsupported member kind to diff");
+      return RCUTILS_RET_ERROR;
+  }
+}
+
+
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_diff_struct(
+  fastrtps__dynamic_data_delta_writer_t * writer, DynamicData * from, DynamicData * to);
+
+
+// `from` and `to` are the loaned member values
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_diff_complex(
+  fastrtps__dynamic_data_delta_writer_t * writer,
+  DynamicData * from, DynamicData * to, const DynamicType_ptr & type)
+{
+  TypeDescriptor descriptor;
+  type->get_descriptor(&descriptor);
+  TypeKind kind = descriptor.get_kind();
+
+  if (kind == eprosima::fastrtps::types::TK_STRUCTURE) {
+    return fastrtps__dynamic_data_delta_diff_struct(writer, from, to);
+  }
+
+  if (kind == eprosima::fastrtps::types::TK_ARRAY) {
+    TypeKind element_kind = descriptor.get_element_type()->get_kind();
+    if (fastrtps__dynamic_data_delta_is_value_kind(element_kind)) {
+      uint32_t item_count = from->get_item_count();
+      for (uint32_t index = 0; index < item_count; ++index) {
+        writer->path_.push_back(index);
+        rcutils_ret_t ret = fastrtps__dynamic_data_delta_diff_value(
+          writer, from, to, index, element_kind);
+        writer->path_.pop_back();
+        if (ret != RCUTILS_RET_OK) {
+          return ret;
+        }
+      }
+      return RCUTILS_RET_OK;
+    }
+  }
+
+  // Anything else is sent whole if it changed at all
+  thread_local std::vector<char> from_image;
+  thread_local std::vector<char> to_image;
+  if (!fastrtps__dynamic_data_image_write(from, from_image) ||
+    !fastrtps__dynamic_data_image_write(to, to_image))
+  {
+    RCUTILS_SET_ERROR_MSG("Could not serialize member to diff");
+    return RCUTILS_RET_ERROR;
+  }
+  if (from_image.size() != to_image.size() ||
+    memcmp(from_image.data(), to_image.data(), from_image.size()) != 0)
+  {
+    fastrtps__dynamic_data_delta_begin_change(writer, kind);
+    to->serialize(writer->cdr_);
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_diff_struct(
+  fastrtps__dynamic_data_delta_writer_t * writer, DynamicData * from, DynamicData * to)
+{
+  uint32_t item_count = from->get_item_count();
+  if (item_count != to->get_item_count()) {
+    RCUTILS_SET_ERROR_MSG("Cannot diff dynamic data of different types");
+    return RCUTILS_RET_ERROR;
+  }
+
+  for (uint32_t index = 0; index < item_count; ++index) {
+    MemberId id = from->get_member_id_at_index(index);
+    MemberDescriptor descriptor;
+    if (from->get_descriptor(descriptor, id) != ReturnCode_t::RETCODE_OK) {
+      RCUTILS_SET_ERROR_MSG("Could not get member descriptor to diff");
+      return RCUTILS_RET_ERROR;
+    }
+
+    writer->path_.push_back(id);
+    rcutils_ret_t ret = RCUTILS_RET_OK;
+    if (fastrtps__dynamic_data_delta_is_value_kind(descriptor.get_kind())) {
+      ret = fastrtps__dynamic_data_delta_diff_value(writer, from, to, id, descriptor.get_kind());
+    } else {
+      DynamicData * from_member = from->loan_value(id);
+      DynamicData * to_member = to->loan_value(id);
+      if (from_member && to_member) {
+        ret = fastrtps__dynamic_data_delta_diff_complex(
+          writer, from_member, to_member, descriptor.get_type());
+      } else {
+        RCUTILS_SET_ERROR_MSG("Could not loan member to diff");
+        ret = RCUTILS_RET_ERROR;
+      }
+      if (from_member) {
+        from->return_loaned_value(from_member);
+      }
+      if (to_member) {
+        to->return_loaned_value(to_member);
+      }
+    }
+    writer->path_.pop_back();
+
+    if (ret != RCUTILS_RET_OK) {
+      return ret;
+    }
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__dynamic_data_delta_diff(
+  const DynamicData * from,
+  const DynamicData * to,
+  rcutils_uint8_array_t * delta,
+  size_t * change_count)
+{
+  FastBuffer buffer;
+  Cdr cdr(buffer, Cdr::LITTLE_ENDIANNESS, Cdr::DDS_CDR);
+  fastrtps__dynamic_data_delta_writer_t writer{cdr, {}, 0};
+
+  rcutils_ret_t ret = RCUTILS_RET_OK;
+  try {
+    cdr << writer.change_count_;  // Placeholder, overwritten once the count is known
+
+    // Members are only loaned to read them, the data is not modified
+    ret = fastrtps__dynamic_data_delta_diff_struct(
+      &writer, const_cast<DynamicData *>(from), const_cast<DynamicData *>(to));
+  } catch (const eprosima::fastcdr::exception::Exception &) {
+    RCUTILS_SET_ERROR_MSG("Could not serialize dynamic data delta");
+    ret = RCUTILS_RET_BAD_ALLOC;
+  }
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+
+  size_t length = cdr.getSerializedDataLength();
+  if (delta->buffer_capacity < length) {
+    if (rcutils_uint8_array_resize(delta, length) != RCUTILS_RET_OK) {
+      RCUTILS_SET_ERROR_MSG("Could not resize dynamic data delta buffer");
+      return RCUTILS_RET_BAD_ALLOC;
+    }
+  }
+  memcpy(delta->buffer, buffer.getBuffer(), length);
+  delta->buffer_length = length;
+
+  // The count is a little-endian u32 at the start of the stream
+  FastBuffer count_buffer(reinterpret_cast<char *>(delta->buffer), sizeof(uint32_t));
+  Cdr count_cdr(count_buffer, Cdr::LITTLE_ENDIANNESS, Cdr::DDS_CDR);
+  count_cdr << writer.change_count_;
+
+  *change_count = writer.change_count_;
+  return RCUTILS_RET_OK;
+}
+
+
+// PATCH ===========================================================================================
+template<typename ValueT, typename SetValueT>
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_patch_value_t(
+  DynamicData * target, Cdr & cdr, MemberId id,
+  ReturnCode_t (DynamicData::* set_value)(SetValueT, MemberId))
+{
+  ValueT value{};
+  cdr >> value;
+  if ((target->*set_value)(value, id) != ReturnCode_t::RETCODE_OK) {
+    RCUTILS_SET_ERROR_MSG("Could not set value from dynamic data delta");
+    return RCUTILS_RET_ERROR;
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+template<typename ValueT>
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_check_bound(const ValueT & value, const DynamicType_ptr & type)
+{
+  (void) value;
+  (void) type;
+  return RCUTILS_RET_OK;
+}
+
+
+// fastrtps refuses to set strings longer than their bound
+template<typename CharT>
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_check_bound(
+  const std::basic_string<CharT> & value, const DynamicType_ptr & type)
+{
+  if (value.size() > type->get_bounds()) {
+    RCUTILS_SET_ERROR_MSG("Malformed dynamic data delta, string is longer than its bound");
+    return RCUTILS_RET_ERROR;
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+template<typename ValueT>
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_check_value_t(Cdr & cdr, const DynamicType_ptr & type)
+{
+  ValueT value{};
+  cdr >> value;
+  return fastrtps__dynamic_data_delta_check_bound(value, type);
+}
+
+
+// The data holding a changed member, loaned down from the data being patched
+typedef struct fastrtps__dynamic_data_delta_target_s
+{
+  std::vector<std::pair<DynamicData *, DynamicData *>> loans_;
+  DynamicData * data_;
+  MemberId id_;
+  DynamicType_ptr type_;  // Of the changed member
+} fastrtps__dynamic_data_delta_target_t;
+
+
+static void
+fastrtps__dynamic_data_delta_target_release(fastrtps__dynamic_data_delta_target_t * target)
+{
+  for (auto it = target->loans_.rbegin(); it != target->loans_.rend(); ++it) {
+    it->first->return_loaned_value(it->second);
+  }
+  target->loans_.clear();
+}
+
+
+// Loan down `path` to the data holding the changed member, checking every step and `kind` against
+// the member descriptors. Returned loans must be released even on failure
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_resolve(
+  DynamicData * data, const std::vector<uint32_t> & path, TypeKind kind,
+  fastrtps__dynamic_data_delta_target_t * target)
+{
+  target->data_ = data;
+  DynamicType_ptr array_type;  // Set while target->data_ is an array rather than a struct
+  for (size_t i = 0; i < path.size(); ++i) {
+    bool last = i + 1 == path.size();
+    DynamicType_ptr member_type;
+    if (array_type) {
+      // Only arrays of values are diffed element by element, so an element is always the last step
+      if (!last || path[i] >= target->data_->get_item_count()) {
+        RCUTILS_SET_ERROR_MSG("Malformed dynamic data delta, array element is out of range");
+        return RCUTILS_RET_ERROR;
+      }
+      TypeDescriptor descriptor;
+      array_type->get_descriptor(&descriptor);
+      member_type = descriptor.get_element_type();
+    } else {
+      MemberDescriptor descriptor;
+      if (target->data_->get_descriptor(descriptor, path[i]) != ReturnCode_t::RETCODE_OK) {
+        RCUTILS_SET_ERROR_MSG("Malformed dynamic data delta, member does not exist");
+        return RCUTILS_RET_ERROR;
+      }
+      member_type = descriptor.get_type();
+    }
+
+    if (last) {
+      if (member_type->get_kind() != kind) {
+        RCUTILS_SET_ERROR_MSG("Malformed dynamic data delta, change kind does not match member");
+        return RCUTILS_RET_ERROR;
+      }
+      target->id_ = path[i];
+      target->type_ = std::move(member_type);
+      return RCUTILS_RET_OK;
+    }
+
+    TypeKind member_kind = member_type->get_kind();
+    if (member_kind != eprosima::fastrtps::types::TK_STRUCTURE &&
+      member_kind != eprosima::fastrtps::types::TK_ARRAY)
+    {
+      RCUTILS_SET_ERROR_MSG("Malformed dynamic data delta, path goes through a value member");
+      return RCUTILS_RET_ERROR;
+    }
+    DynamicData * member = target->data_->loan_value(path[i]);
+    if (!member) {
+      RCUTILS_SET_ERROR_MSG("Could not loan member to patch from dynamic data delta");
+      return RCUTILS_RET_ERROR;
+    }
+    target->loans_.emplace_back(target->data_, member);
+    target->data_ = member;
+    array_type = member_kind == eprosima::fastrtps::types::TK_ARRAY ?
+      std::move(member_type) : DynamicType_ptr();
+  }
+
+  RCUTILS_SET_ERROR_MSG("Malformed dynamic data delta, change has an empty path");
+  return RCUTILS_RET_ERROR;
+}
+
+
+// Read the new value of `target`'s member without setting it
+// May throw if the delta is truncated
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_check_member(
+  DynamicDataFactory * data_factory, Cdr & cdr,
+  const fastrtps__dynamic_data_delta_target_t & target, TypeKind kind)
+{
+  switch (kind) {
+    FASTRTPS_DELTA_VALUE_KINDS(FASTRTPS_DELTA_CHECK_VALUE_CASE)
+    default:
+      break;
+  }
+
+  // Anything else was sent whole, and is read into a scratch data of the member's type
+  DynamicData * scratch = data_factory->create_data(target.type_);
+  if (!scratch) {
+    RCUTILS_SET_ERROR_MSG("Could not create dynamic data to check dynamic data delta");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  rcutils_ret_t ret = RCUTILS_RET_OK;
+  try {
+    if (!scratch->deserialize(cdr)) {
+      RCUTILS_SET_ERROR_MSG("Malformed dynamic data delta, member value is invalid");
+      ret = RCUTILS_RET_ERROR;
+    }
+  } catch (...) {
+    data_factory->delete_data(scratch);
+    throw;
+  }
+  data_factory->delete_data(scratch);
+  return ret;
+}
+
+
+// May throw if the delta is truncated
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_patch_member(
+  DynamicData * target, Cdr & cdr, MemberId id, TypeKind kind)
+{
+  switch (kind) {
+    FASTRTPS_DELTA_VALUE_KINDS(FASTRTPS_DELTA_PATCH_VALUE_CASE)
+    default:
+      break;
+  }
+
+  // Anything else was sent whole
+  DynamicData * member = target->loan_value(id);
+  if (!member) {
+    RCUTILS_SET_ERROR_MSG("Could not loan member to patch from dynamic data delta");
+    return RCUTILS_RET_ERROR;
+  }
+  rcutils_ret_t ret = RCUTILS_RET_OK;
+  try {
+    if (!member->deserialize(cdr)) {
+      RCUTILS_SET_ERROR_MSG("Could not set member from dynamic data delta");
+      ret = RCUTILS_RET_ERROR;
+    }
+  } catch (...) {
+    target->return_loaned_value(member);
+    throw;
+  }
+  target->return_loaned_value(member);
+  return ret;
+}
+
+
+// Checks the change against `data` if `data_factory` is set, applies it otherwise
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_patch_change(
+  DynamicDataFactory * data_factory, DynamicData * data, Cdr & cdr)
+{
+  std::vector<uint32_t> path;
+  uint8_t kind;
+  cdr >> path;
+  cdr >> kind;
+
+  fastrtps__dynamic_data_delta_target_t target;
+  rcutils_ret_t ret = fastrtps__dynamic_data_delta_resolve(
+    data, path, static_cast<TypeKind>(kind), &target);
+  if (ret == RCUTILS_RET_OK) {
+    try {
+      if (data_factory) {
+        ret = fastrtps__dynamic_data_delta_check_member(
+          data_factory, cdr, target, static_cast<TypeKind>(kind));
+      } else {
+        ret = fastrtps__dynamic_data_delta_patch_member(
+          target.data_, cdr, target.id_, static_cast<TypeKind>(kind));
+      }
+    } catch (const eprosima::fastcdr::exception::Exception &) {
+      RCUTILS_SET_ERROR_MSG("Malformed dynamic data delta, value is truncated");
+      ret = RCUTILS_RET_ERROR;
+    }
+  }
+  fastrtps__dynamic_data_delta_target_release(&target);
+  return ret;
+}
+
+
+// Checks every change against `data` if `data_factory` is set, applies them otherwise
+static rcutils_ret_t
+fastrtps__dynamic_data_delta_patch_changes(
+  DynamicDataFactory * data_factory, DynamicData * data, const rcutils_uint8_array_t * delta)
+{
+  // fastcdr only reads from the buffer, it just doesn't have a const interface
+  FastBuffer buffer(reinterpret_cast<char *>(delta->buffer), delta->buffer_length);
+  Cdr cdr(buffer, Cdr::LITTLE_ENDIANNESS, Cdr::DDS_CDR);
+
+  try {
+    uint32_t change_count;
+    cdr >> change_count;
+    for (uint32_t i = 0; i < change_count; ++i) {
+      rcutils_ret_t ret = fastrtps__dynamic_data_delta_patch_change(data_factory, data, cdr);
+      if (ret != RCUTILS_RET_OK) {
+        return ret;
+      }
+    }
+  } catch (const eprosima::fastcdr::exception::Exception &) {
+    RCUTILS_SET_ERROR_MSG("Malformed dynamic data delta, change is truncated");
+    return RCUTILS_RET_ERROR;
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__dynamic_data_delta_patch(
+  DynamicDataFactory * data_factory, DynamicData * data, const rcutils_uint8_array_t * delta)
+{
+  // Changes don't alter the shape of what later changes are checked against (sequences are only
+  // ever set whole), so a delta that checks out in full also applies in full
+  rcutils_ret_t ret = fastrtps__dynamic_data_delta_patch_changes(data_factory, data, delta);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  return fastrtps__dynamic_data_delta_patch_changes(nullptr, data, delta);
+}
@@ -0,0 +1,63 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_DYNAMIC_DATA_DELTA_HPP_
+#define DETAIL__FASTRTPS_DYNAMIC_DATA_DELTA_HPP_
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicDataFactory.h>
+
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstddef>
+
+
+// =================================================================================================
+// DYNAMIC DATA DELTA
+// =================================================================================================
+//
+// A delta is a little-endian CDR stream:
+//
+//   u32 change count, then per change
+//     sequence<u32> path   member ids from the outer struct down to the changed member, where the
+//                          member id of an array element is its (flattened) index
+//     u8 kind              TypeKind of the changed member, checked against the member's descriptor
+//     value                the new value, serialized like fastrtps serializes a member of that kind
+//
+// Primitive and string members, and primitive array elements, are diffed individually. Sequences
+// and other arrays are sent whole when anything in them changed.
+
+/// Write the changes that turn `from` into `to` into `delta`, which is resized to fit
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__dynamic_data_delta_diff(
+  const eprosima::fastrtps::types::DynamicData * from,
+  const eprosima::fastrtps::types::DynamicData * to,
+  rcutils_uint8_array_t * delta,  // OUT
+  size_t * change_count);  // OUT
+
+/// Apply the changes in `delta` to `data`, only once every change checks out against it
+/// Returns RCUTILS_RET_ERROR, leaving `data` untouched, if `delta` is malformed or was made from
+/// data of another type
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__dynamic_data_delta_patch(
+  eprosima::fastrtps::types::DynamicDataFactory * data_factory,
+  eprosima::fastrtps::types::DynamicData * data,
+  const rcutils_uint8_array_t * delta);
+
+
+#endif  // DETAIL__FASTRTPS_DYNAMIC_DATA_DELTA_HPP_
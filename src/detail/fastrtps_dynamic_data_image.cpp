@@ -0,0 +1,249 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_dynamic_data_image.hpp"
+
+#include <fastcdr/Cdr.h>
+#include <fastcdr/FastBuffer.h>
+#include <fastcdr/exceptions/Exception.h>
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypeDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+using eprosima::fastrtps::types::DynamicData;
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::ReturnCode_t;
+using eprosima::fastrtps::types::TypeDescriptor;
+
+
+// =================================================================================================
+// DYNAMIC DATA IMAGE
+// =================================================================================================
+bool
+fastrtps__dynamic_data_image_write(const DynamicData * data, std::vector<char> & image)
+{
+  // fastcdr skips over padding instead of writing it, so start from a zeroed buffer
+  size_t max_size = DynamicData::getCdrSerializedSize(data);
+  image.assign(max_size, 0);
+
+  eprosima::fastcdr::FastBuffer buffer(image.data(), image.size());
+  eprosima::fastcdr::Cdr cdr(
+    buffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN, eprosima::fastcdr::Cdr::DDS_CDR);
+  try {
+    data->serialize(cdr);
+  } catch (const eprosima::fastcdr::exception::Exception &) {
+    return false;
+  }
+
+  image.resize(cdr.getSerializedDataLength());
+  return true;
+}
+
+
+// CANONICAL IMAGE =================================================================================
+template<typename ValueT>
+static void
+fastrtps__dynamic_data_image_append(std::vector<char> & image, const ValueT & value)
+{
+  const char * bytes = reinterpret_cast<const char *>(&value);
+  image.insert(image.end(), bytes, bytes + sizeof(ValueT));
+}
+
+
+// -0.0 == 0.0, so comparing against zero turns -0.0 into 0.0 and leaves other values alone
+template<typename FloatT>
+static FloatT
+fastrtps__dynamic_data_image_canonical_float(FloatT value)
+{
+  if (std::isnan(value)) {
+    return std::numeric_limits<FloatT>::quiet_NaN();
+  }
+  return value == 0 ? FloatT(0) : value;
+}
+
+
+#define FASTRTPS_IMAGE_APPEND_CASE(KIND, NAME, ValueT) \
+  case eprosima::fastrtps::types::KIND: \
+    { \
+      ValueT value{}; \
+      if (data->get_ ## NAME ## _value(value, id) != ReturnCode_t::RETCODE_OK) { \
+        return false; \
+      } \
+      fastrtps__dynamic_data_image_append(image, value); \
+      return true; \
+    }
+
+#define FASTRTPS_IMAGE_APPEND_FLOAT_CASE(KIND, NAME, ValueT) \
+  case eprosima::fastrtps::types::KIND: \
+    { \
+      ValueT value{}; \
+      if (data->get_ ## NAME ## _value(value, id) != ReturnCode_t::RETCODE_OK) { \
+        return false; \
+      } \
+      fastrtps__dynamic_data_image_append( \
+        image, fastrtps__dynamic_data_image_canonical_float(value)); \
+      return true; \
+    }
+
+
+static bool
+fastrtps__dynamic_data_image_write_canonical_struct(DynamicData * data, std::vector<char> & image);
+
+static bool
+fastrtps__dynamic_data_image_write_canonical_complex(
+  DynamicData * data, const DynamicType_ptr & type, std::vector<char> & image);
+
+
+// Member (or element) `id` of `data`, of type `type`
+static bool
+fastrtps__dynamic_data_image_write_canonical_value(
+  DynamicData * data, MemberId id, const DynamicType_ptr & type, std::vector<char> & image)
+{
+  switch (type->get_kind()) {
+    FASTRTPS_IMAGE_APPEND_CASE(TK_BOOLEAN, bool, bool)
+    FASTRTPS_IMAGE_APPEND_CASE(TK_BYTE, byte, eprosima::fastrtps::types::octet)
+    FASTRTPS_IMAGE_APPEND_CASE(TK_CHAR8, char8, char)
+    FASTRTPS_IMAGE_APPEND_CASE(TK_CHAR16, char16, wchar_t)
+    FASTRTPS_IMAGE_APPEND_CASE(TK_INT16, int16, int16_t)
+    FASTRTPS_IMAGE_APPEND_CASE(TK_UINT16, uint16, uint16_t)
+    FASTRTPS_IMAGE_APPEND_CASE(TK_INT32, int32, int32_t)
+    FASTRTPS_IMAGE_APPEND_CASE(TK_UINT32, uint32, uint32_t)
+    FASTRTPS_IMAGE_APPEND_CASE(TK_INT64, int64, int64_t)
+    FASTRTPS_IMAGE_APPEND_CASE(TK_UINT64, uint64, uint64_t)
+    FASTRTPS_IMAGE_APPEND_FLOAT_CASE(TK_FLOAT32, float32, float)
+    FASTRTPS_IMAGE_APPEND_FLOAT_CASE(TK_FLOAT64, float64, double)
+
+    case eprosima::fastrtps::types::TK_FLOAT128:
+      {
+        // The padding bytes of a long double are unspecified, so it is written as the nearest
+        // double instead: equal values still convert to equal doubles
+        long double value{};
+        if (data->get_float128_value(value, id) != ReturnCode_t::RETCODE_OK) {
+          return false;
+        }
+        fastrtps__dynamic_data_image_append(
+          image, fastrtps__dynamic_data_image_canonical_float(static_cast<double>(value)));
+        return true;
+      }
+
+    case eprosima::fastrtps::types::TK_STRING8:
+      {
+        std::string value;
+        if (data->get_string_value(value, id) != ReturnCode_t::RETCODE_OK) {
+          return false;
+        }
+        fastrtps__dynamic_data_image_append(image, static_cast<uint32_t>(value.size()));
+        image.insert(image.end(), value.begin(), value.end());
+        return true;
+      }
+
+    case eprosima::fastrtps::types::TK_STRING16:
+      {
+        std::wstring value;
+        if (data->get_wstring_value(value, id) != ReturnCode_t::RETCODE_OK) {
+          return false;
+        }
+        fastrtps__dynamic_data_image_append(image, static_cast<uint32_t>(value.size()));
+        for (wchar_t c : value) {
+          fastrtps__dynamic_data_image_append(image, c);
+        }
+        return true;
+      }
+
+    case eprosima::fastrtps::types::TK_STRUCTURE:
+    case eprosima::fastrtps::types::TK_ARRAY:
+    case eprosima::fastrtps::types::TK_SEQUENCE:
+      {
+        DynamicData * member = data->loan_value(id);
+        if (!member) {
+          return false;
+        }
+        bool ok = fastrtps__dynamic_data_image_write_canonical_complex(member, type, image);
+        data->return_loaned_value(member);
+        return ok;
+      }
+
+    default:
+      return false;
+  }
+}
+
+#undef FASTRTPS_IMAGE_APPEND_FLOAT_CASE
+#undef FASTRTPS_IMAGE_APPEND_CASE
+
+
+static bool
+fastrtps__dynamic_data_image_write_canonical_complex(
+  DynamicData * data, const DynamicType_ptr & type, std::vector<char> & image)
+{
+  TypeDescriptor descriptor;
+  type->get_descriptor(&descriptor);
+  if (descriptor.get_kind() == eprosima::fastrtps::types::TK_STRUCTURE) {
+    return fastrtps__dynamic_data_image_write_canonical_struct(data, image);
+  }
+
+  // Arrays and sequences, only sequences are prefixed with their length
+  uint32_t item_count = data->get_item_count();
+  if (descriptor.get_kind() == eprosima::fastrtps::types::TK_SEQUENCE) {
+    fastrtps__dynamic_data_image_append(image, item_count);
+  }
+  DynamicType_ptr element_type = descriptor.get_element_type();
+  for (uint32_t index = 0; index < item_count; ++index) {
+    if (!fastrtps__dynamic_data_image_write_canonical_value(data, index, element_type, image)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+static bool
+fastrtps__dynamic_data_image_write_canonical_struct(DynamicData * data, std::vector<char> & image)
+{
+  uint32_t item_count = data->get_item_count();
+  for (uint32_t index = 0; index < item_count; ++index) {
+    MemberId id = data->get_member_id_at_index(index);
+    MemberDescriptor descriptor;
+    if (data->get_descriptor(descriptor, id) != ReturnCode_t::RETCODE_OK ||
+      !fastrtps__dynamic_data_image_write_canonical_value(data, id, descriptor.get_type(), image))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool
+fastrtps__dynamic_data_image_write_canonical(const DynamicData * data, std::vector<char> & image)
+{
+  image.clear();
+
+  // Members are only loaned to read them, the data is not modified
+  return fastrtps__dynamic_data_image_write_canonical_struct(
+    const_cast<DynamicData *>(data), image);
+}
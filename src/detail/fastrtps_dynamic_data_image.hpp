@@ -0,0 +1,58 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_DYNAMIC_DATA_IMAGE_HPP_
+#define DETAIL__FASTRTPS_DYNAMIC_DATA_IMAGE_HPP_
+
+#include <fastrtps/types/DynamicData.h>
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <vector>
+
+
+// =================================================================================================
+// DYNAMIC DATA IMAGE
+// =================================================================================================
+//
+// The image of a dynamic data is its value serialized to CDR, without encapsulation header, with
+// every alignment padding byte zeroed. Two data of the same type hold bitwise equal values if and
+// only if their images are equal, so images can be hashed and compared with memcmp. Bitwise
+// equality is not DynamicData::equals, which compares floating point values by value.
+
+/// Write the image of `data` into `image`, which is resized to fit it exactly
+/// Returns false if `data` could not be serialized
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__dynamic_data_image_write(
+  const eprosima::fastrtps::types::DynamicData * data,
+  std::vector<char> & image);  // OUT
+
+/// Write the canonical image of `data` into `image`, which is resized to fit it exactly
+/**
+ * The canonical image is only meant for hashing. It lists the same values as the image, in the same
+ * order, without padding and in host byte order, with every -0.0 written as 0.0 and every NaN as
+ * the same quiet NaN. Data that DynamicData::equals considers equal have equal canonical images.
+ *
+ * Nested members are loaned while they are written, so `data` must not be used from other threads
+ * meanwhile. Returns false if `data` has members of a kind that is not supported.
+ */
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__dynamic_data_image_write_canonical(
+  const eprosima::fastrtps::types::DynamicData * data,
+  std::vector<char> & image);  // OUT
+
+
+#endif  // DETAIL__FASTRTPS_DYNAMIC_DATA_IMAGE_HPP_
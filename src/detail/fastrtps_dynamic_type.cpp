@@ -35,10 +35,13 @@
 #include <rosidl_dynamic_typesupport/api/serialization_support_interface.h>
 #include <rosidl_dynamic_typesupport/types.h>
 
+#include <atomic>
 #include <string>
 #include <utility>
 
 #include "fastrtps_serialization_support.hpp"
+#include "fastrtps_tracepoints.hpp"
+#include "fastrtps_type_cache.hpp"
 #include "macros.hpp"
 #include "utils.hpp"
 
@@ -56,6 +59,74 @@ using eprosima::fastrtps::types::TypeDescriptor;
 // DYNAMIC TYPE
 // =================================================================================================
 
+// DYNAMIC TYPE HANDLE ============================================================================
+const DynamicType_ptr &
+fastrtps__dynamic_type_handle_get_type(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl,
+  fastrtps__dynamic_type_handle_t * type_handle)
+{
+  if (!type_handle->materialized_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(type_handle->lazy_mutex_);
+    if (!type_handle->materialized_.load(std::memory_order_relaxed)) {
+      DynamicType_ptr type = fastrtps__lazy_struct_build(
+        *type_handle->lazy_, fastrtps_impl->type_factory_, &fastrtps_impl->type_cache_);
+      if (type) {
+        type_handle->fingerprint_ = fastrtps__type_fingerprint_compute(type);
+        type_handle->type_ = std::move(type);
+        type_handle->lazy_.reset();  // The builder snapshots are not needed anymore
+        type_handle->materialized_.store(true, std::memory_order_release);
+      }
+    }
+  }
+  return type_handle->type_;
+}
+
+
+bool
+fastrtps__dynamic_type_handle_is_flat(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl,
+  fastrtps__dynamic_type_handle_t * type_handle)
+{
+  // Racing threads work out the same answer, so the first one does not need to win
+  fastrtps__type_flatness_t flatness = type_handle->flatness_.load(std::memory_order_relaxed);
+  if (flatness == FASTRTPS_TYPE_FLATNESS_UNKNOWN) {
+    const auto & type = fastrtps__dynamic_type_handle_get_type(fastrtps_impl, type_handle);
+    if (!type) {
+      return false;
+    }
+    flatness = fastrtps__data_pool_type_is_flat(type) ?
+      FASTRTPS_TYPE_FLATNESS_FLAT : FASTRTPS_TYPE_FLATNESS_NOT_FLAT;
+    type_handle->flatness_.store(flatness, std::memory_order_relaxed);
+  }
+  return flatness == FASTRTPS_TYPE_FLATNESS_FLAT;
+}
+
+
+// Returns the unbuilt type behind `type_handle`, or an empty pointer if it is already built
+static std::shared_ptr<fastrtps__lazy_struct_t>
+fastrtps__dynamic_type_handle_get_lazy(fastrtps__dynamic_type_handle_t * type_handle)
+{
+  if (type_handle->materialized_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(type_handle->lazy_mutex_);
+  return type_handle->lazy_;
+}
+
+
+std::string
+fastrtps__dynamic_type_handle_get_name(fastrtps__dynamic_type_handle_t * type_handle)
+{
+  if (!type_handle->materialized_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(type_handle->lazy_mutex_);
+    if (type_handle->lazy_) {
+      return type_handle->lazy_->snapshot_->get_name();
+    }
+  }
+  return type_handle->type_->get_name();
+}
+
+
 // DYNAMIC TYPE UTILS =======================================================================
 rcutils_ret_t
 fastrtps__dynamic_type_equals(
@@ -64,13 +135,28 @@ fastrtps__dynamic_type_equals(
   const rosidl_dynamic_typesupport_dynamic_type_impl_t * other_type_impl,
   bool * equals)
 {
-  (void) serialization_support_impl;
-  auto type = eprosima::fastrtps::types::DynamicType_ptr(
-    *static_cast<const eprosima::fastrtps::types::DynamicType_ptr *>(type_impl->handle));
-  auto other = eprosima::fastrtps::types::DynamicType_ptr(
-    *static_cast<const eprosima::fastrtps::types::DynamicType_ptr *>(other_type_impl->handle));
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  auto type_handle = static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle);
+  auto other_handle = static_cast<fastrtps__dynamic_type_handle_t *>(other_type_impl->handle);
+
+  // Lazy types only get their fingerprint once built
+  if (!fastrtps__dynamic_type_handle_get_type(fastrtps_impl, type_handle) ||
+    !fastrtps__dynamic_type_handle_get_type(fastrtps_impl, other_handle))
+  {
+    RCUTILS_SET_ERROR_MSG("Could not build lazy type for comparison");
+    return RCUTILS_RET_ERROR;
+  }
+
+  *equals = fastrtps__type_fingerprint_equal(
+    &type_handle->fingerprint_, &other_handle->fingerprint_);
 
-  *equals = type->equals(other.get());
+#ifdef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_VERIFY_TYPE_FINGERPRINTS
+  if (*equals != type_handle->type_->equals(other_handle->type_.get())) {
+    RCUTILS_SET_ERROR_MSG("Type fingerprint comparison disagrees with deep type comparison");
+    return RCUTILS_RET_ERROR;
+  }
+#endif
   return RCUTILS_RET_OK;
 }
 
@@ -81,9 +167,14 @@ fastrtps__dynamic_type_get_member_count(
   const rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
   size_t * member_count)
 {
-  (void) serialization_support_impl;
-  auto type = eprosima::fastrtps::types::DynamicType_ptr(
-    *static_cast<const eprosima::fastrtps::types::DynamicType_ptr *>(type_impl->handle));
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  const auto & type = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle));
+  if (!type) {
+    RCUTILS_SET_ERROR_MSG("Could not build lazy type");
+    return RCUTILS_RET_ERROR;
+  }
 
   *member_count = type->get_members_count();
   return RCUTILS_RET_OK;
@@ -98,6 +189,7 @@ fastrtps__dynamic_type_builder_init(
   rcutils_allocator_t * allocator,
   rosidl_dynamic_typesupport_dynamic_type_builder_impl_t * type_builder_impl)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
   (void) allocator;
 
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
@@ -113,6 +205,8 @@ fastrtps__dynamic_type_builder_init(
     std::string(name, name_length), "/", "::"
   );
 
+  FASTRTPS_TRACEPOINT(type_builder_init, name_string.c_str());
+
   FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
     type_builder_handle->set_name(name_string), "Could not set type builder name");
 
@@ -128,6 +222,7 @@ fastrtps__dynamic_type_builder_clone(
   rcutils_allocator_t * allocator,
   rosidl_dynamic_typesupport_dynamic_type_builder_impl_t * type_builder_impl)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
   type_builder_impl->allocator = *allocator;
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
@@ -137,6 +232,9 @@ fastrtps__dynamic_type_builder_clone(
     RCUTILS_SET_ERROR_MSG("Could not clone struct type builder");
     return RCUTILS_RET_ERROR;
   }
+  fastrtps__lazy_builder_registry_copy(
+    &fastrtps_impl->lazy_builders_,
+    static_cast<const DynamicTypeBuilder *>(other->handle), type_builder_handle);
 
   type_builder_impl->handle = std::move(type_builder_handle);
   return RCUTILS_RET_OK;
@@ -148,8 +246,11 @@ fastrtps__dynamic_type_builder_fini(
   rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
   rosidl_dynamic_typesupport_dynamic_type_builder_impl_t * type_builder_impl)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
+  fastrtps__lazy_builder_registry_erase(
+    &fastrtps_impl->lazy_builders_, static_cast<DynamicTypeBuilder *>(type_builder_impl->handle));
   FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
     fastrtps_impl->type_factory_->delete_builder(
       static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)),
@@ -166,11 +267,36 @@ fastrtps__dynamic_type_init_from_dynamic_type_builder(
   rcutils_allocator_t * allocator,
   rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_LATENCY_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
   (void) allocator;
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+
+  auto type_builder = static_cast<DynamicTypeBuilder *>(type_builder_impl->handle);
+  std::string trace_type_name;
+  if (FASTRTPS_TRACEPOINTS_ENABLED(type_build)) {
+    trace_type_name = type_builder->get_name();
+  }
+  FASTRTPS_TRACEPOINT(type_build_entry, trace_type_name.c_str());
+  FASTRTPS_TRACEPOINT_ON_EXIT(
+    type_build_exit, trace_type_name.c_str(), type_builder->get_member_count());
+
+  // Builders with nested builder members recorded in lazy mode are built on first use instead
+  auto lazy = fastrtps__lazy_builder_registry_snapshot(
+    &fastrtps_impl->lazy_builders_, fastrtps_impl->type_factory_, type_builder);
+  if (lazy) {
+    auto type_handle = new fastrtps__dynamic_type_handle_t;
+    type_handle->fingerprint_ = fastrtps__type_fingerprint_t{{0, 0}};
+    type_handle->lazy_ = std::move(lazy);
+    type_handle->materialized_.store(false, std::memory_order_relaxed);
+    type_impl->handle = static_cast<void *>(type_handle);
+    FASTRTPS_RECORD_ALLOCATION(
+      serialization_support_impl, TYPE_BUILD, sizeof(fastrtps__dynamic_type_handle_t));
+    return RCUTILS_RET_OK;
+  }
 
-  eprosima::fastrtps::types::DynamicType_ptr type_impl_out_handle =
-    static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->build();
+  eprosima::fastrtps::types::DynamicType_ptr type_impl_out_handle = type_builder->build();
   if (!type_impl_out_handle) {
     RCUTILS_SET_ERROR_MSG("Could not create dynamic type from dynamic type builder");
     return RCUTILS_RET_BAD_ALLOC;
@@ -179,8 +305,13 @@ fastrtps__dynamic_type_init_from_dynamic_type_builder(
   // Disgusting, but unavoidable... (we can't easily transfer ownership)
   //
   // We're forcing the managed pointer to persist outside of function scope by moving ownership
-  // to a new, heap-allocated DynamicType_ptr (which is a shared_ptr)
-  type_impl->handle = static_cast<void *>(new DynamicType_ptr(std::move(type_impl_out_handle)));
+  // to a new, heap-allocated handle holding the DynamicType_ptr (which is a shared_ptr)
+  auto type_handle = new fastrtps__dynamic_type_handle_t;
+  type_handle->fingerprint_ = fastrtps__type_fingerprint_compute(type_impl_out_handle);
+  type_handle->type_ = std::move(type_impl_out_handle);
+  type_impl->handle = static_cast<void *>(type_handle);
+  FASTRTPS_RECORD_ALLOCATION(
+    serialization_support_impl, TYPE_BUILD, sizeof(fastrtps__dynamic_type_handle_t));
   return RCUTILS_RET_OK;
 }
 
@@ -192,30 +323,18 @@ fastrtps__dynamic_type_clone(
   rcutils_allocator_t * allocator,
   rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl)
 {
+  (void) serialization_support_impl;
   type_impl->allocator = *allocator;
-  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
-    serialization_support_impl->handle);
 
-  auto type_impl_handle = eprosima::fastrtps::types::DynamicType_ptr(
-    *static_cast<const eprosima::fastrtps::types::DynamicType_ptr *>(other->handle));
-  if (!type_impl_handle) {
+  auto type_handle = static_cast<fastrtps__dynamic_type_handle_t *>(other->handle);
+  if (!type_handle) {
     RCUTILS_SET_ERROR_MSG("Could not get handle to type impl");
     return RCUTILS_RET_INVALID_ARGUMENT;
   }
 
-  eprosima::fastrtps::types::DynamicType_ptr type_impl_out_handle =
-    fastrtps_impl->type_factory_->create_alias_type(type_impl_handle, type_impl_handle->get_name());
-  if (!type_impl_out_handle) {
-    RCUTILS_SET_ERROR_MSG("Could not clone struct type");
-    return RCUTILS_RET_ERROR;
-  }
-
-  // Disgusting, but unavoidable... (we can't easily transfer ownership)
-  //
-  // We're forcing the managed pointer to persist outside of function scope by moving ownership
-  // to a new, heap-allocated DynamicType_ptr (which is a shared_ptr)
-  type_impl->handle = static_cast<void *>(
-    new DynamicType_ptr(std::move(type_impl_out_handle)));
+  // Built types are immutable, so the clone can share the handle instead of creating a new type
+  type_handle->ref_count_.fetch_add(1, std::memory_order_relaxed);
+  type_impl->handle = static_cast<void *>(type_handle);
   return RCUTILS_RET_OK;
 }
 
@@ -225,14 +344,29 @@ fastrtps__dynamic_type_fini(
   rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
   rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl)
 {
-  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
-    serialization_support_impl->handle);
-  auto type = eprosima::fastrtps::types::DynamicType_ptr(
-    *static_cast<const eprosima::fastrtps::types::DynamicType_ptr *>(type_impl->handle));
-
-  FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
-    fastrtps_impl->type_factory_->delete_type(type.get()), "Could not fini type"
-  );
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+
+  // Only drop this impl's reference to the shared handle. The type factory deletes the type once
+  // the handle and any data created from the type are gone as well
+  auto type_handle = static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle);
+  if (type_handle->ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // Data kept for reuse would keep the type alive, so it goes with the last reference
+    if (type_handle->flatness_.load(std::memory_order_relaxed) == FASTRTPS_TYPE_FLATNESS_FLAT) {
+      auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+        serialization_support_impl->handle);
+      size_t evicted = fastrtps__data_pool_evict(
+        &fastrtps_impl->data_pool_, type_handle->type_, fastrtps_impl->data_factory_);
+      if (evicted > 0) {
+        FASTRTPS_RECORD_FREE(
+          serialization_support_impl, DATA_CREATE,
+          evicted * sizeof(eprosima::fastrtps::types::DynamicData));
+      }
+    }
+    delete type_handle;
+    FASTRTPS_RECORD_FREE(
+      serialization_support_impl, TYPE_BUILD, sizeof(fastrtps__dynamic_type_handle_t));
+  }
+  type_impl->handle = NULL;
   return RCUTILS_RET_OK;
 }
 
@@ -244,14 +378,16 @@ fastrtps__dynamic_type_get_name(
   const char ** name,
   size_t * name_length)
 {
-  (void) serialization_support_impl;
-  auto type = eprosima::fastrtps::types::DynamicType_ptr(
-    *static_cast<const eprosima::fastrtps::types::DynamicType_ptr *>(type_impl->handle));
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, GETTER_OUTPUT);
 
   // Undo the mangling
-  std::string tmp_name = fastrtps__replace_string(type->get_name(), "::", "/");
+  std::string tmp_name = fastrtps__replace_string(
+    fastrtps__dynamic_type_handle_get_name(
+      static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle)),
+    "::", "/");
   *name = rcutils_strdup(tmp_name.c_str(), type_impl->allocator);
   *name_length = tmp_name.size();
+  FASTRTPS_RECORD_ALLOCATION(serialization_support_impl, GETTER_OUTPUT, *name_length + 1);
   return RCUTILS_RET_OK;
 }
 
@@ -263,13 +399,14 @@ fastrtps__dynamic_type_builder_get_name(
   const char ** name,
   size_t * name_length)
 {
-  (void)serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, GETTER_OUTPUT);
 
   // Undo the mangling
   std::string tmp_name = fastrtps__replace_string(
     static_cast<const DynamicTypeBuilder *>(type_builder_impl->handle)->get_name(), "::", "/");
   *name = rcutils_strdup(tmp_name.c_str(), type_builder_impl->allocator);
   *name_length = tmp_name.size();
+  FASTRTPS_RECORD_ALLOCATION(serialization_support_impl, GETTER_OUTPUT, *name_length + 1);
   return RCUTILS_RET_OK;
 }
 
@@ -280,7 +417,7 @@ fastrtps__dynamic_type_builder_set_name(
   rosidl_dynamic_typesupport_dynamic_type_builder_impl_t * type_builder_impl,
   const char * name, size_t name_length)
 {
-  (void)serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->set_name(
       std::string(name, name_length).c_str()),
@@ -290,7 +427,17 @@ fastrtps__dynamic_type_builder_set_name(
 
 
 // DYNAMIC TYPE PRIMITIVE MEMBERS ==================================================================
-#define FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(FunctionT, MemberT) \
+// Hit the type_builder_add_member tracepoint. Names are only copied out while a tracer is attached
+#define FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length) \
+  if (FASTRTPS_TRACEPOINT_ENABLED(type_builder_add_member)) { \
+    std::string trace_type_name = \
+      static_cast<DynamicTypeBuilder *>((type_builder_impl)->handle)->get_name(); \
+    std::string trace_member_name(name, name_length); \
+    FASTRTPS_TRACEPOINT( \
+      type_builder_add_member, trace_type_name.c_str(), trace_member_name.c_str(), id); \
+  }
+
+#define FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(FunctionT, MemberT, KindT) \
   rcutils_ret_t \
   fastrtps__dynamic_type_builder_add_ ## FunctionT ## _member( \
     rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl, \
@@ -299,34 +446,38 @@ fastrtps__dynamic_type_builder_set_name(
     const char * name, size_t name_length, \
     const char * default_value, size_t default_value_length) \
   { \
+    FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD); \
+    FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length); \
     auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>( \
       serialization_support_impl->handle); \
  \
     FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG( \
       static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member( \
         fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(), \
-        fastrtps_impl->type_factory_->create_ ## MemberT ## _type(), \
+        fastrtps__type_cache_get_primitive_type( \
+          &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, \
+          eprosima::fastrtps::types::KindT), \
         std::string(default_value, default_value_length).c_str()), \
       "Could not add `" #MemberT "` member to type builder" \
     ); \
   }
 
 
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(bool, bool)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(byte, byte)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(char, char8)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(wchar, char16)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(float32, float32)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(float64, float64)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(float128, float128)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(int8, byte)  // NOTE!!
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(uint8, byte)  // NOTE!!
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(int16, int16)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(uint16, uint16)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(int32, int32)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(uint32, uint32)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(int64, int64)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(uint64, uint64)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(bool, bool, TK_BOOLEAN)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(byte, byte, TK_BYTE)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(char, char8, TK_CHAR8)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(wchar, char16, TK_CHAR16)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(float32, float32, TK_FLOAT32)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(float64, float64, TK_FLOAT64)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(float128, float128, TK_FLOAT128)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(int8, byte, TK_BYTE)  // NOTE!!
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(uint8, byte, TK_BYTE)  // NOTE!!
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(int16, int16, TK_INT16)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(uint16, uint16, TK_UINT16)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(int32, int32, TK_INT32)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(uint32, uint32, TK_UINT32)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(int64, int64, TK_INT64)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN(uint64, uint64, TK_UINT64)
 #undef FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_MEMBER_FN
 
 
@@ -403,13 +554,17 @@ fastrtps__dynamic_type_builder_add_bounded_string_member(
   const char * default_value, size_t default_value_length,
   size_t string_bound)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
       fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(),
-      fastrtps_impl->type_factory_->create_string_type(fastrtps__size_t_to_uint32_t(string_bound)),
+      fastrtps__type_cache_get_string_type(
+        &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
+        fastrtps__size_t_to_uint32_t(string_bound)),
       std::string(default_value, default_value_length).c_str()),
     "Could not add string member"
   );
@@ -425,13 +580,16 @@ fastrtps__dynamic_type_builder_add_bounded_wstring_member(
   const char * default_value, size_t default_value_length,
   size_t wstring_bound)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
       fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(),
-      fastrtps_impl->type_factory_->create_wstring_type(
+      fastrtps__type_cache_get_wstring_type(
+        &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
         fastrtps__size_t_to_uint32_t(wstring_bound)),
       std::string(default_value, default_value_length).c_str()),
     "Could not add wstring member"
@@ -440,7 +598,7 @@ fastrtps__dynamic_type_builder_add_bounded_wstring_member(
 
 
 // DYNAMIC TYPE STATIC ARRAY MEMBERS ===============================================================
-#define FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(FunctionT, MemberT) \
+#define FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(FunctionT, MemberT, KindT) \
   rcutils_ret_t \
   fastrtps__dynamic_type_builder_add_ ## FunctionT ## _array_member( \
     rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl, \
@@ -450,36 +608,41 @@ fastrtps__dynamic_type_builder_add_bounded_wstring_member(
     const char * default_value, size_t default_value_length, \
     size_t array_length) \
   { \
+    FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD); \
+    FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length); \
     auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>( \
       serialization_support_impl->handle); \
  \
     FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG( \
       static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member( \
         fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(), \
-        fastrtps_impl->type_factory_->create_array_builder( \
-          fastrtps_impl->type_factory_->create_ ## MemberT ## _type(), \
-          {fastrtps__size_t_to_uint32_t(array_length)}), \
+        fastrtps__type_cache_get_array_type( \
+          &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, \
+          fastrtps__type_cache_get_primitive_type( \
+            &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, \
+            eprosima::fastrtps::types::KindT), \
+          fastrtps__size_t_to_uint32_t(array_length)), \
         std::string(default_value, default_value_length).c_str()), \
       "Could not add `" #MemberT "` array member to type builder" \
     ); \
   }
 
 
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(bool, bool)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(byte, byte)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(char, char8)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(wchar, char16)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(float32, float32)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(float64, float64)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(float128, float128)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(int8, byte)  // NOTE!!
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(uint8, byte)  // NOTE!!
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(int16, int16)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(uint16, uint16)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(int32, int32)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(uint32, uint32)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(int64, int64)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(uint64, uint64)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(bool, bool, TK_BOOLEAN)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(byte, byte, TK_BYTE)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(char, char8, TK_CHAR8)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(wchar, char16, TK_CHAR16)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(float32, float32, TK_FLOAT32)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(float64, float64, TK_FLOAT64)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(float128, float128, TK_FLOAT128)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(int8, byte, TK_BYTE)  // NOTE!!
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(uint8, byte, TK_BYTE)  // NOTE!!
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(int16, int16, TK_INT16)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(uint16, uint16, TK_UINT16)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(int32, int32, TK_INT32)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(uint32, uint32, TK_UINT32)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(int64, int64, TK_INT64)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN(uint64, uint64, TK_UINT64)
 #undef FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_ARRAY_MEMBER_FN
 
 
@@ -561,16 +724,20 @@ fastrtps__dynamic_type_builder_add_bounded_string_array_member(
   size_t string_bound,
   size_t array_length)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
       fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(),
-      fastrtps_impl->type_factory_->create_array_builder(
-        fastrtps_impl->type_factory_->create_string_type(
+      fastrtps__type_cache_get_array_type(
+        &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
+        fastrtps__type_cache_get_string_type(
+          &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
           fastrtps__size_t_to_uint32_t(string_bound)),
-        {fastrtps__size_t_to_uint32_t(array_length)}),
+        fastrtps__size_t_to_uint32_t(array_length)),
       std::string(default_value, default_value_length).c_str()),
     "Could not add bounded `string` array member to type builder"
   );
@@ -587,16 +754,20 @@ fastrtps__dynamic_type_builder_add_bounded_wstring_array_member(
   size_t wstring_bound,
   size_t array_length)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
       fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(),
-      fastrtps_impl->type_factory_->create_array_builder(
-        fastrtps_impl->type_factory_->create_wstring_type(
+      fastrtps__type_cache_get_array_type(
+        &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
+        fastrtps__type_cache_get_wstring_type(
+          &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
           fastrtps__size_t_to_uint32_t(wstring_bound)),
-        {fastrtps__size_t_to_uint32_t(array_length)}),
+        fastrtps__size_t_to_uint32_t(array_length)),
       std::string(default_value, default_value_length).c_str()),
     "Could not add bounded `wstring` array member to type builder"
   );
@@ -713,7 +884,7 @@ fastrtps__dynamic_type_builder_add_bounded_wstring_unbounded_sequence_member(
 
 
 // DYNAMIC TYPE BOUNDED SEQUENCE MEMBERS ===========================================================
-#define FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(FunctionT, MemberT) \
+#define FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(FunctionT, MemberT, KindT) \
   rcutils_ret_t \
   fastrtps__dynamic_type_builder_add_ ## FunctionT ## _bounded_sequence_member( \
     rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl, \
@@ -723,14 +894,19 @@ fastrtps__dynamic_type_builder_add_bounded_wstring_unbounded_sequence_member(
     const char * default_value, size_t default_value_length, \
     size_t sequence_bound) \
   { \
+    FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD); \
+    FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length); \
     auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>( \
       serialization_support_impl->handle); \
  \
     FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG( \
       static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member( \
         fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(), \
-        fastrtps_impl->type_factory_->create_sequence_builder( \
-          fastrtps_impl->type_factory_->create_ ## MemberT ## _type(), \
+        fastrtps__type_cache_get_sequence_type( \
+          &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, \
+          fastrtps__type_cache_get_primitive_type( \
+            &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, \
+            eprosima::fastrtps::types::KindT), \
           fastrtps__size_t_to_uint32_t(sequence_bound)), \
         std::string(default_value, default_value_length).c_str()), \
       "Could not add `" #MemberT "` bounded sequence member to type builder" \
@@ -738,21 +914,21 @@ fastrtps__dynamic_type_builder_add_bounded_wstring_unbounded_sequence_member(
   }
 
 
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(bool, bool)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(byte, byte)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(char, char8)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(wchar, char16)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(float32, float32)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(float64, float64)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(float128, float128)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(int8, byte)  // NOTE!!
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(uint8, byte)  // NOTE!!
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(int16, int16)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(uint16, uint16)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(int32, int32)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(uint32, uint32)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(int64, int64)
-FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(uint64, uint64)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(bool, bool, TK_BOOLEAN)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(byte, byte, TK_BYTE)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(char, char8, TK_CHAR8)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(wchar, char16, TK_CHAR16)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(float32, float32, TK_FLOAT32)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(float64, float64, TK_FLOAT64)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(float128, float128, TK_FLOAT128)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(int8, byte, TK_BYTE)  // NOTE!!
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(uint8, byte, TK_BYTE)  // NOTE!!
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(int16, int16, TK_INT16)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(uint16, uint16, TK_UINT16)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(int32, int32, TK_INT32)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(uint32, uint32, TK_UINT32)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(int64, int64, TK_INT64)
+FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN(uint64, uint64, TK_UINT64)
 #undef FASTRTPS_DYNAMIC_TYPE_BUILDER_ADD_BOUNDED_SEQUENCE_MEMBER_FN
 
 
@@ -832,14 +1008,18 @@ fastrtps__dynamic_type_builder_add_bounded_string_bounded_sequence_member(
   size_t string_bound,
   size_t sequence_bound)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
       fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(),
-      fastrtps_impl->type_factory_->create_sequence_builder(
-        fastrtps_impl->type_factory_->create_string_type(
+      fastrtps__type_cache_get_sequence_type(
+        &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
+        fastrtps__type_cache_get_string_type(
+          &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
           fastrtps__size_t_to_uint32_t(string_bound)),
         fastrtps__size_t_to_uint32_t(sequence_bound)),
       std::string(default_value, default_value_length).c_str()),
@@ -858,14 +1038,18 @@ fastrtps__dynamic_type_builder_add_bounded_wstring_bounded_sequence_member(
   size_t wstring_bound,
   size_t sequence_bound)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
       fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(),
-      fastrtps_impl->type_factory_->create_sequence_builder(
-        fastrtps_impl->type_factory_->create_wstring_type(
+      fastrtps__type_cache_get_sequence_type(
+        &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
+        fastrtps__type_cache_get_wstring_type(
+          &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
           fastrtps__size_t_to_uint32_t(wstring_bound)),
         fastrtps__size_t_to_uint32_t(sequence_bound)),
       std::string(default_value, default_value_length).c_str()),
@@ -884,10 +1068,28 @@ fastrtps__dynamic_type_builder_add_complex_member(
   const char * default_value, size_t default_value_length,
   rosidl_dynamic_typesupport_dynamic_type_impl_t * nested_struct)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  auto nested_struct_handle = static_cast<fastrtps__dynamic_type_handle_t *>(nested_struct->handle);
+
+  // A nested type that was built lazily and not used yet stays unbuilt
+  auto nested_lazy = fastrtps__dynamic_type_handle_get_lazy(nested_struct_handle);
+  if (nested_lazy) {
+    return fastrtps__lazy_builder_registry_add_lazy_member(
+      &fastrtps_impl->lazy_builders_, static_cast<DynamicTypeBuilder *>(type_builder_impl->handle),
+      fastrtps__size_t_to_uint32_t(id), std::string(name, name_length),
+      std::string(default_value, default_value_length),
+      std::move(nested_lazy), eprosima::fastrtps::types::TK_NONE, 0);
+  }
 
-  auto nested_struct_dynamictype_ptr = DynamicType_ptr(
-    *static_cast<DynamicType_ptr *>(nested_struct->handle));
+  auto nested_struct_dynamictype_ptr = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, nested_struct_handle);
+  if (!nested_struct_dynamictype_ptr) {
+    RCUTILS_SET_ERROR_MSG("Could not build lazy nested type");
+    return RCUTILS_RET_ERROR;
+  }
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
@@ -909,17 +1111,36 @@ fastrtps__dynamic_type_builder_add_complex_array_member(
   rosidl_dynamic_typesupport_dynamic_type_impl_t * nested_struct,
   size_t array_length)
 {
-  auto nested_struct_dynamictype_ptr = DynamicType_ptr(
-    *static_cast<DynamicType_ptr *>(nested_struct->handle));
-
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
+  auto nested_struct_handle = static_cast<fastrtps__dynamic_type_handle_t *>(nested_struct->handle);
+
+  // A nested type that was built lazily and not used yet stays unbuilt
+  auto nested_lazy = fastrtps__dynamic_type_handle_get_lazy(nested_struct_handle);
+  if (nested_lazy) {
+    return fastrtps__lazy_builder_registry_add_lazy_member(
+      &fastrtps_impl->lazy_builders_, static_cast<DynamicTypeBuilder *>(type_builder_impl->handle),
+      fastrtps__size_t_to_uint32_t(id), std::string(name, name_length),
+      std::string(default_value, default_value_length),
+      std::move(nested_lazy),
+      eprosima::fastrtps::types::TK_ARRAY, fastrtps__size_t_to_uint32_t(array_length));
+  }
+
+  auto nested_struct_dynamictype_ptr = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, nested_struct_handle);
+  if (!nested_struct_dynamictype_ptr) {
+    RCUTILS_SET_ERROR_MSG("Could not build lazy nested type");
+    return RCUTILS_RET_ERROR;
+  }
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
       fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(),
-      fastrtps_impl->type_factory_->create_array_builder(
-        nested_struct_dynamictype_ptr, {fastrtps__size_t_to_uint32_t(array_length)}),
+      fastrtps__type_cache_get_array_type(
+        &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
+        nested_struct_dynamictype_ptr, fastrtps__size_t_to_uint32_t(array_length)),
       std::string(default_value, default_value_length).c_str()),
     "Could not add complex array member to type builder"
   );
@@ -952,16 +1173,35 @@ fastrtps__dynamic_type_builder_add_complex_bounded_sequence_member(
   rosidl_dynamic_typesupport_dynamic_type_impl_t * nested_struct,
   size_t sequence_bound)
 {
-  auto nested_struct_dynamictype_ptr = DynamicType_ptr(
-    *static_cast<DynamicType_ptr *>(nested_struct->handle));
-
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
+  auto nested_struct_handle = static_cast<fastrtps__dynamic_type_handle_t *>(nested_struct->handle);
+
+  // A nested type that was built lazily and not used yet stays unbuilt
+  auto nested_lazy = fastrtps__dynamic_type_handle_get_lazy(nested_struct_handle);
+  if (nested_lazy) {
+    return fastrtps__lazy_builder_registry_add_lazy_member(
+      &fastrtps_impl->lazy_builders_, static_cast<DynamicTypeBuilder *>(type_builder_impl->handle),
+      fastrtps__size_t_to_uint32_t(id), std::string(name, name_length),
+      std::string(default_value, default_value_length),
+      std::move(nested_lazy),
+      eprosima::fastrtps::types::TK_SEQUENCE, fastrtps__size_t_to_uint32_t(sequence_bound));
+  }
+
+  auto nested_struct_dynamictype_ptr = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, nested_struct_handle);
+  if (!nested_struct_dynamictype_ptr) {
+    RCUTILS_SET_ERROR_MSG("Could not build lazy nested type");
+    return RCUTILS_RET_ERROR;
+  }
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
       fastrtps__size_t_to_uint32_t(id), std::string(name, name_length).c_str(),
-      fastrtps_impl->type_factory_->create_sequence_builder(
+      fastrtps__type_cache_get_sequence_type(
+        &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_,
         nested_struct_dynamictype_ptr, fastrtps__size_t_to_uint32_t(sequence_bound)),
       std::string(default_value, default_value_length).c_str()),
     "Could not add complex bounded sequence member to type builder"
@@ -978,7 +1218,19 @@ fastrtps__dynamic_type_builder_add_complex_member_builder(
   const char * default_value, size_t default_value_length,
   rosidl_dynamic_typesupport_dynamic_type_builder_impl_t * nested_struct_builder)
 {
-  (void) serialization_support_impl;
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  if (fastrtps_impl->lazy_nested_types_.load(std::memory_order_relaxed)) {
+    return fastrtps__lazy_builder_registry_add_member(
+      &fastrtps_impl->lazy_builders_, fastrtps_impl->type_factory_,
+      static_cast<DynamicTypeBuilder *>(type_builder_impl->handle),
+      fastrtps__size_t_to_uint32_t(id), std::string(name, name_length),
+      std::string(default_value, default_value_length),
+      static_cast<DynamicTypeBuilder *>(nested_struct_builder->handle),
+      eprosima::fastrtps::types::TK_NONE, 0);
+  }
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
@@ -1000,8 +1252,19 @@ fastrtps__dynamic_type_builder_add_complex_array_member_builder(
   rosidl_dynamic_typesupport_dynamic_type_builder_impl_t * nested_struct_builder,
   size_t array_length)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
+  if (fastrtps_impl->lazy_nested_types_.load(std::memory_order_relaxed)) {
+    return fastrtps__lazy_builder_registry_add_member(
+      &fastrtps_impl->lazy_builders_, fastrtps_impl->type_factory_,
+      static_cast<DynamicTypeBuilder *>(type_builder_impl->handle),
+      fastrtps__size_t_to_uint32_t(id), std::string(name, name_length),
+      std::string(default_value, default_value_length),
+      static_cast<DynamicTypeBuilder *>(nested_struct_builder->handle),
+      eprosima::fastrtps::types::TK_ARRAY, fastrtps__size_t_to_uint32_t(array_length));
+  }
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
@@ -1042,8 +1305,19 @@ fastrtps__dynamic_type_builder_add_complex_bounded_sequence_member_builder(
   rosidl_dynamic_typesupport_dynamic_type_builder_impl_t * nested_struct_builder,
   size_t sequence_bound)
 {
+  FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, TYPE_BUILD);
+  FASTRTPS_TRACE_ADD_MEMBER(type_builder_impl, id, name, name_length);
   auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
+  if (fastrtps_impl->lazy_nested_types_.load(std::memory_order_relaxed)) {
+    return fastrtps__lazy_builder_registry_add_member(
+      &fastrtps_impl->lazy_builders_, fastrtps_impl->type_factory_,
+      static_cast<DynamicTypeBuilder *>(type_builder_impl->handle),
+      fastrtps__size_t_to_uint32_t(id), std::string(name, name_length),
+      std::string(default_value, default_value_length),
+      static_cast<DynamicTypeBuilder *>(nested_struct_builder->handle),
+      eprosima::fastrtps::types::TK_SEQUENCE, fastrtps__size_t_to_uint32_t(sequence_bound));
+  }
 
   FASTRTPS_CHECK_RET_FOR_NOT_OK_AND_RETURN_WITH_MSG(
     static_cast<DynamicTypeBuilder *>(type_builder_impl->handle)->add_member(
@@ -1055,3 +1329,5 @@ fastrtps__dynamic_type_builder_add_complex_bounded_sequence_member_builder(
     "Could not add complex bounded sequence member to type builder"
   );
 }
+
+#undef FASTRTPS_TRACE_ADD_MEMBER
@@ -15,16 +15,85 @@
 #ifndef DETAIL__FASTRTPS_DYNAMIC_TYPE_HPP_
 #define DETAIL__FASTRTPS_DYNAMIC_TYPE_HPP_
 
+#include <fastrtps/types/DynamicTypePtr.h>
+
 #include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
 #include <rosidl_dynamic_typesupport/api/serialization_support_interface.h>
 
 #include <rcutils/allocator.h>
 #include <rcutils/types/rcutils_ret.h>
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "fastrtps_lazy_type.hpp"
+#include "fastrtps_serialization_support.hpp"
+#include "fastrtps_type_fingerprint.hpp"
+
 // =================================================================================================
 // DYNAMIC TYPE
 // =================================================================================================
 
+/// What rosidl_dynamic_typesupport_dynamic_type_impl_t::handle points to
+/**
+ * The built type is shared (data created from it keeps its own reference), so the handle only
+ * owns one reference to it.
+ * The fingerprint is computed once when the type is built, so that comparing types is cheap.
+ *
+ * Built types are immutable, so clones share the same handle: cloning bumps `ref_count_`, and the
+ * handle is deleted when the last type impl referring to it is finalized.
+ *
+ * Types built in lazy mode start out with only `lazy_` set; `type_` and `fingerprint_` are filled
+ * in on first use. Always go through fastrtps__dynamic_type_handle_get_type to read `type_`.
+ *
+ * Whether the type is flat (see fastrtps_data_pool.hpp) is only worked out when it is first asked
+ * for, through fastrtps__dynamic_type_handle_is_flat.
+ */
+typedef enum fastrtps__type_flatness_e
+{
+  FASTRTPS_TYPE_FLATNESS_UNKNOWN,
+  FASTRTPS_TYPE_FLATNESS_FLAT,
+  FASTRTPS_TYPE_FLATNESS_NOT_FLAT,
+} fastrtps__type_flatness_t;
+
+typedef struct fastrtps__dynamic_type_handle_s
+{
+  eprosima::fastrtps::types::DynamicType_ptr type_;
+  fastrtps__type_fingerprint_t fingerprint_;
+  std::atomic<uint32_t> ref_count_{1};
+  std::atomic<fastrtps__type_flatness_t> flatness_{FASTRTPS_TYPE_FLATNESS_UNKNOWN};
+
+  std::shared_ptr<fastrtps__lazy_struct_t> lazy_;
+  std::atomic<bool> materialized_{true};
+  std::mutex lazy_mutex_;
+} fastrtps__dynamic_type_handle_t;
+
+
+/// Get the type behind `type_handle`, building it first if it was built in lazy mode
+/// Returns an empty type if it could not be built
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+const eprosima::fastrtps::types::DynamicType_ptr &
+fastrtps__dynamic_type_handle_get_type(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl,
+  fastrtps__dynamic_type_handle_t * type_handle);
+
+/// Whether the type behind `type_handle` is flat, building it first if it was built in lazy mode
+/// Returns false if it could not be built
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__dynamic_type_handle_is_flat(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl,
+  fastrtps__dynamic_type_handle_t * type_handle);
+
+/// Lazy types know their name before they are built, so getting it does not build them
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+std::string
+fastrtps__dynamic_type_handle_get_name(fastrtps__dynamic_type_handle_t * type_handle);
+
+
 // DYNAMIC TYPE UTILS =======================================================================
 ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
 rcutils_ret_t
@@ -0,0 +1,321 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastrtps_footprint.hpp"
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicPubSubType.h>
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypeMember.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypeDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+
+using eprosima::fastrtps::types::DynamicData;
+using eprosima::fastrtps::types::DynamicType;
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::DynamicTypeMember;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::ReturnCode_t;
+using eprosima::fastrtps::types::TypeDescriptor;
+using eprosima::fastrtps::types::TypeKind;
+
+
+// =================================================================================================
+// FOOTPRINT
+// =================================================================================================
+
+// HEAP MODEL ======================================================================================
+// Heap block taken by a `size` byte allocation: glibc malloc chunks are 16 byte aligned, carry an
+// 8 byte header, and are at least 32 bytes
+static size_t
+fastrtps__footprint_block(size_t size)
+{
+  size_t chunk = (size + 8 + 15) & ~static_cast<size_t>(15);
+  return chunk < 32 ? 32 : chunk;
+}
+
+// std::map node: color (padded to a pointer) and three links, then the value
+static size_t
+fastrtps__footprint_map_node(size_t value_size)
+{
+  return fastrtps__footprint_block(4 * sizeof(void *) + value_size);
+}
+
+// Heap block of a std::basic_string of `length` characters, none while it fits in the 16 byte
+// inline buffer
+static size_t
+fastrtps__footprint_string(size_t length, size_t char_size)
+{
+  if ((length + 1) * char_size <= 16) {
+    return 0;
+  }
+  return fastrtps__footprint_block((length + 1) * char_size);
+}
+
+// Node of the member id to value map every dynamic data holds its values in
+static size_t
+fastrtps__footprint_value_node()
+{
+  return fastrtps__footprint_map_node(sizeof(std::pair<const MemberId, void *>));
+}
+
+// What fastrtps allocates for a primitive value of `kind`, 0 if `kind` is not primitive
+static size_t
+fastrtps__footprint_primitive_size(TypeKind kind)
+{
+  switch (kind) {
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+      return sizeof(bool);
+    case eprosima::fastrtps::types::TK_BYTE:
+      return sizeof(eprosima::fastrtps::types::octet);
+    case eprosima::fastrtps::types::TK_CHAR8:
+      return sizeof(char);
+    case eprosima::fastrtps::types::TK_CHAR16:
+      return sizeof(wchar_t);
+    case eprosima::fastrtps::types::TK_INT16:
+      return sizeof(int16_t);
+    case eprosima::fastrtps::types::TK_UINT16:
+      return sizeof(uint16_t);
+    case eprosima::fastrtps::types::TK_INT32:
+      return sizeof(int32_t);
+    case eprosima::fastrtps::types::TK_UINT32:
+      return sizeof(uint32_t);
+    case eprosima::fastrtps::types::TK_INT64:
+      return sizeof(int64_t);
+    case eprosima::fastrtps::types::TK_UINT64:
+      return sizeof(uint64_t);
+    case eprosima::fastrtps::types::TK_FLOAT32:
+      return sizeof(float);
+    case eprosima::fastrtps::types::TK_FLOAT64:
+      return sizeof(double);
+    case eprosima::fastrtps::types::TK_FLOAT128:
+      return sizeof(long double);
+    default:
+      return 0;
+  }
+}
+
+
+// DATA ============================================================================================
+static size_t
+fastrtps__footprint_data(DynamicData * data);
+
+// Nested dynamic data held by `data` under `id`, 0 if it cannot be loaned
+static size_t
+fastrtps__footprint_data_nested(DynamicData * data, MemberId id)
+{
+  DynamicData * nested = data->loan_value(id);
+  if (!nested) {
+    return 0;
+  }
+  size_t bytes = fastrtps__footprint_value_node() + fastrtps__footprint_data(nested);
+  data->return_loaned_value(nested);
+  return bytes;
+}
+
+// Value of `kind` held by `data` under `id`
+static size_t
+fastrtps__footprint_data_value(DynamicData * data, MemberId id, TypeKind kind)
+{
+  size_t primitive_size = fastrtps__footprint_primitive_size(kind);
+  if (primitive_size) {
+    return fastrtps__footprint_value_node() + fastrtps__footprint_block(primitive_size);
+  }
+
+  switch (kind) {
+    case eprosima::fastrtps::types::TK_STRING8:
+      {
+        std::string value;
+        data->get_string_value(value, id);
+        return fastrtps__footprint_value_node() + fastrtps__footprint_block(sizeof(value)) +
+               fastrtps__footprint_string(value.size(), sizeof(char));
+      }
+    case eprosima::fastrtps::types::TK_STRING16:
+      {
+        std::wstring value;
+        data->get_wstring_value(value, id);
+        return fastrtps__footprint_value_node() + fastrtps__footprint_block(sizeof(value)) +
+               fastrtps__footprint_string(value.size(), sizeof(wchar_t));
+      }
+    default:
+      return fastrtps__footprint_data_nested(data, id);
+  }
+}
+
+// Struct member `id` of `data`: its descriptor copy and its value
+static size_t
+fastrtps__footprint_data_member(DynamicData * data, MemberId id, std::string * name)
+{
+  MemberDescriptor descriptor;
+  if (data->get_descriptor(descriptor, id) != ReturnCode_t::RETCODE_OK) {
+    return 0;
+  }
+  if (name) {
+    *name = descriptor.get_name();
+  }
+  return fastrtps__footprint_map_node(sizeof(std::pair<const MemberId, MemberDescriptor *>)) +
+         fastrtps__footprint_block(sizeof(MemberDescriptor)) +
+         fastrtps__footprint_string(descriptor.get_name().size(), sizeof(char)) +
+         fastrtps__footprint_string(descriptor.get_default_value().size(), sizeof(char)) +
+         fastrtps__footprint_data_value(data, id, descriptor.get_kind());
+}
+
+static size_t
+fastrtps__footprint_data(DynamicData * data)
+{
+  size_t bytes = fastrtps__footprint_block(sizeof(DynamicData));
+  uint32_t item_count = data->get_item_count();
+
+  switch (data->get_kind()) {
+    case eprosima::fastrtps::types::TK_STRUCTURE:
+      for (uint32_t index = 0; index < item_count; ++index) {
+        bytes += fastrtps__footprint_data_member(
+          data, data->get_member_id_at_index(index), nullptr);
+      }
+      break;
+    // Every element is a dynamic data of its own, unset array elements are not allocated
+    case eprosima::fastrtps::types::TK_ARRAY:
+    case eprosima::fastrtps::types::TK_SEQUENCE:
+      for (uint32_t index = 0; index < item_count; ++index) {
+        bytes += fastrtps__footprint_data_nested(data, index);
+      }
+      break;
+    default:
+      bytes += fastrtps__footprint_data_value(
+        data, eprosima::fastrtps::types::MEMBER_ID_INVALID, data->get_kind());
+      break;
+  }
+  return bytes;
+}
+
+
+void
+fastrtps__dynamic_data_footprint(DynamicData * data, fastrtps__footprint_t * footprint)
+{
+  footprint->members_.clear();
+  footprint->heap_bytes_ = fastrtps__footprint_block(sizeof(DynamicData));
+
+  if (data->get_kind() == eprosima::fastrtps::types::TK_STRUCTURE) {
+    uint32_t item_count = data->get_item_count();
+    footprint->members_.reserve(item_count);
+    for (uint32_t index = 0; index < item_count; ++index) {
+      fastrtps__member_footprint_t member;
+      member.heap_bytes_ = fastrtps__footprint_data_member(
+        data, data->get_member_id_at_index(index), &member.name_);
+      footprint->heap_bytes_ += member.heap_bytes_;
+      footprint->members_.push_back(std::move(member));
+    }
+  } else {
+    footprint->heap_bytes_ = fastrtps__footprint_data(data);
+  }
+
+  eprosima::fastrtps::types::DynamicPubSubType pub_sub_type;
+  footprint->serialized_bytes_ = pub_sub_type.getSerializedSizeProvider(data)();
+}
+
+
+// TYPES ===========================================================================================
+using fastrtps__footprint_seen_types_t = std::unordered_set<const DynamicType *>;
+
+static size_t
+fastrtps__footprint_type(const DynamicType_ptr & type, fastrtps__footprint_seen_types_t & seen);
+
+// Member entry of a type: the member object, its nodes in the by id and by name maps, its name
+// (as a key and in its descriptor), and its type
+static size_t
+fastrtps__footprint_type_member(
+  const DynamicTypeMember * member, std::string * name, fastrtps__footprint_seen_types_t & seen)
+{
+  MemberDescriptor descriptor;
+  member->get_descriptor(&descriptor);
+  if (name) {
+    *name = descriptor.get_name();
+  }
+  return fastrtps__footprint_block(sizeof(DynamicTypeMember)) +
+         fastrtps__footprint_map_node(sizeof(std::pair<const MemberId, DynamicTypeMember *>)) +
+         fastrtps__footprint_map_node(sizeof(std::pair<const std::string, DynamicTypeMember *>)) +
+         2 * fastrtps__footprint_string(descriptor.get_name().size(), sizeof(char)) +
+         fastrtps__footprint_string(descriptor.get_default_value().size(), sizeof(char)) +
+         fastrtps__footprint_type(descriptor.get_type(), seen);
+}
+
+// The type object and its descriptor, and the types the descriptor refers to
+static size_t
+fastrtps__footprint_type_without_members(
+  const DynamicType_ptr & type, fastrtps__footprint_seen_types_t & seen)
+{
+  TypeDescriptor descriptor;
+  type->get_descriptor(&descriptor);
+  size_t bytes = fastrtps__footprint_block(sizeof(DynamicType)) +
+    fastrtps__footprint_block(sizeof(TypeDescriptor)) +
+    2 * fastrtps__footprint_string(descriptor.get_name().size(), sizeof(char));
+  if (descriptor.get_bounds_size() > 0) {
+    bytes += fastrtps__footprint_block(descriptor.get_bounds_size() * sizeof(uint32_t));
+  }
+  bytes += fastrtps__footprint_type(descriptor.get_base_type(), seen);
+  bytes += fastrtps__footprint_type(descriptor.get_element_type(), seen);
+  bytes += fastrtps__footprint_type(descriptor.get_key_element_type(), seen);
+  return bytes;
+}
+
+// Everything, unless `type` was already counted
+static size_t
+fastrtps__footprint_type(const DynamicType_ptr & type, fastrtps__footprint_seen_types_t & seen)
+{
+  if (!type || !seen.insert(type.get()).second) {
+    return 0;
+  }
+  size_t bytes = fastrtps__footprint_type_without_members(type, seen);
+
+  std::map<MemberId, DynamicTypeMember *> members;
+  type->get_all_members(members);
+  for (const auto & it : members) {
+    bytes += fastrtps__footprint_type_member(it.second, nullptr, seen);
+  }
+  return bytes;
+}
+
+
+void
+fastrtps__dynamic_type_footprint(const DynamicType_ptr & type, fastrtps__footprint_t * footprint)
+{
+  footprint->members_.clear();
+  footprint->serialized_bytes_ = 0;
+
+  fastrtps__footprint_seen_types_t seen;
+  seen.insert(type.get());
+  footprint->heap_bytes_ = fastrtps__footprint_type_without_members(type, seen);
+
+  std::map<MemberId, DynamicTypeMember *> members;
+  type->get_all_members(members);
+  footprint->members_.reserve(members.size());
+  for (const auto & it : members) {
+    fastrtps__member_footprint_t member;
+    member.heap_bytes_ = fastrtps__footprint_type_member(it.second, &member.name_, seen);
+    footprint->heap_bytes_ += member.heap_bytes_;
+    footprint->members_.push_back(std::move(member));
+  }
+}
@@ -0,0 +1,63 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DETAIL__FASTRTPS_FOOTPRINT_HPP_
+#define DETAIL__FASTRTPS_FOOTPRINT_HPP_
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+// =================================================================================================
+// FOOTPRINT
+// =================================================================================================
+//
+// See rosidl_dynamic_typesupport_fastrtps/footprint.h for the model and what it leaves out.
+
+typedef struct fastrtps__member_footprint_s
+{
+  std::string name_;
+  size_t heap_bytes_;
+} fastrtps__member_footprint_t;
+
+typedef struct fastrtps__footprint_s
+{
+  size_t heap_bytes_;
+  size_t serialized_bytes_;
+  std::vector<fastrtps__member_footprint_t> members_;
+} fastrtps__footprint_t;
+
+
+/// Values of members loaned out elsewhere are skipped, the others are loaned for a moment
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__dynamic_data_footprint(
+  eprosima::fastrtps::types::DynamicData * data,
+  fastrtps__footprint_t * footprint);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__dynamic_type_footprint(
+  const eprosima::fastrtps::types::DynamicType_ptr & type,
+  fastrtps__footprint_t * footprint);  // OUT
+
+
+#endif  // DETAIL__FASTRTPS_FOOTPRINT_HPP_
@@ -0,0 +1,363 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastrtps_latency_histogram.hpp"
+
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+
+
+// =================================================================================================
+// LATENCY HISTOGRAMS
+// =================================================================================================
+
+// Index of the highest set bit, `value` must not be 0
+static int
+fastrtps__latency_histogram_highest_bit(uint64_t value)
+{
+  int out = 0;
+  for (int shift = 32; shift > 0; shift /= 2) {
+    if (value >> shift) {
+      value >>= shift;
+      out += shift;
+    }
+  }
+  return out;
+}
+
+
+size_t
+fastrtps__latency_histogram_bucket_index(uint64_t ns)
+{
+  if (ns < FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+    return static_cast<size_t>(ns);
+  }
+  if (ns >> FASTRTPS_LATENCY_HISTOGRAM_MAX_BITS) {
+    return FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT - 1;
+  }
+  // The top SUB_BUCKET_BITS + 1 bits pick the bucket, the rest is within it
+  int shift =
+    fastrtps__latency_histogram_highest_bit(ns) - FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+  return static_cast<size_t>(shift + 1) * FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT +
+         static_cast<size_t>((ns >> shift) - FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT);
+}
+
+
+uint64_t
+fastrtps__latency_histogram_bucket_lowest(size_t index)
+{
+  if (index < FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+    return index;
+  }
+  size_t shift = index / FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1;
+  uint64_t sub_bucket = index % FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+  return (FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + sub_bucket) << shift;
+}
+
+
+uint64_t
+fastrtps__latency_histogram_bucket_highest(size_t index)
+{
+  if (index + 1 >= FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT) {
+    return UINT64_MAX;
+  }
+  return fastrtps__latency_histogram_bucket_lowest(index + 1) - 1;
+}
+
+
+// Threads are handed out shards round robin, the first time they record anything
+static std::atomic<size_t> fastrtps__latency_next_shard{0};
+
+static size_t
+fastrtps__latency_thread_shard()
+{
+  static thread_local size_t shard = fastrtps__latency_next_shard.fetch_add(
+    1, std::memory_order_relaxed) % FASTRTPS_LATENCY_HISTOGRAM_SHARD_COUNT;
+  return shard;
+}
+
+
+void
+fastrtps__latency_histogram_record(fastrtps__latency_histogram_t * histogram, uint64_t ns)
+{
+  fastrtps__latency_shard_t & shard = histogram->shards_[fastrtps__latency_thread_shard()];
+  shard.buckets_[fastrtps__latency_histogram_bucket_index(ns)].fetch_add(
+    1, std::memory_order_relaxed);
+  shard.sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+
+  uint64_t max_ns = shard.max_ns_.load(std::memory_order_relaxed);
+  while (ns > max_ns &&
+    !shard.max_ns_.compare_exchange_weak(max_ns, ns, std::memory_order_relaxed))
+  {
+  }
+}
+
+
+void
+fastrtps__latency_histogram_snapshot(
+  const fastrtps__latency_histogram_t * histogram,
+  fastrtps__latency_histogram_snapshot_t * snapshot)
+{
+  *snapshot = fastrtps__latency_histogram_snapshot_t{};
+  for (const auto & shard : histogram->shards_) {
+    for (size_t i = 0; i < FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+      uint64_t count = shard.buckets_[i].load(std::memory_order_relaxed);
+      snapshot->buckets_[i] += count;
+      snapshot->count_ += count;
+    }
+    snapshot->sum_ns_ += shard.sum_ns_.load(std::memory_order_relaxed);
+    uint64_t max_ns = shard.max_ns_.load(std::memory_order_relaxed);
+    if (max_ns > snapshot->max_ns_) {
+      snapshot->max_ns_ = max_ns;
+    }
+  }
+}
+
+
+uint64_t
+fastrtps__latency_histogram_snapshot_percentile(
+  const fastrtps__latency_histogram_snapshot_t * snapshot, double percentile)
+{
+  if (snapshot->count_ == 0) {
+    return 0;
+  }
+  if (percentile >= 100.0) {
+    return snapshot->max_ns_;
+  }
+
+  // Rank of the value at `percentile`, counting from 1
+  double rank = std::ceil(percentile / 100.0 * static_cast<double>(snapshot->count_));
+  uint64_t target = rank < 1.0 ? 1 : static_cast<uint64_t>(rank);
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+    seen += snapshot->buckets_[i];
+    if (seen >= target) {
+      // Nothing recorded is above the maximum, even when its bucket goes higher
+      uint64_t highest = fastrtps__latency_histogram_bucket_highest(i);
+      return highest < snapshot->max_ns_ ? highest : snapshot->max_ns_;
+    }
+  }
+  // Only when shards were recorded into while summing them up
+  return snapshot->max_ns_;
+}
+
+
+// TRACKING ========================================================================================
+rcutils_ret_t
+fastrtps__latency_tracking_set_enabled(fastrtps__latency_tracking_t * tracking, bool enabled)
+{
+  if (enabled && !tracking->histograms_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(tracking->mutex_);
+    if (!tracking->histograms_.load(std::memory_order_relaxed)) {
+      auto histograms = new (std::nothrow) fastrtps__latency_histogram_t[
+        ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_COUNT]();
+      if (!histograms) {
+        RCUTILS_SET_ERROR_MSG("Could not allocate latency histograms");
+        return RCUTILS_RET_BAD_ALLOC;
+      }
+      tracking->histograms_.store(histograms, std::memory_order_release);
+    }
+  }
+  tracking->enabled_.store(enabled, std::memory_order_relaxed);
+  return RCUTILS_RET_OK;
+}
+
+
+void
+fastrtps__latency_tracking_reset(fastrtps__latency_tracking_t * tracking)
+{
+  fastrtps__latency_histogram_t * histograms =
+    tracking->histograms_.load(std::memory_order_acquire);
+  if (!histograms) {
+    return;
+  }
+  for (int operation = 0; operation < ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_COUNT;
+    ++operation)
+  {
+    for (auto & shard : histograms[operation].shards_) {
+      for (auto & bucket : shard.buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+      shard.sum_ns_.store(0, std::memory_order_relaxed);
+      shard.max_ns_.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+
+void
+fastrtps__latency_tracking_snapshot(
+  fastrtps__latency_tracking_t * tracking,
+  rosidl_dynamic_typesupport_fastrtps_latency_operation_t operation,
+  fastrtps__latency_histogram_snapshot_t * snapshot)
+{
+  fastrtps__latency_histogram_t * histograms =
+    tracking->histograms_.load(std::memory_order_acquire);
+  if (!histograms) {
+    *snapshot = fastrtps__latency_histogram_snapshot_t{};
+    return;
+  }
+  fastrtps__latency_histogram_snapshot(&histograms[operation], snapshot);
+}
+
+
+void
+fastrtps__latency_tracking_clear(fastrtps__latency_tracking_t * tracking)
+{
+  tracking->enabled_.store(false, std::memory_order_relaxed);
+  delete[] tracking->histograms_.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+
+// DUMP ============================================================================================
+static const char *
+fastrtps__latency_operation_name(int operation)
+{
+  static const char * names[ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_COUNT] = {
+    "type_build",
+    "data_init",
+    "data_fini",
+    "clone",
+    "serialize",
+    "deserialize",
+  };
+  return names[operation];
+}
+
+// Percentiles in every dump, with how they are labelled in text and JSON
+static const struct
+{
+  double percentile;
+  const char * text_label;
+  const char * json_label;
+} fastrtps__latency_dump_percentiles[] = {
+  {50.0, "p50", "p50_ns"},
+  {90.0, "p90", "p90_ns"},
+  {99.0, "p99", "p99_ns"},
+  {99.9, "p99.9", "p999_ns"},
+};
+
+
+static void
+fastrtps__latency_dump_text(
+  const char * name, const fastrtps__latency_histogram_snapshot_t & snapshot, std::string & dump)
+{
+  dump += name;
+  dump += ": count=" + std::to_string(snapshot.count_);
+  if (snapshot.count_ == 0) {
+    dump += "\n";
+    return;
+  }
+  dump += " mean=" + std::to_string(snapshot.sum_ns_ / snapshot.count_) + "ns";
+  for (const auto & p : fastrtps__latency_dump_percentiles) {
+    dump += std::string(" ") + p.text_label + "=" +
+      std::to_string(fastrtps__latency_histogram_snapshot_percentile(&snapshot, p.percentile)) +
+      "ns";
+  }
+  dump += " max=" + std::to_string(snapshot.max_ns_) + "ns\n";
+
+  for (size_t i = 0; i < FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+    if (snapshot.buckets_[i] == 0) {
+      continue;
+    }
+    dump += "  [" + std::to_string(fastrtps__latency_histogram_bucket_lowest(i)) + ", ";
+    if (i + 1 < FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT) {
+      dump += std::to_string(fastrtps__latency_histogram_bucket_highest(i)) + "]ns ";
+    } else {
+      dump += "...)ns ";
+    }
+    dump += std::to_string(snapshot.buckets_[i]) + "\n";
+  }
+}
+
+
+static void
+fastrtps__latency_dump_json(
+  const char * name, const fastrtps__latency_histogram_snapshot_t & snapshot, std::string & dump)
+{
+  dump += std::string("\"") + name + "\":{\"count\":" + std::to_string(snapshot.count_);
+  dump += ",\"mean_ns\":" +
+    std::to_string(snapshot.count_ ? snapshot.sum_ns_ / snapshot.count_ : 0);
+  for (const auto & p : fastrtps__latency_dump_percentiles) {
+    dump += std::string(",\"") + p.json_label + "\":" +
+      std::to_string(fastrtps__latency_histogram_snapshot_percentile(&snapshot, p.percentile));
+  }
+  dump += ",\"max_ns\":" + std::to_string(snapshot.max_ns_) + ",\"buckets\":[";
+
+  bool first = true;
+  for (size_t i = 0; i < FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+    if (snapshot.buckets_[i] == 0) {
+      continue;
+    }
+    dump += first ? "[" : ",[";
+    dump += std::to_string(fastrtps__latency_histogram_bucket_lowest(i)) + "," +
+      std::to_string(snapshot.buckets_[i]) + "]";
+    first = false;
+  }
+  dump += "]}";
+}
+
+
+rcutils_ret_t
+fastrtps__latency_tracking_dump(
+  fastrtps__latency_tracking_t * tracking,
+  rosidl_dynamic_typesupport_fastrtps_latency_dump_format_t format,
+  std::string & dump)
+{
+  if (format != ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_DUMP_FORMAT_TEXT &&
+    format != ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_DUMP_FORMAT_JSON)
+  {
+    RCUTILS_SET_ERROR_MSG("Unknown latency dump format");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  bool json = format == ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_DUMP_FORMAT_JSON;
+
+  // A few KiB, kept off the stack
+  auto snapshot = std::make_unique<fastrtps__latency_histogram_snapshot_t>();
+
+  dump.clear();
+  if (json) {
+    dump += "{";
+  }
+  for (int operation = 0; operation < ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_COUNT;
+    ++operation)
+  {
+    fastrtps__latency_tracking_snapshot(
+      tracking, static_cast<rosidl_dynamic_typesupport_fastrtps_latency_operation_t>(operation),
+      snapshot.get());
+    if (json) {
+      if (operation > 0) {
+        dump += ",";
+      }
+      fastrtps__latency_dump_json(fastrtps__latency_operation_name(operation), *snapshot, dump);
+    } else {
+      fastrtps__latency_dump_text(fastrtps__latency_operation_name(operation), *snapshot, dump);
+    }
+  }
+  if (json) {
+    dump += "}\n";
+  }
+  return RCUTILS_RET_OK;
+}
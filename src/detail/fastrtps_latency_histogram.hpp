@@ -0,0 +1,187 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DETAIL__FASTRTPS_LATENCY_HISTOGRAM_HPP_
+#define DETAIL__FASTRTPS_LATENCY_HISTOGRAM_HPP_
+
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport_fastrtps/latency_histogram.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+
+// =================================================================================================
+// LATENCY HISTOGRAMS
+// =================================================================================================
+//
+// Log-linear buckets, HDR-style: values below 2^SUB_BUCKET_BITS get a bucket each, every power of
+// two above that is split into 2^SUB_BUCKET_BITS buckets. Values of 2^MAX_BITS ns or more go to the
+// last bucket.
+//
+// Each histogram is split into shards, each on its own cache lines. A thread always records into
+// the same shard, so with no more threads than shards recording never contends, and it never locks.
+// Shards are summed up when the histogram is read. Histograms are only allocated once enabled: the
+// cost while disabled is one relaxed load per operation.
+
+#define FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_BITS 4
+#define FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT \
+  (1 << FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+#define FASTRTPS_LATENCY_HISTOGRAM_MAX_BITS 36
+#define FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT \
+  ((FASTRTPS_LATENCY_HISTOGRAM_MAX_BITS - FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * \
+  FASTRTPS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+#define FASTRTPS_LATENCY_HISTOGRAM_SHARD_COUNT 8
+
+typedef struct alignas(64) fastrtps__latency_shard_s
+{
+  std::atomic<uint64_t> buckets_[FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT];
+  std::atomic<uint64_t> sum_ns_;
+  std::atomic<uint64_t> max_ns_;
+} fastrtps__latency_shard_t;
+
+typedef struct fastrtps__latency_histogram_s
+{
+  fastrtps__latency_shard_t shards_[FASTRTPS_LATENCY_HISTOGRAM_SHARD_COUNT];
+} fastrtps__latency_histogram_t;
+
+/// A histogram with its shards summed up
+typedef struct fastrtps__latency_histogram_snapshot_s
+{
+  uint64_t buckets_[FASTRTPS_LATENCY_HISTOGRAM_BUCKET_COUNT];
+  uint64_t count_;
+  uint64_t sum_ns_;
+  uint64_t max_ns_;
+} fastrtps__latency_histogram_snapshot_t;
+
+typedef struct fastrtps__latency_tracking_s
+{
+  std::atomic<bool> enabled_{false};
+
+  // One histogram per operation, allocated the first time tracking is enabled (under mutex_), then
+  // kept until fastrtps__latency_tracking_clear
+  std::mutex mutex_;
+  std::atomic<fastrtps__latency_histogram_t *> histograms_{nullptr};
+} fastrtps__latency_tracking_t;
+
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+size_t
+fastrtps__latency_histogram_bucket_index(uint64_t ns);
+
+/// Lowest value that goes to bucket `index`
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+uint64_t
+fastrtps__latency_histogram_bucket_lowest(size_t index);
+
+/// Highest value that goes to bucket `index`, UINT64_MAX for the last one
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+uint64_t
+fastrtps__latency_histogram_bucket_highest(size_t index);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__latency_histogram_record(fastrtps__latency_histogram_t * histogram, uint64_t ns);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__latency_histogram_snapshot(
+  const fastrtps__latency_histogram_t * histogram,
+  fastrtps__latency_histogram_snapshot_t * snapshot);  // OUT
+
+/// See rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_get_latency_percentile
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+uint64_t
+fastrtps__latency_histogram_snapshot_percentile(
+  const fastrtps__latency_histogram_snapshot_t * snapshot, double percentile);
+
+
+// TRACKING ========================================================================================
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__latency_tracking_set_enabled(fastrtps__latency_tracking_t * tracking, bool enabled);
+
+/// Empty every histogram, if there are any
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__latency_tracking_reset(fastrtps__latency_tracking_t * tracking);
+
+/// Get the summed up histogram of `operation`, empty if tracking was never enabled
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__latency_tracking_snapshot(
+  fastrtps__latency_tracking_t * tracking,
+  rosidl_dynamic_typesupport_fastrtps_latency_operation_t operation,
+  fastrtps__latency_histogram_snapshot_t * snapshot);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__latency_tracking_dump(
+  fastrtps__latency_tracking_t * tracking,
+  rosidl_dynamic_typesupport_fastrtps_latency_dump_format_t format,
+  std::string & dump);  // OUT
+
+/// Free the histograms, nothing may be recording anymore
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__latency_tracking_clear(fastrtps__latency_tracking_t * tracking);
+
+
+// SCOPES ==========================================================================================
+/// Records how long it lives into the histogram of `operation`, if tracking is enabled when it is
+/// created
+class fastrtps__latency_scope_t
+{
+public:
+  fastrtps__latency_scope_t(
+    fastrtps__latency_tracking_t * tracking,
+    rosidl_dynamic_typesupport_fastrtps_latency_operation_t operation)
+  : histogram_(nullptr)
+  {
+    if (tracking->enabled_.load(std::memory_order_relaxed)) {
+      fastrtps__latency_histogram_t * histograms =
+        tracking->histograms_.load(std::memory_order_acquire);
+      if (histograms) {
+        histogram_ = &histograms[operation];
+        start_ = std::chrono::steady_clock::now();
+      }
+    }
+  }
+
+  ~fastrtps__latency_scope_t()
+  {
+    if (histogram_) {
+      auto elapsed = std::chrono::steady_clock::now() - start_;
+      fastrtps__latency_histogram_record(
+        histogram_, static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+  }
+
+  fastrtps__latency_scope_t(const fastrtps__latency_scope_t &) = delete;
+  fastrtps__latency_scope_t & operator=(const fastrtps__latency_scope_t &) = delete;
+
+private:
+  fastrtps__latency_histogram_t * histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+
+#endif  // DETAIL__FASTRTPS_LATENCY_HISTOGRAM_HPP_
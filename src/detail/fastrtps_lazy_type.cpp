@@ -0,0 +1,291 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_lazy_type.hpp"
+
+#include <fastrtps/types/DynamicTypeBuilder.h>
+#include <fastrtps/types/DynamicTypeBuilderFactory.h>
+#include <fastrtps/types/DynamicTypeMember.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "fastrtps_type_cache.hpp"
+#include "utils.hpp"
+
+
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::DynamicTypeBuilder;
+using eprosima::fastrtps::types::DynamicTypeBuilderFactory;
+using eprosima::fastrtps::types::DynamicTypeMember;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::ReturnCode_t;
+using eprosima::fastrtps::types::TypeKind;
+
+
+// =================================================================================================
+// LAZY TYPES
+// =================================================================================================
+
+// Copies `builder`, the copy is handed back to the factory once the last reference goes away
+static std::shared_ptr<DynamicTypeBuilder>
+fastrtps__lazy_copy_builder(
+  DynamicTypeBuilderFactory * type_factory, const DynamicTypeBuilder * builder)
+{
+  DynamicTypeBuilder * copy = type_factory->create_builder_copy(builder);
+  if (!copy) {
+    return nullptr;
+  }
+  return std::shared_ptr<DynamicTypeBuilder>(
+    copy, [type_factory](DynamicTypeBuilder * b) {type_factory->delete_builder(b);});
+}
+
+
+// REGISTRY ========================================================================================
+// Must be called with registry->mutex_ held
+static void
+fastrtps__lazy_builder_registry_record(
+  fastrtps__lazy_builder_registry_t * registry,
+  DynamicTypeBuilder * builder,
+  uint32_t id,
+  const std::string & name,
+  const std::string & default_value,
+  std::shared_ptr<fastrtps__lazy_struct_t> nested,
+  TypeKind container_kind,
+  uint32_t container_bound)
+{
+  auto & deferred_members = registry->deferred_members_[builder];
+
+  fastrtps__lazy_member_t member;
+  member.position_ = builder->get_member_count() +
+    fastrtps__size_t_to_uint32_t(deferred_members.size());
+  member.id_ = id;
+  member.name_ = name;
+  member.default_value_ = default_value;
+  member.container_kind_ = container_kind;
+  member.container_bound_ = container_bound;
+  member.nested_ = std::move(nested);
+  deferred_members.push_back(std::move(member));
+}
+
+
+rcutils_ret_t
+fastrtps__lazy_builder_registry_add_member(
+  fastrtps__lazy_builder_registry_t * registry,
+  DynamicTypeBuilderFactory * type_factory,
+  DynamicTypeBuilder * builder,
+  uint32_t id,
+  const std::string & name,
+  const std::string & default_value,
+  DynamicTypeBuilder * nested_builder,
+  TypeKind container_kind,
+  uint32_t container_bound)
+{
+  auto nested = std::make_shared<fastrtps__lazy_struct_t>();
+  nested->snapshot_ = fastrtps__lazy_copy_builder(type_factory, nested_builder);
+  if (!nested->snapshot_) {
+    RCUTILS_SET_ERROR_MSG("Could not copy nested type builder for lazy member");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+
+  std::lock_guard<std::mutex> lock(registry->mutex_);
+
+  // Nested builders may have recorded members of their own
+  auto nested_it = registry->deferred_members_.find(nested_builder);
+  if (nested_it != registry->deferred_members_.end()) {
+    nested->deferred_members_ = nested_it->second;
+  }
+
+  fastrtps__lazy_builder_registry_record(
+    registry, builder, id, name, default_value, std::move(nested),
+    container_kind, container_bound);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__lazy_builder_registry_add_lazy_member(
+  fastrtps__lazy_builder_registry_t * registry,
+  DynamicTypeBuilder * builder,
+  uint32_t id,
+  const std::string & name,
+  const std::string & default_value,
+  std::shared_ptr<fastrtps__lazy_struct_t> nested,
+  TypeKind container_kind,
+  uint32_t container_bound)
+{
+  std::lock_guard<std::mutex> lock(registry->mutex_);
+  fastrtps__lazy_builder_registry_record(
+    registry, builder, id, name, default_value, std::move(nested),
+    container_kind, container_bound);
+  return RCUTILS_RET_OK;
+}
+
+
+std::shared_ptr<fastrtps__lazy_struct_t>
+fastrtps__lazy_builder_registry_snapshot(
+  fastrtps__lazy_builder_registry_t * registry,
+  DynamicTypeBuilderFactory * type_factory,
+  const DynamicTypeBuilder * builder)
+{
+  std::lock_guard<std::mutex> lock(registry->mutex_);
+  auto it = registry->deferred_members_.find(builder);
+  if (it == registry->deferred_members_.end()) {
+    return nullptr;
+  }
+
+  auto out = std::make_shared<fastrtps__lazy_struct_t>();
+  out->snapshot_ = fastrtps__lazy_copy_builder(type_factory, builder);
+  if (!out->snapshot_) {
+    return nullptr;
+  }
+  out->deferred_members_ = it->second;
+  return out;
+}
+
+
+void
+fastrtps__lazy_builder_registry_copy(
+  fastrtps__lazy_builder_registry_t * registry,
+  const DynamicTypeBuilder * other,
+  const DynamicTypeBuilder * builder)
+{
+  std::lock_guard<std::mutex> lock(registry->mutex_);
+  auto it = registry->deferred_members_.find(other);
+  if (it != registry->deferred_members_.end()) {
+    // Copy first, inserting may invalidate `it`
+    std::vector<fastrtps__lazy_member_t> deferred_members = it->second;
+    registry->deferred_members_[builder] = std::move(deferred_members);
+  }
+}
+
+
+void
+fastrtps__lazy_builder_registry_erase(
+  fastrtps__lazy_builder_registry_t * registry,
+  const DynamicTypeBuilder * builder)
+{
+  std::lock_guard<std::mutex> lock(registry->mutex_);
+  registry->deferred_members_.erase(builder);
+}
+
+
+void
+fastrtps__lazy_builder_registry_clear(fastrtps__lazy_builder_registry_t * registry)
+{
+  std::lock_guard<std::mutex> lock(registry->mutex_);
+  registry->deferred_members_.clear();
+}
+
+
+// BUILD ===========================================================================================
+static DynamicType_ptr
+fastrtps__lazy_struct_build_impl(
+  const fastrtps__lazy_struct_t & lazy_struct,
+  DynamicTypeBuilderFactory * type_factory,
+  fastrtps__type_cache_t * type_cache,
+  std::unordered_map<const fastrtps__lazy_struct_t *, DynamicType_ptr> & built)
+{
+  auto built_it = built.find(&lazy_struct);
+  if (built_it != built.end()) {
+    return built_it->second;
+  }
+
+  if (lazy_struct.deferred_members_.empty()) {
+    DynamicType_ptr out = lazy_struct.snapshot_->build();
+    built.emplace(&lazy_struct, out);
+    return out;
+  }
+
+  DynamicTypeBuilder * builder = type_factory->create_struct_builder();
+  if (!builder) {
+    return DynamicType_ptr(nullptr);
+  }
+
+  // Member ids are handed out in insertion order, so this iterates the directly added members in
+  // the order they were added
+  std::map<MemberId, DynamicTypeMember *> direct_members;
+  lazy_struct.snapshot_->get_all_members(direct_members);
+  auto direct_it = direct_members.begin();
+  auto deferred_it = lazy_struct.deferred_members_.begin();
+
+  // Replay every member in its original position, so the built type is identical to the one the
+  // eager path would have built
+  bool ok = builder->set_name(lazy_struct.snapshot_->get_name()) == ReturnCode_t::RETCODE_OK;
+  size_t member_count = direct_members.size() + lazy_struct.deferred_members_.size();
+  for (size_t position = 0; ok && position < member_count; ++position) {
+    if (deferred_it != lazy_struct.deferred_members_.end() && deferred_it->position_ == position) {
+      DynamicType_ptr member_type = fastrtps__lazy_struct_build_impl(
+        *deferred_it->nested_, type_factory, type_cache, built);
+      if (member_type) {
+        switch (deferred_it->container_kind_) {
+          case eprosima::fastrtps::types::TK_ARRAY:
+            member_type = fastrtps__type_cache_get_array_type(
+              type_cache, type_factory, member_type, deferred_it->container_bound_);
+            break;
+          case eprosima::fastrtps::types::TK_SEQUENCE:
+            member_type = fastrtps__type_cache_get_sequence_type(
+              type_cache, type_factory, member_type, deferred_it->container_bound_);
+            break;
+          default:
+            break;
+        }
+      }
+      ok = member_type && builder->add_member(
+        deferred_it->id_, deferred_it->name_, member_type, deferred_it->default_value_) ==
+        ReturnCode_t::RETCODE_OK;
+      ++deferred_it;
+    } else if (direct_it != direct_members.end()) {
+      MemberDescriptor descriptor;
+      direct_it->second->get_descriptor(&descriptor);
+      ok = builder->add_member(
+        descriptor.get_index(), descriptor.get_name(), descriptor.get_type(),
+        descriptor.get_default_value()) == ReturnCode_t::RETCODE_OK;
+      ++direct_it;
+    } else {
+      ok = false;
+    }
+  }
+
+  DynamicType_ptr out = ok ? builder->build() : DynamicType_ptr(nullptr);
+  type_factory->delete_builder(builder);
+  if (out) {
+    built.emplace(&lazy_struct, out);
+  }
+  return out;
+}
+
+
+DynamicType_ptr
+fastrtps__lazy_struct_build(
+  const fastrtps__lazy_struct_t & lazy_struct,
+  DynamicTypeBuilderFactory * type_factory,
+  fastrtps__type_cache_t * type_cache)
+{
+  // Nested structs shared by several members are only built once
+  std::unordered_map<const fastrtps__lazy_struct_t *, DynamicType_ptr> built;
+  return fastrtps__lazy_struct_build_impl(lazy_struct, type_factory, type_cache, built);
+}
@@ -0,0 +1,150 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_LAZY_TYPE_HPP_
+#define DETAIL__FASTRTPS_LAZY_TYPE_HPP_
+
+#include <fastrtps/types/DynamicTypeBuilder.h>
+#include <fastrtps/types/DynamicTypeBuilderFactory.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "fastrtps_type_cache.hpp"
+
+
+// =================================================================================================
+// LAZY TYPES
+// =================================================================================================
+//
+// fastrtps builds a nested struct builder into a type as soon as it is added as a member. In lazy
+// mode, members added from nested builders are recorded instead, together with their position
+// among the builder's members, and the whole type is only built (replaying the recorded members in
+// their original positions) the first time it is actually needed.
+
+struct fastrtps__lazy_struct_s;
+
+/// A nested struct member that has not been built yet
+typedef struct fastrtps__lazy_member_s
+{
+  // Number of members added to the outer builder before this one
+  uint32_t position_;
+
+  uint32_t id_;
+  std::string name_;
+  std::string default_value_;
+
+  // TK_NONE for a plain nested struct member, otherwise TK_ARRAY or TK_SEQUENCE
+  eprosima::fastrtps::types::TypeKind container_kind_;
+  uint32_t container_bound_;
+
+  std::shared_ptr<struct fastrtps__lazy_struct_s> nested_;
+} fastrtps__lazy_member_t;
+
+/// A struct type that has not been built yet
+typedef struct fastrtps__lazy_struct_s
+{
+  // Copy of the builder, holding every member that was added directly
+  std::shared_ptr<eprosima::fastrtps::types::DynamicTypeBuilder> snapshot_;
+  std::vector<fastrtps__lazy_member_t> deferred_members_;
+} fastrtps__lazy_struct_t;
+
+/// Members recorded so far for every builder that had nested builder members added in lazy mode
+typedef struct fastrtps__lazy_builder_registry_s
+{
+  std::mutex mutex_;
+  std::unordered_map<
+    const eprosima::fastrtps::types::DynamicTypeBuilder *, std::vector<fastrtps__lazy_member_t>
+  > deferred_members_;
+} fastrtps__lazy_builder_registry_t;
+
+
+/// Record a nested builder member of `builder` instead of building it
+/// `nested_builder` is copied, so the caller can finalize it right after
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__lazy_builder_registry_add_member(
+  fastrtps__lazy_builder_registry_t * registry,
+  eprosima::fastrtps::types::DynamicTypeBuilderFactory * type_factory,
+  eprosima::fastrtps::types::DynamicTypeBuilder * builder,
+  uint32_t id,
+  const std::string & name,
+  const std::string & default_value,
+  eprosima::fastrtps::types::DynamicTypeBuilder * nested_builder,
+  eprosima::fastrtps::types::TypeKind container_kind,
+  uint32_t container_bound);
+
+/// Record a member of `builder` whose type is a struct that was not built yet
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__lazy_builder_registry_add_lazy_member(
+  fastrtps__lazy_builder_registry_t * registry,
+  eprosima::fastrtps::types::DynamicTypeBuilder * builder,
+  uint32_t id,
+  const std::string & name,
+  const std::string & default_value,
+  std::shared_ptr<fastrtps__lazy_struct_t> nested,
+  eprosima::fastrtps::types::TypeKind container_kind,
+  uint32_t container_bound);
+
+/// Snapshot `builder` and its recorded members
+/// Returns an empty pointer if `builder` has no recorded members, and can be built right away
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+std::shared_ptr<fastrtps__lazy_struct_t>
+fastrtps__lazy_builder_registry_snapshot(
+  fastrtps__lazy_builder_registry_t * registry,
+  eprosima::fastrtps::types::DynamicTypeBuilderFactory * type_factory,
+  const eprosima::fastrtps::types::DynamicTypeBuilder * builder);
+
+/// Give `builder` a copy of the members recorded for `other`
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__lazy_builder_registry_copy(
+  fastrtps__lazy_builder_registry_t * registry,
+  const eprosima::fastrtps::types::DynamicTypeBuilder * other,
+  const eprosima::fastrtps::types::DynamicTypeBuilder * builder);
+
+/// Forget the members recorded for `builder`
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__lazy_builder_registry_erase(
+  fastrtps__lazy_builder_registry_t * registry,
+  const eprosima::fastrtps::types::DynamicTypeBuilder * builder);
+
+/// Forget every recorded member
+/// Must be called before the type factory that created the recorded builders is deleted
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__lazy_builder_registry_clear(fastrtps__lazy_builder_registry_t * registry);
+
+/// Build `lazy_struct`, including every nested struct recorded in it
+/// Returns an empty pointer if the type could not be built
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+eprosima::fastrtps::types::DynamicType_ptr
+fastrtps__lazy_struct_build(
+  const fastrtps__lazy_struct_t & lazy_struct,
+  eprosima::fastrtps::types::DynamicTypeBuilderFactory * type_factory,
+  fastrtps__type_cache_t * type_cache);
+
+
+#endif  // DETAIL__FASTRTPS_LAZY_TYPE_HPP_
@@ -0,0 +1,512 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastrtps_message_log.hpp"
+
+#include <fastdds/rtps/common/SerializedPayload.h>
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicPubSubType.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string>
+
+#include "fastrtps_type_fingerprint.hpp"
+
+
+using eprosima::fastrtps::types::DynamicData;
+
+
+typedef struct fastrtps__message_log_header_s
+{
+  char magic[8];
+  uint32_t format_version;
+  uint32_t reserved;
+} fastrtps__message_log_header_t;
+
+typedef struct fastrtps__message_log_index_header_s
+{
+  char magic[8];
+  uint32_t format_version;
+  uint32_t reserved;
+  uint64_t entry_count;
+} fastrtps__message_log_index_header_t;
+
+
+// =================================================================================================
+// MESSAGE LOG
+// =================================================================================================
+
+// WRITER ==========================================================================================
+#ifndef _WIN32
+// Make room for `length` more bytes in `file`, remapping it if it has to grow
+static rcutils_ret_t
+fastrtps__message_log_file_reserve(fastrtps__message_log_file_t * file, size_t length)
+{
+  if (file->capacity_ - file->size_ >= length) {
+    return RCUTILS_RET_OK;
+  }
+
+  size_t capacity = std::max(
+    file->size_ + length,
+    file->capacity_ + std::max<size_t>(file->capacity_, FASTRTPS_MESSAGE_LOG_MIN_GROWTH));
+  if (ftruncate(file->fd_, static_cast<off_t>(capacity)) != 0) {
+    RCUTILS_SET_ERROR_MSG("Could not grow message log file");
+    return RCUTILS_RET_ERROR;
+  }
+  void * map = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd_, 0);
+  if (map == MAP_FAILED) {
+    RCUTILS_SET_ERROR_MSG("Could not map message log file");
+    return RCUTILS_RET_ERROR;
+  }
+  if (file->data_) {
+    munmap(file->data_, file->capacity_);
+  }
+  file->data_ = static_cast<uint8_t *>(map);
+  file->capacity_ = capacity;
+  return RCUTILS_RET_OK;
+}
+
+
+static rcutils_ret_t
+fastrtps__message_log_file_open(
+  const char * path, const void * header, size_t header_size, fastrtps__message_log_file_t * file)
+{
+  file->fd_ = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file->fd_ < 0) {
+    RCUTILS_SET_ERROR_MSG("Could not create message log file");
+    return RCUTILS_RET_ERROR;
+  }
+  rcutils_ret_t ret = fastrtps__message_log_file_reserve(file, header_size);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  std::memcpy(file->data_, header, header_size);
+  file->size_ = header_size;
+  return RCUTILS_RET_OK;
+}
+
+
+static rcutils_ret_t
+fastrtps__message_log_file_close(fastrtps__message_log_file_t * file)
+{
+  if (file->fd_ < 0) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = RCUTILS_RET_OK;
+  if (file->data_) {
+    munmap(file->data_, file->capacity_);
+  }
+  // Drop the unused part of the last growth step
+  if (ftruncate(file->fd_, static_cast<off_t>(file->size_)) != 0) {
+    RCUTILS_SET_ERROR_MSG("Could not truncate message log file");
+    ret = RCUTILS_RET_ERROR;
+  }
+  close(file->fd_);
+  file->fd_ = -1;
+  return ret;
+}
+#endif
+
+
+static size_t
+fastrtps__message_log_align(size_t offset)
+{
+  return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+
+// Make room for a message of `length` bytes and its index entry
+static rcutils_ret_t
+fastrtps__message_log_writer_reserve(
+  fastrtps__message_log_writer_t * writer, int64_t timestamp, size_t length,
+  uint8_t ** destination)
+{
+  if (timestamp < writer->last_timestamp_) {
+    RCUTILS_SET_ERROR_MSG("Messages must be appended to a message log in timestamp order");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+#ifndef _WIN32
+  size_t offset = fastrtps__message_log_align(writer->log_.size_);
+  rcutils_ret_t ret = fastrtps__message_log_file_reserve(
+    &writer->log_, offset - writer->log_.size_ + length);
+  if (ret == RCUTILS_RET_OK) {
+    ret = fastrtps__message_log_file_reserve(
+      &writer->index_, sizeof(fastrtps__message_log_entry_t));
+  }
+  *destination = writer->log_.data_ + offset;
+  return ret;
+#else
+  (void) length;
+  (void) destination;
+  return RCUTILS_RET_ERROR;
+#endif
+}
+
+
+// Index a message of `length` bytes written where reserve pointed, cannot fail once reserved
+static void
+fastrtps__message_log_writer_commit(
+  fastrtps__message_log_writer_t * writer, int64_t timestamp,
+  const fastrtps__type_fingerprint_t * fingerprint, size_t length)
+{
+  fastrtps__message_log_entry_t entry;
+  entry.timestamp = timestamp;
+  entry.fingerprint[0] = fingerprint->hash[0];
+  entry.fingerprint[1] = fingerprint->hash[1];
+  entry.offset = fastrtps__message_log_align(writer->log_.size_);
+  entry.length = length;
+
+  // Padding needs no zeroing, the files grow zero filled and are never written twice
+  std::memcpy(writer->index_.data_ + writer->index_.size_, &entry, sizeof(entry));
+  writer->index_.size_ += sizeof(entry);
+  writer->log_.size_ = entry.offset + length;
+  writer->last_timestamp_ = timestamp;
+
+  // The count goes last, so the index never claims an entry that isn't fully written
+  ++writer->entry_count_;
+  std::memcpy(
+    writer->index_.data_ + offsetof(fastrtps__message_log_index_header_t, entry_count),
+    &writer->entry_count_, sizeof(writer->entry_count_));
+}
+
+
+rcutils_ret_t
+fastrtps__message_log_writer_open(
+  const char * path, rcutils_allocator_t * allocator, fastrtps__message_log_writer_t ** writer)
+{
+#ifndef _WIN32
+  void * writer_mem = allocator->allocate(
+    sizeof(fastrtps__message_log_writer_t), allocator->state);
+  if (!writer_mem) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate message log writer");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  auto out = new (writer_mem) fastrtps__message_log_writer_t();
+  out->allocator_ = *allocator;
+  out->log_ = {-1, nullptr, 0, 0};
+  out->index_ = {-1, nullptr, 0, 0};
+  out->entry_count_ = 0;
+  out->last_timestamp_ = std::numeric_limits<int64_t>::min();
+
+  fastrtps__message_log_header_t header;
+  std::memcpy(header.magic, FASTRTPS_MESSAGE_LOG_MAGIC, sizeof(header.magic));
+  header.format_version = FASTRTPS_MESSAGE_LOG_FORMAT_VERSION;
+  header.reserved = 0;
+  fastrtps__message_log_index_header_t index_header;
+  std::memcpy(index_header.magic, FASTRTPS_MESSAGE_LOG_INDEX_MAGIC, sizeof(index_header.magic));
+  index_header.format_version = FASTRTPS_MESSAGE_LOG_FORMAT_VERSION;
+  index_header.reserved = 0;
+  index_header.entry_count = 0;
+
+  std::string index_path = std::string(path) + ".idx";
+  rcutils_ret_t ret = fastrtps__message_log_file_open(path, &header, sizeof(header), &out->log_);
+  if (ret == RCUTILS_RET_OK) {
+    ret = fastrtps__message_log_file_open(
+      index_path.c_str(), &index_header, sizeof(index_header), &out->index_);
+  }
+  if (ret != RCUTILS_RET_OK) {
+    fastrtps__message_log_writer_close(out);
+    return ret;
+  }
+  *writer = out;
+  return RCUTILS_RET_OK;
+#else
+  (void) path;
+  (void) allocator;
+  (void) writer;
+  RCUTILS_SET_ERROR_MSG("Message logs are POSIX-only, not supported on Windows");
+  return RCUTILS_RET_ERROR;
+#endif
+}
+
+
+rcutils_ret_t
+fastrtps__message_log_writer_append(
+  fastrtps__message_log_writer_t * writer,
+  int64_t timestamp,
+  const fastrtps__type_fingerprint_t * fingerprint,
+  const uint8_t * message, size_t length)
+{
+  uint8_t * destination = nullptr;
+  rcutils_ret_t ret = fastrtps__message_log_writer_reserve(
+    writer, timestamp, length, &destination);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  std::memcpy(destination, message, length);
+  fastrtps__message_log_writer_commit(writer, timestamp, fingerprint, length);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__message_log_writer_append_data(
+  fastrtps__message_log_writer_t * writer,
+  int64_t timestamp,
+  const fastrtps__type_fingerprint_t * fingerprint,
+  DynamicData * data)
+{
+  eprosima::fastrtps::types::DynamicPubSubType pubsub_type;
+  uint32_t length = pubsub_type.getSerializedSizeProvider(data)();
+
+  uint8_t * destination = nullptr;
+  rcutils_ret_t ret = fastrtps__message_log_writer_reserve(
+    writer, timestamp, length, &destination);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+
+  eprosima::fastrtps::rtps::SerializedPayload_t payload;
+  payload.data = destination;
+  payload.max_size = length;
+  bool success = pubsub_type.serialize(data, &payload);
+  size_t serialized_length = payload.length;
+  payload.data = nullptr;  // Owned by the log, the payload must not free it
+  if (!success) {
+    RCUTILS_SET_ERROR_MSG("Could not serialize dynamic data into message log");
+    return RCUTILS_RET_ERROR;
+  }
+  fastrtps__message_log_writer_commit(writer, timestamp, fingerprint, serialized_length);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__message_log_writer_close(fastrtps__message_log_writer_t * writer)
+{
+  rcutils_ret_t ret = RCUTILS_RET_OK;
+#ifndef _WIN32
+  ret = fastrtps__message_log_file_close(&writer->log_);
+  rcutils_ret_t index_ret = fastrtps__message_log_file_close(&writer->index_);
+  if (ret == RCUTILS_RET_OK) {
+    ret = index_ret;
+  }
+#endif
+  rcutils_allocator_t allocator = writer->allocator_;
+  writer->~fastrtps__message_log_writer_t();
+  allocator.deallocate(writer, allocator.state);
+  return ret;
+}
+
+
+// READER ==========================================================================================
+#ifndef _WIN32
+static rcutils_ret_t
+fastrtps__message_log_map(const char * path, const uint8_t ** data, size_t * size)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return RCUTILS_RET_NOT_FOUND;
+    }
+    RCUTILS_SET_ERROR_MSG("Could not open message log file");
+    return RCUTILS_RET_ERROR;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    RCUTILS_SET_ERROR_MSG("Could not stat message log file");
+    return RCUTILS_RET_ERROR;
+  }
+  *size = static_cast<size_t>(file_stat.st_size);
+  *data = nullptr;
+  if (*size > 0) {
+    void * map = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      close(fd);
+      RCUTILS_SET_ERROR_MSG("Could not map message log file");
+      return RCUTILS_RET_ERROR;
+    }
+    *data = static_cast<const uint8_t *>(map);
+  }
+  close(fd);  // The mapping stays valid after the descriptor is closed
+  return RCUTILS_RET_OK;
+}
+#endif
+
+
+rcutils_ret_t
+fastrtps__message_log_reader_open(
+  const char * path, rcutils_allocator_t * allocator, fastrtps__message_log_reader_t ** reader)
+{
+#ifndef _WIN32
+  void * reader_mem = allocator->allocate(
+    sizeof(fastrtps__message_log_reader_t), allocator->state);
+  if (!reader_mem) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate message log reader");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  auto out = new (reader_mem) fastrtps__message_log_reader_t();
+  out->allocator_ = *allocator;
+  out->log_ = nullptr;
+  out->log_size_ = 0;
+  out->index_ = nullptr;
+  out->index_size_ = 0;
+  out->entry_count_ = 0;
+
+  std::string index_path = std::string(path) + ".idx";
+  rcutils_ret_t ret = fastrtps__message_log_map(path, &out->log_, &out->log_size_);
+  if (ret == RCUTILS_RET_OK) {
+    ret = fastrtps__message_log_map(index_path.c_str(), &out->index_, &out->index_size_);
+  }
+
+  if (ret == RCUTILS_RET_OK) {
+    fastrtps__message_log_header_t header;
+    fastrtps__message_log_index_header_t index_header;
+    if (out->log_size_ < sizeof(header) || out->index_size_ < sizeof(index_header)) {
+      ret = RCUTILS_RET_ERROR;
+    } else {
+      std::memcpy(&header, out->log_, sizeof(header));
+      std::memcpy(&index_header, out->index_, sizeof(index_header));
+      if (std::memcmp(header.magic, FASTRTPS_MESSAGE_LOG_MAGIC, sizeof(header.magic)) != 0 ||
+        std::memcmp(
+          index_header.magic, FASTRTPS_MESSAGE_LOG_INDEX_MAGIC, sizeof(index_header.magic)) != 0 ||
+        header.format_version != FASTRTPS_MESSAGE_LOG_FORMAT_VERSION ||
+        index_header.format_version != FASTRTPS_MESSAGE_LOG_FORMAT_VERSION)
+      {
+        ret = RCUTILS_RET_ERROR;
+      }
+    }
+    if (ret == RCUTILS_RET_OK) {
+      // A writer that didn't close cleanly may have left a count past the end of the index
+      out->entry_count_ = std::min<uint64_t>(
+        index_header.entry_count,
+        (out->index_size_ - sizeof(index_header)) / sizeof(fastrtps__message_log_entry_t));
+    } else {
+      RCUTILS_SET_ERROR_MSG("Not a message log, or written by another format version");
+    }
+  }
+
+  if (ret != RCUTILS_RET_OK) {
+    fastrtps__message_log_reader_close(out);
+    return ret;
+  }
+  *reader = out;
+  return RCUTILS_RET_OK;
+#else
+  (void) path;
+  (void) allocator;
+  (void) reader;
+  RCUTILS_SET_ERROR_MSG("Message logs are POSIX-only, not supported on Windows");
+  return RCUTILS_RET_ERROR;
+#endif
+}
+
+
+static int64_t
+fastrtps__message_log_reader_get_timestamp(
+  const fastrtps__message_log_reader_t * reader, uint64_t index)
+{
+  int64_t timestamp;
+  std::memcpy(
+    &timestamp,
+    reader->index_ + sizeof(fastrtps__message_log_index_header_t) +
+    index * sizeof(fastrtps__message_log_entry_t) +
+    offsetof(fastrtps__message_log_entry_t, timestamp),
+    sizeof(timestamp));
+  return timestamp;
+}
+
+
+rcutils_ret_t
+fastrtps__message_log_reader_get(
+  const fastrtps__message_log_reader_t * reader,
+  uint64_t index,
+  fastrtps__message_log_entry_t * entry,
+  const uint8_t ** message)
+{
+  if (index >= reader->entry_count_) {
+    RCUTILS_SET_ERROR_MSG("Message index out of range");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  std::memcpy(
+    entry,
+    reader->index_ + sizeof(fastrtps__message_log_index_header_t) +
+    index * sizeof(fastrtps__message_log_entry_t),
+    sizeof(*entry));
+  if (entry->offset > reader->log_size_ || entry->length > reader->log_size_ - entry->offset) {
+    RCUTILS_SET_ERROR_MSG("Message log index entry points outside of the log");
+    return RCUTILS_RET_ERROR;
+  }
+  *message = reader->log_ + entry->offset;
+  return RCUTILS_RET_OK;
+}
+
+
+// Index of the first message with a timestamp at or after `timestamp`
+static uint64_t
+fastrtps__message_log_reader_lower_bound(
+  const fastrtps__message_log_reader_t * reader, int64_t timestamp)
+{
+  uint64_t lo = 0;
+  uint64_t hi = reader->entry_count_;
+  while (lo < hi) {
+    uint64_t mid = lo + (hi - lo) / 2;
+    if (fastrtps__message_log_reader_get_timestamp(reader, mid) < timestamp) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+
+void
+fastrtps__message_log_reader_find_time_range(
+  const fastrtps__message_log_reader_t * reader,
+  int64_t start, int64_t end,
+  uint64_t * first, uint64_t * count)
+{
+  *first = fastrtps__message_log_reader_lower_bound(reader, start);
+  uint64_t last = end > start ? fastrtps__message_log_reader_lower_bound(reader, end) : *first;
+  *count = last - *first;
+}
+
+
+rcutils_ret_t
+fastrtps__message_log_reader_close(fastrtps__message_log_reader_t * reader)
+{
+#ifndef _WIN32
+  if (reader->log_) {
+    munmap(const_cast<uint8_t *>(reader->log_), reader->log_size_);
+  }
+  if (reader->index_) {
+    munmap(const_cast<uint8_t *>(reader->index_), reader->index_size_);
+  }
+#endif
+  rcutils_allocator_t allocator = reader->allocator_;
+  reader->~fastrtps__message_log_reader_t();
+  allocator.deallocate(reader, allocator.state);
+  return RCUTILS_RET_OK;
+}
@@ -0,0 +1,162 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DETAIL__FASTRTPS_MESSAGE_LOG_HPP_
+#define DETAIL__FASTRTPS_MESSAGE_LOG_HPP_
+
+#include <fastrtps/types/DynamicData.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "fastrtps_type_fingerprint.hpp"
+
+
+// =================================================================================================
+// MESSAGE LOG
+// =================================================================================================
+//
+// A log is two files, both little-endian:
+//
+//   log    `path`, magic "RDTFMLOG", u32 format version, u32 reserved, then the serialized
+//          messages back to back, each starting 8 byte aligned
+//   index  `path`.idx, magic "RDTFMIDX", u32 format version, u32 reserved, u64 entry count, then
+//          one entry per message: i64 timestamp, u64 fingerprint[2], u64 offset, u64 length
+//
+// Messages are appended in timestamp order, so the index can be binary searched by time.
+//
+// The writer maps both files and grows them in large steps, so appending a message is a copy into
+// the mapping (or serializing straight into it), without a system call unless the files need to
+// grow. Closing the writer truncates both files to what was actually written.
+//
+// POSIX-only: there is no CreateFileMapping counterpart, so on Windows both open functions fail.
+
+#define FASTRTPS_MESSAGE_LOG_MAGIC "RDTFMLOG"
+#define FASTRTPS_MESSAGE_LOG_INDEX_MAGIC "RDTFMIDX"
+#define FASTRTPS_MESSAGE_LOG_FORMAT_VERSION 1
+
+// The files grow by at least this much, or by their current size, whichever is larger
+#define FASTRTPS_MESSAGE_LOG_MIN_GROWTH (4u << 20)
+
+typedef struct fastrtps__message_log_entry_s
+{
+  int64_t timestamp;
+  uint64_t fingerprint[2];
+  uint64_t offset;
+  uint64_t length;
+} fastrtps__message_log_entry_t;
+
+/// A file mapped for writing
+typedef struct fastrtps__message_log_file_s
+{
+  int fd_;
+  uint8_t * data_;
+  size_t capacity_;  // Mapped size
+  size_t size_;  // Written size
+} fastrtps__message_log_file_t;
+
+typedef struct fastrtps__message_log_writer_s
+{
+  rcutils_allocator_t allocator_;
+  fastrtps__message_log_file_t log_;
+  fastrtps__message_log_file_t index_;
+  uint64_t entry_count_;
+  int64_t last_timestamp_;
+} fastrtps__message_log_writer_t;
+
+typedef struct fastrtps__message_log_reader_s
+{
+  rcutils_allocator_t allocator_;
+  const uint8_t * log_;
+  size_t log_size_;
+  const uint8_t * index_;
+  size_t index_size_;
+  uint64_t entry_count_;
+} fastrtps__message_log_reader_t;
+
+
+// WRITER ==========================================================================================
+/// Create a new log at `path`, replacing any existing one
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__message_log_writer_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  fastrtps__message_log_writer_t ** writer);  // OUT
+
+/// Append an already serialized message
+/// Returns RCUTILS_RET_INVALID_ARGUMENT if `timestamp` is older than the last appended one
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__message_log_writer_append(
+  fastrtps__message_log_writer_t * writer,
+  int64_t timestamp,
+  const fastrtps__type_fingerprint_t * fingerprint,
+  const uint8_t * message, size_t length);
+
+/// Serialize `data` straight into the log, exactly like fastrtps__dynamic_data_serialize would
+/// Returns RCUTILS_RET_INVALID_ARGUMENT if `timestamp` is older than the last appended one
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__message_log_writer_append_data(
+  fastrtps__message_log_writer_t * writer,
+  int64_t timestamp,
+  const fastrtps__type_fingerprint_t * fingerprint,
+  eprosima::fastrtps::types::DynamicData * data);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__message_log_writer_close(fastrtps__message_log_writer_t * writer);
+
+
+// READER ==========================================================================================
+/// Map the log at `path` for reading
+/// Returns RCUTILS_RET_NOT_FOUND if it does not exist, RCUTILS_RET_ERROR if it is not a valid log
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__message_log_reader_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  fastrtps__message_log_reader_t ** reader);  // OUT
+
+/// Get message `index`, pointing into the mapped log
+/// Returns RCUTILS_RET_ERROR if its index entry points outside of the log
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__message_log_reader_get(
+  const fastrtps__message_log_reader_t * reader,
+  uint64_t index,
+  fastrtps__message_log_entry_t * entry,  // OUT
+  const uint8_t ** message);  // OUT
+
+/// Find the messages with `start <= timestamp < end`, as a range of indices
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__message_log_reader_find_time_range(
+  const fastrtps__message_log_reader_t * reader,
+  int64_t start, int64_t end,
+  uint64_t * first,  // OUT
+  uint64_t * count);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__message_log_reader_close(fastrtps__message_log_reader_t * reader);
+
+
+#endif  // DETAIL__FASTRTPS_MESSAGE_LOG_HPP_
@@ -0,0 +1,194 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastrtps_sequence_index.hpp"
+
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "fastrtps_cdr_layout.hpp"
+
+
+using eprosima::fastrtps::types::DynamicType_ptr;
+
+
+// =================================================================================================
+// SEQUENCE INDEX
+// =================================================================================================
+
+// INIT ============================================================================================
+static rcutils_ret_t
+fastrtps__sequence_index_compile(fastrtps__sequence_index_t * index, const char * path)
+{
+  const fastrtps__cdr_layout_node_t * node = index->layout_.root_;
+  const char * position = path;
+  while (true) {
+    const char * name_start = position;
+    while (*position && *position != '.' && *position != '[') {
+      ++position;
+    }
+    std::string name(name_start, static_cast<size_t>(position - name_start));
+    if (node->kind_ != eprosima::fastrtps::types::TK_STRUCTURE) {
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "'%s' in sequence index path is not a struct member", name.c_str());
+      return RCUTILS_RET_INVALID_ARGUMENT;
+    }
+    size_t member_index = 0;
+    while (member_index < node->members_.size() && node->members_[member_index].name_ != name) {
+      ++member_index;
+    }
+    if (member_index == node->members_.size()) {
+      RCUTILS_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "No member '%s' in sequence index path", name.c_str());
+      return RCUTILS_RET_INVALID_ARGUMENT;
+    }
+    for (size_t i = 0; i < member_index; ++i) {
+      index->steps_.push_back({false, node->members_[i].node_, 0});
+    }
+    node = node->members_[member_index].node_;
+
+    while (*position == '[') {
+      char * end = nullptr;
+      unsigned long element = std::strtoul(position + 1, &end, 10);  // NOLINT(runtime/int)
+      if (end == position + 1 || *end != ']' || element > UINT32_MAX) {
+        RCUTILS_SET_ERROR_MSG("Expected an element index in sequence index path");
+        return RCUTILS_RET_INVALID_ARGUMENT;
+      }
+      if (node->kind_ != eprosima::fastrtps::types::TK_ARRAY &&
+        node->kind_ != eprosima::fastrtps::types::TK_SEQUENCE)
+      {
+        RCUTILS_SET_ERROR_MSG(
+          "Element index in sequence index path is not on an array or sequence");
+        return RCUTILS_RET_INVALID_ARGUMENT;
+      }
+      index->steps_.push_back({true, node, static_cast<uint32_t>(element)});
+      node = node->element_;
+      position = end + 1;
+    }
+
+    if (*position == '\0') {
+      break;
+    }
+    if (*position != '.') {
+      RCUTILS_SET_ERROR_MSG("Expected '.' or '[' in sequence index path");
+      return RCUTILS_RET_INVALID_ARGUMENT;
+    }
+    ++position;
+  }
+
+  if (node->kind_ != eprosima::fastrtps::types::TK_ARRAY &&
+    node->kind_ != eprosima::fastrtps::types::TK_SEQUENCE)
+  {
+    RCUTILS_SET_ERROR_MSG("Sequence index path does not lead to an array or sequence");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  index->node_ = node;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__sequence_index_init(
+  const DynamicType_ptr & type,
+  const char * path,
+  rcutils_allocator_t * allocator,
+  fastrtps__sequence_index_t ** index)
+{
+  void * index_mem = allocator->allocate(sizeof(fastrtps__sequence_index_t), allocator->state);
+  if (!index_mem) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate sequence index");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  // Holds C++ members, so it must be constructed in place
+  auto out = new (index_mem) fastrtps__sequence_index_t();
+  out->allocator_ = *allocator;
+  out->node_ = nullptr;
+
+  rcutils_ret_t ret = fastrtps__cdr_layout_init(type, &out->layout_);
+  if (ret == RCUTILS_RET_OK &&
+    out->layout_.root_->kind_ != eprosima::fastrtps::types::TK_STRUCTURE)
+  {
+    RCUTILS_SET_ERROR_MSG("Sequence indexes can only be compiled against struct types");
+    ret = RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  if (ret == RCUTILS_RET_OK) {
+    ret = fastrtps__sequence_index_compile(out, path);
+  }
+
+  if (ret != RCUTILS_RET_OK) {
+    fastrtps__sequence_index_fini(out);
+    return ret;
+  }
+  *index = out;
+  return RCUTILS_RET_OK;
+}
+
+
+// BUILD ===========================================================================================
+rcutils_ret_t
+fastrtps__sequence_index_build(
+  fastrtps__sequence_index_t * index,
+  const uint8_t * buffer, size_t length)
+{
+  index->offsets_.clear();
+  fastrtps__cdr_reader_t reader;
+  if (!fastrtps__cdr_reader_init(&reader, buffer, length)) {
+    RCUTILS_SET_ERROR_MSG("Sequence indexes can only be built over plain CDR data");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+
+  size_t offset = 0;
+  bool ok = true;
+  for (auto step = index->steps_.begin(); ok && step != index->steps_.end(); ++step) {
+    ok = step->element_ ?
+      fastrtps__cdr_layout_seek_element(step->node_, &reader, step->index_, &offset) :
+      fastrtps__cdr_layout_skip(step->node_, &reader, &offset);
+  }
+  if (!ok ||
+    !fastrtps__cdr_layout_index_elements(index->node_, &reader, &offset, &index->offsets_))
+  {
+    index->offsets_.clear();
+    RCUTILS_SET_ERROR_MSG("Serialized data ends before the indexed member does");
+    return RCUTILS_RET_ERROR;
+  }
+
+  // Reader offsets start after the encapsulation header
+  size_t header_size = static_cast<size_t>(reader.data_ - buffer);
+  for (size_t & element_offset : index->offsets_) {
+    element_offset += header_size;
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+// FINI ============================================================================================
+rcutils_ret_t
+fastrtps__sequence_index_fini(fastrtps__sequence_index_t * index)
+{
+  rcutils_allocator_t allocator = index->allocator_;
+  index->~fastrtps__sequence_index_t();
+  allocator.deallocate(index, allocator.state);
+  return RCUTILS_RET_OK;
+}
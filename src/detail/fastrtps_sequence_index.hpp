@@ -0,0 +1,99 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DETAIL__FASTRTPS_SEQUENCE_INDEX_HPP_
+#define DETAIL__FASTRTPS_SEQUENCE_INDEX_HPP_
+
+#include <fastrtps/types/DynamicTypePtr.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fastrtps_cdr_layout.hpp"
+
+
+// =================================================================================================
+// SEQUENCE INDEX
+// =================================================================================================
+//
+// Where every element of one array or sequence member is in a serialized buffer.
+//
+// Reaching an element of variable size (strings, structs holding strings or sequences) means
+// skipping over every element before it. The index does that walk once per buffer and records
+// where each element starts, so every element after that is found in constant time.
+//
+// The member is given as a path from the root struct:
+//
+//   path  := name ('.' name | '[' index ']')*
+//
+// e.g. "points" or "markers[2].points".
+
+typedef struct fastrtps__sequence_index_step_s
+{
+  // Skip over `node_`, or seek to element `index_` of it
+  bool element_;
+  const fastrtps__cdr_layout_node_t * node_;
+  uint32_t index_;
+} fastrtps__sequence_index_step_t;
+
+typedef struct fastrtps__sequence_index_s
+{
+  rcutils_allocator_t allocator_;
+  fastrtps__cdr_layout_t layout_;
+
+  // From the start of the serialized data to the indexed member
+  std::vector<fastrtps__sequence_index_step_t> steps_;
+  const fastrtps__cdr_layout_node_t * node_;
+
+  // Of the last buffer the index was built for: where each element starts (before any padding
+  // ahead of it) counted from the start of the buffer, followed by where the last one ends
+  std::vector<size_t> offsets_;
+} fastrtps__sequence_index_t;
+
+
+/// Compile the path to the array or sequence member `path` of struct type `type`
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__sequence_index_init(
+  const eprosima::fastrtps::types::DynamicType_ptr & type,
+  const char * path,
+  rcutils_allocator_t * allocator,
+  fastrtps__sequence_index_t ** index);  // OUT
+
+/// Index the elements of the member in CDR serialized data, replacing the previous index
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__sequence_index_build(
+  fastrtps__sequence_index_t * index,
+  const uint8_t * buffer, size_t length);
+
+/// Number of elements found by the last build
+inline size_t
+fastrtps__sequence_index_get_element_count(const fastrtps__sequence_index_t * index)
+{
+  return index->offsets_.empty() ? 0 : index->offsets_.size() - 1;
+}
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__sequence_index_fini(fastrtps__sequence_index_t * index);
+
+
+#endif  // DETAIL__FASTRTPS_SEQUENCE_INDEX_HPP_
@@ -12,15 +12,63 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <fastrtps/types/DynamicDataFactory.h>
+#include <fastrtps/types/DynamicTypeBuilderFactory.h>
 #include <fastrtps/types/TypesBase.h>
 #include <rcutils/allocator.h>
 #include <rcutils/types/rcutils_ret.h>
 #include <rosidl_dynamic_typesupport/api/serialization_support.h>
 #include <rosidl_dynamic_typesupport/api/serialization_support_interface.h>
 
+#include <cstddef>
+#include <mutex>
+
+#include "fastrtps_data_pool.hpp"
 #include "fastrtps_serialization_support.hpp"
 #include "macros.hpp"
 
+
+// FACTORIES =======================================================================================
+// NOTE: fastrtps only has one instance of each factory per process, and uses them internally
+//       too, so serialization support impls can't get factories of their own. The factories are
+//       instead kept alive for as long as any serialization support impl is using them.
+static std::mutex fastrtps__factories_mutex;
+static size_t fastrtps__factories_users = 0;
+
+void
+fastrtps__serialization_support_acquire_factories(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl)
+{
+  std::lock_guard<std::mutex> lock(fastrtps__factories_mutex);
+  fastrtps_impl->type_factory_ =
+    eprosima::fastrtps::types::DynamicTypeBuilderFactory::get_instance();
+  fastrtps_impl->data_factory_ =
+    eprosima::fastrtps::types::DynamicDataFactory::get_instance();
+  ++fastrtps__factories_users;
+}
+
+rcutils_ret_t
+fastrtps__serialization_support_release_factories(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl)
+{
+  std::lock_guard<std::mutex> lock(fastrtps__factories_mutex);
+  if (--fastrtps__factories_users > 0) {
+    return RCUTILS_RET_OK;
+  }
+
+  FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
+    fastrtps_impl->type_factory_->delete_instance(),
+    "Could not delete dynamic type factory when finalizing serialization support");
+
+  FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
+    fastrtps_impl->data_factory_->delete_instance(),
+    "Could not delete dynamic data factory when finalizing serialization support");
+  return RCUTILS_RET_OK;
+}
+
+
+// CORE ============================================================================================
+
 rcutils_ret_t
 fastrtps__serialization_support_impl_fini(
   rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl)
@@ -31,16 +79,24 @@ fastrtps__serialization_support_impl_fini(
     static_cast<fastrtps__serialization_support_impl_handle_t *>(
     serialization_support_impl->handle);
 
-  FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
-    fastrtps_serialization_support_handle->type_factory_->delete_instance(),
-    "Could not delete dynamic type factory when finalizing serialization support");
+  // Pooled data, cached types and builders must be released before the factories that created
+  // them go away, and the factories may outlive this impl
+  fastrtps__data_pool_clear(
+    &fastrtps_serialization_support_handle->data_pool_,
+    fastrtps_serialization_support_handle->data_factory_);
+  fastrtps__lazy_builder_registry_clear(&fastrtps_serialization_support_handle->lazy_builders_);
+  fastrtps__type_cache_clear(&fastrtps_serialization_support_handle->type_cache_);
+  fastrtps__latency_tracking_clear(&fastrtps_serialization_support_handle->latency_tracking_);
 
-  FASTRTPS_CHECK_RET_FOR_NOT_OK_WITH_MSG(
-    fastrtps_serialization_support_handle->data_factory_->delete_instance(),
-    "Could not delete dynamic data factory when finalizing serialization support");
+  // The users count is already decremented if this fails, so the handle is released regardless and
+  // the error is only reported afterwards
+  rcutils_ret_t ret = fastrtps__serialization_support_release_factories(
+    fastrtps_serialization_support_handle);
 
+  fastrtps_serialization_support_handle->~fastrtps__serialization_support_impl_handle_t();
   allocator.deallocate(serialization_support_impl->handle, allocator.state);
-  return RCUTILS_RET_OK;
+  serialization_support_impl->handle = NULL;
+  return ret;
 }
 
 rcutils_ret_t
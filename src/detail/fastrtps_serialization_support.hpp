@@ -23,14 +23,82 @@
 #include <rosidl_dynamic_typesupport/api/serialization_support.h>
 #include <rosidl_dynamic_typesupport/api/serialization_support_interface.h>
 
+#include <atomic>
+
+#include "fastrtps_allocation_accounting.hpp"
+#include "fastrtps_data_pool.hpp"
+#include "fastrtps_latency_histogram.hpp"
+#include "fastrtps_lazy_type.hpp"
+#include "fastrtps_type_cache.hpp"
+
 
 // CORE ============================================================================================
 typedef struct fastrtps__serialization_support_impl_handle_s
 {
+  // Process-wide singletons, shared with every other serialization support impl
   eprosima::fastrtps::types::DynamicTypeBuilderFactory * type_factory_;
   eprosima::fastrtps::types::DynamicDataFactory * data_factory_;
+
+  // Finalized data of flat types, kept to overwrite
+  fastrtps__data_pool_t data_pool_;
+
+  // Shared member types for the type builder functions
+  fastrtps__type_cache_t type_cache_;
+
+  // Opt-in: defer building nested struct builder members until a type is first used
+  // Read by every nested member addition, and may be toggled while other threads add members
+  std::atomic<bool> lazy_nested_types_{false};
+  fastrtps__lazy_builder_registry_t lazy_builders_;
+
+  // Opt-in: count allocations by operation
+  fastrtps__allocation_accounting_t allocation_accounting_;
+
+  // Opt-in: latency histograms by operation
+  fastrtps__latency_tracking_t latency_tracking_;
 } fastrtps__serialization_support_impl_handle_t;
 
+/// Attribute what allocation hooks report on this thread to the ROSIDL_..._CATEGORY_`CATEGORY`
+/// operation, until the end of the enclosing block
+#define FASTRTPS_ALLOCATION_SCOPE(serialization_support_impl, CATEGORY) \
+  fastrtps__allocation_scope_t fastrtps__allocation_scope( \
+    &static_cast<fastrtps__serialization_support_impl_handle_t *>( \
+      (serialization_support_impl)->handle)->allocation_accounting_, \
+    ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_ ## CATEGORY)
+
+/// Record `size` bytes handed out to the caller by the `CATEGORY` operation
+#define FASTRTPS_RECORD_ALLOCATION(serialization_support_impl, CATEGORY, size) \
+  fastrtps__allocation_accounting_record_allocation( \
+    &static_cast<fastrtps__serialization_support_impl_handle_t *>( \
+      (serialization_support_impl)->handle)->allocation_accounting_, \
+    ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_ ## CATEGORY, size)
+
+/// Record `size` bytes taken back from the caller by the `CATEGORY` operation
+#define FASTRTPS_RECORD_FREE(serialization_support_impl, CATEGORY, size) \
+  fastrtps__allocation_accounting_record_free( \
+    &static_cast<fastrtps__serialization_support_impl_handle_t *>( \
+      (serialization_support_impl)->handle)->allocation_accounting_, \
+    ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_ ## CATEGORY, size)
+
+/// Record how long the rest of the enclosing block takes into the ROSIDL_..._OPERATION_`OPERATION`
+/// latency histogram
+#define FASTRTPS_LATENCY_SCOPE(serialization_support_impl, OPERATION) \
+  fastrtps__latency_scope_t fastrtps__latency_scope( \
+    &static_cast<fastrtps__serialization_support_impl_handle_t *>( \
+      (serialization_support_impl)->handle)->latency_tracking_, \
+    ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_ ## OPERATION)
+
+/// Get the fastrtps factories, creating them if no other serialization support impl is using them
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__serialization_support_acquire_factories(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl);
+
+/// Release the fastrtps factories, deleting them if no other serialization support impl uses them
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__serialization_support_release_factories(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl);
+
 ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
 rcutils_ret_t
 fastrtps__serialization_support_impl_fini(
@@ -0,0 +1,33 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastrtps_tracepoints.hpp"
+
+
+// =================================================================================================
+// TRACEPOINTS
+// =================================================================================================
+
+#ifdef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_TRACEPOINTS
+
+// Probe semaphores live in the .probes section, where tracers find them (through the probe notes)
+// to count themselves in when they attach
+#define FASTRTPS_DEFINE_TRACEPOINT_SEMAPHORE(probe) \
+  __extension__ unsigned short FASTRTPS_TRACEPOINT_SEMAPHORE(probe) \
+  __attribute__((section(".probes"))) = 0;
+FASTRTPS_TRACEPOINT_PROBES(FASTRTPS_DEFINE_TRACEPOINT_SEMAPHORE)
+#undef FASTRTPS_DEFINE_TRACEPOINT_SEMAPHORE
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_TRACEPOINTS
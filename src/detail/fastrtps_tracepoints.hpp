@@ -0,0 +1,118 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DETAIL__FASTRTPS_TRACEPOINTS_HPP_
+#define DETAIL__FASTRTPS_TRACEPOINTS_HPP_
+
+
+// =================================================================================================
+// TRACEPOINTS
+// =================================================================================================
+//
+// Static (USDT) tracepoints, compiled in with -DROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_TRACEPOINTS=ON
+// and no-ops otherwise. Provider `rosidl_dynamic_typesupport_fastrtps`, probes:
+//
+//   serialize_entry          type name
+//   serialize_exit           type name, serialized length
+//   deserialize_entry        type name, buffer length
+//   deserialize_exit         type name, buffer length
+//   data_init_entry          type name
+//   data_init_exit           type name
+//   data_fini_entry          type name
+//   data_fini_exit           type name
+//   clone_entry              type name
+//   clone_exit               type name
+//   type_build_entry         type name
+//   type_build_exit          type name, member count
+//   type_builder_init        type name
+//   type_builder_add_member  type name, member name, member id
+//
+// Type names are fastrtps names (`pkg::msg::Type`). They are only looked up while a tracer is
+// attached to one of the probes of an operation, which the probe semaphores tell. For example:
+//
+//   bpftrace -e 'usdt:librosidl_dynamic_typesupport_fastrtps.so:*:serialize_exit
+//                {@bytes[str(arg0)] = hist(arg1)}'
+
+#ifdef ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_TRACEPOINTS
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define FASTRTPS_TRACEPOINT_PROBES(X) \
+  X(serialize_entry) X(serialize_exit) \
+  X(deserialize_entry) X(deserialize_exit) \
+  X(data_init_entry) X(data_init_exit) \
+  X(data_fini_entry) X(data_fini_exit) \
+  X(clone_entry) X(clone_exit) \
+  X(type_build_entry) X(type_build_exit) \
+  X(type_builder_init) \
+  X(type_builder_add_member)
+
+#define FASTRTPS_TRACEPOINT_SEMAPHORE(probe) \
+  rosidl_dynamic_typesupport_fastrtps_ ## probe ## _semaphore
+
+// Set by tracers while they are attached to a probe, see fastrtps_tracepoints.cpp
+#define FASTRTPS_DECLARE_TRACEPOINT_SEMAPHORE(probe) \
+  extern "C" unsigned short FASTRTPS_TRACEPOINT_SEMAPHORE(probe);
+FASTRTPS_TRACEPOINT_PROBES(FASTRTPS_DECLARE_TRACEPOINT_SEMAPHORE)
+#undef FASTRTPS_DECLARE_TRACEPOINT_SEMAPHORE
+
+/// Whether a tracer is attached to `probe`
+#define FASTRTPS_TRACEPOINT_ENABLED(probe) \
+  __builtin_expect(FASTRTPS_TRACEPOINT_SEMAPHORE(probe) != 0, 0)
+
+#define FASTRTPS_TRACEPOINT(probe, ...) \
+  STAP_PROBEV(rosidl_dynamic_typesupport_fastrtps, probe, __VA_ARGS__)
+
+/// Calls `on_exit` when it goes out of scope
+template<typename FunctionT>
+class fastrtps__tracepoint_exit_t
+{
+public:
+  explicit fastrtps__tracepoint_exit_t(FunctionT on_exit)
+  : on_exit_(on_exit) {}
+
+  ~fastrtps__tracepoint_exit_t()
+  {
+    on_exit_();
+  }
+
+  fastrtps__tracepoint_exit_t(const fastrtps__tracepoint_exit_t &) = delete;
+  fastrtps__tracepoint_exit_t & operator=(const fastrtps__tracepoint_exit_t &) = delete;
+
+private:
+  FunctionT on_exit_;
+};
+
+/// Hit `probe` when leaving the enclosing block, however it is left. Arguments are evaluated then
+#define FASTRTPS_TRACEPOINT_ON_EXIT(probe, ...) \
+  fastrtps__tracepoint_exit_t fastrtps__tracepoint_exit( \
+    [&]() {FASTRTPS_TRACEPOINT(probe, __VA_ARGS__);})
+
+#else
+
+#define FASTRTPS_TRACEPOINT_ENABLED(probe) false
+#define FASTRTPS_TRACEPOINT(probe, ...) ((void) 0)
+#define FASTRTPS_TRACEPOINT_ON_EXIT(probe, ...) ((void) 0)
+
+#endif  // ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_TRACEPOINTS
+
+/// Whether a tracer is attached to the entry or the exit probe of `operation`
+#define FASTRTPS_TRACEPOINTS_ENABLED(operation) \
+  (FASTRTPS_TRACEPOINT_ENABLED(operation ## _entry) || \
+  FASTRTPS_TRACEPOINT_ENABLED(operation ## _exit))
+
+
+#endif  // DETAIL__FASTRTPS_TRACEPOINTS_HPP_
@@ -0,0 +1,243 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_type_cache.hpp"
+
+#include <fastrtps/types/DynamicTypeBuilder.h>
+#include <fastrtps/types/DynamicTypeBuilderFactory.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::DynamicTypeBuilder;
+using eprosima::fastrtps::types::DynamicTypeBuilderFactory;
+using eprosima::fastrtps::types::TypeKind;
+
+
+// =================================================================================================
+// TYPE CACHE
+// =================================================================================================
+static DynamicType_ptr
+fastrtps__create_primitive_type(DynamicTypeBuilderFactory * type_factory, TypeKind kind)
+{
+  switch (kind) {
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+      return type_factory->create_bool_type();
+    case eprosima::fastrtps::types::TK_BYTE:
+      return type_factory->create_byte_type();
+    case eprosima::fastrtps::types::TK_CHAR8:
+      return type_factory->create_char8_type();
+    case eprosima::fastrtps::types::TK_CHAR16:
+      return type_factory->create_char16_type();
+    case eprosima::fastrtps::types::TK_FLOAT32:
+      return type_factory->create_float32_type();
+    case eprosima::fastrtps::types::TK_FLOAT64:
+      return type_factory->create_float64_type();
+    case eprosima::fastrtps::types::TK_FLOAT128:
+      return type_factory->create_float128_type();
+    case eprosima::fastrtps::types::TK_INT16:
+      return type_factory->create_int16_type();
+    case eprosima::fastrtps::types::TK_UINT16:
+      return type_factory->create_uint16_type();
+    case eprosima::fastrtps::types::TK_INT32:
+      return type_factory->create_int32_type();
+    case eprosima::fastrtps::types::TK_UINT32:
+      return type_factory->create_uint32_type();
+    case eprosima::fastrtps::types::TK_INT64:
+      return type_factory->create_int64_type();
+    case eprosima::fastrtps::types::TK_UINT64:
+      return type_factory->create_uint64_type();
+    default:
+      return DynamicType_ptr(nullptr);
+  }
+}
+
+
+// Builds the container from a temporary builder, which is released right away since only the
+// resulting type is cached
+static DynamicType_ptr
+fastrtps__build_and_delete_builder(
+  DynamicTypeBuilderFactory * type_factory, DynamicTypeBuilder * builder)
+{
+  if (!builder) {
+    return DynamicType_ptr(nullptr);
+  }
+  DynamicType_ptr out = builder->build();
+  type_factory->delete_builder(builder);
+  return out;
+}
+
+
+// Only containers of primitive and string elements are shared. Those element types come from the
+// cache themselves, so their address is stable; a struct element belongs to a type handle that can
+// be finalized (and its address reused) long before the serialization support is
+static bool
+fastrtps__type_cache_is_cached_element(const DynamicType_ptr & element_type)
+{
+  switch (element_type->get_kind()) {
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+    case eprosima::fastrtps::types::TK_BYTE:
+    case eprosima::fastrtps::types::TK_CHAR8:
+    case eprosima::fastrtps::types::TK_CHAR16:
+    case eprosima::fastrtps::types::TK_FLOAT32:
+    case eprosima::fastrtps::types::TK_FLOAT64:
+    case eprosima::fastrtps::types::TK_FLOAT128:
+    case eprosima::fastrtps::types::TK_INT16:
+    case eprosima::fastrtps::types::TK_UINT16:
+    case eprosima::fastrtps::types::TK_INT32:
+    case eprosima::fastrtps::types::TK_UINT32:
+    case eprosima::fastrtps::types::TK_INT64:
+    case eprosima::fastrtps::types::TK_UINT64:
+    case eprosima::fastrtps::types::TK_STRING8:
+    case eprosima::fastrtps::types::TK_STRING16:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+DynamicType_ptr
+fastrtps__type_cache_get_primitive_type(
+  fastrtps__type_cache_t * cache, DynamicTypeBuilderFactory * type_factory, TypeKind kind)
+{
+  std::lock_guard<std::mutex> lock(cache->mutex_);
+  auto it = cache->primitive_types_.find(kind);
+  if (it != cache->primitive_types_.end()) {
+    return it->second;
+  }
+
+  DynamicType_ptr out = fastrtps__create_primitive_type(type_factory, kind);
+  if (out) {
+    cache->primitive_types_.emplace(kind, out);
+  }
+  return out;
+}
+
+
+DynamicType_ptr
+fastrtps__type_cache_get_string_type(
+  fastrtps__type_cache_t * cache, DynamicTypeBuilderFactory * type_factory, uint32_t string_bound)
+{
+  std::lock_guard<std::mutex> lock(cache->mutex_);
+  auto it = cache->string_types_.find(string_bound);
+  if (it != cache->string_types_.end()) {
+    return it->second;
+  }
+
+  DynamicType_ptr out = type_factory->create_string_type(string_bound);
+  if (out) {
+    cache->string_types_.emplace(string_bound, out);
+  }
+  return out;
+}
+
+
+DynamicType_ptr
+fastrtps__type_cache_get_wstring_type(
+  fastrtps__type_cache_t * cache, DynamicTypeBuilderFactory * type_factory, uint32_t wstring_bound)
+{
+  std::lock_guard<std::mutex> lock(cache->mutex_);
+  auto it = cache->wstring_types_.find(wstring_bound);
+  if (it != cache->wstring_types_.end()) {
+    return it->second;
+  }
+
+  DynamicType_ptr out = type_factory->create_wstring_type(wstring_bound);
+  if (out) {
+    cache->wstring_types_.emplace(wstring_bound, out);
+  }
+  return out;
+}
+
+
+DynamicType_ptr
+fastrtps__type_cache_get_array_type(
+  fastrtps__type_cache_t * cache,
+  DynamicTypeBuilderFactory * type_factory,
+  const DynamicType_ptr & element_type,
+  uint32_t array_length)
+{
+  if (!element_type) {
+    return DynamicType_ptr(nullptr);
+  }
+  if (!fastrtps__type_cache_is_cached_element(element_type)) {
+    return fastrtps__build_and_delete_builder(
+      type_factory, type_factory->create_array_builder(element_type, {array_length}));
+  }
+
+  std::lock_guard<std::mutex> lock(cache->mutex_);
+  fastrtps__type_cache_t::container_key_t key(element_type.get(), array_length);
+  auto it = cache->array_types_.find(key);
+  if (it != cache->array_types_.end()) {
+    return it->second;
+  }
+
+  DynamicType_ptr out = fastrtps__build_and_delete_builder(
+    type_factory, type_factory->create_array_builder(element_type, {array_length}));
+  if (out) {
+    cache->array_types_.emplace(key, out);
+  }
+  return out;
+}
+
+
+DynamicType_ptr
+fastrtps__type_cache_get_sequence_type(
+  fastrtps__type_cache_t * cache,
+  DynamicTypeBuilderFactory * type_factory,
+  const DynamicType_ptr & element_type,
+  uint32_t sequence_bound)
+{
+  if (!element_type) {
+    return DynamicType_ptr(nullptr);
+  }
+  if (!fastrtps__type_cache_is_cached_element(element_type)) {
+    return fastrtps__build_and_delete_builder(
+      type_factory, type_factory->create_sequence_builder(element_type, sequence_bound));
+  }
+
+  std::lock_guard<std::mutex> lock(cache->mutex_);
+  fastrtps__type_cache_t::container_key_t key(element_type.get(), sequence_bound);
+  auto it = cache->sequence_types_.find(key);
+  if (it != cache->sequence_types_.end()) {
+    return it->second;
+  }
+
+  DynamicType_ptr out = fastrtps__build_and_delete_builder(
+    type_factory, type_factory->create_sequence_builder(element_type, sequence_bound));
+  if (out) {
+    cache->sequence_types_.emplace(key, out);
+  }
+  return out;
+}
+
+
+void
+fastrtps__type_cache_clear(fastrtps__type_cache_t * cache)
+{
+  std::lock_guard<std::mutex> lock(cache->mutex_);
+
+  // Containers hold references to their element types, so they go first
+  cache->sequence_types_.clear();
+  cache->array_types_.clear();
+  cache->wstring_types_.clear();
+  cache->string_types_.clear();
+  cache->primitive_types_.clear();
+}
@@ -0,0 +1,112 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_TYPE_CACHE_HPP_
+#define DETAIL__FASTRTPS_TYPE_CACHE_HPP_
+
+#include <fastrtps/types/DynamicTypeBuilderFactory.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+
+// =================================================================================================
+// TYPE CACHE
+// =================================================================================================
+
+/// Cache of the member types handed out while building dynamic types
+/**
+ * Primitive, string and container types are immutable once built, so every member that uses the
+ * same (element, bound) combination can share a single instance instead of asking the type factory
+ * for a new one.
+ *
+ * Containers are keyed by the address of their element type, and only cached when that element
+ * type is itself a cached primitive or string type. Containers of structs (or of other containers)
+ * are built anew on every call, so a struct type is never pinned past its own handle.
+ */
+typedef struct fastrtps__type_cache_s
+{
+  using container_key_t = std::pair<const eprosima::fastrtps::types::DynamicType *, uint32_t>;
+
+  std::mutex mutex_;
+  std::unordered_map<
+    eprosima::fastrtps::types::TypeKind, eprosima::fastrtps::types::DynamicType_ptr
+  > primitive_types_;
+  std::unordered_map<uint32_t, eprosima::fastrtps::types::DynamicType_ptr> string_types_;
+  std::unordered_map<uint32_t, eprosima::fastrtps::types::DynamicType_ptr> wstring_types_;
+  std::map<container_key_t, eprosima::fastrtps::types::DynamicType_ptr> array_types_;
+  std::map<container_key_t, eprosima::fastrtps::types::DynamicType_ptr> sequence_types_;
+} fastrtps__type_cache_t;
+
+
+/// Get the shared primitive type of `kind`, creating it on first use
+/// Returns an empty pointer if `kind` is not a primitive kind, or the type could not be created
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+eprosima::fastrtps::types::DynamicType_ptr
+fastrtps__type_cache_get_primitive_type(
+  fastrtps__type_cache_t * cache,
+  eprosima::fastrtps::types::DynamicTypeBuilderFactory * type_factory,
+  eprosima::fastrtps::types::TypeKind kind);
+
+/// Get the shared string type with bound `string_bound` (0 is unbounded)
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+eprosima::fastrtps::types::DynamicType_ptr
+fastrtps__type_cache_get_string_type(
+  fastrtps__type_cache_t * cache,
+  eprosima::fastrtps::types::DynamicTypeBuilderFactory * type_factory,
+  uint32_t string_bound);
+
+/// Get the shared wstring type with bound `wstring_bound` (0 is unbounded)
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+eprosima::fastrtps::types::DynamicType_ptr
+fastrtps__type_cache_get_wstring_type(
+  fastrtps__type_cache_t * cache,
+  eprosima::fastrtps::types::DynamicTypeBuilderFactory * type_factory,
+  uint32_t wstring_bound);
+
+/// Get the shared array type of `array_length` elements of `element_type`
+/// Only shared if `element_type` is a primitive or string type, built anew otherwise
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+eprosima::fastrtps::types::DynamicType_ptr
+fastrtps__type_cache_get_array_type(
+  fastrtps__type_cache_t * cache,
+  eprosima::fastrtps::types::DynamicTypeBuilderFactory * type_factory,
+  const eprosima::fastrtps::types::DynamicType_ptr & element_type,
+  uint32_t array_length);
+
+/// Get the shared sequence type of `element_type`, bounded by `sequence_bound` (0 is unbounded)
+/// Only shared if `element_type` is a primitive or string type, built anew otherwise
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+eprosima::fastrtps::types::DynamicType_ptr
+fastrtps__type_cache_get_sequence_type(
+  fastrtps__type_cache_t * cache,
+  eprosima::fastrtps::types::DynamicTypeBuilderFactory * type_factory,
+  const eprosima::fastrtps::types::DynamicType_ptr & element_type,
+  uint32_t sequence_bound);
+
+/// Drop every cached type
+/// Must be called before the type factory that created the cached types is deleted
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+void
+fastrtps__type_cache_clear(fastrtps__type_cache_t * cache);
+
+
+#endif  // DETAIL__FASTRTPS_TYPE_CACHE_HPP_
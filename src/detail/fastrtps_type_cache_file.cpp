@@ -0,0 +1,775 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_type_cache_file.hpp"
+
+#include <fastrtps/config.h>
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypeBuilder.h>
+#include <fastrtps/types/DynamicTypeMember.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypeDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fastrtps_type_cache.hpp"
+#include "fastrtps_type_fingerprint.hpp"
+#include "utils.hpp"
+
+
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::DynamicTypeBuilder;
+using eprosima::fastrtps::types::DynamicTypeMember;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::TypeDescriptor;
+using eprosima::fastrtps::types::TypeKind;
+
+
+typedef struct fastrtps__type_cache_file_header_s
+{
+  char magic[8];
+  uint32_t format_version;
+  uint16_t fastrtps_major;
+  uint16_t fastrtps_minor;
+  uint32_t entry_count;
+  uint32_t reserved;
+  uint64_t file_size;
+} fastrtps__type_cache_file_header_t;
+
+typedef struct fastrtps__type_cache_file_entry_s
+{
+  uint64_t fingerprint[2];
+  uint32_t name_offset;
+  uint32_t name_length;
+  uint32_t record_offset;
+  uint32_t record_length;
+} fastrtps__type_cache_file_entry_t;
+
+static_assert(sizeof(fastrtps__type_cache_file_header_t) == 32, "Unexpected header padding");
+static_assert(sizeof(fastrtps__type_cache_file_entry_t) == 32, "Unexpected entry padding");
+
+
+// =================================================================================================
+// TYPE CACHE FILE
+// =================================================================================================
+
+// ENCODING ========================================================================================
+static void
+fastrtps__type_cache_file_append_u32(std::string & out, uint32_t value)
+{
+  out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+
+static void
+fastrtps__type_cache_file_append_u64(std::string & out, uint64_t value)
+{
+  out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+
+static void
+fastrtps__type_cache_file_append_string(std::string & out, const std::string & value)
+{
+  fastrtps__type_cache_file_append_u32(out, fastrtps__size_t_to_uint32_t(value.size()));
+  out.append(value);
+}
+
+
+static rcutils_ret_t
+fastrtps__type_cache_file_encode(std::string & out, const DynamicType_ptr & type, int depth)
+{
+  if (!type) {
+    RCUTILS_SET_ERROR_MSG("Could not encode empty type for type cache file");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  // The reader would reject it
+  if (depth >= FASTRTPS_TYPE_CACHE_FILE_MAX_DEPTH) {
+    RCUTILS_SET_ERROR_MSG("Type is nested too deep for a type cache file");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+
+  TypeDescriptor descriptor;
+  type->get_descriptor(&descriptor);
+  TypeKind kind = descriptor.get_kind();
+  out.push_back(static_cast<char>(kind));
+
+  switch (kind) {
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+    case eprosima::fastrtps::types::TK_BYTE:
+    case eprosima::fastrtps::types::TK_CHAR8:
+    case eprosima::fastrtps::types::TK_CHAR16:
+    case eprosima::fastrtps::types::TK_FLOAT32:
+    case eprosima::fastrtps::types::TK_FLOAT64:
+    case eprosima::fastrtps::types::TK_FLOAT128:
+    case eprosima::fastrtps::types::TK_INT16:
+    case eprosima::fastrtps::types::TK_UINT16:
+    case eprosima::fastrtps::types::TK_INT32:
+    case eprosima::fastrtps::types::TK_UINT32:
+    case eprosima::fastrtps::types::TK_INT64:
+    case eprosima::fastrtps::types::TK_UINT64:
+      return RCUTILS_RET_OK;
+
+    case eprosima::fastrtps::types::TK_STRING8:
+    case eprosima::fastrtps::types::TK_STRING16:
+      fastrtps__type_cache_file_append_u32(out, descriptor.get_bounds(0));
+      return RCUTILS_RET_OK;
+
+    case eprosima::fastrtps::types::TK_ARRAY:
+      {
+        uint32_t bounds_size = descriptor.get_bounds_size();
+        fastrtps__type_cache_file_append_u32(out, bounds_size);
+        for (uint32_t i = 0; i < bounds_size; ++i) {
+          fastrtps__type_cache_file_append_u32(out, descriptor.get_bounds(i));
+        }
+        return fastrtps__type_cache_file_encode(out, descriptor.get_element_type(), depth + 1);
+      }
+
+    case eprosima::fastrtps::types::TK_SEQUENCE:
+      fastrtps__type_cache_file_append_u32(out, descriptor.get_bounds(0));
+      return fastrtps__type_cache_file_encode(out, descriptor.get_element_type(), depth + 1);
+
+    case eprosima::fastrtps::types::TK_STRUCTURE:
+      {
+        fastrtps__type_cache_file_append_string(out, descriptor.get_name());
+        fastrtps__type_fingerprint_t fingerprint = fastrtps__type_fingerprint_compute(type);
+        fastrtps__type_cache_file_append_u64(out, fingerprint.hash[0]);
+        fastrtps__type_cache_file_append_u64(out, fingerprint.hash[1]);
+
+        // Body length is patched in once the members are written
+        size_t body_length_pos = out.size();
+        fastrtps__type_cache_file_append_u32(out, 0);
+        size_t body_start = out.size();
+
+        std::map<MemberId, DynamicTypeMember *> members;
+        type->get_all_members(members);
+        fastrtps__type_cache_file_append_u32(out, fastrtps__size_t_to_uint32_t(members.size()));
+        for (const auto & it : members) {
+          MemberDescriptor member_descriptor;
+          it.second->get_descriptor(&member_descriptor);
+
+          fastrtps__type_cache_file_append_u32(out, member_descriptor.get_id());
+          fastrtps__type_cache_file_append_string(out, member_descriptor.get_name());
+          fastrtps__type_cache_file_append_string(out, member_descriptor.get_default_value());
+          rcutils_ret_t ret = fastrtps__type_cache_file_encode(
+            out, member_descriptor.get_type(), depth + 1);
+          if (ret != RCUTILS_RET_OK) {
+            return ret;
+          }
+        }
+
+        uint32_t body_length = fastrtps__size_t_to_uint32_t(out.size() - body_start);
+        std::memcpy(&out[body_length_pos], &body_length, sizeof(body_length));
+        return RCUTILS_RET_OK;
+      }
+
+    default:
+      RCUTILS_SET_ERROR_MSG("Type cache files do not support this type kind");
+      return RCUTILS_RET_ERROR;
+  }
+}
+
+
+// DECODING ========================================================================================
+typedef struct fastrtps__type_cache_file_reader_s
+{
+  const uint8_t * cur;
+  const uint8_t * end;
+} fastrtps__type_cache_file_reader_t;
+
+
+static bool
+fastrtps__type_cache_file_read_u32(fastrtps__type_cache_file_reader_t * reader, uint32_t * out)
+{
+  if (static_cast<size_t>(reader->end - reader->cur) < sizeof(*out)) {
+    return false;
+  }
+  std::memcpy(out, reader->cur, sizeof(*out));
+  reader->cur += sizeof(*out);
+  return true;
+}
+
+
+static bool
+fastrtps__type_cache_file_read_u64(fastrtps__type_cache_file_reader_t * reader, uint64_t * out)
+{
+  if (static_cast<size_t>(reader->end - reader->cur) < sizeof(*out)) {
+    return false;
+  }
+  std::memcpy(out, reader->cur, sizeof(*out));
+  reader->cur += sizeof(*out);
+  return true;
+}
+
+
+static bool
+fastrtps__type_cache_file_read_string(
+  fastrtps__type_cache_file_reader_t * reader, std::string * out)
+{
+  uint32_t length;
+  if (!fastrtps__type_cache_file_read_u32(reader, &length) ||
+    static_cast<size_t>(reader->end - reader->cur) < length)
+  {
+    return false;
+  }
+  out->assign(reinterpret_cast<const char *>(reader->cur), length);
+  reader->cur += length;
+  return true;
+}
+
+
+static DynamicType_ptr
+fastrtps__type_cache_file_build_and_delete_builder(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl, DynamicTypeBuilder * builder)
+{
+  if (!builder) {
+    return DynamicType_ptr(nullptr);
+  }
+  DynamicType_ptr out = builder->build();
+  fastrtps_impl->type_factory_->delete_builder(builder);
+  return out;
+}
+
+
+// Returns an empty type if the record is malformed, nested too deep, or holds a struct that does
+// not match its fingerprint
+// Must be called with cache_file->mutex_ held
+static DynamicType_ptr
+fastrtps__type_cache_file_decode(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl,
+  fastrtps__type_cache_file_t * cache_file,
+  fastrtps__type_cache_file_reader_t * reader,
+  int depth)
+{
+  if (reader->cur == reader->end || depth >= FASTRTPS_TYPE_CACHE_FILE_MAX_DEPTH) {
+    return DynamicType_ptr(nullptr);
+  }
+  TypeKind kind = *reader->cur++;
+
+  switch (kind) {
+    case eprosima::fastrtps::types::TK_BOOLEAN:
+    case eprosima::fastrtps::types::TK_BYTE:
+    case eprosima::fastrtps::types::TK_CHAR8:
+    case eprosima::fastrtps::types::TK_CHAR16:
+    case eprosima::fastrtps::types::TK_FLOAT32:
+    case eprosima::fastrtps::types::TK_FLOAT64:
+    case eprosima::fastrtps::types::TK_FLOAT128:
+    case eprosima::fastrtps::types::TK_INT16:
+    case eprosima::fastrtps::types::TK_UINT16:
+    case eprosima::fastrtps::types::TK_INT32:
+    case eprosima::fastrtps::types::TK_UINT32:
+    case eprosima::fastrtps::types::TK_INT64:
+    case eprosima::fastrtps::types::TK_UINT64:
+      return fastrtps__type_cache_get_primitive_type(
+        &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, kind);
+
+    case eprosima::fastrtps::types::TK_STRING8:
+    case eprosima::fastrtps::types::TK_STRING16:
+      {
+        uint32_t bound;
+        if (!fastrtps__type_cache_file_read_u32(reader, &bound)) {
+          return DynamicType_ptr(nullptr);
+        }
+        if (kind == eprosima::fastrtps::types::TK_STRING8) {
+          return fastrtps__type_cache_get_string_type(
+            &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, bound);
+        }
+        return fastrtps__type_cache_get_wstring_type(
+          &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, bound);
+      }
+
+    case eprosima::fastrtps::types::TK_ARRAY:
+      {
+        uint32_t bounds_size;
+        if (!fastrtps__type_cache_file_read_u32(reader, &bounds_size) ||
+          static_cast<size_t>(reader->end - reader->cur) / sizeof(uint32_t) < bounds_size)
+        {
+          return DynamicType_ptr(nullptr);
+        }
+        std::vector<uint32_t> bounds(bounds_size);
+        for (uint32_t i = 0; i < bounds_size; ++i) {
+          fastrtps__type_cache_file_read_u32(reader, &bounds[i]);
+        }
+        DynamicType_ptr element_type =
+          fastrtps__type_cache_file_decode(fastrtps_impl, cache_file, reader, depth + 1);
+        if (!element_type) {
+          return DynamicType_ptr(nullptr);
+        }
+        if (bounds_size == 1) {
+          return fastrtps__type_cache_get_array_type(
+            &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, element_type, bounds[0]);
+        }
+        return fastrtps__type_cache_file_build_and_delete_builder(
+          fastrtps_impl, fastrtps_impl->type_factory_->create_array_builder(element_type, bounds));
+      }
+
+    case eprosima::fastrtps::types::TK_SEQUENCE:
+      {
+        uint32_t bound;
+        if (!fastrtps__type_cache_file_read_u32(reader, &bound)) {
+          return DynamicType_ptr(nullptr);
+        }
+        DynamicType_ptr element_type =
+          fastrtps__type_cache_file_decode(fastrtps_impl, cache_file, reader, depth + 1);
+        if (!element_type) {
+          return DynamicType_ptr(nullptr);
+        }
+        return fastrtps__type_cache_get_sequence_type(
+          &fastrtps_impl->type_cache_, fastrtps_impl->type_factory_, element_type, bound);
+      }
+
+    case eprosima::fastrtps::types::TK_STRUCTURE:
+      {
+        std::string name;
+        fastrtps__type_fingerprint_t fingerprint;
+        uint32_t body_length;
+        if (!fastrtps__type_cache_file_read_string(reader, &name) ||
+          !fastrtps__type_cache_file_read_u64(reader, &fingerprint.hash[0]) ||
+          !fastrtps__type_cache_file_read_u64(reader, &fingerprint.hash[1]) ||
+          !fastrtps__type_cache_file_read_u32(reader, &body_length) ||
+          static_cast<size_t>(reader->end - reader->cur) < body_length)
+        {
+          return DynamicType_ptr(nullptr);
+        }
+        const uint8_t * body_end = reader->cur + body_length;
+
+        // Only verified types are kept, so a hit is the type the fingerprint stands for
+        auto it = cache_file->struct_types_.find(fingerprint);
+        if (it != cache_file->struct_types_.end()) {
+          reader->cur = body_end;
+          return it->second;
+        }
+
+        fastrtps__type_cache_file_reader_t body_reader = {reader->cur, body_end};
+        uint32_t member_count;
+        if (!fastrtps__type_cache_file_read_u32(&body_reader, &member_count)) {
+          return DynamicType_ptr(nullptr);
+        }
+
+        DynamicTypeBuilder * builder = fastrtps_impl->type_factory_->create_struct_builder();
+        if (!builder) {
+          return DynamicType_ptr(nullptr);
+        }
+        bool ok = builder->set_name(name) == eprosima::fastrtps::types::ReturnCode_t::RETCODE_OK;
+        for (uint32_t i = 0; ok && i < member_count; ++i) {
+          uint32_t id;
+          std::string member_name;
+          std::string default_value;
+          ok = fastrtps__type_cache_file_read_u32(&body_reader, &id) &&
+            fastrtps__type_cache_file_read_string(&body_reader, &member_name) &&
+            fastrtps__type_cache_file_read_string(&body_reader, &default_value);
+          if (!ok) {
+            break;
+          }
+          DynamicType_ptr member_type =
+            fastrtps__type_cache_file_decode(fastrtps_impl, cache_file, &body_reader, depth + 1);
+          ok = member_type && builder->add_member(id, member_name, member_type, default_value) ==
+            eprosima::fastrtps::types::ReturnCode_t::RETCODE_OK;
+        }
+        if (!ok || body_reader.cur != body_end) {
+          fastrtps_impl->type_factory_->delete_builder(builder);
+          return DynamicType_ptr(nullptr);
+        }
+
+        DynamicType_ptr out = fastrtps__type_cache_file_build_and_delete_builder(
+          fastrtps_impl, builder);
+        if (!out) {
+          return DynamicType_ptr(nullptr);
+        }
+        // A stale or corrupt record must not pass for the type it claims to be
+        fastrtps__type_fingerprint_t computed = fastrtps__type_fingerprint_compute(out);
+        if (!fastrtps__type_fingerprint_equal(&computed, &fingerprint)) {
+          return DynamicType_ptr(nullptr);
+        }
+        cache_file->struct_types_.emplace(fingerprint, out);
+        reader->cur = body_end;
+        return out;
+      }
+
+    default:
+      return DynamicType_ptr(nullptr);
+  }
+}
+
+
+// WRITE ===========================================================================================
+rcutils_ret_t
+fastrtps__type_cache_file_write(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl,
+  const char * path,
+  fastrtps__dynamic_type_handle_t * const * type_handles,
+  size_t type_count)
+{
+  struct pending_entry_t
+  {
+    std::string name;
+    std::string record;
+    fastrtps__type_fingerprint_t fingerprint;
+  };
+
+  std::vector<pending_entry_t> pending(type_count);
+  for (size_t i = 0; i < type_count; ++i) {
+    const DynamicType_ptr & type =
+      fastrtps__dynamic_type_handle_get_type(fastrtps_impl, type_handles[i]);
+    if (!type) {
+      RCUTILS_SET_ERROR_MSG("Could not build lazy type for type cache file");
+      return RCUTILS_RET_ERROR;
+    }
+    pending[i].name = fastrtps__replace_string(type->get_name(), "::", "/");
+    pending[i].fingerprint = type_handles[i]->fingerprint_;
+    rcutils_ret_t ret = fastrtps__type_cache_file_encode(pending[i].record, type, 0);
+    if (ret != RCUTILS_RET_OK) {
+      return ret;
+    }
+  }
+
+  // Sorted by name so that lookups can binary search the entry table
+  std::sort(
+    pending.begin(), pending.end(),
+    [](const pending_entry_t & a, const pending_entry_t & b) {return a.name < b.name;});
+  for (size_t i = 1; i < pending.size(); ++i) {
+    if (pending[i - 1].name == pending[i].name) {
+      RCUTILS_SET_ERROR_MSG("Type cache file cannot hold two types with the same name");
+      return RCUTILS_RET_INVALID_ARGUMENT;
+    }
+  }
+
+  size_t blob_offset = sizeof(fastrtps__type_cache_file_header_t) +
+    type_count * sizeof(fastrtps__type_cache_file_entry_t);
+  size_t file_size = blob_offset;
+  for (const auto & entry : pending) {
+    file_size += entry.name.size() + entry.record.size();
+  }
+  if (file_size > UINT32_MAX) {
+    RCUTILS_SET_ERROR_MSG("Type cache file would exceed 4 GiB");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+
+  std::string image;
+  image.reserve(file_size);
+
+  fastrtps__type_cache_file_header_t header;
+  std::memcpy(header.magic, FASTRTPS_TYPE_CACHE_FILE_MAGIC, sizeof(header.magic));
+  header.format_version = FASTRTPS_TYPE_CACHE_FILE_FORMAT_VERSION;
+  header.fastrtps_major = FASTRTPS_VERSION_MAJOR;
+  header.fastrtps_minor = FASTRTPS_VERSION_MINOR;
+  header.entry_count = fastrtps__size_t_to_uint32_t(type_count);
+  header.reserved = 0;
+  header.file_size = file_size;
+  image.append(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  size_t offset = blob_offset;
+  for (const auto & pending_entry : pending) {
+    fastrtps__type_cache_file_entry_t entry;
+    entry.fingerprint[0] = pending_entry.fingerprint.hash[0];
+    entry.fingerprint[1] = pending_entry.fingerprint.hash[1];
+    entry.name_offset = fastrtps__size_t_to_uint32_t(offset);
+    entry.name_length = fastrtps__size_t_to_uint32_t(pending_entry.name.size());
+    offset += pending_entry.name.size();
+    entry.record_offset = fastrtps__size_t_to_uint32_t(offset);
+    entry.record_length = fastrtps__size_t_to_uint32_t(pending_entry.record.size());
+    offset += pending_entry.record.size();
+    image.append(reinterpret_cast<const char *>(&entry), sizeof(entry));
+  }
+  for (const auto & pending_entry : pending) {
+    image.append(pending_entry.name);
+    image.append(pending_entry.record);
+  }
+
+  // Write to a temporary file and rename it over the target, so readers never see a partial file
+  std::string tmp_path = std::string(path) + ".tmp";
+  FILE * file = std::fopen(tmp_path.c_str(), "wb");
+  if (!file) {
+    RCUTILS_SET_ERROR_MSG("Could not open type cache file for writing");
+    return RCUTILS_RET_ERROR;
+  }
+  bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+  written = (std::fclose(file) == 0) && written;
+  if (!written) {
+    std::remove(tmp_path.c_str());
+    RCUTILS_SET_ERROR_MSG("Could not write type cache file");
+    return RCUTILS_RET_ERROR;
+  }
+
+#ifdef _WIN32
+  // rename does not replace existing files on Windows
+  std::remove(path);
+#endif
+  if (std::rename(tmp_path.c_str(), path) != 0) {
+    std::remove(tmp_path.c_str());
+    RCUTILS_SET_ERROR_MSG("Could not move type cache file into place");
+    return RCUTILS_RET_ERROR;
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+// OPEN ============================================================================================
+// Only checks the header and the entry table. Records are checked as they are decoded, which also
+// bounds their nesting
+static rcutils_ret_t
+fastrtps__type_cache_file_validate(const uint8_t * data, size_t size)
+{
+  fastrtps__type_cache_file_header_t header;
+  if (size < sizeof(header)) {
+    RCUTILS_SET_ERROR_MSG("Type cache file is truncated");
+    return RCUTILS_RET_ERROR;
+  }
+  std::memcpy(&header, data, sizeof(header));
+
+  if (std::memcmp(header.magic, FASTRTPS_TYPE_CACHE_FILE_MAGIC, sizeof(header.magic)) != 0) {
+    RCUTILS_SET_ERROR_MSG("File is not a type cache file");
+    return RCUTILS_RET_ERROR;
+  }
+  if (header.format_version != FASTRTPS_TYPE_CACHE_FILE_FORMAT_VERSION ||
+    header.fastrtps_major != FASTRTPS_VERSION_MAJOR ||
+    header.fastrtps_minor != FASTRTPS_VERSION_MINOR)
+  {
+    RCUTILS_SET_ERROR_MSG("Type cache file was written by an incompatible version");
+    return RCUTILS_RET_ERROR;
+  }
+  if (header.file_size != size ||
+    (size - sizeof(header)) / sizeof(fastrtps__type_cache_file_entry_t) < header.entry_count)
+  {
+    RCUTILS_SET_ERROR_MSG("Type cache file is truncated");
+    return RCUTILS_RET_ERROR;
+  }
+
+  // Check every range once here, so lookups can trust the entry table
+  const uint8_t * entries = data + sizeof(header);
+  for (uint32_t i = 0; i < header.entry_count; ++i) {
+    fastrtps__type_cache_file_entry_t entry;
+    std::memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+    if (static_cast<uint64_t>(entry.name_offset) + entry.name_length > size ||
+      static_cast<uint64_t>(entry.record_offset) + entry.record_length > size)
+    {
+      RCUTILS_SET_ERROR_MSG("Type cache file entry is out of bounds");
+      return RCUTILS_RET_ERROR;
+    }
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__type_cache_file_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  fastrtps__type_cache_file_t ** cache_file)
+{
+  const uint8_t * data = NULL;
+  size_t size = 0;
+  bool mapped = false;
+
+#ifndef _WIN32
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return RCUTILS_RET_NOT_FOUND;
+    }
+    RCUTILS_SET_ERROR_MSG("Could not open type cache file");
+    return RCUTILS_RET_ERROR;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    RCUTILS_SET_ERROR_MSG("Could not stat type cache file");
+    return RCUTILS_RET_ERROR;
+  }
+  size = static_cast<size_t>(file_stat.st_size);
+  if (size > 0) {
+    void * map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      close(fd);
+      RCUTILS_SET_ERROR_MSG("Could not map type cache file");
+      return RCUTILS_RET_ERROR;
+    }
+    data = static_cast<const uint8_t *>(map);
+    mapped = true;
+  }
+  close(fd);  // The mapping stays valid after the descriptor is closed
+#else
+  // No mmap here, read the whole file instead
+  FILE * file = std::fopen(path, "rb");
+  if (!file) {
+    return RCUTILS_RET_NOT_FOUND;
+  }
+  std::fseek(file, 0, SEEK_END);
+  long file_size = std::ftell(file);  // NOLINT(runtime/int)
+  std::fseek(file, 0, SEEK_SET);
+  if (file_size > 0) {
+    size = static_cast<size_t>(file_size);
+    void * buffer = allocator->allocate(size, allocator->state);
+    if (!buffer) {
+      std::fclose(file);
+      RCUTILS_SET_ERROR_MSG("Could not allocate buffer for type cache file");
+      return RCUTILS_RET_BAD_ALLOC;
+    }
+    if (std::fread(buffer, 1, size, file) != size) {
+      allocator->deallocate(buffer, allocator->state);
+      std::fclose(file);
+      RCUTILS_SET_ERROR_MSG("Could not read type cache file");
+      return RCUTILS_RET_ERROR;
+    }
+    data = static_cast<const uint8_t *>(buffer);
+  }
+  std::fclose(file);
+#endif
+
+  rcutils_ret_t ret = fastrtps__type_cache_file_validate(data, size);
+  void * cache_file_mem = NULL;
+  if (ret == RCUTILS_RET_OK) {
+    cache_file_mem = allocator->allocate(sizeof(fastrtps__type_cache_file_t), allocator->state);
+    if (!cache_file_mem) {
+      RCUTILS_SET_ERROR_MSG("Could not allocate type cache file");
+      ret = RCUTILS_RET_BAD_ALLOC;
+    }
+  }
+  if (ret != RCUTILS_RET_OK) {
+#ifndef _WIN32
+    if (mapped) {
+      munmap(const_cast<uint8_t *>(data), size);
+    }
+#else
+    allocator->deallocate(const_cast<uint8_t *>(data), allocator->state);
+#endif
+    return ret;
+  }
+
+  // Holds C++ members, so it must be constructed in place
+  auto out = new (cache_file_mem) fastrtps__type_cache_file_t();
+  out->allocator_ = *allocator;
+  out->data_ = data;
+  out->size_ = size;
+  out->mapped_ = mapped;
+  *cache_file = out;
+  return RCUTILS_RET_OK;
+}
+
+
+// GET TYPE ========================================================================================
+rcutils_ret_t
+fastrtps__type_cache_file_get_type(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl,
+  fastrtps__type_cache_file_t * cache_file,
+  const char * name, size_t name_length,
+  fastrtps__dynamic_type_handle_t ** type_handle)
+{
+  fastrtps__type_cache_file_header_t header;
+  std::memcpy(&header, cache_file->data_, sizeof(header));
+  const uint8_t * entries = cache_file->data_ + sizeof(header);
+
+  // Binary search over the name-sorted entry table
+  fastrtps__type_cache_file_entry_t entry;
+  bool found = false;
+  uint32_t lo = 0;
+  uint32_t hi = header.entry_count;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    std::memcpy(&entry, entries + mid * sizeof(entry), sizeof(entry));
+
+    int cmp = std::memcmp(
+      cache_file->data_ + entry.name_offset, name,
+      std::min<size_t>(entry.name_length, name_length));
+    if (cmp == 0) {
+      cmp = (entry.name_length < name_length) ? -1 : (entry.name_length > name_length ? 1 : 0);
+    }
+    if (cmp == 0) {
+      found = true;
+      break;
+    } else if (cmp < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (!found) {
+    return RCUTILS_RET_NOT_FOUND;
+  }
+
+  fastrtps__type_fingerprint_t fingerprint = {{entry.fingerprint[0], entry.fingerprint[1]}};
+  DynamicType_ptr type;
+  bool verified = false;
+  {
+    std::lock_guard<std::mutex> lock(cache_file->mutex_);
+    fastrtps__type_cache_file_reader_t reader = {
+      cache_file->data_ + entry.record_offset,
+      cache_file->data_ + entry.record_offset + entry.record_length
+    };
+    type = fastrtps__type_cache_file_decode(fastrtps_impl, cache_file, &reader, 0);
+
+    // Structs were checked against their fingerprint as they were decoded
+    auto it = cache_file->struct_types_.find(fingerprint);
+    verified = it != cache_file->struct_types_.end() && it->second == type;
+  }
+  if (type && !verified) {
+    fastrtps__type_fingerprint_t computed = fastrtps__type_fingerprint_compute(type);
+    verified = fastrtps__type_fingerprint_equal(&computed, &fingerprint);
+  }
+  if (!type || !verified) {
+    RCUTILS_SET_ERROR_MSG(
+      "Could not rehydrate type from type cache file, the file is stale or corrupt");
+    return RCUTILS_RET_ERROR;
+  }
+
+  auto out = new fastrtps__dynamic_type_handle_t;
+  out->type_ = std::move(type);
+  out->fingerprint_ = fingerprint;
+  *type_handle = out;
+  return RCUTILS_RET_OK;
+}
+
+
+// FINI ============================================================================================
+rcutils_ret_t
+fastrtps__type_cache_file_fini(fastrtps__type_cache_file_t * cache_file)
+{
+  rcutils_allocator_t allocator = cache_file->allocator_;
+
+#ifndef _WIN32
+  if (cache_file->mapped_) {
+    munmap(const_cast<uint8_t *>(cache_file->data_), cache_file->size_);
+  }
+#else
+  allocator.deallocate(const_cast<uint8_t *>(cache_file->data_), allocator.state);
+#endif
+
+  cache_file->~fastrtps__type_cache_file_t();
+  allocator.deallocate(cache_file, allocator.state);
+  return RCUTILS_RET_OK;
+}
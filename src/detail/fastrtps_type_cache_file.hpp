@@ -0,0 +1,135 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_TYPE_CACHE_FILE_HPP_
+#define DETAIL__FASTRTPS_TYPE_CACHE_FILE_HPP_
+
+#include <fastrtps/types/DynamicTypePtr.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "fastrtps_dynamic_type.hpp"
+#include "fastrtps_serialization_support.hpp"
+#include "fastrtps_type_fingerprint.hpp"
+
+
+// =================================================================================================
+// TYPE CACHE FILE
+// =================================================================================================
+//
+// File layout (all integers little-endian, all offsets from the start of the file):
+//
+//   header   magic "RDTFASTC", u32 format version, u16 fastrtps major, u16 fastrtps minor,
+//            u32 entry count, u32 reserved, u64 file size
+//   entries  one per type, sorted by name:
+//            u64 fingerprint[2], u32 name offset, u32 name length, u32 record offset,
+//            u32 record length
+//   blob     names and type records
+//
+// A type record is a pre-order encoding of the type tree, one node per type:
+//
+//   u8 kind, then depending on kind
+//     primitives  nothing
+//     strings     u32 bound
+//     array       u32 dimension count, u32 bound per dimension, element node
+//     sequence    u32 bound, element node
+//     struct      string name, u64 fingerprint[2], u32 body length, u32 member count,
+//                 then per member u32 id, string name, string default value, type node
+//
+// where strings are a u32 length followed by the bytes. The struct fingerprint and body length let
+// the reader skip nested structs it has already rehydrated. Two structs with the same name but
+// different definitions have different fingerprints, so they are never mixed up.
+//
+// The file is not trusted: every struct rehydrated from it has its fingerprint recomputed and
+// checked against the stored one, so a stale or corrupt record is rejected instead of making
+// unequal types compare equal. Type nodes nest at most FASTRTPS_TYPE_CACHE_FILE_MAX_DEPTH deep,
+// which bounds the recursion of the reader; deeper types cannot be written.
+
+#define FASTRTPS_TYPE_CACHE_FILE_MAGIC "RDTFASTC"
+#define FASTRTPS_TYPE_CACHE_FILE_FORMAT_VERSION 2
+#define FASTRTPS_TYPE_CACHE_FILE_MAX_DEPTH 64
+
+typedef struct fastrtps__type_cache_file_fingerprint_hash_s
+{
+  size_t
+  operator()(const fastrtps__type_fingerprint_t & fingerprint) const
+  {
+    // Already a hash
+    return static_cast<size_t>(fingerprint.hash[0]);
+  }
+} fastrtps__type_cache_file_fingerprint_hash_t;
+
+typedef struct fastrtps__type_cache_file_fingerprint_equal_s
+{
+  bool
+  operator()(const fastrtps__type_fingerprint_t & a, const fastrtps__type_fingerprint_t & b) const
+  {
+    return fastrtps__type_fingerprint_equal(&a, &b);
+  }
+} fastrtps__type_cache_file_fingerprint_equal_t;
+
+typedef struct fastrtps__type_cache_file_s
+{
+  rcutils_allocator_t allocator_;
+
+  // Either mapped, or read into memory allocated with allocator_
+  const uint8_t * data_;
+  size_t size_;
+  bool mapped_;
+
+  // Struct types rehydrated so far, by fingerprint, so nested types are only built once
+  std::mutex mutex_;
+  std::unordered_map<
+    fastrtps__type_fingerprint_t, eprosima::fastrtps::types::DynamicType_ptr,
+    fastrtps__type_cache_file_fingerprint_hash_t, fastrtps__type_cache_file_fingerprint_equal_t
+  > struct_types_;
+} fastrtps__type_cache_file_t;
+
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__type_cache_file_write(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl,
+  const char * path,
+  fastrtps__dynamic_type_handle_t * const * type_handles,
+  size_t type_count);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__type_cache_file_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  fastrtps__type_cache_file_t ** cache_file);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__type_cache_file_get_type(
+  fastrtps__serialization_support_impl_handle_t * fastrtps_impl,
+  fastrtps__type_cache_file_t * cache_file,
+  const char * name, size_t name_length,
+  fastrtps__dynamic_type_handle_t ** type_handle);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__type_cache_file_fini(fastrtps__type_cache_file_t * cache_file);
+
+
+#endif  // DETAIL__FASTRTPS_TYPE_CACHE_FILE_HPP_
@@ -0,0 +1,743 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastrtps_type_converter.hpp"
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicDataFactory.h>
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypeMember.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypeDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "fastrtps_cdr_layout.hpp"
+#include "fastrtps_dynamic_data_image.hpp"
+
+
+using eprosima::fastrtps::types::DynamicData;
+using eprosima::fastrtps::types::DynamicDataFactory;
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::DynamicTypeMember;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::ReturnCode_t;
+using eprosima::fastrtps::types::TypeDescriptor;
+using eprosima::fastrtps::types::TypeKind;
+
+
+// Members that are copied through the DynamicData value accessors, with the accessors of each
+#define FASTRTPS_TYPE_CONVERTER_VALUE_KINDS(X) \
+  X(TK_BOOLEAN, bool, bool) \
+  X(TK_BYTE, eprosima::fastrtps::types::octet, byte) \
+  X(TK_CHAR8, char, char8) \
+  X(TK_CHAR16, wchar_t, char16) \
+  X(TK_FLOAT32, float, float32) \
+  X(TK_FLOAT64, double, float64) \
+  X(TK_FLOAT128, long double, float128) \
+  X(TK_INT16, int16_t, int16) \
+  X(TK_UINT16, uint16_t, uint16) \
+  X(TK_INT32, int32_t, int32) \
+  X(TK_UINT32, uint32_t, uint32) \
+  X(TK_INT64, int64_t, int64) \
+  X(TK_UINT64, uint64_t, uint64) \
+  X(TK_STRING8, std::string, string) \
+  X(TK_STRING16, std::wstring, wstring)
+
+#define FASTRTPS_TYPE_CONVERTER_VALUE_KIND_CASE(Kind, ValueT, DataFnT) \
+  case eprosima::fastrtps::types::Kind:
+
+#define FASTRTPS_TYPE_CONVERTER_COPY_VALUE_CASE(Kind, ValueT, DataFnT) \
+  case eprosima::fastrtps::types::Kind: \
+    return fastrtps__type_converter_copy_value_t<ValueT>( \
+      from, op.from_id_, &DynamicData::get_ ## DataFnT ## _value, \
+      to, op.to_id_, &DynamicData::set_ ## DataFnT ## _value);
+
+
+// Converted serialized data, including its encapsulation header
+typedef struct fastrtps__type_converter_writer_s
+{
+  std::vector<uint8_t> & bytes_;
+  bool swap_;  // Whether the output is not in host byte order
+} fastrtps__type_converter_writer_t;
+
+
+// =================================================================================================
+// TYPE CONVERTER
+// =================================================================================================
+
+// PLAN ============================================================================================
+typedef struct fastrtps__type_converter_source_member_s
+{
+  uint32_t index_;
+  MemberId id_;
+  DynamicType_ptr type_;
+} fastrtps__type_converter_source_member_t;
+
+
+// Find the structs to convert between for members of type `from` and `to`: the types themselves
+// if they are structs, or their elements if they are sequences or arrays of structs that can hold
+// every source element. Returns false if they are neither.
+static bool
+fastrtps__type_converter_match_structs(
+  const DynamicType_ptr & from, const DynamicType_ptr & to,
+  DynamicType_ptr * from_struct, DynamicType_ptr * to_struct)
+{
+  TypeKind kind = to->get_kind();
+  if (from->get_kind() != kind) {
+    return false;
+  }
+  if (kind == eprosima::fastrtps::types::TK_STRUCTURE) {
+    *from_struct = from;
+    *to_struct = to;
+    return true;
+  }
+  if (kind != eprosima::fastrtps::types::TK_SEQUENCE &&
+    kind != eprosima::fastrtps::types::TK_ARRAY)
+  {
+    return false;
+  }
+
+  TypeDescriptor from_descriptor;
+  TypeDescriptor to_descriptor;
+  from->get_descriptor(&from_descriptor);
+  to->get_descriptor(&to_descriptor);
+  if (kind == eprosima::fastrtps::types::TK_ARRAY) {
+    if (from_descriptor.get_bounds_size() != to_descriptor.get_bounds_size()) {
+      return false;
+    }
+    for (uint32_t i = 0; i < from_descriptor.get_bounds_size(); ++i) {
+      if (from_descriptor.get_bounds(i) != to_descriptor.get_bounds(i)) {
+        return false;
+      }
+    }
+  } else {
+    // A bound of 0 is unbounded
+    uint32_t from_bound = from_descriptor.get_bounds();
+    uint32_t to_bound = to_descriptor.get_bounds();
+    if (to_bound != 0 && (from_bound == 0 || from_bound > to_bound)) {
+      return false;
+    }
+  }
+
+  *from_struct = from_descriptor.get_element_type();
+  *to_struct = to_descriptor.get_element_type();
+  return (*from_struct)->get_kind() == eprosima::fastrtps::types::TK_STRUCTURE &&
+         (*to_struct)->get_kind() == eprosima::fastrtps::types::TK_STRUCTURE;
+}
+
+
+static const fastrtps__type_converter_plan_t *
+fastrtps__type_converter_add_plan(
+  fastrtps__type_converter_t * converter, const DynamicType_ptr & from, const DynamicType_ptr & to)
+{
+  auto key = std::make_pair(from.get(), to.get());
+  auto plan_it = converter->plans_by_types_.find(key);
+  if (plan_it != converter->plans_by_types_.end()) {
+    return plan_it->second;
+  }
+
+  auto from_node_it = converter->from_layout_.nodes_by_type_.find(from.get());
+  auto to_node_it = converter->to_layout_.nodes_by_type_.find(to.get());
+  if (from_node_it == converter->from_layout_.nodes_by_type_.end() ||
+    to_node_it == converter->to_layout_.nodes_by_type_.end())
+  {
+    RCUTILS_SET_ERROR_MSG("Could not find struct layout to convert");
+    return nullptr;
+  }
+  const fastrtps__cdr_layout_node_t * to_node = to_node_it->second;
+
+  // Registered before its ops are compiled, so the root plan stays first
+  auto plan_ptr = std::make_unique<fastrtps__type_converter_plan_t>();
+  fastrtps__type_converter_plan_t * plan = plan_ptr.get();
+  converter->plans_.push_back(std::move(plan_ptr));
+  converter->plans_by_types_.emplace(key, plan);
+  plan->from_type_ = from;
+  plan->to_type_ = to;
+  plan->from_node_ = from_node_it->second;
+
+  DynamicData * default_data = converter->data_factory_->create_data(to);
+  bool default_ok = default_data &&
+    fastrtps__dynamic_data_image_write(default_data, plan->default_image_);
+  if (default_data) {
+    converter->data_factory_->delete_data(default_data);
+  }
+  if (!default_ok) {
+    RCUTILS_SET_ERROR_MSG("Could not serialize default value of target type to convert to");
+    return nullptr;
+  }
+
+  std::map<MemberId, DynamicTypeMember *> from_members;
+  from->get_all_members(from_members);
+  std::unordered_map<std::string, fastrtps__type_converter_source_member_t> from_by_name;
+  uint32_t from_index = 0;
+  for (const auto & member : from_members) {
+    MemberDescriptor descriptor;
+    member.second->get_descriptor(&descriptor);
+    from_by_name.emplace(
+      descriptor.get_name(),
+      fastrtps__type_converter_source_member_t{from_index++, member.first, descriptor.get_type()});
+  }
+
+  std::map<MemberId, DynamicTypeMember *> to_members;
+  to->get_all_members(to_members);
+  fastrtps__cdr_reader_t default_reader{
+    reinterpret_cast<const uint8_t *>(plan->default_image_.data()),
+    plan->default_image_.size(), false};
+  size_t default_offset = 0;
+  uint32_t to_index = 0;
+  for (const auto & member : to_members) {
+    MemberDescriptor descriptor;
+    member.second->get_descriptor(&descriptor);
+    DynamicType_ptr to_member_type = descriptor.get_type();
+    const fastrtps__cdr_layout_node_t * to_member_node = to_node->members_[to_index++].node_;
+
+    fastrtps__type_converter_op_t op;
+    op.kind_ = FASTRTPS_TYPE_CONVERTER_DEFAULT;
+    op.type_kind_ = to_member_type->get_kind();
+    op.from_id_ = eprosima::fastrtps::types::MEMBER_ID_INVALID;
+    op.from_index_ = 0;
+    op.to_id_ = member.first;
+    op.node_ = to_member_node;
+    op.default_offset_ = default_offset;
+    op.nested_ = nullptr;
+
+    auto from_it = from_by_name.find(descriptor.get_name());
+    if (from_it != from_by_name.end()) {
+      const fastrtps__type_converter_source_member_t & from_member = from_it->second;
+      DynamicType_ptr from_struct;
+      DynamicType_ptr to_struct;
+      if (from_member.type_->equals(to_member_type.get())) {
+        op.kind_ = FASTRTPS_TYPE_CONVERTER_COPY;
+      } else if (fastrtps__type_converter_match_structs(
+          from_member.type_, to_member_type, &from_struct, &to_struct))
+      {
+        op.nested_ = fastrtps__type_converter_add_plan(converter, from_struct, to_struct);
+        if (!op.nested_) {
+          return nullptr;
+        }
+        op.kind_ = FASTRTPS_TYPE_CONVERTER_CONVERT;
+      }
+      if (op.kind_ != FASTRTPS_TYPE_CONVERTER_DEFAULT) {
+        op.from_id_ = from_member.id_;
+        op.from_index_ = from_member.index_;
+        op.node_ = plan->from_node_->members_[from_member.index_].node_;
+      }
+    }
+
+    if (!fastrtps__cdr_layout_skip(to_member_node, &default_reader, &default_offset)) {
+      RCUTILS_SET_ERROR_MSG("Could not lay out default value of target type to convert to");
+      return nullptr;
+    }
+    plan->ops_.push_back(op);
+  }
+  return plan;
+}
+
+
+// CONVERT DATA ====================================================================================
+static bool
+fastrtps__type_converter_is_value_kind(TypeKind kind)
+{
+  switch (kind) {
+    FASTRTPS_TYPE_CONVERTER_VALUE_KINDS(FASTRTPS_TYPE_CONVERTER_VALUE_KIND_CASE)
+    return true;
+    default:
+      return false;
+  }
+}
+
+
+template<typename ValueT, typename SetValueT>
+static bool
+fastrtps__type_converter_copy_value_t(
+  const DynamicData * from, MemberId from_id,
+  ReturnCode_t (DynamicData::*get_value)(ValueT &, MemberId) const,
+  DynamicData * to, MemberId to_id,
+  ReturnCode_t (DynamicData::*set_value)(SetValueT, MemberId))
+{
+  ValueT value;
+  return (from->*get_value)(value, from_id) == ReturnCode_t::RETCODE_OK &&
+         (to->*set_value)(value, to_id) == ReturnCode_t::RETCODE_OK;
+}
+
+
+static bool
+fastrtps__type_converter_copy_value(
+  const fastrtps__type_converter_op_t & op, const DynamicData * from, DynamicData * to)
+{
+  switch (op.type_kind_) {
+    FASTRTPS_TYPE_CONVERTER_VALUE_KINDS(FASTRTPS_TYPE_CONVERTER_COPY_VALUE_CASE)
+    default:
+      return false;
+  }
+}
+
+
+static bool
+fastrtps__type_converter_convert_struct_data(
+  DynamicDataFactory * data_factory,
+  const fastrtps__type_converter_plan_t * plan, DynamicData * from, DynamicData * to);
+
+
+// Convert a CONVERT member, `from` and `to` being the loaned struct, sequence or array
+static bool
+fastrtps__type_converter_convert_member_data(
+  DynamicDataFactory * data_factory,
+  const fastrtps__type_converter_op_t & op, DynamicData * from, DynamicData * to)
+{
+  if (op.type_kind_ == eprosima::fastrtps::types::TK_STRUCTURE) {
+    return fastrtps__type_converter_convert_struct_data(data_factory, op.nested_, from, to);
+  }
+
+  // `to` may be reused, so a target sequence is refilled from scratch
+  bool sequence = op.type_kind_ == eprosima::fastrtps::types::TK_SEQUENCE;
+  if (sequence && to->clear_data() != ReturnCode_t::RETCODE_OK) {
+    return false;
+  }
+  uint32_t item_count = from->get_item_count();
+  for (uint32_t index = 0; index < item_count; ++index) {
+    MemberId to_id = index;
+    if (sequence && to->insert_sequence_data(to_id) != ReturnCode_t::RETCODE_OK) {
+      return false;
+    }
+    DynamicData * from_element = from->loan_value(index);
+    DynamicData * to_element = to->loan_value(to_id);
+    bool ok = from_element && to_element && fastrtps__type_converter_convert_struct_data(
+      data_factory, op.nested_, from_element, to_element);
+    if (from_element) {
+      from->return_loaned_value(from_element);
+    }
+    if (to_element) {
+      to->return_loaned_value(to_element);
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+static bool
+fastrtps__type_converter_convert_struct_data(
+  DynamicDataFactory * data_factory,
+  const fastrtps__type_converter_plan_t * plan, DynamicData * from, DynamicData * to)
+{
+  for (const auto & op : plan->ops_) {
+    bool ok = false;
+    switch (op.kind_) {
+      case FASTRTPS_TYPE_CONVERTER_COPY:
+        if (fastrtps__type_converter_is_value_kind(op.type_kind_)) {
+          ok = fastrtps__type_converter_copy_value(op, from, to);
+        } else {
+          // The copy is owned by `to` once set
+          DynamicData * value = nullptr;
+          ok = from->get_complex_value(&value, op.from_id_) == ReturnCode_t::RETCODE_OK &&
+            to->set_complex_value(value, op.to_id_) == ReturnCode_t::RETCODE_OK;
+          if (!ok && value) {
+            data_factory->delete_data(value);
+          }
+        }
+        break;
+
+      case FASTRTPS_TYPE_CONVERTER_CONVERT: {
+          DynamicData * from_member = from->loan_value(op.from_id_);
+          DynamicData * to_member = to->loan_value(op.to_id_);
+          ok = from_member && to_member && fastrtps__type_converter_convert_member_data(
+            data_factory, op, from_member, to_member);
+          if (from_member) {
+            from->return_loaned_value(from_member);
+          }
+          if (to_member) {
+            to->return_loaned_value(to_member);
+          }
+          break;
+        }
+
+      case FASTRTPS_TYPE_CONVERTER_DEFAULT:
+        // `to` may be reused, so default members are reset rather than assumed untouched
+        ok = to->clear_value(op.to_id_) == ReturnCode_t::RETCODE_OK;
+        break;
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+rcutils_ret_t
+fastrtps__type_converter_convert_data(
+  const fastrtps__type_converter_t * converter, const DynamicData * from, DynamicData * to)
+{
+  // Members of `from` are only loaned to read them, it is not modified
+  if (!fastrtps__type_converter_convert_struct_data(
+      converter->data_factory_, converter->plans_.front().get(),
+      const_cast<DynamicData *>(from), to))
+  {
+    RCUTILS_SET_ERROR_MSG("Could not convert dynamic data, is it of the converter's types?");
+    return RCUTILS_RET_ERROR;
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+// CONVERT SERIALIZED ==============================================================================
+static size_t
+fastrtps__type_converter_writer_offset(const fastrtps__type_converter_writer_t * writer)
+{
+  // Alignment is relative to the end of the encapsulation header
+  return writer->bytes_.size() - 4;
+}
+
+
+static void
+fastrtps__type_converter_align(fastrtps__type_converter_writer_t * writer, uint32_t align)
+{
+  size_t offset = fastrtps__type_converter_writer_offset(writer);
+  writer->bytes_.insert(writer->bytes_.end(), (align - offset % align) % align, 0);
+}
+
+
+// Write a primitive given in host byte order
+static void
+fastrtps__type_converter_write(
+  fastrtps__type_converter_writer_t * writer, const uint8_t * value, uint32_t align, uint32_t size)
+{
+  fastrtps__type_converter_align(writer, align);
+  if (writer->swap_) {
+    for (uint32_t i = 0; i < size; ++i) {
+      writer->bytes_.push_back(value[size - 1 - i]);
+    }
+  } else {
+    writer->bytes_.insert(writer->bytes_.end(), value, value + size);
+  }
+}
+
+
+// Copy a value of `node` from `reader` to `writer`, realigning it if needed
+static bool
+fastrtps__type_converter_transcode(
+  const fastrtps__cdr_layout_node_t * node,
+  const fastrtps__cdr_reader_t * reader, size_t * offset,
+  fastrtps__type_converter_writer_t * writer)
+{
+  // Flat values starting on the same phase on both sides keep their exact layout
+  if (node->flat_ && reader->swap_ == writer->swap_ &&
+    *offset % FASTRTPS_CDR_LAYOUT_PHASES ==
+    fastrtps__type_converter_writer_offset(writer) % FASTRTPS_CDR_LAYOUT_PHASES)
+  {
+    size_t size = node->size_by_phase_[*offset % FASTRTPS_CDR_LAYOUT_PHASES];
+    if (*offset > reader->length_ || reader->length_ - *offset < size) {
+      return false;
+    }
+    writer->bytes_.insert(
+      writer->bytes_.end(), reader->data_ + *offset, reader->data_ + *offset + size);
+    *offset += size;
+    return true;
+  }
+
+  uint8_t value[16];
+  if (node->size_) {
+    if (!fastrtps__cdr_reader_read(reader, offset, node->align_, node->size_, value)) {
+      return false;
+    }
+    fastrtps__type_converter_write(writer, value, node->align_, node->size_);
+    return true;
+  }
+
+  uint32_t length;
+  switch (node->kind_) {
+    case eprosima::fastrtps::types::TK_STRING8:
+      if (!fastrtps__cdr_reader_read(reader, offset, 4, 4, &length) ||
+        reader->length_ - *offset < length)
+      {
+        return false;
+      }
+      fastrtps__type_converter_write(writer, reinterpret_cast<uint8_t *>(&length), 4, 4);
+      writer->bytes_.insert(
+        writer->bytes_.end(), reader->data_ + *offset, reader->data_ + *offset + length);
+      *offset += length;
+      return true;
+
+    case eprosima::fastrtps::types::TK_STRING16:
+      if (!fastrtps__cdr_reader_read(reader, offset, 4, 4, &length)) {
+        return false;
+      }
+      fastrtps__type_converter_write(writer, reinterpret_cast<uint8_t *>(&length), 4, 4);
+      for (uint32_t i = 0; i < length; ++i) {
+        if (!fastrtps__cdr_reader_read(reader, offset, 4, 4, value)) {
+          return false;
+        }
+        fastrtps__type_converter_write(writer, value, 4, 4);
+      }
+      return true;
+
+    case eprosima::fastrtps::types::TK_SEQUENCE: {
+        if (!fastrtps__cdr_reader_read(reader, offset, 4, 4, &length)) {
+          return false;
+        }
+        fastrtps__type_converter_write(writer, reinterpret_cast<uint8_t *>(&length), 4, 4);
+        const fastrtps__cdr_layout_node_t * element = node->element_;
+        if (length > 0 && element->size_ && reader->swap_ == writer->swap_) {
+          // Primitive elements are back to back once the first one is aligned
+          *offset = (*offset + element->align_ - 1) & ~static_cast<size_t>(element->align_ - 1);
+          if (*offset > reader->length_ || (reader->length_ - *offset) / element->size_ < length) {
+            return false;
+          }
+          size_t size = static_cast<size_t>(length) * element->size_;
+          fastrtps__type_converter_align(writer, element->align_);
+          writer->bytes_.insert(
+            writer->bytes_.end(), reader->data_ + *offset, reader->data_ + *offset + size);
+          *offset += size;
+          return true;
+        }
+        for (uint32_t i = 0; i < length; ++i) {
+          if (!fastrtps__type_converter_transcode(element, reader, offset, writer)) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+    case eprosima::fastrtps::types::TK_ARRAY:
+      for (uint32_t i = 0; i < node->element_count_; ++i) {
+        if (!fastrtps__type_converter_transcode(node->element_, reader, offset, writer)) {
+          return false;
+        }
+      }
+      return true;
+
+    case eprosima::fastrtps::types::TK_STRUCTURE:
+      for (const auto & member : node->members_) {
+        if (!fastrtps__type_converter_transcode(member.node_, reader, offset, writer)) {
+          return false;
+        }
+      }
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+
+static bool
+fastrtps__type_converter_convert_struct_serialized(
+  const fastrtps__type_converter_plan_t * plan,
+  const fastrtps__cdr_reader_t * reader, size_t * offset,
+  fastrtps__type_converter_writer_t * writer);
+
+
+// Convert a serialized CONVERT member, a struct, or a sequence or array of them
+static bool
+fastrtps__type_converter_convert_member_serialized(
+  const fastrtps__type_converter_op_t & op,
+  const fastrtps__cdr_reader_t * reader, size_t * offset,
+  fastrtps__type_converter_writer_t * writer)
+{
+  if (op.type_kind_ == eprosima::fastrtps::types::TK_STRUCTURE) {
+    return fastrtps__type_converter_convert_struct_serialized(op.nested_, reader, offset, writer);
+  }
+
+  // Target arrays have the same bounds, and target sequences can hold every element
+  uint32_t length = op.node_->element_count_;
+  if (op.type_kind_ == eprosima::fastrtps::types::TK_SEQUENCE) {
+    if (!fastrtps__cdr_reader_read(reader, offset, 4, 4, &length)) {
+      return false;
+    }
+    fastrtps__type_converter_write(writer, reinterpret_cast<uint8_t *>(&length), 4, 4);
+  }
+  for (uint32_t i = 0; i < length; ++i) {
+    if (!fastrtps__type_converter_convert_struct_serialized(op.nested_, reader, offset, writer)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+static bool
+fastrtps__type_converter_convert_struct_serialized(
+  const fastrtps__type_converter_plan_t * plan,
+  const fastrtps__cdr_reader_t * reader, size_t * offset,
+  fastrtps__type_converter_writer_t * writer)
+{
+  const fastrtps__cdr_layout_node_t * from_node = plan->from_node_;
+  fastrtps__cdr_reader_t default_reader{
+    reinterpret_cast<const uint8_t *>(plan->default_image_.data()),
+    plan->default_image_.size(), false};
+
+  // Source members are usually matched in order, in which case this is a single forward pass
+  size_t start = *offset;
+  size_t cursor = start;
+  uint32_t cursor_index = 0;
+  for (const auto & op : plan->ops_) {
+    if (op.kind_ == FASTRTPS_TYPE_CONVERTER_DEFAULT) {
+      size_t default_offset = op.default_offset_;
+      if (!fastrtps__type_converter_transcode(op.node_, &default_reader, &default_offset, writer)) {
+        return false;
+      }
+      continue;
+    }
+
+    if (op.from_index_ < cursor_index) {
+      cursor = start;
+      cursor_index = 0;
+    }
+    for (; cursor_index < op.from_index_; ++cursor_index) {
+      if (!fastrtps__cdr_layout_skip(from_node->members_[cursor_index].node_, reader, &cursor)) {
+        return false;
+      }
+    }
+    bool ok = op.kind_ == FASTRTPS_TYPE_CONVERTER_COPY ?
+      fastrtps__type_converter_transcode(op.node_, reader, &cursor, writer) :
+      fastrtps__type_converter_convert_member_serialized(op, reader, &cursor, writer);
+    if (!ok) {
+      return false;
+    }
+    ++cursor_index;
+  }
+
+  for (; cursor_index < from_node->members_.size(); ++cursor_index) {
+    if (!fastrtps__cdr_layout_skip(from_node->members_[cursor_index].node_, reader, &cursor)) {
+      return false;
+    }
+  }
+  *offset = cursor;
+  return true;
+}
+
+
+rcutils_ret_t
+fastrtps__type_converter_convert_serialized(
+  const fastrtps__type_converter_t * converter,
+  const uint8_t * buffer, size_t length,
+  rcutils_uint8_array_t * to)
+{
+  fastrtps__cdr_reader_t reader;
+  if (!fastrtps__cdr_reader_init(&reader, buffer, length)) {
+    RCUTILS_SET_ERROR_MSG("Can only convert plain CDR serialized data");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+
+  const uint8_t * out = buffer;
+  size_t out_length = length;
+
+  // Kept across calls, so steady state conversion doesn't allocate
+  thread_local std::vector<uint8_t> bytes;
+  if (!converter->identical_) {
+    // Same encapsulation kind, no options
+    bytes.assign(buffer, buffer + 2);
+    bytes.push_back(0);
+    bytes.push_back(0);
+    fastrtps__type_converter_writer_t writer{bytes, reader.swap_};
+    size_t offset = 0;
+    if (!fastrtps__type_converter_convert_struct_serialized(
+        converter->plans_.front().get(), &reader, &offset, &writer))
+    {
+      RCUTILS_SET_ERROR_MSG("Serialized data is truncated, or not of the converter's source type");
+      return RCUTILS_RET_ERROR;
+    }
+    out = bytes.data();
+    out_length = bytes.size();
+  }
+
+  if (to->buffer_capacity < out_length) {
+    if (rcutils_uint8_array_resize(to, out_length) != RCUTILS_RET_OK) {
+      RCUTILS_SET_ERROR_MSG("Could not resize converted data buffer");
+      return RCUTILS_RET_BAD_ALLOC;
+    }
+  }
+  memcpy(to->buffer, out, out_length);
+  to->buffer_length = out_length;
+  return RCUTILS_RET_OK;
+}
+
+
+// CORE ============================================================================================
+rcutils_ret_t
+fastrtps__type_converter_init(
+  DynamicDataFactory * data_factory,
+  const DynamicType_ptr & from,
+  const DynamicType_ptr & to,
+  rcutils_allocator_t * allocator,
+  fastrtps__type_converter_t ** converter)
+{
+  void * converter_mem =
+    allocator->allocate(sizeof(fastrtps__type_converter_t), allocator->state);
+  if (!converter_mem) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate type converter");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  // Holds C++ members, so it must be constructed in place
+  auto out = new (converter_mem) fastrtps__type_converter_t();
+  out->allocator_ = *allocator;
+  out->data_factory_ = data_factory;
+
+  rcutils_ret_t ret = fastrtps__cdr_layout_init(from, &out->from_layout_);
+  if (ret == RCUTILS_RET_OK) {
+    ret = fastrtps__cdr_layout_init(to, &out->to_layout_);
+  }
+  if (ret == RCUTILS_RET_OK &&
+    (out->from_layout_.root_->kind_ != eprosima::fastrtps::types::TK_STRUCTURE ||
+    out->to_layout_.root_->kind_ != eprosima::fastrtps::types::TK_STRUCTURE))
+  {
+    RCUTILS_SET_ERROR_MSG("Can only convert between struct types");
+    ret = RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  if (ret == RCUTILS_RET_OK) {
+    out->identical_ = from->equals(to.get());
+    if (!fastrtps__type_converter_add_plan(out, from, to)) {
+      ret = RCUTILS_RET_ERROR;
+    }
+  }
+
+  if (ret != RCUTILS_RET_OK) {
+    fastrtps__type_converter_fini(out);
+    return ret;
+  }
+  *converter = out;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+fastrtps__type_converter_fini(fastrtps__type_converter_t * converter)
+{
+  rcutils_allocator_t allocator = converter->allocator_;
+  converter->~fastrtps__type_converter_t();
+  allocator.deallocate(converter, allocator.state);
+  return RCUTILS_RET_OK;
+}
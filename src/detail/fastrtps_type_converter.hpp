@@ -0,0 +1,154 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef DETAIL__FASTRTPS_TYPE_CONVERTER_HPP_
+#define DETAIL__FASTRTPS_TYPE_CONVERTER_HPP_
+
+#include <fastrtps/types/DynamicData.h>
+#include <fastrtps/types/DynamicDataFactory.h>
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "fastrtps_cdr_layout.hpp"
+
+
+// =================================================================================================
+// TYPE CONVERTER
+// =================================================================================================
+//
+// A conversion plan from one version of a struct type to another, compiled once.
+//
+// Members of the target type are matched to members of the source type by name. Members with
+// identical types are copied, nested structs that changed are converted with a plan of their own,
+// and so are the elements of sequences and arrays of such structs, as long as the target still
+// holds every source element (same array bounds, sequence bound no smaller). Every other target
+// member (new, or whose type changed in any other way) keeps its default value. Source members
+// without a match are dropped.
+//
+// Serialized data is converted in one pass over the source buffer, copying matched members as
+// they are (realigned if they moved) and default members out of a serialized default value of the
+// target type, without deserializing anything.
+
+typedef enum fastrtps__type_converter_op_kind_e
+{
+  FASTRTPS_TYPE_CONVERTER_COPY,  // Identical member types
+  FASTRTPS_TYPE_CONVERTER_CONVERT,  // Structs, or their sequences or arrays, with a nested plan
+  FASTRTPS_TYPE_CONVERTER_DEFAULT,  // No matching source member
+} fastrtps__type_converter_op_kind_t;
+
+struct fastrtps__type_converter_plan_s;
+
+/// How to fill in one target member
+typedef struct fastrtps__type_converter_op_s
+{
+  fastrtps__type_converter_op_kind_t kind_;
+  eprosima::fastrtps::types::TypeKind type_kind_;
+
+  eprosima::fastrtps::types::MemberId from_id_;
+  uint32_t from_index_;
+  eprosima::fastrtps::types::MemberId to_id_;
+
+  // Source member for COPY and CONVERT, target member for DEFAULT
+  const fastrtps__cdr_layout_node_t * node_;
+
+  // DEFAULT only, where the member is in the plan's default image
+  size_t default_offset_;
+
+  // CONVERT only, the plan of the struct or of its elements
+  const struct fastrtps__type_converter_plan_s * nested_;
+} fastrtps__type_converter_op_t;
+
+/// Conversion of one pair of struct types
+typedef struct fastrtps__type_converter_plan_s
+{
+  eprosima::fastrtps::types::DynamicType_ptr from_type_;
+  eprosima::fastrtps::types::DynamicType_ptr to_type_;
+  const fastrtps__cdr_layout_node_t * from_node_;
+
+  // One per target member, in target member order
+  std::vector<fastrtps__type_converter_op_t> ops_;
+
+  // Image (see fastrtps_dynamic_data_image.hpp) of a default constructed target struct
+  std::vector<char> default_image_;
+} fastrtps__type_converter_plan_t;
+
+typedef struct fastrtps__type_converter_s
+{
+  rcutils_allocator_t allocator_;
+  eprosima::fastrtps::types::DynamicDataFactory * data_factory_;
+
+  fastrtps__cdr_layout_t from_layout_;
+  fastrtps__cdr_layout_t to_layout_;
+
+  // The root plan is first, nested structs used several times only get one plan
+  std::vector<std::unique_ptr<fastrtps__type_converter_plan_t>> plans_;
+  std::map<
+    std::pair<
+      const eprosima::fastrtps::types::DynamicType *, const eprosima::fastrtps::types::DynamicType *
+    >,
+    const fastrtps__type_converter_plan_t *
+  > plans_by_types_;
+
+  // Whether both types are the same, so serialized data can be passed through as is
+  bool identical_;
+} fastrtps__type_converter_t;
+
+
+/// Compile the conversion plan from struct type `from` to struct type `to`
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__type_converter_init(
+  eprosima::fastrtps::types::DynamicDataFactory * data_factory,
+  const eprosima::fastrtps::types::DynamicType_ptr & from,
+  const eprosima::fastrtps::types::DynamicType_ptr & to,
+  rcutils_allocator_t * allocator,
+  fastrtps__type_converter_t ** converter);  // OUT
+
+/// Convert `from`, of the source type, into `to`, of the target type
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__type_converter_convert_data(
+  const fastrtps__type_converter_t * converter,
+  const eprosima::fastrtps::types::DynamicData * from,
+  eprosima::fastrtps::types::DynamicData * to);  // OUT
+
+/// Convert CDR serialized data of the source type into `to`, which is resized to fit
+/// The converted data has the same byte order as `buffer`
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__type_converter_convert_serialized(
+  const fastrtps__type_converter_t * converter,
+  const uint8_t * buffer, size_t length,
+  rcutils_uint8_array_t * to);  // OUT
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+rcutils_ret_t
+fastrtps__type_converter_fini(fastrtps__type_converter_t * converter);
+
+
+#endif  // DETAIL__FASTRTPS_TYPE_CONVERTER_HPP_
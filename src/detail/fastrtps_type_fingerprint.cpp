@@ -0,0 +1,129 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastrtps_type_fingerprint.hpp"
+
+#include <fastrtps/types/DynamicType.h>
+#include <fastrtps/types/DynamicTypeMember.h>
+#include <fastrtps/types/DynamicTypePtr.h>
+#include <fastrtps/types/MemberDescriptor.h>
+#include <fastrtps/types/TypeDescriptor.h>
+#include <fastrtps/types/TypesBase.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "utils.hpp"
+
+
+using eprosima::fastrtps::types::DynamicType_ptr;
+using eprosima::fastrtps::types::DynamicTypeMember;
+using eprosima::fastrtps::types::MemberDescriptor;
+using eprosima::fastrtps::types::MemberId;
+using eprosima::fastrtps::types::TypeDescriptor;
+
+// Independent seeds for the two halves of the fingerprint
+#define FASTRTPS_FINGERPRINT_SEED_LO 0x0ULL
+#define FASTRTPS_FINGERPRINT_SEED_HI 0x9E3779B97F4A7C15ULL
+
+// Marks an absent nested type, so "no element type" and "empty element type" do not collide
+#define FASTRTPS_FINGERPRINT_NULL_TYPE 0xFFu
+
+
+// =================================================================================================
+// TYPE FINGERPRINT
+// =================================================================================================
+
+// The fingerprint is the hash of a canonical byte encoding of the type tree.
+// Every variable length field is length prefixed so adjacent fields cannot alias each other.
+static void
+fastrtps__fingerprint_append_u32(std::string & out, uint32_t value)
+{
+  out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+
+static void
+fastrtps__fingerprint_append_string(std::string & out, const std::string & value)
+{
+  fastrtps__fingerprint_append_u32(out, fastrtps__size_t_to_uint32_t(value.size()));
+  out.append(value);
+}
+
+
+static void
+fastrtps__fingerprint_encode(std::string & out, const DynamicType_ptr & type)
+{
+  if (!type) {
+    out.push_back(static_cast<char>(FASTRTPS_FINGERPRINT_NULL_TYPE));
+    return;
+  }
+
+  TypeDescriptor descriptor;
+  type->get_descriptor(&descriptor);
+
+  out.push_back(static_cast<char>(descriptor.get_kind()));
+  fastrtps__fingerprint_append_string(out, descriptor.get_name());
+
+  uint32_t bounds_size = descriptor.get_bounds_size();
+  fastrtps__fingerprint_append_u32(out, bounds_size);
+  for (uint32_t i = 0; i < bounds_size; ++i) {
+    fastrtps__fingerprint_append_u32(out, descriptor.get_bounds(i));
+  }
+
+  fastrtps__fingerprint_encode(out, descriptor.get_base_type());
+  fastrtps__fingerprint_encode(out, descriptor.get_element_type());
+  fastrtps__fingerprint_encode(out, descriptor.get_key_element_type());
+
+  // std::map iterates in member id order, which is the order the members are serialized in
+  std::map<MemberId, DynamicTypeMember *> members;
+  type->get_all_members(members);
+  fastrtps__fingerprint_append_u32(out, fastrtps__size_t_to_uint32_t(members.size()));
+  for (const auto & it : members) {
+    MemberDescriptor member_descriptor;
+    it.second->get_descriptor(&member_descriptor);
+
+    fastrtps__fingerprint_append_u32(out, member_descriptor.get_id());
+    fastrtps__fingerprint_append_string(out, member_descriptor.get_name());
+    fastrtps__fingerprint_append_string(out, member_descriptor.get_default_value());
+    fastrtps__fingerprint_encode(out, member_descriptor.get_type());
+  }
+}
+
+
+fastrtps__type_fingerprint_t
+fastrtps__type_fingerprint_compute(const DynamicType_ptr & type)
+{
+  fastrtps__type_fingerprint_t out = {{0, 0}};
+  if (!type) {
+    return out;
+  }
+
+  std::string encoded;
+  fastrtps__fingerprint_encode(encoded, type);
+
+  out.hash[0] = fastrtps__xxh64(encoded.data(), encoded.size(), FASTRTPS_FINGERPRINT_SEED_LO);
+  out.hash[1] = fastrtps__xxh64(encoded.data(), encoded.size(), FASTRTPS_FINGERPRINT_SEED_HI);
+  return out;
+}
+
+
+bool
+fastrtps__type_fingerprint_equal(
+  const fastrtps__type_fingerprint_t * fingerprint,
+  const fastrtps__type_fingerprint_t * other)
+{
+  return fingerprint->hash[0] == other->hash[0] && fingerprint->hash[1] == other->hash[1];
+}
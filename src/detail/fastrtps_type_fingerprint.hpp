@@ -0,0 +1,54 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DETAIL__FASTRTPS_TYPE_FINGERPRINT_HPP_
+#define DETAIL__FASTRTPS_TYPE_FINGERPRINT_HPP_
+
+#include <fastrtps/types/DynamicTypePtr.h>
+
+#include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
+
+#include <cstdint>
+
+
+// =================================================================================================
+// TYPE FINGERPRINT
+// =================================================================================================
+
+/// 128-bit structural fingerprint of a built dynamic type
+/**
+ * Covers everything fastrtps compares in DynamicType::equals: kind, name, bounds, element, key
+ * element and base types, and for every member its id, name, default value and type (recursively).
+ * Two types with the same fingerprint are treated as equal.
+ */
+typedef struct fastrtps__type_fingerprint_s
+{
+  uint64_t hash[2];
+} fastrtps__type_fingerprint_t;
+
+
+/// Compute the structural fingerprint of `type`
+/// An empty `type` gets the all-zero fingerprint
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+fastrtps__type_fingerprint_t
+fastrtps__type_fingerprint_compute(const eprosima::fastrtps::types::DynamicType_ptr & type);
+
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+bool
+fastrtps__type_fingerprint_equal(
+  const fastrtps__type_fingerprint_t * fingerprint,
+  const fastrtps__type_fingerprint_t * other);
+
+
+#endif  // DETAIL__FASTRTPS_TYPE_FINGERPRINT_HPP_
@@ -16,7 +16,9 @@
 
 #include <fastrtps/types/TypesBase.h>
 
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <limits>
 #include <stdexcept>
@@ -87,6 +89,109 @@ fastrtps__replace_string(std::string str, const std::string & from, const std::s
 }
 
 
+// XXH64 ===========================================================================================
+static const uint64_t XXH64_PRIME_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t XXH64_PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t XXH64_PRIME_3 = 0x165667B19E3779F9ULL;
+static const uint64_t XXH64_PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t XXH64_PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t
+fastrtps__xxh64_rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+fastrtps__xxh64_read64(const uint8_t * p)
+{
+  uint64_t out;
+  std::memcpy(&out, p, sizeof(out));
+  return out;
+}
+
+static inline uint32_t
+fastrtps__xxh64_read32(const uint8_t * p)
+{
+  uint32_t out;
+  std::memcpy(&out, p, sizeof(out));
+  return out;
+}
+
+static inline uint64_t
+fastrtps__xxh64_round(uint64_t acc, uint64_t input)
+{
+  acc += input * XXH64_PRIME_2;
+  acc = fastrtps__xxh64_rotl(acc, 31);
+  return acc * XXH64_PRIME_1;
+}
+
+static inline uint64_t
+fastrtps__xxh64_merge_round(uint64_t acc, uint64_t val)
+{
+  acc ^= fastrtps__xxh64_round(0, val);
+  return acc * XXH64_PRIME_1 + XXH64_PRIME_4;
+}
+
+
+// NOTE: Assumes a little-endian host, which covers every platform this package is built for
+uint64_t
+fastrtps__xxh64(const void * data, size_t len, uint64_t seed)
+{
+  const uint8_t * p = static_cast<const uint8_t *>(data);
+  const uint8_t * const end = p + len;
+  uint64_t h64;
+
+  if (len >= 32) {
+    const uint8_t * const limit = end - 32;
+    uint64_t v1 = seed + XXH64_PRIME_1 + XXH64_PRIME_2;
+    uint64_t v2 = seed + XXH64_PRIME_2;
+    uint64_t v3 = seed + 0;
+    uint64_t v4 = seed - XXH64_PRIME_1;
+    do {
+      v1 = fastrtps__xxh64_round(v1, fastrtps__xxh64_read64(p)); p += 8;
+      v2 = fastrtps__xxh64_round(v2, fastrtps__xxh64_read64(p)); p += 8;
+      v3 = fastrtps__xxh64_round(v3, fastrtps__xxh64_read64(p)); p += 8;
+      v4 = fastrtps__xxh64_round(v4, fastrtps__xxh64_read64(p)); p += 8;
+    } while (p <= limit);
+
+    h64 = fastrtps__xxh64_rotl(v1, 1) + fastrtps__xxh64_rotl(v2, 7) +
+      fastrtps__xxh64_rotl(v3, 12) + fastrtps__xxh64_rotl(v4, 18);
+    h64 = fastrtps__xxh64_merge_round(h64, v1);
+    h64 = fastrtps__xxh64_merge_round(h64, v2);
+    h64 = fastrtps__xxh64_merge_round(h64, v3);
+    h64 = fastrtps__xxh64_merge_round(h64, v4);
+  } else {
+    h64 = seed + XXH64_PRIME_5;
+  }
+
+  h64 += static_cast<uint64_t>(len);
+
+  while (p + 8 <= end) {
+    h64 ^= fastrtps__xxh64_round(0, fastrtps__xxh64_read64(p));
+    h64 = fastrtps__xxh64_rotl(h64, 27) * XXH64_PRIME_1 + XXH64_PRIME_4;
+    p += 8;
+  }
+  if (p + 4 <= end) {
+    h64 ^= static_cast<uint64_t>(fastrtps__xxh64_read32(p)) * XXH64_PRIME_1;
+    h64 = fastrtps__xxh64_rotl(h64, 23) * XXH64_PRIME_2 + XXH64_PRIME_3;
+    p += 4;
+  }
+  while (p < end) {
+    h64 ^= (*p) * XXH64_PRIME_5;
+    h64 = fastrtps__xxh64_rotl(h64, 11) * XXH64_PRIME_1;
+    p++;
+  }
+
+  h64 ^= h64 >> 33;
+  h64 *= XXH64_PRIME_2;
+  h64 ^= h64 >> 29;
+  h64 *= XXH64_PRIME_3;
+  h64 ^= h64 >> 32;
+  return h64;
+}
+
+
 rcutils_ret_t
 fastrtps__convert_fastrtps_ret_to_rcl_ret(eprosima::fastrtps::types::ReturnCode_t fastrtps_ret)
 {
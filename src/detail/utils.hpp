@@ -18,6 +18,8 @@
 #include <fastrtps/types/TypesBase.h>
 #include <rosidl_dynamic_typesupport_fastrtps/visibility_control.h>
 #include <rcutils/types/rcutils_ret.h>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 
@@ -48,6 +50,12 @@ ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
 std::string
 fastrtps__replace_string(std::string str, const std::string & from, const std::string & to);
 
+/// 64-bit XXH64 hash of `len` bytes starting at `data`
+/// Not cryptographic, only meant to detect structural or content differences cheaply
+ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
+uint64_t
+fastrtps__xxh64(const void * data, size_t len, uint64_t seed);
+
 /// Convert FastRTPS return types to rcl
 ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_PUBLIC
 rcutils_ret_t
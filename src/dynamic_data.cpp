@@ -0,0 +1,85 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <fastrtps/types/DynamicData.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rosidl_dynamic_typesupport_fastrtps/dynamic_data.h"
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_data_delta.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+
+
+using eprosima::fastrtps::types::DynamicData;
+
+
+// =================================================================================================
+// DYNAMIC DATA
+// =================================================================================================
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_hash(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  uint64_t * hash)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(hash, RCUTILS_RET_INVALID_ARGUMENT);
+  return fastrtps__dynamic_data_hash(serialization_support_impl, data_impl, hash);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_diff(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * from_data_impl,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * to_data_impl,
+  rcutils_uint8_array_t * delta,
+  size_t * change_count)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(from_data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(to_data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(delta, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(change_count, RCUTILS_RET_INVALID_ARGUMENT);
+  return fastrtps__dynamic_data_delta_diff(
+    static_cast<const DynamicData *>(from_data_impl->handle),
+    static_cast<const DynamicData *>(to_data_impl->handle),
+    delta, change_count);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_patch(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  const rcutils_uint8_array_t * delta)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(delta, RCUTILS_RET_INVALID_ARGUMENT);
+  return fastrtps__dynamic_data_delta_patch(
+    static_cast<fastrtps__serialization_support_impl_handle_t *>(
+      serialization_support_impl->handle)->data_factory_,
+    static_cast<DynamicData *>(data_impl->handle), delta);
+}
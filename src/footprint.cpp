@@ -0,0 +1,157 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <fastrtps/types/DynamicData.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/strdup.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include "rosidl_dynamic_typesupport_fastrtps/footprint.h"
+
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_footprint.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+
+
+// =================================================================================================
+// FOOTPRINT
+// =================================================================================================
+rosidl_dynamic_typesupport_fastrtps_footprint_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_footprint(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_footprint_t footprint;
+  footprint.allocator = rcutils_get_zero_initialized_allocator();
+  footprint.heap_bytes = 0;
+  footprint.serialized_bytes = 0;
+  footprint.member_count = 0;
+  footprint.members = NULL;
+  return footprint;
+}
+
+
+// Hand `in` out as `out`, with every allocation made with `allocator`
+static rcutils_ret_t
+fastrtps__footprint_copy_out(
+  const fastrtps__footprint_t & in,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_footprint_t * out)
+{
+  *out = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_footprint();
+  out->allocator = *allocator;
+  out->heap_bytes = in.heap_bytes_;
+  out->serialized_bytes = in.serialized_bytes_;
+  if (in.members_.empty()) {
+    return RCUTILS_RET_OK;
+  }
+
+  out->members = static_cast<rosidl_dynamic_typesupport_fastrtps_member_footprint_t *>(
+    allocator->zero_allocate(
+      in.members_.size(), sizeof(rosidl_dynamic_typesupport_fastrtps_member_footprint_t),
+      allocator->state));
+  if (!out->members) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate footprint members");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  for (const auto & member : in.members_) {
+    auto & member_out = out->members[out->member_count];
+    member_out.name = rcutils_strdup(member.name_.c_str(), *allocator);
+    if (!member_out.name) {
+      rosidl_dynamic_typesupport_fastrtps_footprint_fini(out);
+      RCUTILS_SET_ERROR_MSG("Could not allocate footprint member name");
+      return RCUTILS_RET_BAD_ALLOC;
+    }
+    member_out.heap_bytes = member.heap_bytes_;
+    ++out->member_count;
+  }
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_data_get_footprint(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_footprint_t * footprint)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(footprint, RCUTILS_RET_INVALID_ARGUMENT);
+
+  fastrtps__footprint_t out;
+  fastrtps__dynamic_data_footprint(
+    static_cast<eprosima::fastrtps::types::DynamicData *>(data_impl->handle), &out);
+  return fastrtps__footprint_copy_out(out, allocator, footprint);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_dynamic_type_get_footprint(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_footprint_t * footprint)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(footprint, RCUTILS_RET_INVALID_ARGUMENT);
+
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  const auto & type = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle));
+  if (!type) {
+    RCUTILS_SET_ERROR_MSG("Could not build type for footprint");
+    return RCUTILS_RET_ERROR;
+  }
+
+  fastrtps__footprint_t out;
+  fastrtps__dynamic_type_footprint(type, &out);
+  return fastrtps__footprint_copy_out(out, allocator, footprint);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_footprint_fini(
+  rosidl_dynamic_typesupport_fastrtps_footprint_t * footprint)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(footprint, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!footprint->members) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_allocator_t allocator = footprint->allocator;
+  for (size_t i = 0; i < footprint->member_count; ++i) {
+    allocator.deallocate(footprint->members[i].name, allocator.state);
+  }
+  allocator.deallocate(footprint->members, allocator.state);
+  footprint->members = NULL;
+  footprint->member_count = 0;
+  return RCUTILS_RET_OK;
+}
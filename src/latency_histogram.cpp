@@ -0,0 +1,126 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <cstring>
+#include <string>
+
+#include "rosidl_dynamic_typesupport_fastrtps/latency_histogram.h"
+
+#include "detail/fastrtps_latency_histogram.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+
+
+// =================================================================================================
+// LATENCY HISTOGRAMS
+// =================================================================================================
+static fastrtps__latency_tracking_t *
+fastrtps__get_latency_tracking(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl)
+{
+  return &static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle)->latency_tracking_;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_set_latency_histograms(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  bool enabled)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  return fastrtps__latency_tracking_set_enabled(
+    fastrtps__get_latency_tracking(serialization_support_impl), enabled);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_reset_latency_histograms(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  fastrtps__latency_tracking_reset(fastrtps__get_latency_tracking(serialization_support_impl));
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_get_latency_percentile(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_latency_operation_t operation,
+  double percentile,
+  uint64_t * count,
+  uint64_t * nanoseconds)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(count, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(nanoseconds, RCUTILS_RET_INVALID_ARGUMENT);
+  if (operation < 0 || operation >= ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_LATENCY_OPERATION_COUNT) {
+    RCUTILS_SET_ERROR_MSG("Unknown latency operation");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  if (!(percentile >= 0.0 && percentile <= 100.0)) {
+    RCUTILS_SET_ERROR_MSG("Percentile must be between 0 and 100");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+
+  fastrtps__latency_histogram_snapshot_t snapshot;
+  fastrtps__latency_tracking_snapshot(
+    fastrtps__get_latency_tracking(serialization_support_impl), operation, &snapshot);
+  *count = snapshot.count_;
+  *nanoseconds = fastrtps__latency_histogram_snapshot_percentile(&snapshot, percentile);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_dump_latency_histograms(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_latency_dump_format_t format,
+  rcutils_allocator_t * allocator,
+  char ** dump)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(dump, RCUTILS_RET_INVALID_ARGUMENT);
+
+  std::string out;
+  rcutils_ret_t ret = fastrtps__latency_tracking_dump(
+    fastrtps__get_latency_tracking(serialization_support_impl), format, out);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+
+  *dump = static_cast<char *>(allocator->allocate(out.size() + 1, allocator->state));
+  if (!*dump) {
+    RCUTILS_SET_ERROR_MSG("Could not allocate latency histogram dump");
+    return RCUTILS_RET_BAD_ALLOC;
+  }
+  std::memcpy(*dump, out.c_str(), out.size() + 1);
+  return RCUTILS_RET_OK;
+}
@@ -0,0 +1,307 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <fastrtps/types/DynamicData.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <cstdint>
+
+#include "rosidl_dynamic_typesupport_fastrtps/message_log.h"
+
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_message_log.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+#include "detail/fastrtps_type_fingerprint.hpp"
+
+using eprosima::fastrtps::types::DynamicData;
+
+
+// =================================================================================================
+// MESSAGE LOG
+// =================================================================================================
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_message_log_writer(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_message_log_writer_t writer;
+  writer.allocator = rcutils_get_zero_initialized_allocator();
+  writer.handle = NULL;
+  return writer;
+}
+
+
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_message_log_reader(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_message_log_reader_t reader;
+  reader.allocator = rcutils_get_zero_initialized_allocator();
+  reader.handle = NULL;
+  return reader;
+}
+
+
+// Messages are indexed by the fingerprint of their type, lazy types get one once built
+static rcutils_ret_t
+fastrtps__message_log_type_fingerprint(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const fastrtps__type_fingerprint_t ** fingerprint)
+{
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  auto type_handle = static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle);
+  if (!fastrtps__dynamic_type_handle_get_type(fastrtps_impl, type_handle)) {
+    RCUTILS_SET_ERROR_MSG("Could not build lazy type for message log");
+    return RCUTILS_RET_ERROR;
+  }
+  *fingerprint = &type_handle->fingerprint_;
+  return RCUTILS_RET_OK;
+}
+
+
+// WRITER ==========================================================================================
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_message_log_writer_t * writer)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(path, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(writer, RCUTILS_RET_INVALID_ARGUMENT);
+
+  fastrtps__message_log_writer_t * handle = NULL;
+  rcutils_ret_t ret = fastrtps__message_log_writer_open(path, allocator, &handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  writer->allocator = *allocator;
+  writer->handle = handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_append_data(
+  rosidl_dynamic_typesupport_fastrtps_message_log_writer_t * writer,
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+  int64_t timestamp)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(writer, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(writer->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+
+  const fastrtps__type_fingerprint_t * fingerprint = NULL;
+  rcutils_ret_t ret = fastrtps__message_log_type_fingerprint(
+    serialization_support_impl, type_impl, &fingerprint);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  return fastrtps__message_log_writer_append_data(
+    static_cast<fastrtps__message_log_writer_t *>(writer->handle),
+    timestamp, fingerprint, static_cast<DynamicData *>(data_impl->handle));
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_append_serialized(
+  rosidl_dynamic_typesupport_fastrtps_message_log_writer_t * writer,
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const rcutils_uint8_array_t * buffer,
+  int64_t timestamp)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(writer, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(writer->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(buffer, RCUTILS_RET_INVALID_ARGUMENT);
+  if (buffer->buffer_length > 0) {
+    RCUTILS_CHECK_ARGUMENT_FOR_NULL(buffer->buffer, RCUTILS_RET_INVALID_ARGUMENT);
+  }
+
+  const fastrtps__type_fingerprint_t * fingerprint = NULL;
+  rcutils_ret_t ret = fastrtps__message_log_type_fingerprint(
+    serialization_support_impl, type_impl, &fingerprint);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  return fastrtps__message_log_writer_append(
+    static_cast<fastrtps__message_log_writer_t *>(writer->handle),
+    timestamp, fingerprint, buffer->buffer, buffer->buffer_length);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_writer_close(
+  rosidl_dynamic_typesupport_fastrtps_message_log_writer_t * writer)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(writer, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!writer->handle) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = fastrtps__message_log_writer_close(
+    static_cast<fastrtps__message_log_writer_t *>(writer->handle));
+  writer->handle = NULL;
+  return ret;
+}
+
+
+// READER ==========================================================================================
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(path, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(reader, RCUTILS_RET_INVALID_ARGUMENT);
+
+  fastrtps__message_log_reader_t * handle = NULL;
+  rcutils_ret_t ret = fastrtps__message_log_reader_open(path, allocator, &handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  reader->allocator = *allocator;
+  reader->handle = handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_get_message_count(
+  const rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader,
+  size_t * count)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(reader, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(reader->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(count, RCUTILS_RET_INVALID_ARGUMENT);
+  *count = static_cast<size_t>(
+    static_cast<const fastrtps__message_log_reader_t *>(reader->handle)->entry_count_);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_get_message(
+  const rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader,
+  size_t index,
+  int64_t * timestamp,
+  uint64_t * fingerprint,
+  rcutils_uint8_array_t * message)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(reader, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(reader->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(message, RCUTILS_RET_INVALID_ARGUMENT);
+
+  fastrtps__message_log_entry_t entry;
+  const uint8_t * data = NULL;
+  rcutils_ret_t ret = fastrtps__message_log_reader_get(
+    static_cast<const fastrtps__message_log_reader_t *>(reader->handle), index, &entry, &data);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  if (timestamp) {
+    *timestamp = entry.timestamp;
+  }
+  if (fingerprint) {
+    fingerprint[0] = entry.fingerprint[0];
+    fingerprint[1] = entry.fingerprint[1];
+  }
+  // A view into the mapping, the zero allocator keeps it from being resized or finalized
+  message->buffer = const_cast<uint8_t *>(data);
+  message->buffer_length = static_cast<size_t>(entry.length);
+  message->buffer_capacity = static_cast<size_t>(entry.length);
+  message->allocator = rcutils_get_zero_initialized_allocator();
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_find_time_range(
+  const rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader,
+  int64_t start, int64_t end,
+  size_t * first,
+  size_t * count)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(reader, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(reader->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(first, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(count, RCUTILS_RET_INVALID_ARGUMENT);
+
+  uint64_t first_index = 0;
+  uint64_t index_count = 0;
+  fastrtps__message_log_reader_find_time_range(
+    static_cast<const fastrtps__message_log_reader_t *>(reader->handle),
+    start, end, &first_index, &index_count);
+  *first = static_cast<size_t>(first_index);
+  *count = static_cast<size_t>(index_count);
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_reader_close(
+  rosidl_dynamic_typesupport_fastrtps_message_log_reader_t * reader)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(reader, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!reader->handle) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = fastrtps__message_log_reader_close(
+    static_cast<fastrtps__message_log_reader_t *>(reader->handle));
+  reader->handle = NULL;
+  return ret;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_message_log_get_type_fingerprint(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  uint64_t * fingerprint)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(fingerprint, RCUTILS_RET_INVALID_ARGUMENT);
+
+  const fastrtps__type_fingerprint_t * type_fingerprint = NULL;
+  rcutils_ret_t ret = fastrtps__message_log_type_fingerprint(
+    serialization_support_impl, type_impl, &type_fingerprint);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  fingerprint[0] = type_fingerprint->hash[0];
+  fingerprint[1] = type_fingerprint->hash[1];
+  return RCUTILS_RET_OK;
+}
@@ -0,0 +1,144 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include "rosidl_dynamic_typesupport_fastrtps/sequence_index.h"
+
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_sequence_index.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+
+
+// =================================================================================================
+// SEQUENCE INDEX
+// =================================================================================================
+rosidl_dynamic_typesupport_fastrtps_sequence_index_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_sequence_index(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_sequence_index_t index;
+  index.allocator = rcutils_get_zero_initialized_allocator();
+  index.handle = NULL;
+  return index;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl,
+  const char * path,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(path, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(index, RCUTILS_RET_INVALID_ARGUMENT);
+
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  const auto & type = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, static_cast<fastrtps__dynamic_type_handle_t *>(type_impl->handle));
+  if (!type) {
+    RCUTILS_SET_ERROR_MSG("Could not build type for sequence index");
+    return RCUTILS_RET_ERROR;
+  }
+
+  fastrtps__sequence_index_t * handle = NULL;
+  rcutils_ret_t ret = fastrtps__sequence_index_init(type, path, allocator, &handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  index->allocator = *allocator;
+  index->handle = handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_build(
+  rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index,
+  const rcutils_uint8_array_t * serialized)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(index, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(index->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialized, RCUTILS_RET_INVALID_ARGUMENT);
+  return fastrtps__sequence_index_build(
+    static_cast<fastrtps__sequence_index_t *>(index->handle),
+    serialized->buffer, serialized->buffer_length);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_get_element_count(
+  const rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index,
+  size_t * count)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(index, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(index->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(count, RCUTILS_RET_INVALID_ARGUMENT);
+  *count = fastrtps__sequence_index_get_element_count(
+    static_cast<const fastrtps__sequence_index_t *>(index->handle));
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_get_element(
+  const rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index,
+  size_t element_index,
+  size_t * offset,
+  size_t * length)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(index, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(index->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(offset, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(length, RCUTILS_RET_INVALID_ARGUMENT);
+
+  auto handle = static_cast<const fastrtps__sequence_index_t *>(index->handle);
+  if (element_index >= fastrtps__sequence_index_get_element_count(handle)) {
+    RCUTILS_SET_ERROR_MSG("Element index out of range");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  *offset = handle->offsets_[element_index];
+  *length = handle->offsets_[element_index + 1] - handle->offsets_[element_index];
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_sequence_index_fini(
+  rosidl_dynamic_typesupport_fastrtps_sequence_index_t * index)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(index, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!index->handle) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = fastrtps__sequence_index_fini(
+    static_cast<fastrtps__sequence_index_t *>(index->handle));
+  index->handle = NULL;
+  return ret;
+}
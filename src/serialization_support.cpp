@@ -21,8 +21,8 @@
 #include <rosidl_dynamic_typesupport/api/serialization_support_interface.h>
 #include <rosidl_dynamic_typesupport/types.h>
 
-#include <fastrtps/types/DynamicDataFactory.h>
-#include <fastrtps/types/DynamicTypeBuilderFactory.h>
+#include <atomic>
+#include <new>
 
 #include "rosidl_dynamic_typesupport_fastrtps/identifier.h"
 #include "rosidl_dynamic_typesupport_fastrtps/serialization_support.h"
@@ -46,22 +46,22 @@ rosidl_dynamic_typesupport_fastrtps_init_serialization_support_impl(
   }
   RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
 
-  auto serialization_support_impl_handle =
-    static_cast<fastrtps__serialization_support_impl_handle_t *>(allocator->zero_allocate(
-      1, sizeof(fastrtps__serialization_support_impl_handle_t), allocator->state));
-  if (!serialization_support_impl_handle) {
+  void * serialization_support_impl_handle_mem = allocator->allocate(
+    sizeof(fastrtps__serialization_support_impl_handle_t), allocator->state);
+  if (!serialization_support_impl_handle_mem) {
     RCUTILS_SET_ERROR_MSG("could not allocate fastrtps serialization support impl handle");
     return RCUTILS_RET_BAD_ALLOC;
   }
 
+  // The handle owns C++ members (the type cache), so it must be constructed in place
+  auto serialization_support_impl_handle =
+    new (serialization_support_impl_handle_mem) fastrtps__serialization_support_impl_handle_t();
+
   serialization_support_impl->allocator = *allocator;
   serialization_support_impl->serialization_library_identifier =
     fastrtps_serialization_support_library_identifier;
 
-  serialization_support_impl_handle->type_factory_ =
-    eprosima::fastrtps::types::DynamicTypeBuilderFactory::get_instance();
-  serialization_support_impl_handle->data_factory_ =
-    eprosima::fastrtps::types::DynamicDataFactory::get_instance();
+  fastrtps__serialization_support_acquire_factories(serialization_support_impl_handle);
 
   serialization_support_impl->handle = serialization_support_impl_handle;
 
@@ -69,6 +69,21 @@ rosidl_dynamic_typesupport_fastrtps_init_serialization_support_impl(
 }
 
 
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_set_lazy_nested_types(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  bool lazy_nested_types)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl->handle, RCUTILS_RET_INVALID_ARGUMENT);
+
+  static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle)->lazy_nested_types_.store(
+    lazy_nested_types, std::memory_order_relaxed);
+  return RCUTILS_RET_OK;
+}
+
+
 // =================================================================================================
 // SERIALIZATION SUPPORT INTERFACE
 // =================================================================================================
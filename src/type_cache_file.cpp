@@ -0,0 +1,136 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <vector>
+
+#include "rosidl_dynamic_typesupport_fastrtps/type_cache_file.h"
+
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+#include "detail/fastrtps_type_cache_file.hpp"
+
+
+// =================================================================================================
+// TYPE CACHE FILE
+// =================================================================================================
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_type_cache_file(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t cache_file;
+  cache_file.allocator = rcutils_get_zero_initialized_allocator();
+  cache_file.handle = NULL;
+  return cache_file;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_write(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  const char * path,
+  const rosidl_dynamic_typesupport_dynamic_type_impl_t * const * type_impls,
+  size_t type_count)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(path, RCUTILS_RET_INVALID_ARGUMENT);
+  if (type_count > 0) {
+    RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impls, RCUTILS_RET_INVALID_ARGUMENT);
+  }
+
+  std::vector<fastrtps__dynamic_type_handle_t *> type_handles(type_count);
+  for (size_t i = 0; i < type_count; ++i) {
+    RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+      type_impls[i], "type impl is null", return RCUTILS_RET_INVALID_ARGUMENT);
+    type_handles[i] = static_cast<fastrtps__dynamic_type_handle_t *>(type_impls[i]->handle);
+  }
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  return fastrtps__type_cache_file_write(fastrtps_impl, path, type_handles.data(), type_count);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_open(
+  const char * path,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t * cache_file)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(path, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(cache_file, RCUTILS_RET_INVALID_ARGUMENT);
+
+  fastrtps__type_cache_file_t * handle = NULL;
+  rcutils_ret_t ret = fastrtps__type_cache_file_open(path, allocator, &handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  cache_file->allocator = *allocator;
+  cache_file->handle = handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_get_type(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t * cache_file,
+  const char * name, size_t name_length,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type_impl)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(cache_file, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(cache_file->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(name, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  fastrtps__dynamic_type_handle_t * type_handle = NULL;
+  rcutils_ret_t ret = fastrtps__type_cache_file_get_type(
+    fastrtps_impl,
+    static_cast<fastrtps__type_cache_file_t *>(cache_file->handle),
+    name, name_length, &type_handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  type_impl->allocator = *allocator;
+  type_impl->handle = type_handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_cache_file_fini(
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t * cache_file)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(cache_file, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!cache_file->handle) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = fastrtps__type_cache_file_fini(
+    static_cast<fastrtps__type_cache_file_t *>(cache_file->handle));
+  cache_file->handle = NULL;
+  return ret;
+}
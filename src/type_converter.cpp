@@ -0,0 +1,134 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <fastrtps/types/DynamicData.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include "rosidl_dynamic_typesupport_fastrtps/type_converter.h"
+
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+#include "detail/fastrtps_type_converter.hpp"
+
+
+using eprosima::fastrtps::types::DynamicData;
+
+
+// =================================================================================================
+// TYPE CONVERTER
+// =================================================================================================
+rosidl_dynamic_typesupport_fastrtps_type_converter_t
+rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_type_converter(void)
+{
+  rosidl_dynamic_typesupport_fastrtps_type_converter_t converter;
+  converter.allocator = rcutils_get_zero_initialized_allocator();
+  converter.handle = NULL;
+  return converter;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_converter_init(
+  rosidl_dynamic_typesupport_serialization_support_impl_t * serialization_support_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * from_type_impl,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * to_type_impl,
+  rcutils_allocator_t * allocator,
+  rosidl_dynamic_typesupport_fastrtps_type_converter_t * converter)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(serialization_support_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(from_type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(to_type_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(allocator, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!rcutils_allocator_is_valid(allocator)) {
+    RCUTILS_SET_ERROR_MSG("allocator is invalid");
+    return RCUTILS_RET_INVALID_ARGUMENT;
+  }
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(converter, RCUTILS_RET_INVALID_ARGUMENT);
+
+  auto fastrtps_impl = static_cast<fastrtps__serialization_support_impl_handle_t *>(
+    serialization_support_impl->handle);
+  const auto & from = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, static_cast<fastrtps__dynamic_type_handle_t *>(from_type_impl->handle));
+  const auto & to = fastrtps__dynamic_type_handle_get_type(
+    fastrtps_impl, static_cast<fastrtps__dynamic_type_handle_t *>(to_type_impl->handle));
+  if (!from || !to) {
+    RCUTILS_SET_ERROR_MSG("Could not build types to convert between");
+    return RCUTILS_RET_ERROR;
+  }
+
+  fastrtps__type_converter_t * handle = NULL;
+  rcutils_ret_t ret = fastrtps__type_converter_init(
+    fastrtps_impl->data_factory_, from, to, allocator, &handle);
+  if (ret != RCUTILS_RET_OK) {
+    return ret;
+  }
+  converter->allocator = *allocator;
+  converter->handle = handle;
+  return RCUTILS_RET_OK;
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_converter_convert_data(
+  const rosidl_dynamic_typesupport_fastrtps_type_converter_t * converter,
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * from_data_impl,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * to_data_impl)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(converter, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(converter->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(from_data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(to_data_impl, RCUTILS_RET_INVALID_ARGUMENT);
+  return fastrtps__type_converter_convert_data(
+    static_cast<const fastrtps__type_converter_t *>(converter->handle),
+    static_cast<const DynamicData *>(from_data_impl->handle),
+    static_cast<DynamicData *>(to_data_impl->handle));
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_converter_convert_serialized(
+  const rosidl_dynamic_typesupport_fastrtps_type_converter_t * converter,
+  const rcutils_uint8_array_t * from,
+  rcutils_uint8_array_t * to)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(converter, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(converter->handle, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(from, RCUTILS_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(to, RCUTILS_RET_INVALID_ARGUMENT);
+  return fastrtps__type_converter_convert_serialized(
+    static_cast<const fastrtps__type_converter_t *>(converter->handle),
+    from->buffer, from->buffer_length, to);
+}
+
+
+rcutils_ret_t
+rosidl_dynamic_typesupport_fastrtps_type_converter_fini(
+  rosidl_dynamic_typesupport_fastrtps_type_converter_t * converter)
+{
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(converter, RCUTILS_RET_INVALID_ARGUMENT);
+  if (!converter->handle) {
+    return RCUTILS_RET_OK;
+  }
+  rcutils_ret_t ret = fastrtps__type_converter_fini(
+    static_cast<fastrtps__type_converter_t *>(converter->handle));
+  converter->handle = NULL;
+  return ret;
+}
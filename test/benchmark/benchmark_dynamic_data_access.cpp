@@ -0,0 +1,348 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+#include <performance_test_fixture/performance_test_fixture.hpp>
+
+#include <rosidl_dynamic_typesupport/api/serialization_support_interface.h>
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/serialization_support.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+#include "message_shapes.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+
+// =================================================================================================
+// DYNAMIC DATA ACCESS BENCHMARKS
+// =================================================================================================
+//
+// One get, set or insert call per iteration, for every member kind, each measured twice:
+//
+//   <accessor>/direct     calling the fastrtps__dynamic_data_* function
+//   <accessor>/interface  calling it through the serialization support interface table
+//
+// The difference between the two is the dispatch cost, and the direct numbers are what the
+// per-call conversions (std::string temporaries, size_t to uint32_t checks, new[] string outputs)
+// cost on top of fastrtps itself. The fixture adds the heap allocations per call.
+
+
+/// A struct with a member and an unbounded sequence member of every kind, named after the kind
+class AccessorBenchmark : public PerformanceTest
+{
+public:
+  void
+  SetUp(benchmark::State & state) override
+  {
+    support_ = std::make_unique<SerializationSupport>();
+    check(
+      rosidl_dynamic_typesupport_fastrtps_init_serialization_support_interface(
+        &support_->allocator, &interface_),
+      "init serialization support interface");
+
+    {
+      TypeBuilder builder(support_.get(), "benchmark/msg/AllKinds");
+#define ADD_PRIMITIVE_MEMBERS(KIND, TYPE, VALUE) \
+  ids_[#KIND] = builder.add(fastrtps__dynamic_type_builder_add_ ## KIND ## _member, #KIND); \
+  ids_[#KIND "_sequence"] = builder.add( \
+    fastrtps__dynamic_type_builder_add_ ## KIND ## _unbounded_sequence_member, #KIND "_sequence");
+#define ADD_STRING_MEMBERS(KIND, CHAR, VALUE, EXTRA) \
+  ids_[#KIND] = builder.add( \
+    fastrtps__dynamic_type_builder_add_ ## KIND ## _member, #KIND UNPARENTHESIZE EXTRA); \
+  ids_[#KIND "_sequence"] = builder.add( \
+    fastrtps__dynamic_type_builder_add_ ## KIND ## _unbounded_sequence_member, \
+    #KIND "_sequence" UNPARENTHESIZE EXTRA);
+      PRIMITIVE_KINDS(ADD_PRIMITIVE_MEMBERS)
+      STRING_KINDS(ADD_STRING_MEMBERS)
+#undef ADD_PRIMITIVE_MEMBERS
+#undef ADD_STRING_MEMBERS
+      type_ = builder.build();
+    }
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        &support_->impl, &type_, &support_->allocator, &data_),
+      "init data");
+
+    PerformanceTest::SetUp(state);
+  }
+
+  void
+  TearDown(benchmark::State & state) override
+  {
+    PerformanceTest::TearDown(state);
+    fastrtps__dynamic_data_fini(&support_->impl, &data_);
+    fastrtps__dynamic_type_fini(&support_->impl, &type_);
+    fastrtps__serialization_support_interface_fini(&interface_);
+    ids_.clear();
+    support_.reset();
+  }
+
+  /// Run `body` between SetUp and TearDown, benchmarks are registered at runtime, not with the
+  /// fixture macros
+  void
+  run(benchmark::State & state, const std::function<void(benchmark::State &)> & body)
+  {
+    SetUp(state);
+    body(state);
+    TearDown(state);
+  }
+
+  using PerformanceTest::reset_heap_counters;
+
+  std::unique_ptr<SerializationSupport> support_;
+  rosidl_dynamic_typesupport_serialization_support_interface_t interface_;
+  rosidl_dynamic_typesupport_dynamic_type_impl_t type_;
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data_;
+  std::map<std::string, rosidl_dynamic_typesupport_member_id_t> ids_;
+};
+
+
+// LOOPS ===========================================================================================
+// `call` is one of the accessor lambdas below, taking the fixture first
+
+template<typename ValueT, typename CallT>
+void
+get_primitive(AccessorBenchmark & f, benchmark::State & state, const char * kind, CallT call)
+{
+  auto id = f.ids_.at(kind);
+  ValueT value{};
+  f.reset_heap_counters();
+  for (auto _ : state) {
+    if (call(f, &f.support_->impl, &f.data_, id, &value) != RCUTILS_RET_OK) {
+      state.SkipWithError("get failed");
+      break;
+    }
+    benchmark::DoNotOptimize(value);
+    benchmark::ClobberMemory();
+  }
+}
+
+template<typename ValueT, typename CallT>
+void
+set_primitive(
+  AccessorBenchmark & f, benchmark::State & state, const char * kind, ValueT value, CallT call)
+{
+  auto id = f.ids_.at(kind);
+  f.reset_heap_counters();
+  for (auto _ : state) {
+    if (call(f, &f.support_->impl, &f.data_, id, value) != RCUTILS_RET_OK) {
+      state.SkipWithError("set failed");
+      break;
+    }
+    benchmark::ClobberMemory();
+  }
+}
+
+// Strings are returned in a new[] allocation the caller owns, freeing it is part of every get
+template<typename CharT, typename CallT>
+void
+get_string(AccessorBenchmark & f, benchmark::State & state, const char * kind, CallT call)
+{
+  auto id = f.ids_.at(kind);
+  f.reset_heap_counters();
+  for (auto _ : state) {
+    CharT * value = nullptr;
+    size_t value_length = 0;
+    if (call(f, &f.support_->impl, &f.data_, id, &value, &value_length) != RCUTILS_RET_OK) {
+      state.SkipWithError("get failed");
+      break;
+    }
+    benchmark::DoNotOptimize(value);
+    delete[] value;
+  }
+}
+
+template<typename CharT, typename CallT>
+void
+set_string(
+  AccessorBenchmark & f, benchmark::State & state, const char * kind, const CharT * value,
+  CallT call)
+{
+  auto id = f.ids_.at(kind);
+  size_t value_length = std::char_traits<CharT>::length(value);
+  f.reset_heap_counters();
+  for (auto _ : state) {
+    if (call(f, &f.support_->impl, &f.data_, id, value, value_length) != RCUTILS_RET_OK) {
+      state.SkipWithError("set failed");
+      break;
+    }
+    benchmark::ClobberMemory();
+  }
+}
+
+// Inserts at the end of the `kind` sequence member, `insert_one(sequence, out_id)` inserts one item
+template<typename InsertOneT>
+void
+insert_values(
+  AccessorBenchmark & f, benchmark::State & state, const char * kind, InsertOneT insert_one)
+{
+  rosidl_dynamic_typesupport_dynamic_data_impl_t sequence;
+  check(
+    fastrtps__dynamic_data_loan_value(
+      &f.support_->impl, &f.data_, f.ids_.at(std::string(kind) + "_sequence"),
+      &f.support_->allocator, &sequence),
+    "loan sequence");
+
+  f.reset_heap_counters();
+  size_t inserted = 0;
+  for (auto _ : state) {
+    rosidl_dynamic_typesupport_member_id_t out_id;
+    if (insert_one(&sequence, &out_id) != RCUTILS_RET_OK) {
+      state.SkipWithError("insert failed");
+      break;
+    }
+    benchmark::DoNotOptimize(out_id);
+
+    // Keep the sequence short, this measures inserting, not growing a huge sequence
+    if (++inserted % 4096 == 0) {
+      state.PauseTiming();
+      check(
+        fastrtps__dynamic_data_clear_sequence_data(&f.support_->impl, &sequence),
+        "clear sequence");
+      state.ResumeTiming();
+    }
+  }
+
+  check(
+    fastrtps__dynamic_data_return_loaned_value(&f.support_->impl, &f.data_, &sequence),
+    "return sequence");
+}
+
+template<typename ValueT, typename CallT>
+void
+insert_primitive(
+  AccessorBenchmark & f, benchmark::State & state, const char * kind, ValueT value, CallT call)
+{
+  insert_values(
+    f, state, kind,
+    [&](auto sequence, auto out_id) {return call(f, &f.support_->impl, sequence, value, out_id);});
+}
+
+template<typename CharT, typename CallT>
+void
+insert_string(
+  AccessorBenchmark & f, benchmark::State & state, const char * kind, const CharT * value,
+  CallT call)
+{
+  size_t value_length = std::char_traits<CharT>::length(value);
+  insert_values(
+    f, state, kind,
+    [&](auto sequence, auto out_id) {
+      return call(f, &f.support_->impl, sequence, value, value_length, out_id);
+    });
+}
+
+
+// REGISTRATION ====================================================================================
+// `VIA(f, FUNCTION)` names the dynamic data function to call, directly or through the interface
+#define DIRECT(f, FUNCTION) fastrtps__dynamic_data_ ## FUNCTION
+#define INTERFACE(f, FUNCTION) f.interface_.dynamic_data_ ## FUNCTION
+
+#define REGISTER_PRIMITIVE_ACCESSORS_VIA(KIND, TYPE, VALUE, VIA, PATH) \
+  register_accessor( \
+    "get_" #KIND "_value/" PATH, [](AccessorBenchmark & f, benchmark::State & state) { \
+      get_primitive<TYPE>( \
+        f, state, #KIND, [](AccessorBenchmark & f, auto impl, auto data, auto id, auto value) { \
+          (void) f; return VIA(f, get_ ## KIND ## _value)(impl, data, id, value); \
+        }); \
+    }); \
+  register_accessor( \
+    "set_" #KIND "_value/" PATH, [](AccessorBenchmark & f, benchmark::State & state) { \
+      set_primitive<TYPE>( \
+        f, state, #KIND, VALUE, \
+        [](AccessorBenchmark & f, auto impl, auto data, auto id, auto value) { \
+          (void) f; return VIA(f, set_ ## KIND ## _value)(impl, data, id, value); \
+        }); \
+    }); \
+  register_accessor( \
+    "insert_" #KIND "_value/" PATH, [](AccessorBenchmark & f, benchmark::State & state) { \
+      insert_primitive<TYPE>( \
+        f, state, #KIND, VALUE, \
+        [](AccessorBenchmark & f, auto impl, auto data, auto value, auto out_id) { \
+          (void) f; return VIA(f, insert_ ## KIND ## _value)(impl, data, value, out_id); \
+        }); \
+    });
+
+#define REGISTER_STRING_ACCESSORS_VIA(KIND, CHAR, VALUE, EXTRA, VIA, PATH) \
+  register_accessor( \
+    "get_" #KIND "_value/" PATH, [](AccessorBenchmark & f, benchmark::State & state) { \
+      get_string<CHAR>( \
+        f, state, #KIND, \
+        [](AccessorBenchmark & f, auto impl, auto data, auto id, auto value, auto length) { \
+          (void) f; \
+          return VIA(f, get_ ## KIND ## _value)( \
+            impl, data, id, value, length UNPARENTHESIZE EXTRA); \
+        }); \
+    }); \
+  register_accessor( \
+    "set_" #KIND "_value/" PATH, [](AccessorBenchmark & f, benchmark::State & state) { \
+      set_string<CHAR>( \
+        f, state, #KIND, VALUE, \
+        [](AccessorBenchmark & f, auto impl, auto data, auto id, auto value, auto length) { \
+          (void) f; \
+          return VIA(f, set_ ## KIND ## _value)( \
+            impl, data, id, value, length UNPARENTHESIZE EXTRA); \
+        }); \
+    }); \
+  register_accessor( \
+    "insert_" #KIND "_value/" PATH, [](AccessorBenchmark & f, benchmark::State & state) { \
+      insert_string<CHAR>( \
+        f, state, #KIND, VALUE, \
+        [](AccessorBenchmark & f, auto impl, auto data, auto value, auto length, auto out_id) { \
+          (void) f; \
+          return VIA(f, insert_ ## KIND ## _value)( \
+            impl, data, value, length UNPARENTHESIZE EXTRA, out_id); \
+        }); \
+    });
+
+#define REGISTER_PRIMITIVE_ACCESSORS(KIND, TYPE, VALUE) \
+  REGISTER_PRIMITIVE_ACCESSORS_VIA(KIND, TYPE, VALUE, DIRECT, "direct") \
+  REGISTER_PRIMITIVE_ACCESSORS_VIA(KIND, TYPE, VALUE, INTERFACE, "interface")
+
+#define REGISTER_STRING_ACCESSORS(KIND, CHAR, VALUE, EXTRA) \
+  REGISTER_STRING_ACCESSORS_VIA(KIND, CHAR, VALUE, EXTRA, DIRECT, "direct") \
+  REGISTER_STRING_ACCESSORS_VIA(KIND, CHAR, VALUE, EXTRA, INTERFACE, "interface")
+
+
+static void
+register_accessor(
+  const std::string & name, void (* body)(AccessorBenchmark &, benchmark::State &))
+{
+  benchmark::RegisterBenchmark(
+    ("AccessorBenchmark/" + name).c_str(),
+    [body](benchmark::State & state) {
+      AccessorBenchmark fixture;
+      fixture.run(state, [&](benchmark::State & s) {body(fixture, s);});
+    });
+}
+
+static bool
+register_accessors()
+{
+  PRIMITIVE_KINDS(REGISTER_PRIMITIVE_ACCESSORS)
+  STRING_KINDS(REGISTER_STRING_ACCESSORS)
+  return true;
+}
+
+static const bool accessors_registered = register_accessors();
@@ -0,0 +1,225 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+#include <performance_test_fixture/performance_test_fixture.hpp>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "message_shapes.hpp"
+#include "random_messages.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+
+// =================================================================================================
+// RANDOM CORPUS BENCHMARKS
+// =================================================================================================
+//
+// A corpus of random message types, each with a random message, for each nesting depth (the
+// benchmark argument). The seeds are fixed, so the corpus is the same from run to run.
+//
+//   serialize, deserialize  the whole corpus per iteration
+//   round_trip              one fresh random message per iteration, each from a new seed: serialize
+//                           it, deserialize it into new data and check the two are equal and
+//                           serialize to the same bytes. Fails the benchmark with both seeds on any
+//                           mismatch
+
+static constexpr uint64_t CORPUS_SEED = 0x5eed;
+static constexpr uint64_t ROUND_TRIP_SEED = 0x7e57;
+static constexpr size_t CORPUS_SIZE = 32;
+
+
+// Empty if the message from `data_seed` survives a round trip, what went wrong otherwise
+static std::string
+round_trip(
+  SerializationSupport * support, RandomMessage * message, uint64_t data_seed,
+  rcutils_uint8_array_t * buffer, rcutils_uint8_array_t * other_buffer)
+{
+  auto impl = &support->impl;
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+  rosidl_dynamic_typesupport_dynamic_data_impl_t other_data;
+  check(
+    fastrtps__dynamic_data_init_from_dynamic_type(
+      impl, message->type(), &support->allocator, &data),
+    "init data");
+  check(
+    fastrtps__dynamic_data_init_from_dynamic_type(
+      impl, message->type(), &support->allocator, &other_data),
+    "init data");
+  message->fill(data_seed, &data);
+
+  std::string error;
+  bool equals = false;
+  if (fastrtps__dynamic_data_serialize(impl, &data, buffer) != RCUTILS_RET_OK) {
+    error = "serialize failed";
+  } else if (fastrtps__dynamic_data_deserialize(impl, &other_data, buffer) != RCUTILS_RET_OK) {
+    error = "deserialize failed";
+  } else if (
+    fastrtps__dynamic_data_equals(impl, &data, &other_data, &equals) != RCUTILS_RET_OK ||
+    !equals)
+  {
+    error = "deserialized data differs";
+  } else if (fastrtps__dynamic_data_serialize(impl, &other_data, other_buffer) != RCUTILS_RET_OK) {
+    error = "serialize deserialized data failed";
+  } else if (
+    buffer->buffer_length != other_buffer->buffer_length ||
+    std::memcmp(buffer->buffer, other_buffer->buffer, buffer->buffer_length) != 0)
+  {
+    error = "deserialized data serializes differently";
+  }
+
+  fastrtps__dynamic_data_fini(impl, &other_data);
+  fastrtps__dynamic_data_fini(impl, &data);
+  if (!error.empty()) {
+    error += " (type seed " + std::to_string(message->seed()) + ", data seed " +
+      std::to_string(data_seed) + ")";
+  }
+  return error;
+}
+
+
+class RandomCorpusBenchmark : public PerformanceTest
+{
+public:
+  void
+  SetUp(benchmark::State & state) override
+  {
+    RandomMessageOptions options;
+    options.max_depth = static_cast<int>(state.range(0));
+    support_ = std::make_unique<SerializationSupport>();
+
+    // Serialized once up front: the deserialize benchmark reads the buffers, and the serialize
+    // benchmark reuses them, so neither measures buffer growth
+    corpus_bytes_ = 0;
+    for (size_t i = 0; i < CORPUS_SIZE; ++i) {
+      corpus_.push_back(std::make_unique<RandomMessage>(support_.get(), CORPUS_SEED + i, options));
+      buffers_.push_back(rcutils_get_zero_initialized_uint8_array());
+      check(rcutils_uint8_array_init(&buffers_.back(), 0, &support_->allocator), "init buffer");
+      check(
+        fastrtps__dynamic_data_serialize(&support_->impl, &corpus_.back()->data, &buffers_.back()),
+        "serialize");
+      corpus_bytes_ += buffers_.back().buffer_length;
+    }
+
+    PerformanceTest::SetUp(state);
+  }
+
+  void
+  TearDown(benchmark::State & state) override
+  {
+    PerformanceTest::TearDown(state);
+    for (auto & buffer : buffers_) {
+      rcutils_uint8_array_fini(&buffer);
+    }
+    buffers_.clear();
+    corpus_.clear();
+    support_.reset();
+  }
+
+protected:
+  std::unique_ptr<SerializationSupport> support_;
+  std::vector<std::unique_ptr<RandomMessage>> corpus_;
+  std::vector<rcutils_uint8_array_t> buffers_;
+  size_t corpus_bytes_;
+};
+
+
+BENCHMARK_DEFINE_F(RandomCorpusBenchmark, serialize)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    for (size_t i = 0; i < corpus_.size(); ++i) {
+      if (fastrtps__dynamic_data_serialize(&support_->impl, &corpus_[i]->data, &buffers_[i]) !=
+        RCUTILS_RET_OK)
+      {
+        state.SkipWithError("serialize failed");
+        break;
+      }
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(corpus_bytes_));
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(corpus_.size()));
+}
+BENCHMARK_REGISTER_F(RandomCorpusBenchmark, serialize)->DenseRange(0, 3)->ArgName("depth");
+
+
+BENCHMARK_DEFINE_F(RandomCorpusBenchmark, deserialize)(benchmark::State & state)
+{
+  std::vector<rosidl_dynamic_typesupport_dynamic_data_impl_t> data(corpus_.size());
+  for (size_t i = 0; i < corpus_.size(); ++i) {
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        &support_->impl, corpus_[i]->type(), &support_->allocator, &data[i]),
+      "init data");
+  }
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    for (size_t i = 0; i < corpus_.size(); ++i) {
+      if (fastrtps__dynamic_data_deserialize(&support_->impl, &data[i], &buffers_[i]) !=
+        RCUTILS_RET_OK)
+      {
+        state.SkipWithError("deserialize failed");
+        break;
+      }
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(corpus_bytes_));
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(corpus_.size()));
+
+  for (auto & d : data) {
+    fastrtps__dynamic_data_fini(&support_->impl, &d);
+  }
+}
+BENCHMARK_REGISTER_F(RandomCorpusBenchmark, deserialize)->DenseRange(0, 3)->ArgName("depth");
+
+
+BENCHMARK_DEFINE_F(RandomCorpusBenchmark, round_trip)(benchmark::State & state)
+{
+  rcutils_uint8_array_t buffer = rcutils_get_zero_initialized_uint8_array();
+  rcutils_uint8_array_t other_buffer = rcutils_get_zero_initialized_uint8_array();
+  check(rcutils_uint8_array_init(&buffer, 0, &support_->allocator), "init buffer");
+  check(rcutils_uint8_array_init(&other_buffer, 0, &support_->allocator), "init buffer");
+
+  reset_heap_counters();
+  uint64_t data_seed = ROUND_TRIP_SEED;
+  for (auto _ : state) {
+    RandomMessage * message = corpus_[data_seed % corpus_.size()].get();
+    std::string error = round_trip(support_.get(), message, data_seed, &buffer, &other_buffer);
+    if (!error.empty()) {
+      state.SkipWithError(error.c_str());
+      break;
+    }
+    ++data_seed;
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  rcutils_uint8_array_fini(&other_buffer);
+  rcutils_uint8_array_fini(&buffer);
+}
+BENCHMARK_REGISTER_F(RandomCorpusBenchmark, round_trip)->DenseRange(0, 3)->ArgName("depth");
@@ -0,0 +1,125 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+#include <performance_test_fixture/performance_test_fixture.hpp>
+
+#include <rcutils/allocator.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "message_shapes.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+
+// =================================================================================================
+// SERIALIZATION BENCHMARKS
+// =================================================================================================
+//
+// Serialize and deserialize one message per iteration, for each message shape (the benchmark
+// argument). Throughput is reported in bytes and messages per second, and the fixture adds the
+// heap allocations per message.
+
+class SerializationBenchmark : public PerformanceTest
+{
+public:
+  void
+  SetUp(benchmark::State & state) override
+  {
+    int shape = static_cast<int>(state.range(0));
+    support_ = std::make_unique<SerializationSupport>();
+    message_ = std::make_unique<Message>(support_.get(), shape);
+    state.SetLabel(message_shape_name(shape));
+
+    // Serialized once up front: the deserialize benchmark reads it, and the serialize benchmark
+    // reuses its buffer, so neither measures buffer growth
+    buffer_ = rcutils_get_zero_initialized_uint8_array();
+    check(rcutils_uint8_array_init(&buffer_, 0, &support_->allocator), "init buffer");
+    check(
+      fastrtps__dynamic_data_serialize(&support_->impl, &message_->data, &buffer_), "serialize");
+
+    PerformanceTest::SetUp(state);
+  }
+
+  void
+  TearDown(benchmark::State & state) override
+  {
+    PerformanceTest::TearDown(state);
+    rcutils_uint8_array_fini(&buffer_);
+    message_.reset();
+    support_.reset();
+  }
+
+protected:
+  void
+  set_throughput(benchmark::State & state)
+  {
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(buffer_.buffer_length));
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  std::unique_ptr<SerializationSupport> support_;
+  std::unique_ptr<Message> message_;
+  rcutils_uint8_array_t buffer_;
+};
+
+
+BENCHMARK_DEFINE_F(SerializationBenchmark, serialize)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    if (fastrtps__dynamic_data_serialize(&support_->impl, &message_->data, &buffer_) !=
+      RCUTILS_RET_OK)
+    {
+      state.SkipWithError("serialize failed");
+      break;
+    }
+    benchmark::DoNotOptimize(buffer_.buffer);
+    benchmark::ClobberMemory();
+  }
+  set_throughput(state);
+}
+BENCHMARK_REGISTER_F(SerializationBenchmark, serialize)
+->DenseRange(0, MESSAGE_SHAPE_COUNT - 1)->ArgName("shape");
+
+
+BENCHMARK_DEFINE_F(SerializationBenchmark, deserialize)(benchmark::State & state)
+{
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+  check(
+    fastrtps__dynamic_data_init_from_dynamic_type(
+      &support_->impl, message_->type(), &support_->allocator, &data),
+    "init data");
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    if (fastrtps__dynamic_data_deserialize(&support_->impl, &data, &buffer_) != RCUTILS_RET_OK) {
+      state.SkipWithError("deserialize failed");
+      break;
+    }
+    benchmark::ClobberMemory();
+  }
+  set_throughput(state);
+
+  fastrtps__dynamic_data_fini(&support_->impl, &data);
+}
+BENCHMARK_REGISTER_F(SerializationBenchmark, deserialize)
+->DenseRange(0, MESSAGE_SHAPE_COUNT - 1)->ArgName("shape");
@@ -0,0 +1,283 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+#include <performance_test_fixture/performance_test_fixture.hpp>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+
+// =================================================================================================
+// TYPE CONSTRUCTION BENCHMARKS
+// =================================================================================================
+//
+// Build one type per iteration, from fresh type builders to a built dynamic type, for each type
+// shape (the benchmark argument). Nested struct types are added as member builders, the way types
+// are brought up from type descriptions.
+//
+// On top of the fixture's numbers per type, time and heap allocations are reported per member added
+// and per struct type built, nested ones included:
+//
+//   build       the serialization support's type cache is warm after the first iteration, like it
+//               is for every type but the first few in a long running process
+//   build_cold  every iteration gets a fresh serialization support, like the first types built at
+//               startup. Bringing it up is not timed, but its heap allocations are counted
+
+enum TypeShape
+{
+  TYPE_SHAPE_WIDE_STRUCT,
+  TYPE_SHAPE_DEEP_NESTING,
+  TYPE_SHAPE_ARRAYS_AND_SEQUENCES,
+  TYPE_SHAPE_POINT_CLOUD,
+  TYPE_SHAPE_COUNT,
+};
+
+struct TypeCounts
+{
+  int members;
+  int types;
+};
+
+
+// SHAPES ==========================================================================================
+// struct { bool member_0; byte member_1; ... string member_15; bool member_16; ... } 256 members
+static TypeCounts
+build_wide_struct(
+  SerializationSupport * support, rosidl_dynamic_typesupport_dynamic_type_impl_t * type)
+{
+#define ADD_MEMBER_FUNCTION(KIND, TYPE, VALUE) \
+  fastrtps__dynamic_type_builder_add_ ## KIND ## _member,
+  static decltype(&fastrtps__dynamic_type_builder_add_bool_member) const add_member[] = {
+    PRIMITIVE_KINDS(ADD_MEMBER_FUNCTION)
+    fastrtps__dynamic_type_builder_add_string_member,
+  };
+#undef ADD_MEMBER_FUNCTION
+  const int kind_count = sizeof(add_member) / sizeof(add_member[0]);
+  const int member_count = 256;
+
+  TypeBuilder builder(support, "benchmark/msg/WideStruct");
+  for (int i = 0; i < member_count; ++i) {
+    builder.add(add_member[i % kind_count], "member_" + std::to_string(i));
+  }
+  *type = builder.build();
+  return {member_count, 1};
+}
+
+// struct Level15 { int32 value; Level14 child }, down to Level0 { int32 value }
+static TypeCounts
+build_deep_nesting(
+  SerializationSupport * support, rosidl_dynamic_typesupport_dynamic_type_impl_t * type)
+{
+  const int depth = 16;
+  std::unique_ptr<TypeBuilder> inner;
+  for (int level = 0; level < depth; ++level) {
+    auto outer = std::make_unique<TypeBuilder>(
+      support, "benchmark/msg/Level" + std::to_string(level));
+    outer->add(fastrtps__dynamic_type_builder_add_int32_member, "value");
+    if (inner) {
+      outer->add(fastrtps__dynamic_type_builder_add_complex_member_builder, "child", inner->get());
+    }
+    inner = std::move(outer);
+  }
+  *type = inner->build();
+  return {2 * depth - 1, depth};
+}
+
+// struct { bool[16] bool_array; bool[] bool_sequence; bool[<=16] bool_bounded_sequence; ... } for
+// every primitive kind and string
+static TypeCounts
+build_arrays_and_sequences(
+  SerializationSupport * support, rosidl_dynamic_typesupport_dynamic_type_impl_t * type)
+{
+  TypeBuilder builder(support, "benchmark/msg/ArraysAndSequences");
+#define ADD_CONTAINER_MEMBERS(KIND, TYPE, VALUE) \
+  builder.add(fastrtps__dynamic_type_builder_add_ ## KIND ## _array_member, #KIND "_array", 16); \
+  builder.add( \
+    fastrtps__dynamic_type_builder_add_ ## KIND ## _unbounded_sequence_member, #KIND "_sequence"); \
+  builder.add( \
+    fastrtps__dynamic_type_builder_add_ ## KIND ## _bounded_sequence_member, \
+    #KIND "_bounded_sequence", 16);
+  PRIMITIVE_KINDS(ADD_CONTAINER_MEMBERS)
+  ADD_CONTAINER_MEMBERS(string, char, "benchmark")
+#undef ADD_CONTAINER_MEMBERS
+  *type = builder.build();
+  return {3 * 16, 1};
+}
+
+// Shaped like sensor_msgs/msg/PointCloud2:
+//   Time { int32 sec; uint32 nanosec }
+//   Header { Time stamp; string frame_id }
+//   PointField { string name; uint32 offset; uint8 datatype; uint32 count }
+//   PointCloud2 { Header header; uint32 height; uint32 width; PointField[] fields;
+//                 bool is_bigendian; uint32 point_step; uint32 row_step; uint8[] data;
+//                 bool is_dense }
+static TypeCounts
+build_point_cloud(
+  SerializationSupport * support, rosidl_dynamic_typesupport_dynamic_type_impl_t * type)
+{
+  TypeBuilder time(support, "builtin_interfaces/msg/Time");
+  time.add(fastrtps__dynamic_type_builder_add_int32_member, "sec");
+  time.add(fastrtps__dynamic_type_builder_add_uint32_member, "nanosec");
+
+  TypeBuilder header(support, "std_msgs/msg/Header");
+  header.add(fastrtps__dynamic_type_builder_add_complex_member_builder, "stamp", time.get());
+  header.add(fastrtps__dynamic_type_builder_add_string_member, "frame_id");
+
+  TypeBuilder point_field(support, "sensor_msgs/msg/PointField");
+  point_field.add(fastrtps__dynamic_type_builder_add_string_member, "name");
+  point_field.add(fastrtps__dynamic_type_builder_add_uint32_member, "offset");
+  point_field.add(fastrtps__dynamic_type_builder_add_uint8_member, "datatype");
+  point_field.add(fastrtps__dynamic_type_builder_add_uint32_member, "count");
+
+  TypeBuilder point_cloud(support, "sensor_msgs/msg/PointCloud2");
+  point_cloud.add(
+    fastrtps__dynamic_type_builder_add_complex_member_builder, "header", header.get());
+  point_cloud.add(fastrtps__dynamic_type_builder_add_uint32_member, "height");
+  point_cloud.add(fastrtps__dynamic_type_builder_add_uint32_member, "width");
+  point_cloud.add(
+    fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member_builder, "fields",
+    point_field.get());
+  point_cloud.add(fastrtps__dynamic_type_builder_add_bool_member, "is_bigendian");
+  point_cloud.add(fastrtps__dynamic_type_builder_add_uint32_member, "point_step");
+  point_cloud.add(fastrtps__dynamic_type_builder_add_uint32_member, "row_step");
+  point_cloud.add(fastrtps__dynamic_type_builder_add_uint8_unbounded_sequence_member, "data");
+  point_cloud.add(fastrtps__dynamic_type_builder_add_bool_member, "is_dense");
+  *type = point_cloud.build();
+  return {2 + 2 + 4 + 9, 4};
+}
+
+static TypeCounts
+build_type_shape(
+  int shape, SerializationSupport * support,
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type)
+{
+  static decltype(&build_wide_struct) const build[TYPE_SHAPE_COUNT] = {
+    build_wide_struct,
+    build_deep_nesting,
+    build_arrays_and_sequences,
+    build_point_cloud,
+  };
+  return build[shape](support, type);
+}
+
+static const char *
+type_shape_name(int shape)
+{
+  static const char * names[TYPE_SHAPE_COUNT] = {
+    "wide_struct",
+    "deep_nesting",
+    "arrays_and_sequences",
+    "point_cloud",
+  };
+  return names[shape];
+}
+
+
+// BENCHMARKS ======================================================================================
+class TypeConstructionBenchmark : public PerformanceTest
+{
+public:
+  void
+  SetUp(benchmark::State & state) override
+  {
+    shape_ = static_cast<int>(state.range(0));
+    support_ = std::make_unique<SerializationSupport>();
+    state.SetLabel(type_shape_name(shape_));
+
+    // Built once up front for the counts, which also warms the type cache for `build`
+    rosidl_dynamic_typesupport_dynamic_type_impl_t type;
+    counts_ = build_type_shape(shape_, support_.get(), &type);
+    fastrtps__dynamic_type_fini(&support_->impl, &type);
+
+    PerformanceTest::SetUp(state);
+  }
+
+  void
+  TearDown(benchmark::State & state) override
+  {
+    PerformanceTest::TearDown(state);
+
+    // Rate counters with kInvert report seconds per member and per type
+    state.counters["time_per_member"] = benchmark::Counter(
+      counts_.members, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    state.counters["time_per_type"] = benchmark::Counter(
+      counts_.types, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+
+    // Only there if the fixture could count allocations on this platform
+    auto heap_allocations = state.counters.find("heap_allocations");
+    if (heap_allocations != state.counters.end()) {
+      double allocations = heap_allocations->second.value;
+      state.counters["heap_allocations_per_member"] = benchmark::Counter(
+        allocations / counts_.members, benchmark::Counter::kAvgIterations);
+      state.counters["heap_allocations_per_type"] = benchmark::Counter(
+        allocations / counts_.types, benchmark::Counter::kAvgIterations);
+    }
+
+    support_.reset();
+  }
+
+protected:
+  int shape_;
+  TypeCounts counts_;
+  std::unique_ptr<SerializationSupport> support_;
+};
+
+
+BENCHMARK_DEFINE_F(TypeConstructionBenchmark, build)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    rosidl_dynamic_typesupport_dynamic_type_impl_t type;
+    build_type_shape(shape_, support_.get(), &type);
+    benchmark::DoNotOptimize(type.handle);
+
+    state.PauseTiming();
+    fastrtps__dynamic_type_fini(&support_->impl, &type);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK_REGISTER_F(TypeConstructionBenchmark, build)
+->DenseRange(0, TYPE_SHAPE_COUNT - 1)->ArgName("shape");
+
+
+BENCHMARK_DEFINE_F(TypeConstructionBenchmark, build_cold)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    state.PauseTiming();
+    support_.reset();
+    support_ = std::make_unique<SerializationSupport>();
+    state.ResumeTiming();
+
+    rosidl_dynamic_typesupport_dynamic_type_impl_t type;
+    build_type_shape(shape_, support_.get(), &type);
+    benchmark::DoNotOptimize(type.handle);
+
+    state.PauseTiming();
+    fastrtps__dynamic_type_fini(&support_->impl, &type);
+    state.ResumeTiming();
+  }
+}
+BENCHMARK_REGISTER_F(TypeConstructionBenchmark, build_cold)
+->DenseRange(0, TYPE_SHAPE_COUNT - 1)->ArgName("shape");
@@ -0,0 +1,132 @@
+# Copyright 2023 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Compare a fixed subset of the benchmarks against the baseline checked into the repo.
+
+The baseline lists, per benchmark executable, the filter selecting the benchmarks to run and the
+median time per iteration each of them had on the reference machine. A benchmark fails the check
+when its throughput (the inverse of its median time) drops more than the tolerance below the
+baseline. Benchmarks without a baseline fail the check too, so it can't pass by having nothing to
+compare against: record one with --update on the reference machine first.
+
+Run with --update to record the current numbers as the new baseline instead.
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+
+TIME_UNIT_NS = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+
+def run_benchmarks(executable, benchmark_filter, repetitions):
+    """Run the benchmarks matching the filter, return their median times in ns by name."""
+    output = subprocess.run(
+        [
+            executable,
+            '--benchmark_filter=' + benchmark_filter,
+            '--benchmark_repetitions=%d' % repetitions,
+            '--benchmark_report_aggregates_only=true',
+            '--benchmark_format=json',
+        ],
+        check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+
+    medians = {}
+    for benchmark in json.loads(output)['benchmarks']:
+        if benchmark.get('error_occurred'):
+            raise RuntimeError('%s failed: %s' % (
+                benchmark['run_name'], benchmark.get('error_message', '')))
+        if benchmark.get('aggregate_name') != 'median':
+            continue
+        medians[benchmark['run_name']] = (
+            benchmark['real_time'] * TIME_UNIT_NS[benchmark['time_unit']])
+    if not medians:
+        raise RuntimeError('%s: no benchmark matches %s' % (executable, benchmark_filter))
+    return medians
+
+
+def main(argv=sys.argv[1:]):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument(
+        '--baseline', required=True, help='Baseline JSON file')
+    parser.add_argument(
+        '--benchmark', action='append', default=[], metavar='NAME=PATH',
+        help='Benchmark executable the baseline names NAME, repeat for each one')
+    parser.add_argument(
+        '--tolerance', type=float, default=0.2,
+        help='Largest throughput drop accepted, as a fraction of the baseline (default 0.2)')
+    parser.add_argument(
+        '--repetitions', type=int, default=5,
+        help='Runs per benchmark, the median is compared (default 5)')
+    parser.add_argument(
+        '--update', action='store_true',
+        help='Record the current numbers as the baseline instead of checking against it')
+    args = parser.parse_args(argv)
+
+    executables = dict(benchmark.split('=', 1) for benchmark in args.benchmark)
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    regressions = []
+    missing = []
+    for name, entry in sorted(baseline['benchmarks'].items()):
+        if name not in executables:
+            print('%s: not built, skipped' % name)
+            continue
+        medians = run_benchmarks(executables[name], entry['filter'], args.repetitions)
+
+        if args.update:
+            entry['median_time_ns'] = {
+                run_name: round(time_ns, 1) for run_name, time_ns in sorted(medians.items())}
+            continue
+
+        for run_name, time_ns in sorted(medians.items()):
+            baseline_ns = entry['median_time_ns'].get(run_name)
+            if baseline_ns is None:
+                print('%s: %.1f ns, NO BASELINE' % (run_name, time_ns))
+                missing.append(run_name)
+                continue
+            # Throughput relative to the baseline, below 1 is slower
+            relative = baseline_ns / time_ns
+            verdict = 'ok'
+            if relative < 1.0 - args.tolerance:
+                verdict = 'REGRESSION'
+                regressions.append(run_name)
+            print('%s: %.1f ns, baseline %.1f ns, throughput x%.2f %s' % (
+                run_name, time_ns, baseline_ns, relative, verdict))
+
+    if args.update:
+        with open(args.baseline, 'w') as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('Baseline updated: %s' % args.baseline)
+        return 0
+
+    if missing:
+        print('%d benchmark(s) have no baseline to check against, record one with --update:' % (
+            len(missing)))
+        for run_name in missing:
+            print('  ' + run_name)
+    if regressions:
+        print('%d benchmark(s) lost more than %d%% throughput against the baseline:' % (
+            len(regressions), round(args.tolerance * 100)))
+        for run_name in regressions:
+            print('  ' + run_name)
+    return 1 if missing or regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
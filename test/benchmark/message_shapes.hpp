@@ -0,0 +1,430 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef BENCHMARK__MESSAGE_SHAPES_HPP_
+#define BENCHMARK__MESSAGE_SHAPES_HPP_
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/serialization_support.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_serialization_support.hpp"
+
+
+// =================================================================================================
+// MESSAGE SHAPES
+// =================================================================================================
+//
+// Representative message types and data for the benchmarks, built through the same detail
+// functions the serialization support interface dispatches to.
+
+/// Abort the benchmark run on any failure, numbers from a half built message are meaningless
+inline void
+check(rcutils_ret_t ret, const char * what)
+{
+  if (ret != RCUTILS_RET_OK) {
+    std::fprintf(stderr, "%s failed: %s\n", what, rcutils_get_error_string().str);
+    std::abort();
+  }
+}
+
+
+// Member kinds: name, C++ type, value set or inserted
+#define PRIMITIVE_KINDS(X) \
+  X(bool, bool, true) \
+  X(byte, unsigned char, 0x5a) \
+  X(char, char, 'x') \
+  X(wchar, char16_t, u'x') \
+  X(float32, float, 1.5f) \
+  X(float64, double, 2.5) \
+  X(float128, long double, 3.5L) \
+  X(int8, int8_t, -8) \
+  X(uint8, uint8_t, 8) \
+  X(int16, int16_t, -16) \
+  X(uint16, uint16_t, 16) \
+  X(int32, int32_t, -32) \
+  X(uint32, uint32_t, 32) \
+  X(int64, int64_t, -64) \
+  X(uint64, uint64_t, 64)
+
+// Member kinds: name, character type, value set or inserted, parenthesized extra arguments (the
+// length or bound) every accessor and member of that kind takes
+#define STRING_KINDS(X) \
+  X(string, char, "benchmark", ()) \
+  X(wstring, char16_t, u"benchmark", ()) \
+  X(fixed_string, char, "benchmark", (, 16)) \
+  X(fixed_wstring, char16_t, u"benchmark", (, 16)) \
+  X(bounded_string, char, "benchmark", (, 64)) \
+  X(bounded_wstring, char16_t, u"benchmark", (, 64))
+
+#define UNPARENTHESIZE(...) __VA_ARGS__
+
+
+class SerializationSupport
+{
+public:
+  SerializationSupport()
+  : allocator(rcutils_get_default_allocator())
+  {
+    check(
+      rosidl_dynamic_typesupport_fastrtps_init_serialization_support_impl(&allocator, &impl),
+      "init serialization support impl");
+  }
+
+  ~SerializationSupport()
+  {
+    fastrtps__serialization_support_impl_fini(&impl);
+  }
+
+  SerializationSupport(const SerializationSupport &) = delete;
+  SerializationSupport & operator=(const SerializationSupport &) = delete;
+
+  rcutils_allocator_t allocator;
+  rosidl_dynamic_typesupport_serialization_support_impl_t impl;
+};
+
+
+/// A struct type under construction, member ids are handed out in the order members are added
+class TypeBuilder
+{
+public:
+  TypeBuilder(SerializationSupport * support, const std::string & name)
+  : support_(support)
+  {
+    check(
+      fastrtps__dynamic_type_builder_init(
+        &support_->impl, name.c_str(), name.size(), &support_->allocator, &builder_),
+      "init type builder");
+  }
+
+  ~TypeBuilder()
+  {
+    fastrtps__dynamic_type_builder_fini(&support_->impl, &builder_);
+  }
+
+  TypeBuilder(const TypeBuilder &) = delete;
+  TypeBuilder & operator=(const TypeBuilder &) = delete;
+
+  /// Add a member with one of the `fastrtps__dynamic_type_builder_add_*_member` functions
+  /// Returns the id of the new member
+  template<typename AddMemberT, typename ... ArgsT>
+  rosidl_dynamic_typesupport_member_id_t
+  add(AddMemberT add_member, const std::string & name, ArgsT... args)
+  {
+    check(
+      add_member(
+        &support_->impl, &builder_, member_count_, name.c_str(), name.size(), "", 0, args ...),
+      "add member");
+    return member_count_++;
+  }
+
+  /// For the `add_complex_*_member_builder` functions
+  rosidl_dynamic_typesupport_dynamic_type_builder_impl_t *
+  get()
+  {
+    return &builder_;
+  }
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t
+  build()
+  {
+    rosidl_dynamic_typesupport_dynamic_type_impl_t type;
+    check(
+      fastrtps__dynamic_type_init_from_dynamic_type_builder(
+        &support_->impl, &builder_, &support_->allocator, &type),
+      "build type");
+    return type;
+  }
+
+private:
+  SerializationSupport * support_;
+  rosidl_dynamic_typesupport_dynamic_type_builder_impl_t builder_;
+  rosidl_dynamic_typesupport_member_id_t member_count_ = 0;
+};
+
+
+enum MessageShape
+{
+  MESSAGE_SHAPE_FLAT_PRIMITIVES,
+  MESSAGE_SHAPE_DEEP_NESTING,
+  MESSAGE_SHAPE_LONG_STRING,
+  MESSAGE_SHAPE_LARGE_PRIMITIVE_SEQUENCE,
+  MESSAGE_SHAPE_SEQUENCE_OF_STRUCTS,
+  MESSAGE_SHAPE_WSTRINGS,
+  MESSAGE_SHAPE_COUNT,
+};
+
+inline const char *
+message_shape_name(int shape)
+{
+  static const char * names[MESSAGE_SHAPE_COUNT] = {
+    "flat_primitives",
+    "deep_nesting",
+    "long_string",
+    "large_primitive_sequence",
+    "sequence_of_structs",
+    "wstrings",
+  };
+  return names[shape];
+}
+
+
+/// The type of one message shape, with a message of it filled with representative values
+class Message
+{
+public:
+  Message(SerializationSupport * support, int shape)
+  : support_(support)
+  {
+    switch (shape) {
+      case MESSAGE_SHAPE_FLAT_PRIMITIVES:
+        build_flat_primitives();
+        break;
+      case MESSAGE_SHAPE_DEEP_NESTING:
+        build_deep_nesting();
+        break;
+      case MESSAGE_SHAPE_LONG_STRING:
+        build_long_string();
+        break;
+      case MESSAGE_SHAPE_LARGE_PRIMITIVE_SEQUENCE:
+        build_large_primitive_sequence();
+        break;
+      case MESSAGE_SHAPE_SEQUENCE_OF_STRUCTS:
+        build_sequence_of_structs();
+        break;
+      case MESSAGE_SHAPE_WSTRINGS:
+        build_wstrings();
+        break;
+      default:
+        std::abort();
+    }
+  }
+
+  ~Message()
+  {
+    fastrtps__dynamic_data_fini(&support_->impl, &data);
+    // Outer types first, they hold references to the nested ones
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_->impl, &*it);
+    }
+  }
+
+  Message(const Message &) = delete;
+  Message & operator=(const Message &) = delete;
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t *
+  type()
+  {
+    return &types_.back();
+  }
+
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+
+private:
+  rosidl_dynamic_typesupport_dynamic_type_impl_t *
+  add_type(TypeBuilder & builder)
+  {
+    types_.push_back(builder.build());
+    return &types_.back();
+  }
+
+  void
+  init_data()
+  {
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        &support_->impl, type(), &support_->allocator, &data),
+      "init data");
+  }
+
+  // struct { bool; byte; int16; uint16; int32; uint32; int64; uint64; float32; float64 } x 2
+  void
+  build_flat_primitives()
+  {
+    TypeBuilder builder(support_, "benchmark/msg/FlatPrimitives");
+    for (int i = 0; i < 2; ++i) {
+      std::string suffix = std::to_string(i);
+      builder.add(fastrtps__dynamic_type_builder_add_bool_member, "bool_" + suffix);
+      builder.add(fastrtps__dynamic_type_builder_add_byte_member, "byte_" + suffix);
+      builder.add(fastrtps__dynamic_type_builder_add_int16_member, "int16_" + suffix);
+      builder.add(fastrtps__dynamic_type_builder_add_uint16_member, "uint16_" + suffix);
+      builder.add(fastrtps__dynamic_type_builder_add_int32_member, "int32_" + suffix);
+      builder.add(fastrtps__dynamic_type_builder_add_uint32_member, "uint32_" + suffix);
+      builder.add(fastrtps__dynamic_type_builder_add_int64_member, "int64_" + suffix);
+      builder.add(fastrtps__dynamic_type_builder_add_uint64_member, "uint64_" + suffix);
+      builder.add(fastrtps__dynamic_type_builder_add_float32_member, "float32_" + suffix);
+      builder.add(fastrtps__dynamic_type_builder_add_float64_member, "float64_" + suffix);
+    }
+    add_type(builder);
+    init_data();
+
+    auto impl = &support_->impl;
+    for (rosidl_dynamic_typesupport_member_id_t base = 0; base < 20; base += 10) {
+      check(fastrtps__dynamic_data_set_bool_value(impl, &data, base, true), "set");
+      check(fastrtps__dynamic_data_set_byte_value(impl, &data, base + 1, 0x5a), "set");
+      check(fastrtps__dynamic_data_set_int16_value(impl, &data, base + 2, -1234), "set");
+      check(fastrtps__dynamic_data_set_uint16_value(impl, &data, base + 3, 1234), "set");
+      check(fastrtps__dynamic_data_set_int32_value(impl, &data, base + 4, -123456), "set");
+      check(fastrtps__dynamic_data_set_uint32_value(impl, &data, base + 5, 123456), "set");
+      check(fastrtps__dynamic_data_set_int64_value(impl, &data, base + 6, -1), "set");
+      check(fastrtps__dynamic_data_set_uint64_value(impl, &data, base + 7, 1), "set");
+      check(fastrtps__dynamic_data_set_float32_value(impl, &data, base + 8, 1.5f), "set");
+      check(fastrtps__dynamic_data_set_float64_value(impl, &data, base + 9, 2.5), "set");
+    }
+  }
+
+  // struct Level15 { int32 value; Level14 child }, down to Level0 { int32 value }
+  void
+  build_deep_nesting()
+  {
+    const int depth = 16;
+    for (int level = 0; level < depth; ++level) {
+      TypeBuilder builder(support_, "benchmark/msg/Level" + std::to_string(level));
+      builder.add(fastrtps__dynamic_type_builder_add_int32_member, "value");
+      if (level > 0) {
+        builder.add(fastrtps__dynamic_type_builder_add_complex_member, "child", type());
+      }
+      add_type(builder);
+    }
+    init_data();
+
+    // Only the outermost value is set, every level is serialized the same either way
+    check(fastrtps__dynamic_data_set_int32_value(&support_->impl, &data, 0, 42), "set");
+  }
+
+  // struct { string<65536> text } with 64 KiB of text. Bounded, since fastrtps caps unbounded
+  // strings at 255 characters
+  void
+  build_long_string()
+  {
+    const size_t length = 64 * 1024;
+    TypeBuilder builder(support_, "benchmark/msg/LongString");
+    builder.add(fastrtps__dynamic_type_builder_add_bounded_string_member, "text", length);
+    add_type(builder);
+    init_data();
+
+    std::string text(length, 'x');
+    check(
+      fastrtps__dynamic_data_set_bounded_string_value(
+        &support_->impl, &data, 0, text.c_str(), text.size(), length),
+      "set");
+  }
+
+  // struct { float64[] values } with 128k values, a point cloud sized payload
+  void
+  build_large_primitive_sequence()
+  {
+    TypeBuilder builder(support_, "benchmark/msg/LargePrimitiveSequence");
+    builder.add(fastrtps__dynamic_type_builder_add_float64_unbounded_sequence_member, "values");
+    add_type(builder);
+    init_data();
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t values;
+    check(
+      fastrtps__dynamic_data_loan_value(&support_->impl, &data, 0, &support_->allocator, &values),
+      "loan");
+    for (int i = 0; i < 128 * 1024; ++i) {
+      rosidl_dynamic_typesupport_member_id_t id;
+      check(fastrtps__dynamic_data_insert_float64_value(&support_->impl, &values, i * 0.5, &id),
+        "insert");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(&support_->impl, &data, &values), "return");
+  }
+
+  // struct { Point[] points } with 1024 points, Point { float64 x, y, z; string frame_id }
+  void
+  build_sequence_of_structs()
+  {
+    TypeBuilder point_builder(support_, "benchmark/msg/Point");
+    point_builder.add(fastrtps__dynamic_type_builder_add_float64_member, "x");
+    point_builder.add(fastrtps__dynamic_type_builder_add_float64_member, "y");
+    point_builder.add(fastrtps__dynamic_type_builder_add_float64_member, "z");
+    point_builder.add(fastrtps__dynamic_type_builder_add_string_member, "frame_id");
+    rosidl_dynamic_typesupport_dynamic_type_impl_t * point_type = add_type(point_builder);
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t point;
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        &support_->impl, point_type, &support_->allocator, &point),
+      "init point");
+    check(fastrtps__dynamic_data_set_float64_value(&support_->impl, &point, 0, 1.0), "set");
+    check(fastrtps__dynamic_data_set_float64_value(&support_->impl, &point, 1, 2.0), "set");
+    check(fastrtps__dynamic_data_set_float64_value(&support_->impl, &point, 2, 3.0), "set");
+    check(fastrtps__dynamic_data_set_string_value(&support_->impl, &point, 3, "map", 3), "set");
+
+    TypeBuilder builder(support_, "benchmark/msg/SequenceOfStructs");
+    builder.add(
+      fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "points", point_type);
+    add_type(builder);
+    init_data();
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t points;
+    check(
+      fastrtps__dynamic_data_loan_value(&support_->impl, &data, 0, &support_->allocator, &points),
+      "loan");
+    for (int i = 0; i < 1024; ++i) {
+      rosidl_dynamic_typesupport_member_id_t id;
+      check(
+        fastrtps__dynamic_data_insert_complex_value_copy(&support_->impl, &points, &point, &id),
+        "insert");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(&support_->impl, &data, &points), "return");
+    fastrtps__dynamic_data_fini(&support_->impl, &point);
+  }
+
+  // struct { wstring<256> text_0 ... text_15 } with 256 characters each. Bounded, since fastrtps
+  // caps unbounded wide strings at 255 characters
+  void
+  build_wstrings()
+  {
+    const int count = 16;
+    const size_t length = 256;
+    TypeBuilder builder(support_, "benchmark/msg/WStrings");
+    for (int i = 0; i < count; ++i) {
+      builder.add(
+        fastrtps__dynamic_type_builder_add_bounded_wstring_member, "text_" + std::to_string(i),
+        length);
+    }
+    add_type(builder);
+    init_data();
+
+    std::u16string text(length, u'\u00e9');
+    for (int i = 0; i < count; ++i) {
+      check(
+        fastrtps__dynamic_data_set_bounded_wstring_value(
+          &support_->impl, &data, i, text.c_str(), text.size(), length),
+        "set");
+    }
+  }
+
+  SerializationSupport * support_;
+  // Nested types come before the types using them, the message type is last. A deque, so the
+  // pointers add_type hands out stay valid
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+};
+
+
+#endif  // BENCHMARK__MESSAGE_SHAPES_HPP_
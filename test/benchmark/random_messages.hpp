@@ -0,0 +1,437 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef BENCHMARK__RANDOM_MESSAGES_HPP_
+#define BENCHMARK__RANDOM_MESSAGES_HPP_
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+
+
+// =================================================================================================
+// RANDOM MESSAGES
+// =================================================================================================
+//
+// Random but valid message types, built through the type builder, and random data for them. The
+// same seed always gives the same type and the same data, so a failure found with a seed can be
+// reproduced with just that seed.
+//
+// Every member picks a kind (any primitive, string, wstring, bounded string or wstring, or a nested
+// struct while the nesting depth allows it) and a container (none, array, unbounded or bounded
+// sequence) at random.
+
+struct RandomMessageOptions
+{
+  /// Levels of nested structs below the message type, 0 for flat messages
+  int max_depth = 2;
+  /// Members per struct, at least one
+  size_t max_members = 8;
+  size_t max_array_length = 8;
+  size_t max_sequence_bound = 16;
+  /// For unbounded sequences, bounded ones are filled up to their bound
+  size_t max_sequence_length = 16;
+  size_t max_string_bound = 32;
+  /// For unbounded strings, bounded ones are filled up to their bound
+  size_t max_string_length = 32;
+};
+
+enum RandomMemberKind
+{
+#define RANDOM_MEMBER_KIND(KIND, TYPE, VALUE) RANDOM_MEMBER_KIND_ ## KIND,
+  PRIMITIVE_KINDS(RANDOM_MEMBER_KIND)
+#undef RANDOM_MEMBER_KIND
+  RANDOM_MEMBER_KIND_string,
+  RANDOM_MEMBER_KIND_wstring,
+  RANDOM_MEMBER_KIND_bounded_string,
+  RANDOM_MEMBER_KIND_bounded_wstring,
+  // Last, so it can be left out once the nesting depth is used up
+  RANDOM_MEMBER_KIND_struct,
+  RANDOM_MEMBER_KIND_COUNT,
+};
+
+enum RandomContainer
+{
+  RANDOM_CONTAINER_NONE,
+  RANDOM_CONTAINER_ARRAY,
+  RANDOM_CONTAINER_UNBOUNDED_SEQUENCE,
+  RANDOM_CONTAINER_BOUNDED_SEQUENCE,
+  RANDOM_CONTAINER_COUNT,
+};
+
+// String member kinds: name, character type, parenthesized extra arguments (the bound) every
+// accessor and member of that kind takes, longest value filled in
+#define RANDOM_STRING_KINDS(X) \
+  X(string, char, (), options_.max_string_length) \
+  X(wstring, char16_t, (), options_.max_string_length) \
+  X(bounded_string, char, (, member.string_bound), member.string_bound) \
+  X(bounded_wstring, char16_t, (, member.string_bound), member.string_bound)
+
+struct RandomStruct;
+
+struct RandomMember
+{
+  int kind;
+  int container;
+  /// Array length or sequence bound
+  size_t length;
+  size_t string_bound;
+  const RandomStruct * nested;
+};
+
+struct RandomStruct
+{
+  std::vector<RandomMember> members;
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type;
+};
+
+
+inline size_t
+random_size(std::mt19937_64 & rng, size_t min, size_t max)
+{
+  return std::uniform_int_distribution<size_t>(min, max)(rng);
+}
+
+/// Characters are printable, and wide ones stay clear of the surrogates so every value is valid
+template<typename T>
+T
+random_value(std::mt19937_64 & rng)
+{
+  if constexpr (std::is_same_v<T, bool>) {
+    return rng() & 1;
+  } else if constexpr (std::is_same_v<T, char>) {
+    return static_cast<char>(random_size(rng, 0x20, 0x7e));
+  } else if constexpr (std::is_same_v<T, char16_t>) {
+    return static_cast<char16_t>(random_size(rng, 0x20, 0xd7ff));
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return static_cast<T>(std::uniform_real_distribution<double>(-1e6, 1e6)(rng));
+  } else {
+    return static_cast<T>(rng());
+  }
+}
+
+template<typename CharT>
+std::basic_string<CharT>
+random_string(std::mt19937_64 & rng, size_t max_length)
+{
+  std::basic_string<CharT> out(random_size(rng, 0, max_length), CharT());
+  for (auto & c : out) {
+    c = random_value<CharT>(rng);
+  }
+  return out;
+}
+
+
+/// A random message type, with a message of it filled with random values
+class RandomMessage
+{
+public:
+  RandomMessage(
+    SerializationSupport * support, uint64_t seed,
+    const RandomMessageOptions & options = RandomMessageOptions())
+  : support_(support), options_(options), seed_(seed)
+  {
+    std::mt19937_64 rng(seed);
+    generate_struct(rng, 0);
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        &support_->impl, type(), &support_->allocator, &data),
+      "init data");
+    fill_struct(rng, structs_.back(), &data);
+  }
+
+  ~RandomMessage()
+  {
+    fastrtps__dynamic_data_fini(&support_->impl, &data);
+    // Outer types first, they hold references to the nested ones
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_->impl, &*it);
+    }
+  }
+
+  RandomMessage(const RandomMessage &) = delete;
+  RandomMessage & operator=(const RandomMessage &) = delete;
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t *
+  type()
+  {
+    return &types_.back();
+  }
+
+  uint64_t
+  seed() const
+  {
+    return seed_;
+  }
+
+  /// Members of all struct types, nested ones included
+  size_t
+  member_count() const
+  {
+    size_t out = 0;
+    for (const auto & random_struct : structs_) {
+      out += random_struct.members.size();
+    }
+    return out;
+  }
+
+  size_t
+  type_count() const
+  {
+    return structs_.size();
+  }
+
+  /// Fill `out`, freshly initialized from type(), with the random values drawn from `seed`
+  void
+  fill(uint64_t seed, rosidl_dynamic_typesupport_dynamic_data_impl_t * out)
+  {
+    std::mt19937_64 rng(seed);
+    fill_struct(rng, structs_.back(), out);
+  }
+
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+
+private:
+  // TYPES =========================================================================================
+  const RandomStruct *
+  generate_struct(std::mt19937_64 & rng, int depth)
+  {
+    int kind_count = depth < options_.max_depth ?
+      RANDOM_MEMBER_KIND_COUNT : RANDOM_MEMBER_KIND_struct;
+
+    RandomStruct random_struct;
+    size_t member_count = random_size(rng, 1, options_.max_members);
+    for (size_t i = 0; i < member_count; ++i) {
+      RandomMember member;
+      member.kind = static_cast<int>(random_size(rng, 0, kind_count - 1));
+      member.container = static_cast<int>(random_size(rng, 0, RANDOM_CONTAINER_COUNT - 1));
+      member.length = random_size(
+        rng, 1, member.container == RANDOM_CONTAINER_ARRAY ?
+        options_.max_array_length : options_.max_sequence_bound);
+      member.string_bound = random_size(rng, 1, options_.max_string_bound);
+      // Nested types are generated (and built) before the types using them
+      member.nested = member.kind == RANDOM_MEMBER_KIND_struct ?
+        generate_struct(rng, depth + 1) : nullptr;
+      random_struct.members.push_back(member);
+    }
+
+    // Named by seed too, so messages from different seeds never share a type name
+    TypeBuilder builder(
+      support_,
+      "random/msg/Random" + std::to_string(seed_) + "_" + std::to_string(structs_.size()));
+    for (size_t i = 0; i < random_struct.members.size(); ++i) {
+      add_member(builder, "member_" + std::to_string(i), random_struct.members[i]);
+    }
+    types_.push_back(builder.build());
+    random_struct.type = &types_.back();
+    structs_.push_back(std::move(random_struct));
+    return &structs_.back();
+  }
+
+  template<typename AddT, typename AddArrayT, typename AddSequenceT, typename AddBoundedSequenceT,
+    typename ... ExtraT>
+  static void
+  add_member_of_kind(
+    TypeBuilder & builder, const std::string & name, const RandomMember & member,
+    AddT add, AddArrayT add_array, AddSequenceT add_sequence,
+    AddBoundedSequenceT add_bounded_sequence, ExtraT... extra)
+  {
+    switch (member.container) {
+      case RANDOM_CONTAINER_NONE:
+        builder.add(add, name, extra ...);
+        break;
+      case RANDOM_CONTAINER_ARRAY:
+        builder.add(add_array, name, extra ..., member.length);
+        break;
+      case RANDOM_CONTAINER_UNBOUNDED_SEQUENCE:
+        builder.add(add_sequence, name, extra ...);
+        break;
+      default:
+        builder.add(add_bounded_sequence, name, extra ..., member.length);
+        break;
+    }
+  }
+
+  static void
+  add_member(TypeBuilder & builder, const std::string & name, const RandomMember & member)
+  {
+#define ADD_MEMBER_OF_KIND(KIND, EXTRA) \
+  add_member_of_kind( \
+    builder, name, member, \
+    fastrtps__dynamic_type_builder_add_ ## KIND ## _member, \
+    fastrtps__dynamic_type_builder_add_ ## KIND ## _array_member, \
+    fastrtps__dynamic_type_builder_add_ ## KIND ## _unbounded_sequence_member, \
+    fastrtps__dynamic_type_builder_add_ ## KIND ## _bounded_sequence_member UNPARENTHESIZE EXTRA);
+#define ADD_PRIMITIVE_MEMBER(KIND, TYPE, VALUE) \
+  case RANDOM_MEMBER_KIND_ ## KIND: \
+    ADD_MEMBER_OF_KIND(KIND, ()) \
+    break;
+#define ADD_STRING_MEMBER(KIND, CHAR, EXTRA, MAX_LENGTH) \
+  case RANDOM_MEMBER_KIND_ ## KIND: \
+    ADD_MEMBER_OF_KIND(KIND, EXTRA) \
+    break;
+
+    switch (member.kind) {
+      PRIMITIVE_KINDS(ADD_PRIMITIVE_MEMBER)
+      RANDOM_STRING_KINDS(ADD_STRING_MEMBER)
+      default:
+        ADD_MEMBER_OF_KIND(complex, (, member.nested->type))
+        break;
+    }
+
+#undef ADD_STRING_MEMBER
+#undef ADD_PRIMITIVE_MEMBER
+#undef ADD_MEMBER_OF_KIND
+  }
+
+
+  // DATA ==========================================================================================
+  // `set` sets one value by member id or array index, `insert` appends one to a sequence, and
+  // `generate` draws the next random value
+  template<typename SetT, typename InsertT, typename GenerateT>
+  void
+  fill_member(
+    std::mt19937_64 & rng, rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl,
+    rosidl_dynamic_typesupport_member_id_t id, const RandomMember & member,
+    SetT set, InsertT insert, GenerateT generate)
+  {
+    if (member.container == RANDOM_CONTAINER_NONE) {
+      set(data_impl, id, generate());
+      return;
+    }
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t loaned;
+    check(
+      fastrtps__dynamic_data_loan_value(
+        &support_->impl, data_impl, id, &support_->allocator, &loaned),
+      "loan");
+    if (member.container == RANDOM_CONTAINER_ARRAY) {
+      for (size_t i = 0; i < member.length; ++i) {
+        set(&loaned, i, generate());
+      }
+    } else {
+      size_t length = random_size(
+        rng, 0, member.container == RANDOM_CONTAINER_BOUNDED_SEQUENCE ?
+        member.length : options_.max_sequence_length);
+      for (size_t i = 0; i < length; ++i) {
+        rosidl_dynamic_typesupport_member_id_t out_id;
+        insert(&loaned, generate(), &out_id);
+      }
+    }
+    check(
+      fastrtps__dynamic_data_return_loaned_value(&support_->impl, data_impl, &loaned), "return");
+  }
+
+  void
+  fill_struct(
+    std::mt19937_64 & rng, const RandomStruct & random_struct,
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl)
+  {
+    using DataImpl = rosidl_dynamic_typesupport_dynamic_data_impl_t;
+    using MemberId = rosidl_dynamic_typesupport_member_id_t;
+    auto impl = &support_->impl;
+
+#define FILL_PRIMITIVE_MEMBER(KIND, TYPE, VALUE) \
+  case RANDOM_MEMBER_KIND_ ## KIND: \
+    fill_member( \
+      rng, data_impl, id, member, \
+      [impl](DataImpl * target, MemberId target_id, TYPE value) { \
+        check( \
+          fastrtps__dynamic_data_set_ ## KIND ## _value(impl, target, target_id, value), "set"); \
+      }, \
+      [impl](DataImpl * target, TYPE value, MemberId * out_id) { \
+        check( \
+          fastrtps__dynamic_data_insert_ ## KIND ## _value(impl, target, value, out_id), \
+          "insert"); \
+      }, \
+      [&rng]() {return random_value<TYPE>(rng);}); \
+    break;
+#define FILL_STRING_MEMBER(KIND, CHAR, EXTRA, MAX_LENGTH) \
+  case RANDOM_MEMBER_KIND_ ## KIND: \
+    fill_member( \
+      rng, data_impl, id, member, \
+      [&](DataImpl * target, MemberId target_id, const std::basic_string<CHAR> & value) { \
+        check( \
+          fastrtps__dynamic_data_set_ ## KIND ## _value( \
+            impl, target, target_id, value.c_str(), value.size() UNPARENTHESIZE EXTRA), \
+          "set"); \
+      }, \
+      [&](DataImpl * target, const std::basic_string<CHAR> & value, MemberId * out_id) { \
+        check( \
+          fastrtps__dynamic_data_insert_ ## KIND ## _value( \
+            impl, target, value.c_str(), value.size() UNPARENTHESIZE EXTRA, out_id), \
+          "insert"); \
+      }, \
+      [&]() {return random_string<CHAR>(rng, MAX_LENGTH);}); \
+    break;
+
+    for (MemberId id = 0; id < random_struct.members.size(); ++id) {
+      const RandomMember & member = random_struct.members[id];
+      switch (member.kind) {
+        PRIMITIVE_KINDS(FILL_PRIMITIVE_MEMBER)
+        RANDOM_STRING_KINDS(FILL_STRING_MEMBER)
+        default:
+          fill_member(
+            rng, data_impl, id, member,
+            // The outer data takes ownership of the value
+            [impl](DataImpl * target, MemberId target_id, DataImpl value) {
+              check(
+                fastrtps__dynamic_data_set_complex_value(impl, target, target_id, &value), "set");
+            },
+            [impl](DataImpl * target, DataImpl value, MemberId * out_id) {
+              check(
+                fastrtps__dynamic_data_insert_complex_value_copy(impl, target, &value, out_id),
+                "insert");
+              fastrtps__dynamic_data_fini(impl, &value);
+            },
+            [&rng, &member, impl, this]() {
+              DataImpl value;
+              check(
+                fastrtps__dynamic_data_init_from_dynamic_type(
+                  impl, member.nested->type, &support_->allocator, &value),
+                "init data");
+              fill_struct(rng, *member.nested, &value);
+              return value;
+            });
+          break;
+      }
+    }
+
+#undef FILL_STRING_MEMBER
+#undef FILL_PRIMITIVE_MEMBER
+  }
+
+  SerializationSupport * support_;
+  RandomMessageOptions options_;
+  uint64_t seed_;
+  // Nested types come before the types using them, the message type is last. Deques, so the
+  // pointers members keep to nested structs and their types stay valid
+  std::deque<RandomStruct> structs_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+};
+
+
+#endif  // BENCHMARK__RANDOM_MESSAGES_HPP_
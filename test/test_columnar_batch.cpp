@@ -0,0 +1,513 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/columnar_batch.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+
+
+// Member ids of test/msg/Row
+#define ROW_FLAG 0
+#define ROW_SMALL 1
+#define ROW_LABEL 2
+#define ROW_SAMPLES 3
+#define ROW_PAIR 4
+#define ROW_INNER 5
+#define ROW_INNERS 6
+
+// Member ids of test/msg/Inner
+#define INNER_ID 0
+#define INNER_NAME 1
+
+// Columns of test/msg/Row, in pre-order
+#define COLUMN_ROOT 0
+#define COLUMN_FLAG 1
+#define COLUMN_SMALL 2
+#define COLUMN_LABEL 3
+#define COLUMN_SAMPLES 4
+#define COLUMN_SAMPLES_ITEM 5
+#define COLUMN_PAIR 6
+#define COLUMN_PAIR_ITEM 7
+#define COLUMN_INNER 8
+#define COLUMN_INNER_ID 9
+#define COLUMN_INNER_NAME 10
+#define COLUMN_INNERS 11
+#define COLUMN_INNERS_ITEM 12
+#define COLUMN_INNERS_ITEM_ID 13
+#define COLUMN_INNERS_ITEM_NAME 14
+#define COLUMN_COUNT 15
+
+#define PAIR_LENGTH 2
+
+// More than 8, so the bool bitmap spans more than one byte
+#define ROW_COUNT 11
+
+typedef rosidl_dynamic_typesupport_fastrtps_column_type_t ColumnType;
+
+
+/// What each column of a batch should hold
+struct Expected
+{
+  std::vector<uint8_t> flags;
+  std::vector<int16_t> smalls;
+  std::vector<int32_t> label_offsets{0};
+  std::string labels;
+  std::vector<int32_t> samples_offsets{0};
+  std::vector<double> samples;
+  std::vector<int32_t> pairs;
+  std::vector<int32_t> inner_ids;
+  std::vector<int32_t> inner_name_offsets{0};
+  std::string inner_names;
+  std::vector<int32_t> inners_offsets{0};
+  std::vector<int32_t> inners_ids;
+  std::vector<int32_t> inners_name_offsets{0};
+  std::string inners_names;
+};
+
+
+// Row `r`, with strings and sequences of a different length in every row, some of them empty
+static bool row_flag(int32_t r) {return r % 3 == 0;}
+static int16_t row_small(int32_t r) {return static_cast<int16_t>(r - 5);}
+static std::string row_label(int32_t r) {return std::string(r % 7, static_cast<char>('a' + r));}
+static int32_t row_sample_count(int32_t r) {return r % 4;}
+static double row_sample(int32_t r, int32_t k) {return r + k * 0.25;}
+static std::string row_inner_name(int32_t r) {return "inner" + std::to_string(r);}
+static int32_t row_inners_count(int32_t r) {return r % 3;}
+static std::string row_inners_name(int32_t k) {return std::string(k + 1, 'x');}
+
+
+class TestColumnarBatch : public ::testing::Test
+{
+protected:
+  void
+  SetUp() override
+  {
+    // struct Inner { int32 id; string name }
+    // struct Row {
+    //   bool flag; int16 small; string label; float64[] samples; int32[2] pair; Inner inner;
+    //   Inner[] inners }
+    TypeBuilder inner_builder(&support_, "test/msg/Inner");
+    inner_builder.add(fastrtps__dynamic_type_builder_add_int32_member, "id");
+    inner_builder.add(fastrtps__dynamic_type_builder_add_string_member, "name");
+    types_.push_back(inner_builder.build());
+
+    TypeBuilder builder(&support_, "test/msg/Row");
+    builder.add(fastrtps__dynamic_type_builder_add_bool_member, "flag");
+    builder.add(fastrtps__dynamic_type_builder_add_int16_member, "small");
+    builder.add(fastrtps__dynamic_type_builder_add_string_member, "label");
+    builder.add(fastrtps__dynamic_type_builder_add_float64_unbounded_sequence_member, "samples");
+    builder.add(fastrtps__dynamic_type_builder_add_int32_array_member, "pair", PAIR_LENGTH);
+    builder.add(fastrtps__dynamic_type_builder_add_complex_member, "inner", &types_.front());
+    builder.add(
+      fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "inners",
+      &types_.front());
+    types_.push_back(builder.build());
+
+    batch_ = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_columnar_batch();
+    ASSERT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_columnar_batch_init(
+        &support_.impl, &types_.back(), &support_.allocator, &batch_))
+      << rcutils_get_error_string().str;
+  }
+
+  void
+  TearDown() override
+  {
+    rosidl_dynamic_typesupport_fastrtps_columnar_batch_fini(&batch_);
+    for (auto & buffer : buffers_) {
+      rcutils_uint8_array_fini(&buffer);
+    }
+    for (auto it = data_.rbegin(); it != data_.rend(); ++it) {
+      fastrtps__dynamic_data_fini(&support_.impl, &*it);
+    }
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_.impl, &*it);
+    }
+    rcutils_reset_error();
+  }
+
+  void
+  set_inner(
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * data,
+    rosidl_dynamic_typesupport_member_id_t id, int32_t inner_id, const std::string & name)
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t inner;
+    check(fastrtps__dynamic_data_loan_value(impl, data, id, &support_.allocator, &inner), "loan");
+    check(fastrtps__dynamic_data_set_int32_value(impl, &inner, INNER_ID, inner_id), "set");
+    check(
+      fastrtps__dynamic_data_set_string_value(impl, &inner, INNER_NAME, name.c_str(), name.size()),
+      "set");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &inner), "return");
+  }
+
+  // Row `r` as dynamic data, with its values added to `expected`
+  rosidl_dynamic_typesupport_dynamic_data_impl_t *
+  make_row(int32_t r, Expected * expected)
+  {
+    auto impl = &support_.impl;
+    data_.emplace_back();
+    auto data = &data_.back();
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        impl, &types_.back(), &support_.allocator, data),
+      "init data");
+
+    check(fastrtps__dynamic_data_set_bool_value(impl, data, ROW_FLAG, row_flag(r)), "set");
+    expected->flags.push_back(row_flag(r));
+    check(fastrtps__dynamic_data_set_int16_value(impl, data, ROW_SMALL, row_small(r)), "set");
+    expected->smalls.push_back(row_small(r));
+    std::string label = row_label(r);
+    check(
+      fastrtps__dynamic_data_set_string_value(impl, data, ROW_LABEL, label.c_str(), label.size()),
+      "set");
+    expected->labels += label;
+    expected->label_offsets.push_back(static_cast<int32_t>(expected->labels.size()));
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t member;
+    rosidl_dynamic_typesupport_member_id_t id;
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, ROW_SAMPLES, &support_.allocator, &member),
+      "loan");
+    for (int32_t k = 0; k < row_sample_count(r); ++k) {
+      check(
+        fastrtps__dynamic_data_insert_float64_value(impl, &member, row_sample(r, k), &id),
+        "insert");
+      expected->samples.push_back(row_sample(r, k));
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+    expected->samples_offsets.push_back(static_cast<int32_t>(expected->samples.size()));
+
+    const int32_t pair[PAIR_LENGTH] = {r, -r};
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, ROW_PAIR, &support_.allocator, &member),
+      "loan");
+    for (rosidl_dynamic_typesupport_member_id_t i = 0; i < PAIR_LENGTH; ++i) {
+      check(fastrtps__dynamic_data_set_int32_value(impl, &member, i, pair[i]), "set");
+      expected->pairs.push_back(pair[i]);
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+
+    set_inner(data, ROW_INNER, r, row_inner_name(r));
+    expected->inner_ids.push_back(r);
+    expected->inner_names += row_inner_name(r);
+    expected->inner_name_offsets.push_back(static_cast<int32_t>(expected->inner_names.size()));
+
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, ROW_INNERS, &support_.allocator, &member),
+      "loan");
+    for (int32_t k = 0; k < row_inners_count(r); ++k) {
+      check(fastrtps__dynamic_data_insert_sequence_data(impl, &member, &id), "insert");
+      set_inner(&member, id, r * 10 + k, row_inners_name(k));
+      expected->inners_ids.push_back(r * 10 + k);
+      expected->inners_names += row_inners_name(k);
+      expected->inners_name_offsets.push_back(
+        static_cast<int32_t>(expected->inners_names.size()));
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+    expected->inners_offsets.push_back(static_cast<int32_t>(expected->inners_ids.size()));
+    return data;
+  }
+
+  const rcutils_uint8_array_t *
+  serialize(rosidl_dynamic_typesupport_dynamic_data_impl_t * data)
+  {
+    buffers_.push_back(rcutils_get_zero_initialized_uint8_array());
+    check(rcutils_uint8_array_init(&buffers_.back(), 0, &support_.allocator), "init buffer");
+    check(fastrtps__dynamic_data_serialize(&support_.impl, data, &buffers_.back()), "serialize");
+    return &buffers_.back();
+  }
+
+  rosidl_dynamic_typesupport_fastrtps_column_t
+  column(size_t index)
+  {
+    rosidl_dynamic_typesupport_fastrtps_column_t out;
+    EXPECT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_columnar_batch_get_column(&batch_, index, &out));
+    return out;
+  }
+
+  void
+  expect_column(
+    size_t index, const char * name, ColumnType type, size_t parent, size_t length,
+    size_t width)
+  {
+    auto got = column(index);
+    EXPECT_STREQ(name, got.name) << index;
+    EXPECT_EQ(type, got.type) << index;
+    EXPECT_EQ(parent, got.parent) << index;
+    EXPECT_EQ(length, got.length) << index;
+    EXPECT_EQ(width, got.width) << index;
+  }
+
+  void
+  expect_offsets(size_t index, const std::vector<int32_t> & offsets)
+  {
+    auto got = column(index);
+    ASSERT_EQ(offsets.size(), got.length + 1) << index;
+    ASSERT_NE(nullptr, got.offsets) << index;
+    EXPECT_EQ(offsets, std::vector<int32_t>(got.offsets, got.offsets + offsets.size())) << index;
+  }
+
+  template<typename T>
+  void
+  expect_values(size_t index, const std::vector<T> & values)
+  {
+    auto got = column(index);
+    ASSERT_EQ(values.size(), got.length) << index;
+    ASSERT_EQ(values.size() * sizeof(T), got.values_length) << index;
+    std::vector<T> got_values(values.size());
+    if (!values.empty()) {
+      std::memcpy(got_values.data(), got.values, got.values_length);
+    }
+    EXPECT_EQ(values, got_values) << index;
+  }
+
+  void
+  expect_bytes(size_t index, const std::string & bytes)
+  {
+    auto got = column(index);
+    ASSERT_EQ(bytes.size(), got.values_length) << index;
+    if (!bytes.empty()) {
+      EXPECT_EQ(bytes, std::string(reinterpret_cast<const char *>(got.values), bytes.size()))
+        << index;
+    }
+  }
+
+  void
+  expect_bitmap(size_t index, const std::vector<uint8_t> & bits)
+  {
+    auto got = column(index);
+    ASSERT_EQ(bits.size(), got.length) << index;
+    ASSERT_EQ((bits.size() + 7) / 8, got.values_length) << index;
+    for (size_t i = 0; i < bits.size(); ++i) {
+      EXPECT_EQ(bits[i] != 0, ((got.values[i / 8] >> (i % 8)) & 1) != 0) << i;
+    }
+  }
+
+  // Every column of the batch holds exactly what `expected` does
+  void
+  expect_batch(const Expected & expected)
+  {
+    size_t column_count = 0;
+    ASSERT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_columnar_batch_get_column_count(
+        &batch_, &column_count));
+    ASSERT_EQ(static_cast<size_t>(COLUMN_COUNT), column_count);
+
+    const size_t rows = expected.flags.size();
+    const size_t inners = expected.inners_ids.size();
+    expect_column(
+      COLUMN_ROOT, "", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRUCT, 0, rows, 0);
+    expect_column(
+      COLUMN_FLAG, "flag", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_BOOL, COLUMN_ROOT,
+      rows, 0);
+    expect_column(
+      COLUMN_SMALL, "small", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT16, COLUMN_ROOT,
+      rows, sizeof(int16_t));
+    expect_column(
+      COLUMN_LABEL, "label", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRING, COLUMN_ROOT,
+      rows, 0);
+    expect_column(
+      COLUMN_SAMPLES, "samples", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_LIST,
+      COLUMN_ROOT, rows, 0);
+    expect_column(
+      COLUMN_SAMPLES_ITEM, "item", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FLOAT64,
+      COLUMN_SAMPLES, expected.samples.size(), sizeof(double));
+    expect_column(
+      COLUMN_PAIR, "pair", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_FIXED_SIZE_LIST,
+      COLUMN_ROOT, rows, PAIR_LENGTH);
+    expect_column(
+      COLUMN_PAIR_ITEM, "item", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT32,
+      COLUMN_PAIR, rows * PAIR_LENGTH, sizeof(int32_t));
+    expect_column(
+      COLUMN_INNER, "inner", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRUCT, COLUMN_ROOT,
+      rows, 0);
+    expect_column(
+      COLUMN_INNER_ID, "id", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT32, COLUMN_INNER,
+      rows, sizeof(int32_t));
+    expect_column(
+      COLUMN_INNER_NAME, "name", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRING,
+      COLUMN_INNER, rows, 0);
+    expect_column(
+      COLUMN_INNERS, "inners", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_LIST, COLUMN_ROOT,
+      rows, 0);
+    expect_column(
+      COLUMN_INNERS_ITEM, "item", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRUCT,
+      COLUMN_INNERS, inners, 0);
+    expect_column(
+      COLUMN_INNERS_ITEM_ID, "id", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_INT32,
+      COLUMN_INNERS_ITEM, inners, sizeof(int32_t));
+    expect_column(
+      COLUMN_INNERS_ITEM_NAME, "name", ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_COLUMN_TYPE_STRING,
+      COLUMN_INNERS_ITEM, inners, 0);
+
+    // Nested columns have no buffers of their own, and only strings and lists have offsets
+    for (size_t index : {COLUMN_ROOT, COLUMN_SAMPLES, COLUMN_PAIR, COLUMN_INNER, COLUMN_INNERS,
+        COLUMN_INNERS_ITEM})
+    {
+      EXPECT_EQ(0u, column(index).values_length) << index;
+    }
+    for (size_t index : {COLUMN_ROOT, COLUMN_FLAG, COLUMN_SMALL, COLUMN_SAMPLES_ITEM, COLUMN_PAIR,
+        COLUMN_PAIR_ITEM, COLUMN_INNER, COLUMN_INNER_ID, COLUMN_INNERS_ITEM,
+        COLUMN_INNERS_ITEM_ID})
+    {
+      EXPECT_EQ(nullptr, column(index).offsets) << index;
+    }
+
+    expect_bitmap(COLUMN_FLAG, expected.flags);
+    expect_values(COLUMN_SMALL, expected.smalls);
+    expect_offsets(COLUMN_LABEL, expected.label_offsets);
+    expect_bytes(COLUMN_LABEL, expected.labels);
+    expect_offsets(COLUMN_SAMPLES, expected.samples_offsets);
+    expect_values(COLUMN_SAMPLES_ITEM, expected.samples);
+    expect_values(COLUMN_PAIR_ITEM, expected.pairs);
+    expect_values(COLUMN_INNER_ID, expected.inner_ids);
+    expect_offsets(COLUMN_INNER_NAME, expected.inner_name_offsets);
+    expect_bytes(COLUMN_INNER_NAME, expected.inner_names);
+    expect_offsets(COLUMN_INNERS, expected.inners_offsets);
+    expect_values(COLUMN_INNERS_ITEM_ID, expected.inners_ids);
+    expect_offsets(COLUMN_INNERS_ITEM_NAME, expected.inners_name_offsets);
+    expect_bytes(COLUMN_INNERS_ITEM_NAME, expected.inners_names);
+  }
+
+  SerializationSupport support_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_data_impl_t> data_;
+  std::deque<rcutils_uint8_array_t> buffers_;
+  rosidl_dynamic_typesupport_fastrtps_columnar_batch_t batch_;
+};
+
+
+TEST_F(TestColumnarBatch, empty) {
+  expect_batch(Expected());
+}
+
+
+TEST_F(TestColumnarBatch, append_serialized) {
+  Expected expected;
+  std::vector<const rcutils_uint8_array_t *> buffers;
+  for (int32_t r = 0; r < ROW_COUNT; ++r) {
+    buffers.push_back(serialize(make_row(r, &expected)));
+  }
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_serialized(
+      &batch_, buffers.data(), buffers.size())) << rcutils_get_error_string().str;
+  expect_batch(expected);
+}
+
+
+TEST_F(TestColumnarBatch, append_data) {
+  // One call per row, so rows also build on what earlier calls appended
+  Expected expected;
+  for (int32_t r = 0; r < ROW_COUNT; ++r) {
+    const rosidl_dynamic_typesupport_dynamic_data_impl_t * data = make_row(r, &expected);
+    ASSERT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_data(&batch_, &data, 1))
+      << rcutils_get_error_string().str;
+  }
+  expect_batch(expected);
+}
+
+
+TEST_F(TestColumnarBatch, failed_row_is_rolled_back) {
+  Expected expected;
+  std::vector<const rcutils_uint8_array_t *> buffers;
+  for (int32_t r = 0; r < ROW_COUNT; ++r) {
+    buffers.push_back(serialize(make_row(r, &expected)));
+  }
+
+  // Row 12 sets its flag, and is cut short in its last member
+  Expected discarded = expected;
+  const rcutils_uint8_array_t * failing = serialize(make_row(12, &discarded));
+  ASSERT_TRUE(row_flag(12));
+  rcutils_uint8_array_t truncated = *failing;
+  truncated.buffer_length -= 3;
+  buffers.push_back(&truncated);
+
+  // The rows before it stay in the batch, and nothing of it does
+  EXPECT_EQ(
+    RCUTILS_RET_ERROR,
+    rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_serialized(
+      &batch_, buffers.data(), buffers.size()));
+  rcutils_reset_error();
+  expect_batch(expected);
+
+  // The next row clears the flag bit the failed one set
+  const rosidl_dynamic_typesupport_dynamic_data_impl_t * data = make_row(13, &expected);
+  ASSERT_FALSE(row_flag(13));
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_data(&batch_, &data, 1));
+  expect_batch(expected);
+
+  // Buffers that are not plain CDR are refused before anything is appended
+  rcutils_uint8_array_t header_only = *failing;
+  header_only.buffer_length = 2;
+  const rcutils_uint8_array_t * bad = &header_only;
+  EXPECT_EQ(
+    RCUTILS_RET_INVALID_ARGUMENT,
+    rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_serialized(&batch_, &bad, 1));
+  rcutils_reset_error();
+  expect_batch(expected);
+}
+
+
+TEST_F(TestColumnarBatch, clear) {
+  Expected expected;
+  std::vector<const rcutils_uint8_array_t *> buffers;
+  for (int32_t r = 0; r < ROW_COUNT; ++r) {
+    buffers.push_back(serialize(make_row(r, &expected)));
+  }
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_serialized(
+      &batch_, buffers.data(), buffers.size()));
+  ASSERT_EQ(RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_columnar_batch_clear(&batch_));
+  expect_batch(Expected());
+
+  // Offsets start over from 0 for the next batch
+  Expected next;
+  buffers.clear();
+  for (int32_t r = 5; r < ROW_COUNT; ++r) {
+    buffers.push_back(serialize(make_row(r, &next)));
+  }
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_columnar_batch_append_serialized(
+      &batch_, buffers.data(), buffers.size()));
+  expect_batch(next);
+}
@@ -0,0 +1,563 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/content_filter.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "detail/fastrtps_content_filter.hpp"
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+
+
+// Member ids of test/msg/Filter
+#define FILTER_COUNT 0
+#define FILTER_TOTAL 1
+#define FILTER_LEVEL 2
+#define FILTER_RATIO 3
+#define FILTER_LETTER 4
+#define FILTER_FRAME_ID 5
+#define FILTER_INNER 6
+#define FILTER_INNERS 7
+#define FILTER_VALUES 8
+#define FILTER_BIG 9
+#define FILTER_HUGE 10
+#define FILTER_WIDE 11
+
+// Member ids of test/msg/Inner
+#define INNER_ID 0
+#define INNER_NAME 1
+
+// Member ids of test/msg/Swap
+#define SWAP_SHORT 0
+#define SWAP_LONG 1
+#define SWAP_DOUBLE 2
+#define SWAP_UNSIGNED 3
+#define SWAP_NAME 4
+
+#define VALUES_LENGTH 3
+
+
+/// An expression, and whether it matches the message it is evaluated on
+struct Case
+{
+  const char * expression;
+  bool match;
+};
+
+
+class TestContentFilter : public ::testing::Test
+{
+protected:
+  void
+  SetUp() override
+  {
+    // struct Inner { int32 id; string name }
+    // struct Filter {
+    //   int32 count; uint32 total; int8 level; float64 ratio; char letter; string frame_id;
+    //   Inner inner; Inner[] inners; int16[3] values; int64 big; uint64 huge; wstring wide }
+    TypeBuilder inner_builder(&support_, "test/msg/Inner");
+    inner_builder.add(fastrtps__dynamic_type_builder_add_int32_member, "id");
+    inner_builder.add(fastrtps__dynamic_type_builder_add_string_member, "name");
+    types_.push_back(inner_builder.build());
+    auto inner_type = &types_.back();
+
+    TypeBuilder builder(&support_, "test/msg/Filter");
+    builder.add(fastrtps__dynamic_type_builder_add_int32_member, "count");
+    builder.add(fastrtps__dynamic_type_builder_add_uint32_member, "total");
+    builder.add(fastrtps__dynamic_type_builder_add_int8_member, "level");
+    builder.add(fastrtps__dynamic_type_builder_add_float64_member, "ratio");
+    builder.add(fastrtps__dynamic_type_builder_add_char_member, "letter");
+    builder.add(fastrtps__dynamic_type_builder_add_string_member, "frame_id");
+    builder.add(fastrtps__dynamic_type_builder_add_complex_member, "inner", inner_type);
+    builder.add(
+      fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "inners", inner_type);
+    builder.add(fastrtps__dynamic_type_builder_add_int16_array_member, "values", VALUES_LENGTH);
+    builder.add(fastrtps__dynamic_type_builder_add_int64_member, "big");
+    builder.add(fastrtps__dynamic_type_builder_add_uint64_member, "huge");
+    builder.add(fastrtps__dynamic_type_builder_add_wstring_member, "wide");
+    types_.push_back(builder.build());
+    filter_type_ = &types_.back();
+
+    // struct Swap { int16 short; int32 long; float64 double; uint16 unsigned; string name }
+    TypeBuilder swap_builder(&support_, "test/msg/Swap");
+    swap_builder.add(fastrtps__dynamic_type_builder_add_int16_member, "short");
+    swap_builder.add(fastrtps__dynamic_type_builder_add_int32_member, "long");
+    swap_builder.add(fastrtps__dynamic_type_builder_add_float64_member, "double");
+    swap_builder.add(fastrtps__dynamic_type_builder_add_uint16_member, "unsigned");
+    swap_builder.add(fastrtps__dynamic_type_builder_add_string_member, "name");
+    types_.push_back(swap_builder.build());
+    swap_type_ = &types_.back();
+
+    buffer_ = rcutils_get_zero_initialized_uint8_array();
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_uint8_array_init(&buffer_, 0, &support_.allocator));
+    filter_ = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_content_filter();
+  }
+
+  void
+  TearDown() override
+  {
+    rosidl_dynamic_typesupport_fastrtps_content_filter_fini(&filter_);
+    rcutils_uint8_array_fini(&buffer_);
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_.impl, &*it);
+    }
+    rcutils_reset_error();
+  }
+
+  void
+  set_inner(
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * data,
+    rosidl_dynamic_typesupport_member_id_t id, int32_t inner_id, const std::string & name)
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t inner;
+    check(fastrtps__dynamic_data_loan_value(impl, data, id, &support_.allocator, &inner), "loan");
+    check(fastrtps__dynamic_data_set_int32_value(impl, &inner, INNER_ID, inner_id), "set");
+    check(
+      fastrtps__dynamic_data_set_string_value(impl, &inner, INNER_NAME, name.c_str(), name.size()),
+      "set");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &inner), "return");
+  }
+
+  // count -5, total 7, level -1, ratio `ratio`, letter 'q', frame_id "map", inner {3, "it's"},
+  // inners {{0, "a"}, {1, "b"}}, values {10, -20, 30}, big INT64_MIN, huge UINT64_MAX, wide "w"
+  void
+  serialize_filter_message(double ratio = 0.5)
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        impl, filter_type_, &support_.allocator, &data),
+      "init data");
+    check(fastrtps__dynamic_data_set_int32_value(impl, &data, FILTER_COUNT, -5), "set");
+    check(fastrtps__dynamic_data_set_uint32_value(impl, &data, FILTER_TOTAL, 7), "set");
+    check(fastrtps__dynamic_data_set_int8_value(impl, &data, FILTER_LEVEL, -1), "set");
+    check(fastrtps__dynamic_data_set_float64_value(impl, &data, FILTER_RATIO, ratio), "set");
+    check(fastrtps__dynamic_data_set_char_value(impl, &data, FILTER_LETTER, 'q'), "set");
+    check(fastrtps__dynamic_data_set_string_value(impl, &data, FILTER_FRAME_ID, "map", 3), "set");
+    set_inner(&data, FILTER_INNER, 3, "it's");
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t member;
+    rosidl_dynamic_typesupport_member_id_t id;
+    check(
+      fastrtps__dynamic_data_loan_value(impl, &data, FILTER_INNERS, &support_.allocator, &member),
+      "loan");
+    check(fastrtps__dynamic_data_insert_sequence_data(impl, &member, &id), "insert");
+    set_inner(&member, id, 0, "a");
+    check(fastrtps__dynamic_data_insert_sequence_data(impl, &member, &id), "insert");
+    set_inner(&member, id, 1, "b");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, &data, &member), "return");
+
+    const int16_t values[VALUES_LENGTH] = {10, -20, 30};
+    check(
+      fastrtps__dynamic_data_loan_value(impl, &data, FILTER_VALUES, &support_.allocator, &member),
+      "loan");
+    for (rosidl_dynamic_typesupport_member_id_t i = 0; i < VALUES_LENGTH; ++i) {
+      check(fastrtps__dynamic_data_set_int16_value(impl, &member, i, values[i]), "set");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, &data, &member), "return");
+
+    check(
+      fastrtps__dynamic_data_set_int64_value(
+        impl, &data, FILTER_BIG, std::numeric_limits<int64_t>::min()),
+      "set");
+    check(
+      fastrtps__dynamic_data_set_uint64_value(
+        impl, &data, FILTER_HUGE, std::numeric_limits<uint64_t>::max()),
+      "set");
+    check(fastrtps__dynamic_data_set_wstring_value(impl, &data, FILTER_WIDE, u"w", 1), "set");
+
+    check(fastrtps__dynamic_data_serialize(impl, &data, &buffer_), "serialize");
+    fastrtps__dynamic_data_fini(impl, &data);
+  }
+
+  rcutils_ret_t
+  init_filter(
+    rosidl_dynamic_typesupport_dynamic_type_impl_t * type, const std::string & expression,
+    const std::vector<const char *> & parameters = {})
+  {
+    rosidl_dynamic_typesupport_fastrtps_content_filter_fini(&filter_);
+    rcutils_reset_error();
+    return rosidl_dynamic_typesupport_fastrtps_content_filter_init(
+      &support_.impl, type, expression.c_str(), parameters.data(), parameters.size(),
+      &support_.allocator, &filter_);
+  }
+
+  // Whether `expression` compiles against test/msg/Filter, and matches the serialized message
+  bool
+  matches(const std::string & expression, const std::vector<const char *> & parameters = {})
+  {
+    rcutils_ret_t ret = init_filter(filter_type_, expression, parameters);
+    EXPECT_EQ(RCUTILS_RET_OK, ret) << rcutils_get_error_string().str;
+    if (ret != RCUTILS_RET_OK) {
+      return false;
+    }
+    bool match = false;
+    EXPECT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_content_filter_evaluate(&filter_, &buffer_, &match));
+    return match;
+  }
+
+  void
+  expect_cases(const std::vector<Case> & cases)
+  {
+    for (const auto & c : cases) {
+      EXPECT_EQ(c.match, matches(c.expression)) << c.expression;
+    }
+  }
+
+  SerializationSupport support_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * filter_type_;
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * swap_type_;
+  rcutils_uint8_array_t buffer_;
+  rosidl_dynamic_typesupport_fastrtps_content_filter_t filter_;
+};
+
+
+TEST_F(TestContentFilter, parse_valid) {
+  serialize_filter_message();
+  expect_cases(
+  {
+    {"count = -5", true},
+    {"count=-5", true},
+    {"count <> -5", false},
+    {"count != -5", false},
+    {"count < -4 AND count <= -5 AND count > -6 AND count >= -5", true},
+    {"count = -5 and not total > 10", true},
+    {"count = 0 OR total = 7", true},
+    {"NOT (count = -5 OR total = 7)", false},
+    {"(count = 0 OR total = 7) AND (ratio > 0.25 OR ratio < 0)", true},
+    {"count = 0 OR total = 7 AND ratio < 0", false},
+    {"count = count", true},
+    {"1 = 1", true},
+    {"TRUE = 1 AND false = 0", true},
+  });
+
+  // Parameters are substituted as literals, strings with or without quotes
+  EXPECT_TRUE(matches("count = %0 AND total = %1", {"-5", " 7 "}));
+  EXPECT_TRUE(matches("ratio = %0", {"5e-1"}));
+  EXPECT_TRUE(matches("frame_id = %0", {"'map'"}));
+  EXPECT_TRUE(matches("frame_id = %0", {"map"}));
+  EXPECT_FALSE(matches("frame_id = %0", {"'odom'"}));
+}
+
+
+TEST_F(TestContentFilter, parse_invalid) {
+  const char * expressions[] = {
+    "",
+    "count",
+    "count =",
+    "= 1",
+    "count = 1 AND",
+    "count = 1 OR OR total = 1",
+    "(count = 1",
+    "count = 1)",
+    "count == 1",
+    "count # 1",
+    "NOT",
+    "frame_id = 'map",
+    "count = 'map'",
+    "frame_id = 1",
+    "nope = 1",
+    "inner = 1",
+    "inner.nope = 1",
+    "inner..id = 1",
+    "count.id = 1",
+    "count[0] = 1",
+    "values[x] = 1",
+    "values[-1] = 1",
+    "values[1 = 1",
+    "wide = 'w'",
+    "count = 99999999999999999999",
+    "count = %0",
+  };
+  for (const char * expression : expressions) {
+    EXPECT_EQ(RCUTILS_RET_INVALID_ARGUMENT, init_filter(filter_type_, expression)) << expression;
+    EXPECT_EQ(nullptr, filter_.handle) << expression;
+  }
+
+  // Parameters that are missing, or strings compared with numbers
+  EXPECT_EQ(RCUTILS_RET_INVALID_ARGUMENT, init_filter(filter_type_, "count = %1", {"1"}));
+  EXPECT_EQ(RCUTILS_RET_INVALID_ARGUMENT, init_filter(filter_type_, "count = %0", {"five"}));
+
+  // An expression is required
+  EXPECT_EQ(
+    RCUTILS_RET_INVALID_ARGUMENT,
+    rosidl_dynamic_typesupport_fastrtps_content_filter_init(
+      &support_.impl, filter_type_, nullptr, nullptr, 0, &support_.allocator, &filter_));
+  rcutils_reset_error();
+}
+
+
+TEST_F(TestContentFilter, depth_limit) {
+  serialize_filter_message();
+
+  std::string nots;
+  for (int i = 0; i < FASTRTPS_CONTENT_FILTER_MAX_DEPTH; ++i) {
+    nots += "NOT ";
+  }
+  EXPECT_TRUE(matches(nots + "count = -5"));
+  EXPECT_EQ(RCUTILS_RET_INVALID_ARGUMENT, init_filter(filter_type_, "NOT " + nots + "count = -5"));
+
+  std::string open(FASTRTPS_CONTENT_FILTER_MAX_DEPTH, '(');
+  std::string close(FASTRTPS_CONTENT_FILTER_MAX_DEPTH, ')');
+  EXPECT_TRUE(matches(open + "count = -5" + close));
+  EXPECT_EQ(
+    RCUTILS_RET_INVALID_ARGUMENT,
+    init_filter(filter_type_, "(" + open + "count = -5" + close + ")"));
+
+  std::string chain = "count = -5";
+  for (int i = 0; i < FASTRTPS_CONTENT_FILTER_MAX_DEPTH; ++i) {
+    chain += " AND total = 7";
+  }
+  EXPECT_TRUE(matches(chain));
+  EXPECT_EQ(RCUTILS_RET_INVALID_ARGUMENT, init_filter(filter_type_, chain + " AND total = 7"));
+
+  // Far past the limit, the way a hostile expression would be
+  std::string deep(100000, '(');
+  EXPECT_EQ(RCUTILS_RET_INVALID_ARGUMENT, init_filter(filter_type_, deep + "count = -5"));
+}
+
+
+TEST_F(TestContentFilter, nested_fields) {
+  serialize_filter_message();
+  expect_cases(
+  {
+    {"inner.id = 3", true},
+    {"inner.name = 'it''s'", true},
+    {"inners[0].id = 0 AND inners[0].name = 'a'", true},
+    {"inners[1].id = 1 AND inners[1].name = 'b'", true},
+    {"values[0] = 10 AND values[1] = -20 AND values[2] = 30", true},
+    {"values[1] < values[0]", true},
+    // Members after variable size ones are still found
+    {"big < 0 AND huge > 0", true},
+    // Elements the message doesn't have never match
+    {"inners[2].id = 2", false},
+    {"inners[2].id <> 2", false},
+    {"NOT inners[2].id = 2", true},
+    {"values[3] = 0", false},
+  });
+}
+
+
+TEST_F(TestContentFilter, mixed_signedness) {
+  serialize_filter_message();
+  expect_cases(
+  {
+    // Negative values are smaller than every unsigned value
+    {"count < total", true},
+    {"total > count", true},
+    {"count = total", false},
+    {"count < 0", true},
+    {"total > -1", true},
+    {"big < huge", true},
+    {"huge > -1", true},
+    {"big < 0", true},
+    {"big = -9223372036854775808", true},
+    {"huge = 18446744073709551615", true},
+    {"huge > 9223372036854775807", true},
+    // Against floating point values
+    {"ratio > count", true},
+    {"total = 7.0", true},
+    {"count < -4.5", true},
+    // Bytes compare unsigned, so an int8 -1 is 255
+    {"level = 255", true},
+    {"level = -1", false},
+    {"level > 0", true},
+  });
+}
+
+
+TEST_F(TestContentFilter, nan) {
+  serialize_filter_message(std::numeric_limits<double>::quiet_NaN());
+  expect_cases(
+  {
+    {"ratio = ratio", false},
+    {"ratio <> ratio", true},
+    {"ratio < 1", false},
+    {"ratio >= 1", false},
+    {"ratio = 0", false},
+    {"ratio <> 0", true},
+    {"count < ratio", false},
+    {"NOT ratio < 1", true},
+  });
+}
+
+
+TEST_F(TestContentFilter, strings_and_chars) {
+  serialize_filter_message();
+  expect_cases(
+  {
+    {"frame_id = 'map'", true},
+    {"frame_id <> 'map'", false},
+    {"frame_id = 'ma'", false},
+    {"frame_id = 'mapx'", false},
+    {"frame_id > 'ma' AND frame_id < 'mb'", true},
+    {"frame_id = ''", false},
+    {"letter = 'q'", true},
+    {"letter < 'r' AND letter > 'p'", true},
+    {"letter = 'qq'", false},
+    {"letter <> frame_id", true},
+    {"inner.name <> frame_id", true},
+  });
+}
+
+
+TEST_F(TestContentFilter, truncated_buffers) {
+  serialize_filter_message();
+  const rcutils_uint8_array_t full = buffer_;
+  const std::vector<Case> cases = {
+    {"count = -5", true},
+    {"frame_id = 'map'", true},
+    {"inners[1].name = 'b'", true},
+    {"values[2] = 30", true},
+    {"huge = 18446744073709551615", true},
+    {"letter = 'q'", true},
+  };
+
+  for (const auto & c : cases) {
+    ASSERT_TRUE(matches(c.expression)) << c.expression;
+
+    // Every shorter buffer either doesn't have the field, or still has all of it
+    bool matched_before = false;
+    for (size_t length = 0; length < full.buffer_length; ++length) {
+      rcutils_uint8_array_t truncated = full;
+      truncated.buffer_length = length;
+      bool match = false;
+      rcutils_ret_t ret =
+        rosidl_dynamic_typesupport_fastrtps_content_filter_evaluate(&filter_, &truncated, &match);
+      if (length < 4) {
+        // Not even an encapsulation header
+        EXPECT_EQ(RCUTILS_RET_INVALID_ARGUMENT, ret) << c.expression << " " << length;
+        rcutils_reset_error();
+        continue;
+      }
+      ASSERT_EQ(RCUTILS_RET_OK, ret) << c.expression << " " << length;
+      // Once there is enough of the buffer to match, longer ones match too
+      EXPECT_TRUE(!matched_before || match) << c.expression << " " << length;
+      matched_before = matched_before || match;
+    }
+  }
+}
+
+
+TEST_F(TestContentFilter, corrupted_buffers) {
+  serialize_filter_message();
+  std::vector<uint8_t> original(buffer_.buffer, buffer_.buffer + buffer_.buffer_length);
+  const char * expressions[] = {
+    "count = -5", "frame_id = 'map'", "inners[1].name = 'b'", "huge > 0", "letter = 'q'",
+  };
+
+  // Lengths and values read from a hostile buffer must never take a read out of it
+  for (const char * expression : expressions) {
+    ASSERT_EQ(RCUTILS_RET_OK, init_filter(filter_type_, expression)) << expression;
+    for (size_t position = 4; position < original.size(); ++position) {
+      for (uint8_t byte : {uint8_t(0x00), uint8_t(0x7f), uint8_t(0xff)}) {
+        std::copy(original.begin(), original.end(), buffer_.buffer);
+        buffer_.buffer[position] = byte;
+        bool match = false;
+        EXPECT_EQ(
+          RCUTILS_RET_OK,
+          rosidl_dynamic_typesupport_fastrtps_content_filter_evaluate(&filter_, &buffer_, &match));
+      }
+    }
+  }
+  std::copy(original.begin(), original.end(), buffer_.buffer);
+
+  // Encapsulations other than plain CDR are refused
+  bool match = false;
+  for (uint8_t kind : {uint8_t(2), uint8_t(3), uint8_t(0x10)}) {
+    buffer_.buffer[1] = kind;
+    EXPECT_EQ(
+      RCUTILS_RET_INVALID_ARGUMENT,
+      rosidl_dynamic_typesupport_fastrtps_content_filter_evaluate(&filter_, &buffer_, &match));
+    rcutils_reset_error();
+  }
+}
+
+
+// Reverse the `size` bytes at `offset` after the encapsulation header
+static void
+swap_bytes(rcutils_uint8_array_t * buffer, size_t offset, size_t size)
+{
+  std::reverse(buffer->buffer + 4 + offset, buffer->buffer + 4 + offset + size);
+}
+
+
+TEST_F(TestContentFilter, byte_swapped_buffers) {
+  auto impl = &support_.impl;
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+  check(
+    fastrtps__dynamic_data_init_from_dynamic_type(impl, swap_type_, &support_.allocator, &data),
+    "init data");
+  check(fastrtps__dynamic_data_set_int16_value(impl, &data, SWAP_SHORT, -2), "set");
+  check(fastrtps__dynamic_data_set_int32_value(impl, &data, SWAP_LONG, 0x01020304), "set");
+  check(fastrtps__dynamic_data_set_float64_value(impl, &data, SWAP_DOUBLE, -1.25), "set");
+  check(fastrtps__dynamic_data_set_uint16_value(impl, &data, SWAP_UNSIGNED, 0xabcd), "set");
+  check(fastrtps__dynamic_data_set_string_value(impl, &data, SWAP_NAME, "swap", 4), "set");
+  check(fastrtps__dynamic_data_serialize(impl, &data, &buffer_), "serialize");
+  fastrtps__dynamic_data_fini(impl, &data);
+
+  const char * expression =
+    "short = -2 AND long = 16909060 AND double = -1.25 AND unsigned = 43981 AND name = 'swap'";
+  ASSERT_EQ(RCUTILS_RET_OK, init_filter(swap_type_, expression)) << rcutils_get_error_string().str;
+  bool match = false;
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_content_filter_evaluate(&filter_, &buffer_, &match));
+  EXPECT_TRUE(match);
+
+  // The same message in the other byte order: short at 0, long at 4, double at 8, unsigned at 16,
+  // the name length at 20, and the name itself is not swapped
+  ASSERT_LE(4u + 24u + 5u, buffer_.buffer_length);
+  buffer_.buffer[1] ^= 1;
+  swap_bytes(&buffer_, 0, 2);
+  swap_bytes(&buffer_, 4, 4);
+  swap_bytes(&buffer_, 8, 8);
+  swap_bytes(&buffer_, 16, 2);
+  swap_bytes(&buffer_, 20, 4);
+  match = false;
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_content_filter_evaluate(&filter_, &buffer_, &match));
+  EXPECT_TRUE(match);
+
+  // Read in the wrong byte order, the values are all different
+  buffer_.buffer[1] ^= 1;
+  ASSERT_EQ(RCUTILS_RET_OK, init_filter(swap_type_, "short = -2 OR long = 16909060"));
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_content_filter_evaluate(&filter_, &buffer_, &match));
+  EXPECT_FALSE(match);
+}
@@ -0,0 +1,304 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/allocation_accounting.h>
+#include <rosidl_dynamic_typesupport_fastrtps/data_snapshot.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+
+
+// Member ids of test/msg/Snapshot
+#define SNAPSHOT_COUNT 0
+#define SNAPSHOT_LABEL 1
+#define SNAPSHOT_INNER 2
+#define SNAPSHOT_VALUES 3
+#define SNAPSHOT_INNERS 4
+
+// Member ids of test/msg/Inner
+#define INNER_VALUE 0
+#define INNER_WEIGHTS 1
+
+#define VALUES_LENGTH 4
+#define INNERS_LENGTH 3
+
+#define READER_COUNT 8
+#define READS_PER_READER 200
+
+
+class TestDataSnapshot : public ::testing::Test
+{
+protected:
+  void
+  SetUp() override
+  {
+    // struct Inner { int32 value; float64[] weights }
+    // struct Snapshot { int32 count; string label; Inner inner; int32[4] values; Inner[] inners }
+    TypeBuilder inner_builder(&support_, "test/msg/Inner");
+    inner_builder.add(fastrtps__dynamic_type_builder_add_int32_member, "value");
+    inner_builder.add(
+      fastrtps__dynamic_type_builder_add_float64_unbounded_sequence_member, "weights");
+    types_.push_back(inner_builder.build());
+
+    TypeBuilder builder(&support_, "test/msg/Snapshot");
+    builder.add(fastrtps__dynamic_type_builder_add_int32_member, "count");
+    builder.add(fastrtps__dynamic_type_builder_add_string_member, "label");
+    builder.add(fastrtps__dynamic_type_builder_add_complex_member, "inner", &types_.front());
+    builder.add(fastrtps__dynamic_type_builder_add_int32_array_member, "values", VALUES_LENGTH);
+    builder.add(
+      fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "inners",
+      &types_.front());
+    types_.push_back(builder.build());
+  }
+
+  void
+  TearDown() override
+  {
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_.impl, &*it);
+    }
+    rcutils_reset_error();
+  }
+
+  // Inner number `n` holds value n and weights {n, n + 0.5}
+  void
+  fill_inner(
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * data,
+    rosidl_dynamic_typesupport_member_id_t id, int32_t n)
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t inner;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t weights;
+    rosidl_dynamic_typesupport_member_id_t weight_id;
+    check(fastrtps__dynamic_data_loan_value(impl, data, id, &support_.allocator, &inner), "loan");
+    check(fastrtps__dynamic_data_set_int32_value(impl, &inner, INNER_VALUE, n), "set");
+    check(
+      fastrtps__dynamic_data_loan_value(impl, &inner, INNER_WEIGHTS, &support_.allocator, &weights),
+      "loan");
+    check(fastrtps__dynamic_data_insert_float64_value(impl, &weights, n, &weight_id), "insert");
+    check(
+      fastrtps__dynamic_data_insert_float64_value(impl, &weights, n + 0.5, &weight_id), "insert");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, &inner, &weights), "return");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &inner), "return");
+  }
+
+  // count 42, label "frozen", inner number 7, values {0, 10, 20, 30}, inners numbers 0 to 2
+  void
+  make_data(rosidl_dynamic_typesupport_dynamic_data_impl_t * data)
+  {
+    auto impl = &support_.impl;
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        impl, &types_.back(), &support_.allocator, data),
+      "init data");
+    check(fastrtps__dynamic_data_set_int32_value(impl, data, SNAPSHOT_COUNT, 42), "set");
+    check(fastrtps__dynamic_data_set_string_value(impl, data, SNAPSHOT_LABEL, "frozen", 6), "set");
+    fill_inner(data, SNAPSHOT_INNER, 7);
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t member;
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, SNAPSHOT_VALUES, &support_.allocator, &member),
+      "loan");
+    for (int32_t i = 0; i < VALUES_LENGTH; ++i) {
+      check(fastrtps__dynamic_data_set_int32_value(impl, &member, i, i * 10), "set");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, SNAPSHOT_INNERS, &support_.allocator, &member),
+      "loan");
+    for (int32_t i = 0; i < INNERS_LENGTH; ++i) {
+      rosidl_dynamic_typesupport_member_id_t id;
+      check(fastrtps__dynamic_data_insert_sequence_data(impl, &member, &id), "insert");
+      fill_inner(&member, id, i);
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+  }
+
+  // Whether the view `inner` of `snapshot` is inner number `n`
+  bool
+  read_inner(
+    const rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot,
+    const rosidl_dynamic_typesupport_dynamic_data_impl_t * inner, int32_t n)
+  {
+    auto impl = &support_.impl;
+    int32_t value = 0;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t weights;
+    size_t weight_count = 0;
+    double weight[2] = {0.0, 0.0};
+    return
+      fastrtps__dynamic_data_get_int32_value(impl, inner, INNER_VALUE, &value) ==
+      RCUTILS_RET_OK && value == n &&
+      rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_nested_data(
+      snapshot, inner, INNER_WEIGHTS, &weights) == RCUTILS_RET_OK &&
+      fastrtps__dynamic_data_get_item_count(impl, &weights, &weight_count) == RCUTILS_RET_OK &&
+      weight_count == 2 &&
+      fastrtps__dynamic_data_get_float64_value(impl, &weights, 0, &weight[0]) ==
+      RCUTILS_RET_OK &&
+      fastrtps__dynamic_data_get_float64_value(impl, &weights, 1, &weight[1]) ==
+      RCUTILS_RET_OK &&
+      weight[0] == n && weight[1] == n + 0.5;
+  }
+
+  // Whether every value read through `snapshot` is the one make_data set
+  bool
+  read(const rosidl_dynamic_typesupport_fastrtps_data_snapshot_t * snapshot)
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+    if (rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_data(snapshot, &data) !=
+      RCUTILS_RET_OK)
+    {
+      return false;
+    }
+
+    int32_t count = 0;
+    char * label = nullptr;
+    size_t label_length = 0;
+    if (fastrtps__dynamic_data_get_int32_value(impl, &data, SNAPSHOT_COUNT, &count) !=
+      RCUTILS_RET_OK || count != 42 ||
+      fastrtps__dynamic_data_get_string_value(impl, &data, SNAPSHOT_LABEL, &label, &label_length) !=
+      RCUTILS_RET_OK)
+    {
+      return false;
+    }
+    bool ok = std::string(label, label_length) == "frozen";
+    delete[] label;
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t nested;
+    ok = ok && rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_nested_data(
+      snapshot, &data, SNAPSHOT_INNER, &nested) == RCUTILS_RET_OK &&
+      read_inner(snapshot, &nested, 7);
+
+    ok = ok && rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_nested_data(
+      snapshot, &data, SNAPSHOT_VALUES, &nested) == RCUTILS_RET_OK;
+    for (int32_t i = 0; ok && i < VALUES_LENGTH; ++i) {
+      int32_t value = -1;
+      ok = fastrtps__dynamic_data_get_int32_value(impl, &nested, i, &value) == RCUTILS_RET_OK &&
+        value == i * 10;
+    }
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t inners;
+    size_t inner_count = 0;
+    ok = ok && rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_nested_data(
+      snapshot, &data, SNAPSHOT_INNERS, &inners) == RCUTILS_RET_OK &&
+      fastrtps__dynamic_data_get_item_count(impl, &inners, &inner_count) == RCUTILS_RET_OK &&
+      inner_count == INNERS_LENGTH;
+    for (int32_t i = 0; ok && i < INNERS_LENGTH; ++i) {
+      ok = rosidl_dynamic_typesupport_fastrtps_data_snapshot_get_nested_data(
+        snapshot, &inners, i, &nested) == RCUTILS_RET_OK && read_inner(snapshot, &nested, i);
+    }
+    return ok;
+  }
+
+  uint64_t
+  data_frees()
+  {
+    rosidl_dynamic_typesupport_fastrtps_allocation_accounting_snapshot_t accounting;
+    check(
+      rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_get_allocation_accounting(
+        &support_.impl, &accounting),
+      "get allocation accounting");
+    return accounting.categories[
+      ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_CATEGORY_DATA_CREATE].frees;
+  }
+
+  SerializationSupport support_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+};
+
+
+TEST_F(TestDataSnapshot, concurrent_readers) {
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_serialization_support_impl_set_allocation_accounting(
+      &support_.impl, ROSIDL_DYNAMIC_TYPESUPPORT_FASTRTPS_ALLOCATION_ACCOUNTING_LIBRARY));
+
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+  make_data(&data);
+  auto snapshot = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_data_snapshot();
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_dynamic_data_freeze(
+      &support_.impl, &data, &support_.allocator, &snapshot)) << rcutils_get_error_string().str;
+  EXPECT_EQ(nullptr, data.handle);
+  uint64_t frees = data_frees();
+
+  // Each reader takes its own reference, and releases it when done
+  std::atomic<int> failed_reads{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < READER_COUNT; ++i) {
+    auto reference = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_data_snapshot();
+    ASSERT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_data_snapshot_acquire(&snapshot, &reference));
+    readers.emplace_back(
+      [this, reference, &failed_reads]() mutable {
+        for (int read_count = 0; read_count < READS_PER_READER; ++read_count) {
+          if (!read(&reference)) {
+            ++failed_reads;
+          }
+        }
+        rosidl_dynamic_typesupport_fastrtps_data_snapshot_release(&reference);
+      });
+  }
+  for (auto & reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, failed_reads.load());
+
+  // Every reader is done, but this reference still holds the data
+  EXPECT_EQ(frees, data_frees());
+  EXPECT_TRUE(read(&snapshot));
+  EXPECT_EQ(RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_data_snapshot_release(&snapshot));
+  EXPECT_EQ(nullptr, snapshot.handle);
+  EXPECT_EQ(frees + 1, data_frees());
+}
+
+
+TEST_F(TestDataSnapshot, freeze_with_loaned_value_fails) {
+  auto impl = &support_.impl;
+  rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+  make_data(&data);
+  rosidl_dynamic_typesupport_dynamic_data_impl_t inner;
+  check(
+    fastrtps__dynamic_data_loan_value(impl, &data, SNAPSHOT_INNER, &support_.allocator, &inner),
+    "loan");
+
+  auto snapshot = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_data_snapshot();
+  EXPECT_EQ(
+    RCUTILS_RET_ERROR,
+    rosidl_dynamic_typesupport_fastrtps_dynamic_data_freeze(
+      impl, &data, &support_.allocator, &snapshot));
+  EXPECT_NE(nullptr, data.handle);
+
+  check(fastrtps__dynamic_data_return_loaned_value(impl, &data, &inner), "return");
+  fastrtps__dynamic_data_fini(impl, &data);
+}
@@ -0,0 +1,329 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/deserialization_pipeline.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+
+
+// Member ids of test/msg/Small and test/msg/Large, both start with the message number
+#define MESSAGE_NUMBER 0
+#define LARGE_SAMPLES 1
+
+
+/// What the callback got for one delivery
+struct Delivery
+{
+  uint64_t sequence;
+  rcutils_ret_t ret;
+  bool has_data;
+  int32_t number;
+};
+
+/// Records deliveries, and holds them back while the gate is closed
+struct Recorder
+{
+  rosidl_dynamic_typesupport_serialization_support_impl_t * impl;
+
+  std::mutex mutex;
+  std::vector<Delivery> deliveries;
+
+  std::mutex gate_mutex;
+  std::condition_variable gate;
+  bool open = true;
+};
+
+
+static void
+record_delivery(
+  void * user_data, uint64_t sequence, rcutils_ret_t ret,
+  rosidl_dynamic_typesupport_dynamic_data_impl_t * data_impl)
+{
+  auto recorder = static_cast<Recorder *>(user_data);
+  {
+    std::unique_lock<std::mutex> lock(recorder->gate_mutex);
+    recorder->gate.wait(lock, [recorder] {return recorder->open;});
+  }
+
+  Delivery delivery{sequence, ret, data_impl != nullptr, -1};
+  if (data_impl) {
+    fastrtps__dynamic_data_get_int32_value(
+      recorder->impl, data_impl, MESSAGE_NUMBER, &delivery.number);
+    fastrtps__dynamic_data_fini(recorder->impl, data_impl);
+  }
+  std::lock_guard<std::mutex> lock(recorder->mutex);
+  recorder->deliveries.push_back(delivery);
+}
+
+
+class TestDeserializationPipeline : public ::testing::Test
+{
+protected:
+  void
+  SetUp() override
+  {
+    // struct Small { int32 number }
+    // struct Large { int32 number; float64[] samples }
+    TypeBuilder small_builder(&support_, "test/msg/Small");
+    small_builder.add(fastrtps__dynamic_type_builder_add_int32_member, "number");
+    types_.push_back(small_builder.build());
+
+    TypeBuilder large_builder(&support_, "test/msg/Large");
+    large_builder.add(fastrtps__dynamic_type_builder_add_int32_member, "number");
+    large_builder.add(
+      fastrtps__dynamic_type_builder_add_float64_unbounded_sequence_member, "samples");
+    types_.push_back(large_builder.build());
+
+    recorder_.impl = &support_.impl;
+    pipeline_ = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_deserialization_pipeline();
+  }
+
+  void
+  TearDown() override
+  {
+    open_gate();
+    rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_fini(&pipeline_);
+    for (auto & buffer : buffers_) {
+      rcutils_uint8_array_fini(&buffer);
+    }
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_.impl, &*it);
+    }
+    rcutils_reset_error();
+  }
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t *
+  small_type()
+  {
+    return &types_.front();
+  }
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t *
+  large_type()
+  {
+    return &types_.back();
+  }
+
+  void
+  init_pipeline(size_t worker_count, size_t capacity)
+  {
+    ASSERT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_init(
+        &support_.impl, worker_count, capacity, record_delivery, &recorder_,
+        &support_.allocator, &pipeline_)) << rcutils_get_error_string().str;
+  }
+
+  // Message `number`, with `sample_count` samples if it is a test/msg/Large
+  const rcutils_uint8_array_t *
+  serialize(
+    rosidl_dynamic_typesupport_dynamic_type_impl_t * type, int32_t number,
+    size_t sample_count = 0)
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(impl, type, &support_.allocator, &data),
+      "init data");
+    check(fastrtps__dynamic_data_set_int32_value(impl, &data, MESSAGE_NUMBER, number), "set");
+    if (type == large_type()) {
+      rosidl_dynamic_typesupport_dynamic_data_impl_t samples;
+      rosidl_dynamic_typesupport_member_id_t id;
+      check(
+        fastrtps__dynamic_data_loan_value(
+          impl, &data, LARGE_SAMPLES, &support_.allocator, &samples),
+        "loan");
+      for (size_t i = 0; i < sample_count; ++i) {
+        check(fastrtps__dynamic_data_insert_float64_value(impl, &samples, i * 0.5, &id), "insert");
+      }
+      check(fastrtps__dynamic_data_return_loaned_value(impl, &data, &samples), "return");
+    }
+
+    buffers_.push_back(rcutils_get_zero_initialized_uint8_array());
+    check(rcutils_uint8_array_init(&buffers_.back(), 0, &support_.allocator), "init buffer");
+    check(fastrtps__dynamic_data_serialize(impl, &data, &buffers_.back()), "serialize");
+    fastrtps__dynamic_data_fini(impl, &data);
+    return &buffers_.back();
+  }
+
+  rcutils_ret_t
+  submit(
+    rosidl_dynamic_typesupport_dynamic_type_impl_t * type, const rcutils_uint8_array_t * buffer,
+    uint64_t * sequence = nullptr)
+  {
+    return rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_submit(
+      &pipeline_, type, buffer, sequence);
+  }
+
+  rcutils_ret_t
+  wait()
+  {
+    return rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_wait(&pipeline_);
+  }
+
+  void
+  close_gate()
+  {
+    std::lock_guard<std::mutex> lock(recorder_.gate_mutex);
+    recorder_.open = false;
+  }
+
+  void
+  open_gate()
+  {
+    {
+      std::lock_guard<std::mutex> lock(recorder_.gate_mutex);
+      recorder_.open = true;
+    }
+    recorder_.gate.notify_all();
+  }
+
+  std::vector<Delivery>
+  deliveries()
+  {
+    std::lock_guard<std::mutex> lock(recorder_.mutex);
+    return recorder_.deliveries;
+  }
+
+  // Every delivery so far is successful, and message number `i` came with sequence `i`
+  void
+  expect_in_order(size_t count)
+  {
+    auto got = deliveries();
+    ASSERT_EQ(count, got.size());
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(i, got[i].sequence);
+      EXPECT_EQ(RCUTILS_RET_OK, got[i].ret);
+      EXPECT_TRUE(got[i].has_data);
+      EXPECT_EQ(static_cast<int32_t>(i), got[i].number);
+    }
+  }
+
+  SerializationSupport support_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+  std::deque<rcutils_uint8_array_t> buffers_;
+  Recorder recorder_;
+  rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_t pipeline_;
+};
+
+
+TEST_F(TestDeserializationPipeline, in_order_mixed_sizes) {
+  init_pipeline(4, 16);
+
+  // Small messages queued behind large ones finish first, and must still wait their turn
+  const int32_t count = 256;
+  for (int32_t i = 0; i < count; ++i) {
+    const rcutils_uint8_array_t * buffer = i % 2 ?
+      serialize(small_type(), i) : serialize(large_type(), i, (i * 997) % 20000);
+    uint64_t sequence = 0;
+    ASSERT_EQ(RCUTILS_RET_OK, submit(i % 2 ? small_type() : large_type(), buffer, &sequence));
+    EXPECT_EQ(static_cast<uint64_t>(i), sequence);
+  }
+  ASSERT_EQ(RCUTILS_RET_OK, wait());
+  expect_in_order(count);
+}
+
+
+TEST_F(TestDeserializationPipeline, capacity_backpressure) {
+  init_pipeline(2, 2);
+  const rcutils_uint8_array_t * buffers[3] = {
+    serialize(small_type(), 0), serialize(small_type(), 1), serialize(small_type(), 2)};
+
+  // Nothing gets delivered, so the first two fill the pipeline and the third has to wait
+  close_gate();
+  ASSERT_EQ(RCUTILS_RET_OK, submit(small_type(), buffers[0]));
+  ASSERT_EQ(RCUTILS_RET_OK, submit(small_type(), buffers[1]));
+  std::atomic<bool> submitted{false};
+  std::thread submitter(
+    [&]() {
+      EXPECT_EQ(RCUTILS_RET_OK, submit(small_type(), buffers[2]));
+      submitted = true;
+    });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(submitted.load());
+
+  open_gate();
+  submitter.join();
+  EXPECT_TRUE(submitted.load());
+  ASSERT_EQ(RCUTILS_RET_OK, wait());
+  expect_in_order(3);
+}
+
+
+TEST_F(TestDeserializationPipeline, error_delivers_null_data) {
+  init_pipeline(2, 8);
+
+  // Cut short in the middle of the samples
+  const rcutils_uint8_array_t * large = serialize(large_type(), 1, 100);
+  rcutils_uint8_array_t truncated = *large;
+  truncated.buffer_length = large->buffer_length / 2;
+
+  ASSERT_EQ(RCUTILS_RET_OK, submit(small_type(), serialize(small_type(), 0)));
+  ASSERT_EQ(RCUTILS_RET_OK, submit(large_type(), &truncated));
+  ASSERT_EQ(RCUTILS_RET_OK, submit(small_type(), serialize(small_type(), 2)));
+  ASSERT_EQ(RCUTILS_RET_OK, wait());
+
+  auto got = deliveries();
+  ASSERT_EQ(3u, got.size());
+  EXPECT_EQ(RCUTILS_RET_OK, got[0].ret);
+  EXPECT_EQ(0, got[0].number);
+  EXPECT_EQ(1u, got[1].sequence);
+  EXPECT_NE(RCUTILS_RET_OK, got[1].ret);
+  EXPECT_FALSE(got[1].has_data);
+  EXPECT_EQ(2u, got[2].sequence);
+  EXPECT_EQ(RCUTILS_RET_OK, got[2].ret);
+  EXPECT_EQ(2, got[2].number);
+}
+
+
+TEST_F(TestDeserializationPipeline, fini_delivers_queued_work) {
+  init_pipeline(1, 64);
+
+  // Held back until fini, so everything is still queued or parked when it is called
+  const int32_t count = 64;
+  close_gate();
+  for (int32_t i = 0; i < count; ++i) {
+    ASSERT_EQ(RCUTILS_RET_OK, submit(large_type(), serialize(large_type(), i, 1000)));
+  }
+  std::thread opener(
+    [this]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      open_gate();
+    });
+  EXPECT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_deserialization_pipeline_fini(&pipeline_));
+  opener.join();
+  expect_in_order(count);
+}
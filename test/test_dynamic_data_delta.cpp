@@ -0,0 +1,295 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <fastrtps/types/TypesBase.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/dynamic_data.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+
+
+// Member ids of test/msg/Delta
+#define DELTA_COUNT 0
+#define DELTA_RATIO 1
+#define DELTA_LABEL 2
+#define DELTA_VALUES 3
+#define DELTA_SAMPLES 4
+#define DELTA_INNER 5
+
+// Member ids of test/msg/Inner
+#define INNER_VALUE 0
+#define INNER_WEIGHTS 1
+
+
+/// Values for one test/msg/Delta
+struct DeltaValues
+{
+  int32_t count;
+  double ratio;
+  std::string label;
+  int32_t values[4];
+  std::vector<int32_t> samples;
+  int32_t inner_value;
+  std::vector<double> inner_weights;
+};
+
+
+class TestDynamicDataDelta : public ::testing::Test
+{
+protected:
+  void
+  SetUp() override
+  {
+    TypeBuilder inner_builder(&support_, "test/msg/Inner");
+    inner_builder.add(fastrtps__dynamic_type_builder_add_int32_member, "value");
+    inner_builder.add(
+      fastrtps__dynamic_type_builder_add_float64_unbounded_sequence_member, "weights");
+    types_.push_back(inner_builder.build());
+
+    TypeBuilder builder(&support_, "test/msg/Delta");
+    builder.add(fastrtps__dynamic_type_builder_add_int32_member, "count");
+    builder.add(fastrtps__dynamic_type_builder_add_float64_member, "ratio");
+    builder.add(fastrtps__dynamic_type_builder_add_string_member, "label");
+    builder.add(fastrtps__dynamic_type_builder_add_int32_array_member, "values", 4);
+    builder.add(fastrtps__dynamic_type_builder_add_int32_unbounded_sequence_member, "samples");
+    builder.add(fastrtps__dynamic_type_builder_add_complex_member, "inner", &types_.front());
+    types_.push_back(builder.build());
+
+    delta_ = rcutils_get_zero_initialized_uint8_array();
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_uint8_array_init(&delta_, 0, &support_.allocator));
+  }
+
+  void
+  TearDown() override
+  {
+    for (auto it = data_.rbegin(); it != data_.rend(); ++it) {
+      fastrtps__dynamic_data_fini(&support_.impl, &*it);
+    }
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_.impl, &*it);
+    }
+    rcutils_uint8_array_fini(&delta_);
+    rcutils_reset_error();
+  }
+
+  rosidl_dynamic_typesupport_dynamic_data_impl_t *
+  make_data(const DeltaValues & values)
+  {
+    auto impl = &support_.impl;
+    data_.emplace_back();
+    auto data = &data_.back();
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        impl, &types_.back(), &support_.allocator, data),
+      "init data");
+
+    check(fastrtps__dynamic_data_set_int32_value(impl, data, DELTA_COUNT, values.count), "set");
+    check(fastrtps__dynamic_data_set_float64_value(impl, data, DELTA_RATIO, values.ratio), "set");
+    check(
+      fastrtps__dynamic_data_set_string_value(
+        impl, data, DELTA_LABEL, values.label.c_str(), values.label.size()),
+      "set");
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t member;
+    rosidl_dynamic_typesupport_member_id_t id;
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, DELTA_VALUES, &support_.allocator, &member),
+      "loan");
+    for (rosidl_dynamic_typesupport_member_id_t i = 0; i < 4; ++i) {
+      check(fastrtps__dynamic_data_set_int32_value(impl, &member, i, values.values[i]), "set");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, DELTA_SAMPLES, &support_.allocator, &member),
+      "loan");
+    for (int32_t sample : values.samples) {
+      check(fastrtps__dynamic_data_insert_int32_value(impl, &member, sample, &id), "insert");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t inner;
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, DELTA_INNER, &support_.allocator, &inner),
+      "loan");
+    check(
+      fastrtps__dynamic_data_set_int32_value(impl, &inner, INNER_VALUE, values.inner_value),
+      "set");
+    check(
+      fastrtps__dynamic_data_loan_value(impl, &inner, INNER_WEIGHTS, &support_.allocator, &member),
+      "loan");
+    for (double weight : values.inner_weights) {
+      check(fastrtps__dynamic_data_insert_float64_value(impl, &member, weight, &id), "insert");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, &inner, &member), "return");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &inner), "return");
+    return data;
+  }
+
+  rosidl_dynamic_typesupport_dynamic_data_impl_t *
+  clone(rosidl_dynamic_typesupport_dynamic_data_impl_t * data)
+  {
+    data_.emplace_back();
+    check(
+      fastrtps__dynamic_data_clone(&support_.impl, data, &support_.allocator, &data_.back()),
+      "clone");
+    return &data_.back();
+  }
+
+  bool
+  equals(
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * data,
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * other)
+  {
+    bool out = false;
+    EXPECT_EQ(RCUTILS_RET_OK, fastrtps__dynamic_data_equals(&support_.impl, data, other, &out));
+    return out;
+  }
+
+  size_t
+  diff(
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * from,
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * to)
+  {
+    size_t change_count = 0;
+    EXPECT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_dynamic_data_diff(
+        &support_.impl, from, to, &delta_, &change_count));
+    return change_count;
+  }
+
+  rcutils_ret_t
+  patch(rosidl_dynamic_typesupport_dynamic_data_impl_t * data)
+  {
+    return rosidl_dynamic_typesupport_fastrtps_dynamic_data_patch(&support_.impl, data, &delta_);
+  }
+
+  // Diff `from` against `to`, patch a copy of `from` with the delta, and check it matches `to`
+  void
+  expect_round_trip(const DeltaValues & from_values, const DeltaValues & to_values)
+  {
+    auto from = make_data(from_values);
+    auto to = make_data(to_values);
+    EXPECT_GT(diff(from, to), 0u);
+    ASSERT_EQ(RCUTILS_RET_OK, patch(from)) << rcutils_get_error_string().str;
+    EXPECT_TRUE(equals(from, to));
+  }
+
+  SerializationSupport support_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_data_impl_t> data_;
+  rcutils_uint8_array_t delta_;
+};
+
+
+static const DeltaValues base_values{
+  1, 0.5, "base", {1, 2, 3, 4}, {10, 20, 30, 40, 50, 60, 70, 80}, 7, {0.25, 0.5, 0.75}};
+
+
+TEST_F(TestDynamicDataDelta, no_changes) {
+  auto from = make_data(base_values);
+  auto to = make_data(base_values);
+  EXPECT_EQ(0u, diff(from, to));
+  ASSERT_EQ(RCUTILS_RET_OK, patch(from));
+  EXPECT_TRUE(equals(from, to));
+}
+
+
+TEST_F(TestDynamicDataDelta, values) {
+  DeltaValues to_values = base_values;
+  to_values.count = -1;
+  to_values.ratio = 2.0;
+  to_values.label = "changed";
+  to_values.values[2] = 33;
+  to_values.inner_value = 8;
+  expect_round_trip(base_values, to_values);
+}
+
+
+TEST_F(TestDynamicDataDelta, shrinking_sequences) {
+  DeltaValues to_values = base_values;
+  to_values.samples = {10, 20, 30};
+  to_values.inner_weights.clear();
+  expect_round_trip(base_values, to_values);
+}
+
+
+TEST_F(TestDynamicDataDelta, growing_sequences) {
+  DeltaValues from_values = base_values;
+  from_values.samples.clear();
+  from_values.inner_weights = {1.0};
+  expect_round_trip(from_values, base_values);
+}
+
+
+TEST_F(TestDynamicDataDelta, truncated_delta_leaves_data_untouched) {
+  DeltaValues to_values = base_values;
+  to_values.count = 2;
+  to_values.samples = {1};
+  auto from = make_data(base_values);
+  auto original = clone(from);
+  ASSERT_EQ(2u, diff(from, make_data(to_values)));
+
+  // The first change still reads fine, the second one is cut short
+  --delta_.buffer_length;
+  EXPECT_EQ(RCUTILS_RET_ERROR, patch(from));
+  EXPECT_TRUE(equals(from, original));
+}
+
+
+TEST_F(TestDynamicDataDelta, wrong_kind_leaves_data_untouched) {
+  DeltaValues to_values = base_values;
+  to_values.count = 2;
+  to_values.label = "changed";
+  auto from = make_data(base_values);
+  auto original = clone(from);
+  ASSERT_EQ(2u, diff(from, make_data(to_values)));
+
+  // u32 change count, then the first change: u32 path length, u32 member id, u8 kind
+  ASSERT_EQ(eprosima::fastrtps::types::TK_INT32, delta_.buffer[12]);
+  delta_.buffer[12] = eprosima::fastrtps::types::TK_FLOAT32;
+  EXPECT_EQ(RCUTILS_RET_ERROR, patch(from));
+  EXPECT_TRUE(equals(from, original));
+}
+
+
+TEST_F(TestDynamicDataDelta, missing_member_leaves_data_untouched) {
+  DeltaValues to_values = base_values;
+  to_values.count = 2;
+  auto from = make_data(base_values);
+  auto original = clone(from);
+  ASSERT_EQ(1u, diff(from, make_data(to_values)));
+
+  // The member id of the only change
+  delta_.buffer[8] = 42;
+  EXPECT_EQ(RCUTILS_RET_ERROR, patch(from));
+  EXPECT_TRUE(equals(from, original));
+}
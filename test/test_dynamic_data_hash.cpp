@@ -0,0 +1,242 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+#include "random_messages.hpp"
+
+
+// Member ids of test/msg/Hash
+#define HASH_SINGLE 0
+#define HASH_DOUBLE 1
+#define HASH_VALUES 2
+#define HASH_SAMPLES 3
+#define HASH_INNER 4
+#define HASH_INNERS 5
+#define HASH_LABEL 6
+
+// Member ids of test/msg/Inner
+#define INNER_VALUE 0
+#define INNER_WEIGHTS 1
+
+#define VALUES_LENGTH 3
+#define SAMPLES_LENGTH 2
+#define INNERS_LENGTH 2
+
+// Fixed, so every run checks the same types and data
+static constexpr uint64_t TYPE_SEED = 0x4a54;
+static constexpr uint64_t TYPE_COUNT = 16;
+
+
+class TestDynamicDataHash : public ::testing::Test
+{
+protected:
+  void
+  SetUp() override
+  {
+    // struct Inner { float64 value; float32[] weights }
+    // struct Hash {
+    //   float32 single; float64 double; float64[3] values; float64[] samples; Inner inner;
+    //   Inner[] inners; string label }
+    TypeBuilder inner_builder(&support_, "test/msg/Inner");
+    inner_builder.add(fastrtps__dynamic_type_builder_add_float64_member, "value");
+    inner_builder.add(
+      fastrtps__dynamic_type_builder_add_float32_unbounded_sequence_member, "weights");
+    types_.push_back(inner_builder.build());
+
+    TypeBuilder builder(&support_, "test/msg/Hash");
+    builder.add(fastrtps__dynamic_type_builder_add_float32_member, "single");
+    builder.add(fastrtps__dynamic_type_builder_add_float64_member, "double");
+    builder.add(fastrtps__dynamic_type_builder_add_float64_array_member, "values", VALUES_LENGTH);
+    builder.add(fastrtps__dynamic_type_builder_add_float64_unbounded_sequence_member, "samples");
+    builder.add(fastrtps__dynamic_type_builder_add_complex_member, "inner", &types_.front());
+    builder.add(
+      fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "inners",
+      &types_.front());
+    builder.add(fastrtps__dynamic_type_builder_add_string_member, "label");
+    types_.push_back(builder.build());
+  }
+
+  void
+  TearDown() override
+  {
+    for (auto it = data_.rbegin(); it != data_.rend(); ++it) {
+      fastrtps__dynamic_data_fini(&support_.impl, &*it);
+    }
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_.impl, &*it);
+    }
+    rcutils_reset_error();
+  }
+
+  void
+  fill_inner(
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * data,
+    rosidl_dynamic_typesupport_member_id_t id, double value)
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t inner;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t weights;
+    rosidl_dynamic_typesupport_member_id_t weight_id;
+    check(fastrtps__dynamic_data_loan_value(impl, data, id, &support_.allocator, &inner), "loan");
+    check(fastrtps__dynamic_data_set_float64_value(impl, &inner, INNER_VALUE, value), "set");
+    check(
+      fastrtps__dynamic_data_loan_value(impl, &inner, INNER_WEIGHTS, &support_.allocator, &weights),
+      "loan");
+    check(
+      fastrtps__dynamic_data_insert_float32_value(
+        impl, &weights, static_cast<float>(value), &weight_id),
+      "insert");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, &inner, &weights), "return");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &inner), "return");
+  }
+
+  // Data with every floating point value, at every nesting level, set to `value`
+  rosidl_dynamic_typesupport_dynamic_data_impl_t *
+  make_data(double value)
+  {
+    auto impl = &support_.impl;
+    data_.emplace_back();
+    auto data = &data_.back();
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        impl, &types_.back(), &support_.allocator, data),
+      "init data");
+
+    check(
+      fastrtps__dynamic_data_set_float32_value(
+        impl, data, HASH_SINGLE, static_cast<float>(value)),
+      "set");
+    check(fastrtps__dynamic_data_set_float64_value(impl, data, HASH_DOUBLE, value), "set");
+    check(fastrtps__dynamic_data_set_string_value(impl, data, HASH_LABEL, "hash", 4), "set");
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t member;
+    rosidl_dynamic_typesupport_member_id_t id;
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, HASH_VALUES, &support_.allocator, &member),
+      "loan");
+    for (rosidl_dynamic_typesupport_member_id_t i = 0; i < VALUES_LENGTH; ++i) {
+      check(fastrtps__dynamic_data_set_float64_value(impl, &member, i, value), "set");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, HASH_SAMPLES, &support_.allocator, &member),
+      "loan");
+    for (int i = 0; i < SAMPLES_LENGTH; ++i) {
+      check(fastrtps__dynamic_data_insert_float64_value(impl, &member, value, &id), "insert");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+
+    fill_inner(data, HASH_INNER, value);
+
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, HASH_INNERS, &support_.allocator, &member),
+      "loan");
+    for (int i = 0; i < INNERS_LENGTH; ++i) {
+      check(fastrtps__dynamic_data_insert_sequence_data(impl, &member, &id), "insert");
+      fill_inner(&member, id, value);
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &member), "return");
+    return data;
+  }
+
+  uint64_t
+  hash(const rosidl_dynamic_typesupport_dynamic_data_impl_t * data)
+  {
+    uint64_t out = 0;
+    EXPECT_EQ(RCUTILS_RET_OK, fastrtps__dynamic_data_hash(&support_.impl, data, &out));
+    return out;
+  }
+
+  bool
+  equals(
+    const rosidl_dynamic_typesupport_dynamic_data_impl_t * data,
+    const rosidl_dynamic_typesupport_dynamic_data_impl_t * other_data)
+  {
+    bool out = false;
+    EXPECT_EQ(
+      RCUTILS_RET_OK, fastrtps__dynamic_data_equals(&support_.impl, data, other_data, &out));
+    return out;
+  }
+
+  SerializationSupport support_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_data_impl_t> data_;
+};
+
+
+TEST_F(TestDynamicDataHash, signed_zeros_hash_the_same) {
+  auto zeros = make_data(0.0);
+  auto negative_zeros = make_data(-0.0);
+  ASSERT_TRUE(equals(zeros, negative_zeros));
+  EXPECT_EQ(hash(zeros), hash(negative_zeros));
+}
+
+
+TEST_F(TestDynamicDataHash, nans_hash_the_same) {
+  // Different payloads and signs, which never compare equal but are still one value to hash
+  auto nan = make_data(std::numeric_limits<double>::quiet_NaN());
+  auto negative_nan = make_data(std::copysign(std::numeric_limits<double>::quiet_NaN(), -1.0));
+  auto payload_nan = make_data(std::nan("7"));
+  EXPECT_EQ(hash(nan), hash(negative_nan));
+  EXPECT_EQ(hash(nan), hash(payload_nan));
+}
+
+
+TEST_F(TestDynamicDataHash, different_values_hash_differently) {
+  EXPECT_NE(hash(make_data(1.0)), hash(make_data(2.0)));
+  EXPECT_NE(hash(make_data(0.0)), hash(make_data(std::numeric_limits<double>::quiet_NaN())));
+}
+
+
+TEST_F(TestDynamicDataHash, equal_data_hash_the_same) {
+  auto impl = &support_.impl;
+  rcutils_uint8_array_t buffer = rcutils_get_zero_initialized_uint8_array();
+  ASSERT_EQ(RCUTILS_RET_OK, rcutils_uint8_array_init(&buffer, 0, &support_.allocator));
+
+  // Random messages, against a copy of themselves made through a serialize round trip
+  RandomMessageOptions options;
+  for (uint64_t type_seed = TYPE_SEED; type_seed < TYPE_SEED + TYPE_COUNT; ++type_seed) {
+    SCOPED_TRACE("type seed " + std::to_string(type_seed));
+    RandomMessage message(&support_, type_seed, options);
+    rosidl_dynamic_typesupport_dynamic_data_impl_t other_data;
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        impl, message.type(), &support_.allocator, &other_data),
+      "init data");
+    EXPECT_EQ(RCUTILS_RET_OK, fastrtps__dynamic_data_serialize(impl, &message.data, &buffer));
+    EXPECT_EQ(RCUTILS_RET_OK, fastrtps__dynamic_data_deserialize(impl, &other_data, &buffer));
+    EXPECT_TRUE(equals(&message.data, &other_data));
+    EXPECT_EQ(hash(&message.data), hash(&other_data));
+    fastrtps__dynamic_data_fini(impl, &other_data);
+  }
+  rcutils_uint8_array_fini(&buffer);
+}
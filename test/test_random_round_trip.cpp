@@ -0,0 +1,115 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "message_shapes.hpp"
+#include "random_messages.hpp"
+
+
+// Fixed, so every run checks the same types and data; a failure reports the seeds to reproduce it
+static constexpr uint64_t TYPE_SEED = 0x5eed;
+static constexpr uint64_t DATA_SEED = 0x7e57;
+static constexpr uint64_t TYPE_COUNT = 16;
+static constexpr uint64_t DATA_COUNT = 4;
+
+
+/// Random messages of one nesting depth (the test parameter)
+class TestRandomRoundTrip : public ::testing::TestWithParam<int>
+{
+protected:
+  void
+  SetUp() override
+  {
+    buffer_ = rcutils_get_zero_initialized_uint8_array();
+    other_buffer_ = rcutils_get_zero_initialized_uint8_array();
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_uint8_array_init(&buffer_, 0, &support_.allocator));
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_uint8_array_init(&other_buffer_, 0, &support_.allocator));
+  }
+
+  void
+  TearDown() override
+  {
+    rcutils_uint8_array_fini(&other_buffer_);
+    rcutils_uint8_array_fini(&buffer_);
+    rcutils_reset_error();
+  }
+
+  // Serialize the message from `data_seed`, deserialize it into new data, and check the two are
+  // equal and serialize to the same bytes
+  void
+  expect_round_trip(RandomMessage * message, uint64_t data_seed)
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t other_data;
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        impl, message->type(), &support_.allocator, &data),
+      "init data");
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        impl, message->type(), &support_.allocator, &other_data),
+      "init data");
+    message->fill(data_seed, &data);
+
+    bool equals = false;
+    EXPECT_EQ(RCUTILS_RET_OK, fastrtps__dynamic_data_serialize(impl, &data, &buffer_));
+    EXPECT_EQ(RCUTILS_RET_OK, fastrtps__dynamic_data_deserialize(impl, &other_data, &buffer_));
+    EXPECT_EQ(RCUTILS_RET_OK, fastrtps__dynamic_data_equals(impl, &data, &other_data, &equals));
+    EXPECT_TRUE(equals);
+    EXPECT_EQ(
+      RCUTILS_RET_OK, fastrtps__dynamic_data_serialize(impl, &other_data, &other_buffer_));
+    ASSERT_EQ(buffer_.buffer_length, other_buffer_.buffer_length);
+    EXPECT_EQ(0, std::memcmp(buffer_.buffer, other_buffer_.buffer, buffer_.buffer_length));
+
+    fastrtps__dynamic_data_fini(impl, &other_data);
+    fastrtps__dynamic_data_fini(impl, &data);
+  }
+
+  SerializationSupport support_;
+  rcutils_uint8_array_t buffer_;
+  rcutils_uint8_array_t other_buffer_;
+};
+
+
+TEST_P(TestRandomRoundTrip, serialize_deserialize) {
+  RandomMessageOptions options;
+  options.max_depth = GetParam();
+  for (uint64_t type_seed = TYPE_SEED; type_seed < TYPE_SEED + TYPE_COUNT; ++type_seed) {
+    RandomMessage message(&support_, type_seed, options);
+    for (uint64_t data_seed = DATA_SEED; data_seed < DATA_SEED + DATA_COUNT; ++data_seed) {
+      SCOPED_TRACE(
+        "type seed " + std::to_string(type_seed) + ", data seed " + std::to_string(data_seed));
+      expect_round_trip(&message, data_seed);
+      if (HasFailure()) {
+        return;
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(depth, TestRandomRoundTrip, ::testing::Range(0, 4));
@@ -0,0 +1,305 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <fastcdr/Cdr.h>
+#include <fastcdr/FastBuffer.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/sequence_index.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+
+
+// Member ids of test/msg/Indexed
+#define INDEXED_FLAG 0
+#define INDEXED_LABEL 1
+#define INDEXED_NAMES 2
+#define INDEXED_INNERS 3
+#define INDEXED_TAIL 4
+
+// Member ids of test/msg/Inner
+#define INNER_ID 0
+#define INNER_NAME 1
+
+#define ELEMENT_COUNT 37
+
+
+using eprosima::fastcdr::Cdr;
+using eprosima::fastcdr::FastBuffer;
+
+
+// Element `i` of either sequence, of every length from empty up, so every padding shows up
+static std::string
+element_name(size_t i)
+{
+  return std::string(i % 11, static_cast<char>('a' + i % 26));
+}
+
+
+class TestSequenceIndex : public ::testing::Test
+{
+protected:
+  void
+  SetUp() override
+  {
+    // struct Inner { int32 id; string name }
+    // struct Indexed { uint8 flag; string label; string[] names; Inner[] inners; float64 tail }
+    TypeBuilder inner_builder(&support_, "test/msg/Inner");
+    inner_builder.add(fastrtps__dynamic_type_builder_add_int32_member, "id");
+    inner_builder.add(fastrtps__dynamic_type_builder_add_string_member, "name");
+    types_.push_back(inner_builder.build());
+
+    TypeBuilder builder(&support_, "test/msg/Indexed");
+    builder.add(fastrtps__dynamic_type_builder_add_uint8_member, "flag");
+    builder.add(fastrtps__dynamic_type_builder_add_string_member, "label");
+    builder.add(fastrtps__dynamic_type_builder_add_string_unbounded_sequence_member, "names");
+    builder.add(
+      fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "inners",
+      &types_.front());
+    builder.add(fastrtps__dynamic_type_builder_add_float64_member, "tail");
+    types_.push_back(builder.build());
+
+    buffer_ = rcutils_get_zero_initialized_uint8_array();
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_uint8_array_init(&buffer_, 0, &support_.allocator));
+    index_ = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_sequence_index();
+    serialize_message();
+  }
+
+  void
+  TearDown() override
+  {
+    rosidl_dynamic_typesupport_fastrtps_sequence_index_fini(&index_);
+    rcutils_uint8_array_fini(&buffer_);
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_.impl, &*it);
+    }
+    rcutils_reset_error();
+  }
+
+  // flag 1, label "indexed", and ELEMENT_COUNT names and inners {i, name} of element_name(i)
+  void
+  serialize_message()
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t data;
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        impl, &types_.back(), &support_.allocator, &data),
+      "init data");
+    check(fastrtps__dynamic_data_set_uint8_value(impl, &data, INDEXED_FLAG, 1), "set");
+    check(fastrtps__dynamic_data_set_string_value(impl, &data, INDEXED_LABEL, "indexed", 7), "set");
+    check(fastrtps__dynamic_data_set_float64_value(impl, &data, INDEXED_TAIL, 2.5), "set");
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t names;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t inners;
+    rosidl_dynamic_typesupport_member_id_t id;
+    check(
+      fastrtps__dynamic_data_loan_value(impl, &data, INDEXED_NAMES, &support_.allocator, &names),
+      "loan");
+    check(
+      fastrtps__dynamic_data_loan_value(impl, &data, INDEXED_INNERS, &support_.allocator, &inners),
+      "loan");
+    for (size_t i = 0; i < ELEMENT_COUNT; ++i) {
+      std::string name = element_name(i);
+      check(
+        fastrtps__dynamic_data_insert_string_value(impl, &names, name.c_str(), name.size(), &id),
+        "insert");
+
+      rosidl_dynamic_typesupport_dynamic_data_impl_t inner;
+      check(fastrtps__dynamic_data_insert_sequence_data(impl, &inners, &id), "insert");
+      check(
+        fastrtps__dynamic_data_loan_value(impl, &inners, id, &support_.allocator, &inner), "loan");
+      check(
+        fastrtps__dynamic_data_set_int32_value(impl, &inner, INNER_ID, static_cast<int32_t>(i)),
+        "set");
+      check(
+        fastrtps__dynamic_data_set_string_value(
+          impl, &inner, INNER_NAME, name.c_str(), name.size()),
+        "set");
+      check(fastrtps__dynamic_data_return_loaned_value(impl, &inners, &inner), "return");
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, &data, &inners), "return");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, &data, &names), "return");
+
+    check(fastrtps__dynamic_data_serialize(impl, &data, &buffer_), "serialize");
+    fastrtps__dynamic_data_fini(impl, &data);
+  }
+
+  void
+  init_index(const char * path)
+  {
+    ASSERT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_sequence_index_init(
+        &support_.impl, &types_.back(), path, &support_.allocator, &index_))
+      << rcutils_get_error_string().str;
+  }
+
+  // Where every element of names (or inners) starts, and where the last one ends, read by
+  // deserializing the message sequentially from the start
+  std::vector<size_t>
+  sequential_offsets(bool inners)
+  {
+    FastBuffer buffer(reinterpret_cast<char *>(buffer_.buffer), buffer_.buffer_length);
+    Cdr cdr(buffer, Cdr::DEFAULT_ENDIAN, Cdr::DDS_CDR);
+    cdr.read_encapsulation();
+
+    uint8_t flag;
+    std::string label;
+    uint32_t count;
+    cdr >> flag >> label >> count;
+    if (inners) {
+      std::string name;
+      for (uint32_t i = 0; i < count; ++i) {
+        cdr >> name;
+      }
+      cdr >> count;
+    }
+    EXPECT_EQ(static_cast<uint32_t>(ELEMENT_COUNT), count);
+
+    std::vector<size_t> offsets;
+    for (uint32_t i = 0; i < count; ++i) {
+      offsets.push_back(static_cast<size_t>(cdr.getCurrentPosition() - cdr.getBufferPointer()));
+      int32_t id;
+      std::string name;
+      if (inners) {
+        cdr >> id;
+      }
+      cdr >> name;
+    }
+    offsets.push_back(static_cast<size_t>(cdr.getCurrentPosition() - cdr.getBufferPointer()));
+    return offsets;
+  }
+
+  // Every element is where the sequential read found it, and reading from there gets it back
+  void
+  expect_sequential_offsets(bool inners)
+  {
+    std::vector<size_t> expected = sequential_offsets(inners);
+    size_t count = 0;
+    ASSERT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_sequence_index_get_element_count(&index_, &count));
+    ASSERT_EQ(expected.size() - 1, count);
+
+    for (size_t i = 0; i < count; ++i) {
+      size_t offset = 0;
+      size_t length = 0;
+      ASSERT_EQ(
+        RCUTILS_RET_OK,
+        rosidl_dynamic_typesupport_fastrtps_sequence_index_get_element(
+          &index_, i, &offset, &length));
+      EXPECT_EQ(expected[i], offset) << i;
+      EXPECT_EQ(expected[i + 1] - expected[i], length) << i;
+
+      // Alignment is relative to the end of the encapsulation header, so jump from there
+      FastBuffer buffer(reinterpret_cast<char *>(buffer_.buffer), buffer_.buffer_length);
+      Cdr cdr(buffer, Cdr::DEFAULT_ENDIAN, Cdr::DDS_CDR);
+      cdr.read_encapsulation();
+      ASSERT_TRUE(cdr.jump(offset - 4));
+      int32_t id = static_cast<int32_t>(i);
+      std::string name;
+      if (inners) {
+        cdr >> id;
+      }
+      cdr >> name;
+      EXPECT_EQ(static_cast<int32_t>(i), id);
+      EXPECT_EQ(element_name(i), name);
+    }
+  }
+
+  SerializationSupport support_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+  rcutils_uint8_array_t buffer_;
+  rosidl_dynamic_typesupport_fastrtps_sequence_index_t index_;
+};
+
+
+TEST_F(TestSequenceIndex, sequence_of_strings) {
+  init_index("names");
+  ASSERT_EQ(
+    RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_sequence_index_build(&index_, &buffer_));
+  expect_sequential_offsets(false);
+}
+
+
+TEST_F(TestSequenceIndex, sequence_of_structs_with_strings) {
+  init_index("inners");
+  ASSERT_EQ(
+    RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_sequence_index_build(&index_, &buffer_));
+  expect_sequential_offsets(true);
+
+  // Rebuilding over the same message gives the same index
+  ASSERT_EQ(
+    RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_sequence_index_build(&index_, &buffer_));
+  expect_sequential_offsets(true);
+}
+
+
+TEST_F(TestSequenceIndex, truncated_buffer) {
+  init_index("inners");
+  const size_t end = sequential_offsets(true).back();
+  const rcutils_uint8_array_t full = buffer_;
+
+  // Every buffer that ends before the last element does fails, and leaves no index behind
+  for (size_t length = 0; length < end; ++length) {
+    rcutils_uint8_array_t truncated = full;
+    truncated.buffer_length = length;
+    rcutils_ret_t ret =
+      rosidl_dynamic_typesupport_fastrtps_sequence_index_build(&index_, &truncated);
+    EXPECT_EQ(length < 4 ? RCUTILS_RET_INVALID_ARGUMENT : RCUTILS_RET_ERROR, ret) << length;
+    rcutils_reset_error();
+
+    size_t count = ELEMENT_COUNT;
+    ASSERT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_sequence_index_get_element_count(&index_, &count));
+    EXPECT_EQ(0u, count) << length;
+  }
+
+  // The members after it are not needed
+  rcutils_uint8_array_t truncated = full;
+  truncated.buffer_length = end;
+  ASSERT_EQ(
+    RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_sequence_index_build(&index_, &truncated));
+  expect_sequential_offsets(true);
+}
+
+
+TEST_F(TestSequenceIndex, invalid_paths) {
+  const char * paths[] = {"", "nope", "label", "tail", "inners[0]", "inners[0].name", "inners[x]"};
+  for (const char * path : paths) {
+    EXPECT_EQ(
+      RCUTILS_RET_INVALID_ARGUMENT,
+      rosidl_dynamic_typesupport_fastrtps_sequence_index_init(
+        &support_.impl, &types_.back(), path, &support_.allocator, &index_)) << path;
+    EXPECT_EQ(nullptr, index_.handle) << path;
+    rcutils_reset_error();
+  }
+}
@@ -0,0 +1,269 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/type_cache_file.h>
+
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "detail/fastrtps_type_cache_file.hpp"
+#include "message_shapes.hpp"
+
+
+class TestTypeCacheFile : public ::testing::Test
+{
+protected:
+  void
+  SetUp() override
+  {
+    path_ = testing::TempDir() + "test_type_cache_file_" +
+      testing::UnitTest::GetInstance()->current_test_info()->name() + ".cache";
+  }
+
+  void
+  TearDown() override
+  {
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_.impl, &*it);
+    }
+    std::remove(path_.c_str());
+    rcutils_reset_error();
+  }
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t *
+  add_type(TypeBuilder & builder)
+  {
+    types_.push_back(builder.build());
+    return &types_.back();
+  }
+
+  // struct test/msg/Inner { <member> value; string label }
+  rosidl_dynamic_typesupport_dynamic_type_impl_t *
+  build_inner(bool float_value)
+  {
+    TypeBuilder builder(&support_, "test/msg/Inner");
+    if (float_value) {
+      builder.add(fastrtps__dynamic_type_builder_add_float64_member, "value");
+    } else {
+      builder.add(fastrtps__dynamic_type_builder_add_int32_member, "value");
+    }
+    builder.add(fastrtps__dynamic_type_builder_add_string_member, "label");
+    return add_type(builder);
+  }
+
+  // struct <name> { Inner inner; Inner[] inners; int32[4] values; uint8[<=8] bytes; wstring text }
+  rosidl_dynamic_typesupport_dynamic_type_impl_t *
+  build_outer(const std::string & name, rosidl_dynamic_typesupport_dynamic_type_impl_t * inner)
+  {
+    TypeBuilder builder(&support_, name);
+    builder.add(fastrtps__dynamic_type_builder_add_complex_member, "inner", inner);
+    builder.add(
+      fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "inners", inner);
+    builder.add(fastrtps__dynamic_type_builder_add_int32_array_member, "values", 4);
+    builder.add(fastrtps__dynamic_type_builder_add_uint8_bounded_sequence_member, "bytes", 8);
+    builder.add(fastrtps__dynamic_type_builder_add_wstring_member, "text");
+    return add_type(builder);
+  }
+
+  rcutils_ret_t
+  write(const std::vector<const rosidl_dynamic_typesupport_dynamic_type_impl_t *> & types)
+  {
+    return rosidl_dynamic_typesupport_fastrtps_type_cache_file_write(
+      &support_.impl, path_.c_str(), types.data(), types.size());
+  }
+
+  rcutils_ret_t
+  open(rosidl_dynamic_typesupport_fastrtps_type_cache_file_t * cache_file)
+  {
+    *cache_file = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_type_cache_file();
+    return rosidl_dynamic_typesupport_fastrtps_type_cache_file_open(
+      path_.c_str(), &support_.allocator, cache_file);
+  }
+
+  rcutils_ret_t
+  get_type(
+    rosidl_dynamic_typesupport_fastrtps_type_cache_file_t * cache_file, const std::string & name,
+    rosidl_dynamic_typesupport_dynamic_type_impl_t ** type)
+  {
+    types_.emplace_back();
+    rcutils_ret_t ret = rosidl_dynamic_typesupport_fastrtps_type_cache_file_get_type(
+      &support_.impl, cache_file, name.c_str(), name.size(), &support_.allocator, &types_.back());
+    if (ret != RCUTILS_RET_OK) {
+      types_.pop_back();
+      return ret;
+    }
+    *type = &types_.back();
+    return ret;
+  }
+
+  bool
+  equals(
+    rosidl_dynamic_typesupport_dynamic_type_impl_t * type,
+    rosidl_dynamic_typesupport_dynamic_type_impl_t * other)
+  {
+    bool out = false;
+    EXPECT_EQ(RCUTILS_RET_OK, fastrtps__dynamic_type_equals(&support_.impl, type, other, &out));
+    return out;
+  }
+
+  std::string
+  read_file()
+  {
+    std::ifstream file(path_, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  void
+  write_file(const std::string & contents)
+  {
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+  }
+
+  SerializationSupport support_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+  std::string path_;
+};
+
+
+TEST_F(TestTypeCacheFile, round_trip) {
+  auto inner = build_inner(false);
+  auto outer = build_outer("test/msg/Outer", inner);
+  ASSERT_EQ(RCUTILS_RET_OK, write({outer, inner}));
+
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t cache_file;
+  ASSERT_EQ(RCUTILS_RET_OK, open(&cache_file));
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * read_outer = nullptr;
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * read_inner = nullptr;
+  ASSERT_EQ(RCUTILS_RET_OK, get_type(&cache_file, "test/msg/Outer", &read_outer));
+  ASSERT_EQ(RCUTILS_RET_OK, get_type(&cache_file, "test/msg/Inner", &read_inner));
+  EXPECT_TRUE(equals(outer, read_outer));
+  EXPECT_TRUE(equals(inner, read_inner));
+  EXPECT_FALSE(equals(inner, read_outer));
+
+  // Getting a type again builds nothing new, and still gives an equal type
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * read_again = nullptr;
+  ASSERT_EQ(RCUTILS_RET_OK, get_type(&cache_file, "test/msg/Outer", &read_again));
+  EXPECT_TRUE(equals(outer, read_again));
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * missing = nullptr;
+  EXPECT_EQ(RCUTILS_RET_NOT_FOUND, get_type(&cache_file, "test/msg/Missing", &missing));
+
+  EXPECT_EQ(RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_type_cache_file_fini(&cache_file));
+}
+
+
+TEST_F(TestTypeCacheFile, same_name_different_definitions) {
+  // Two different test/msg/Inner structs, nested in two types written to the same file
+  auto int_outer = build_outer("test/msg/IntOuter", build_inner(false));
+  auto float_outer = build_outer("test/msg/FloatOuter", build_inner(true));
+  ASSERT_FALSE(equals(int_outer, float_outer));
+  ASSERT_EQ(RCUTILS_RET_OK, write({int_outer, float_outer}));
+
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t cache_file;
+  ASSERT_EQ(RCUTILS_RET_OK, open(&cache_file));
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * read_int_outer = nullptr;
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * read_float_outer = nullptr;
+  ASSERT_EQ(RCUTILS_RET_OK, get_type(&cache_file, "test/msg/IntOuter", &read_int_outer));
+  ASSERT_EQ(RCUTILS_RET_OK, get_type(&cache_file, "test/msg/FloatOuter", &read_float_outer));
+  EXPECT_TRUE(equals(int_outer, read_int_outer));
+  EXPECT_TRUE(equals(float_outer, read_float_outer));
+
+  EXPECT_EQ(RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_type_cache_file_fini(&cache_file));
+}
+
+
+TEST_F(TestTypeCacheFile, missing_file) {
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t cache_file;
+  EXPECT_EQ(RCUTILS_RET_NOT_FOUND, open(&cache_file));
+}
+
+
+TEST_F(TestTypeCacheFile, truncated_file) {
+  auto outer = build_outer("test/msg/Outer", build_inner(false));
+  ASSERT_EQ(RCUTILS_RET_OK, write({outer}));
+  std::string contents = read_file();
+  ASSERT_GT(contents.size(), 64u);
+
+  // Inside the header, inside the entry table, and one byte short of the whole file
+  for (size_t size : {size_t(0), size_t(16), size_t(40), contents.size() - 1}) {
+    write_file(contents.substr(0, size));
+    rosidl_dynamic_typesupport_fastrtps_type_cache_file_t cache_file;
+    EXPECT_EQ(RCUTILS_RET_ERROR, open(&cache_file)) << "truncated to " << size << " bytes";
+    rcutils_reset_error();
+  }
+}
+
+
+TEST_F(TestTypeCacheFile, corrupt_record) {
+  auto outer = build_outer("test/msg/Outer", build_inner(false));
+  ASSERT_EQ(RCUTILS_RET_OK, write({outer}));
+  std::string contents = read_file();
+
+  // The last byte of the file is in the type record
+  contents.back() ^= 0x01;
+  write_file(contents);
+
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t cache_file;
+  ASSERT_EQ(RCUTILS_RET_OK, open(&cache_file));
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * read_outer = nullptr;
+  EXPECT_EQ(RCUTILS_RET_ERROR, get_type(&cache_file, "test/msg/Outer", &read_outer));
+  EXPECT_EQ(RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_type_cache_file_fini(&cache_file));
+}
+
+
+TEST_F(TestTypeCacheFile, stale_fingerprint) {
+  auto outer = build_outer("test/msg/Outer", build_inner(false));
+  ASSERT_EQ(RCUTILS_RET_OK, write({outer}));
+  std::string contents = read_file();
+
+  // The first entry's fingerprint comes right after the header
+  contents[32] ^= 0x01;
+  write_file(contents);
+
+  rosidl_dynamic_typesupport_fastrtps_type_cache_file_t cache_file;
+  ASSERT_EQ(RCUTILS_RET_OK, open(&cache_file));
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * read_outer = nullptr;
+  EXPECT_EQ(RCUTILS_RET_ERROR, get_type(&cache_file, "test/msg/Outer", &read_outer));
+  EXPECT_EQ(RCUTILS_RET_OK, rosidl_dynamic_typesupport_fastrtps_type_cache_file_fini(&cache_file));
+}
+
+
+TEST_F(TestTypeCacheFile, nested_too_deep) {
+  // struct Level<n> { int32 value; Level<n - 1> child }, one type node per level
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type = nullptr;
+  for (int level = 0; level <= FASTRTPS_TYPE_CACHE_FILE_MAX_DEPTH; ++level) {
+    TypeBuilder builder(&support_, "test/msg/Level" + std::to_string(level));
+    builder.add(fastrtps__dynamic_type_builder_add_int32_member, "value");
+    if (type) {
+      builder.add(fastrtps__dynamic_type_builder_add_complex_member, "child", type);
+    }
+    type = add_type(builder);
+  }
+  EXPECT_EQ(RCUTILS_RET_INVALID_ARGUMENT, write({type}));
+}
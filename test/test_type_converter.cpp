@@ -0,0 +1,340 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <rcutils/allocator.h>
+#include <rcutils/error_handling.h>
+#include <rcutils/types/rcutils_ret.h>
+#include <rcutils/types/uint8_array.h>
+
+#include <rosidl_dynamic_typesupport/types.h>
+#include <rosidl_dynamic_typesupport_fastrtps/type_converter.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "detail/fastrtps_dynamic_data.hpp"
+#include "detail/fastrtps_dynamic_type.hpp"
+#include "message_shapes.hpp"
+
+
+/// Values for one test/msg/Item
+struct ItemValues
+{
+  int32_t a;
+  double c;
+};
+
+/// Values for one test/msg/Outer, every member both versions have
+struct OuterValues
+{
+  int32_t id;
+  ItemValues item;
+  std::vector<ItemValues> items;
+  ItemValues pair[2];
+};
+
+
+/// One version of test/msg/Outer, with the member ids of that version
+struct Version
+{
+  rosidl_dynamic_typesupport_dynamic_type_impl_t * type;
+
+  // test/msg/Outer
+  rosidl_dynamic_typesupport_member_id_t id;
+  rosidl_dynamic_typesupport_member_id_t item;
+  rosidl_dynamic_typesupport_member_id_t items;
+  rosidl_dynamic_typesupport_member_id_t pair;
+
+  // test/msg/Item
+  rosidl_dynamic_typesupport_member_id_t a;
+  rosidl_dynamic_typesupport_member_id_t c;
+};
+
+
+class TestTypeConverter : public ::testing::Test
+{
+protected:
+  void
+  SetUp() override
+  {
+    // struct Item { int32 a; string b; float64 c }
+    // struct Outer { int32 id; Item item; Item[] items; Item[2] pair; int32 dropped }
+    TypeBuilder from_item(&support_, "test/msg/Item");
+    from_.a = from_item.add(fastrtps__dynamic_type_builder_add_int32_member, "a");
+    from_item.add(fastrtps__dynamic_type_builder_add_string_member, "b");
+    from_.c = from_item.add(fastrtps__dynamic_type_builder_add_float64_member, "c");
+    auto from_item_type = add_type(from_item);
+
+    TypeBuilder from_outer(&support_, "test/msg/Outer");
+    from_.id = from_outer.add(fastrtps__dynamic_type_builder_add_int32_member, "id");
+    from_.item = from_outer.add(
+      fastrtps__dynamic_type_builder_add_complex_member, "item", from_item_type);
+    from_.items = from_outer.add(
+      fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "items",
+      from_item_type);
+    from_.pair = from_outer.add(
+      fastrtps__dynamic_type_builder_add_complex_array_member, "pair", from_item_type, 2);
+    from_outer.add(fastrtps__dynamic_type_builder_add_int32_member, "dropped");
+    from_.type = add_type(from_outer);
+
+    // b removed, a and c reordered, added is new
+    // struct Item { float64 c; int32 a; int16 added }
+    // struct Outer { Item[] items; int32 id; Item item; Item[2] pair; int16 added }
+    TypeBuilder to_item(&support_, "test/msg/Item");
+    to_.c = to_item.add(fastrtps__dynamic_type_builder_add_float64_member, "c");
+    to_.a = to_item.add(fastrtps__dynamic_type_builder_add_int32_member, "a");
+    to_item.add(fastrtps__dynamic_type_builder_add_int16_member, "added");
+    auto to_item_type = add_type(to_item);
+
+    TypeBuilder to_outer(&support_, "test/msg/Outer");
+    to_.items = to_outer.add(
+      fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "items",
+      to_item_type);
+    to_.id = to_outer.add(fastrtps__dynamic_type_builder_add_int32_member, "id");
+    to_.item = to_outer.add(
+      fastrtps__dynamic_type_builder_add_complex_member, "item", to_item_type);
+    to_.pair = to_outer.add(
+      fastrtps__dynamic_type_builder_add_complex_array_member, "pair", to_item_type, 2);
+    to_outer.add(fastrtps__dynamic_type_builder_add_int16_member, "added");
+    to_.type = add_type(to_outer);
+
+    converter_ = rosidl_dynamic_typesupport_fastrtps_get_zero_initialized_type_converter();
+    ASSERT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_type_converter_init(
+        &support_.impl, from_.type, to_.type, &support_.allocator, &converter_))
+      << rcutils_get_error_string().str;
+  }
+
+  void
+  TearDown() override
+  {
+    rosidl_dynamic_typesupport_fastrtps_type_converter_fini(&converter_);
+    for (auto it = data_.rbegin(); it != data_.rend(); ++it) {
+      fastrtps__dynamic_data_fini(&support_.impl, &*it);
+    }
+    for (auto it = types_.rbegin(); it != types_.rend(); ++it) {
+      fastrtps__dynamic_type_fini(&support_.impl, &*it);
+    }
+    rcutils_reset_error();
+  }
+
+  rosidl_dynamic_typesupport_dynamic_type_impl_t *
+  add_type(TypeBuilder & builder)
+  {
+    types_.push_back(builder.build());
+    return &types_.back();
+  }
+
+  rosidl_dynamic_typesupport_dynamic_data_impl_t *
+  make_data(const Version & version)
+  {
+    data_.emplace_back();
+    check(
+      fastrtps__dynamic_data_init_from_dynamic_type(
+        &support_.impl, version.type, &support_.allocator, &data_.back()),
+      "init data");
+    return &data_.back();
+  }
+
+  void
+  fill_item(
+    const Version & version, rosidl_dynamic_typesupport_dynamic_data_impl_t * data,
+    rosidl_dynamic_typesupport_member_id_t id, const ItemValues & values)
+  {
+    auto impl = &support_.impl;
+    rosidl_dynamic_typesupport_dynamic_data_impl_t item;
+    check(fastrtps__dynamic_data_loan_value(impl, data, id, &support_.allocator, &item), "loan");
+    check(fastrtps__dynamic_data_set_int32_value(impl, &item, version.a, values.a), "set");
+    check(fastrtps__dynamic_data_set_float64_value(impl, &item, version.c, values.c), "set");
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &item), "return");
+  }
+
+  // Only sets the members both versions have, every other member keeps its default value
+  rosidl_dynamic_typesupport_dynamic_data_impl_t *
+  make_data(const Version & version, const OuterValues & values)
+  {
+    auto impl = &support_.impl;
+    auto data = make_data(version);
+    check(fastrtps__dynamic_data_set_int32_value(impl, data, version.id, values.id), "set");
+    fill_item(version, data, version.item, values.item);
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t items;
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, version.items, &support_.allocator, &items),
+      "loan");
+    for (const auto & item : values.items) {
+      rosidl_dynamic_typesupport_member_id_t id;
+      check(fastrtps__dynamic_data_insert_sequence_data(impl, &items, &id), "insert");
+      fill_item(version, &items, id, item);
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &items), "return");
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t pair;
+    check(
+      fastrtps__dynamic_data_loan_value(impl, data, version.pair, &support_.allocator, &pair),
+      "loan");
+    for (rosidl_dynamic_typesupport_member_id_t i = 0; i < 2; ++i) {
+      fill_item(version, &pair, i, values.pair[i]);
+    }
+    check(fastrtps__dynamic_data_return_loaned_value(impl, data, &pair), "return");
+    return data;
+  }
+
+  bool
+  equals(
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * data,
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * other)
+  {
+    bool out = false;
+    EXPECT_EQ(RCUTILS_RET_OK, fastrtps__dynamic_data_equals(&support_.impl, data, other, &out));
+    return out;
+  }
+
+  // Convert serialized `from` and deserialize the result into new data of the target type
+  rosidl_dynamic_typesupport_dynamic_data_impl_t *
+  convert_serialized(rosidl_dynamic_typesupport_dynamic_data_impl_t * from)
+  {
+    rcutils_uint8_array_t from_buffer = rcutils_get_zero_initialized_uint8_array();
+    rcutils_uint8_array_t to_buffer = rcutils_get_zero_initialized_uint8_array();
+    check(rcutils_uint8_array_init(&from_buffer, 0, &support_.allocator), "init buffer");
+    check(rcutils_uint8_array_init(&to_buffer, 0, &support_.allocator), "init buffer");
+    check(fastrtps__dynamic_data_serialize(&support_.impl, from, &from_buffer), "serialize");
+
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * to = nullptr;
+    EXPECT_EQ(
+      RCUTILS_RET_OK,
+      rosidl_dynamic_typesupport_fastrtps_type_converter_convert_serialized(
+        &converter_, &from_buffer, &to_buffer)) << rcutils_get_error_string().str;
+    if (!HasFailure()) {
+      to = make_data(to_);
+      check(fastrtps__dynamic_data_deserialize(&support_.impl, to, &to_buffer), "deserialize");
+    }
+    rcutils_uint8_array_fini(&to_buffer);
+    rcutils_uint8_array_fini(&from_buffer);
+    return to;
+  }
+
+  rcutils_ret_t
+  convert_data(
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * from,
+    rosidl_dynamic_typesupport_dynamic_data_impl_t * to)
+  {
+    return rosidl_dynamic_typesupport_fastrtps_type_converter_convert_data(&converter_, from, to);
+  }
+
+  SerializationSupport support_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_type_impl_t> types_;
+  std::deque<rosidl_dynamic_typesupport_dynamic_data_impl_t> data_;
+  Version from_;
+  Version to_;
+  rosidl_dynamic_typesupport_fastrtps_type_converter_t converter_;
+};
+
+
+static const OuterValues values{
+  7, {1, 0.5}, {{2, 1.5}, {3, 2.5}, {4, 3.5}}, {{5, 4.5}, {6, 5.5}}};
+
+
+TEST_F(TestTypeConverter, convert_data) {
+  auto from = make_data(from_, values);
+  auto to = make_data(to_);
+  ASSERT_EQ(RCUTILS_RET_OK, convert_data(from, to)) << rcutils_get_error_string().str;
+  EXPECT_TRUE(equals(to, make_data(to_, values)));
+}
+
+
+TEST_F(TestTypeConverter, convert_data_reuses_target) {
+  auto to = make_data(to_);
+  ASSERT_EQ(RCUTILS_RET_OK, convert_data(make_data(from_, values), to));
+
+  // Fewer elements than the previous conversion left in the target sequence
+  OuterValues shorter = values;
+  shorter.items = {{8, 7.5}};
+  shorter.pair[1] = {9, 8.5};
+  ASSERT_EQ(RCUTILS_RET_OK, convert_data(make_data(from_, shorter), to));
+  EXPECT_TRUE(equals(to, make_data(to_, shorter)));
+}
+
+
+TEST_F(TestTypeConverter, convert_serialized) {
+  auto to = convert_serialized(make_data(from_, values));
+  ASSERT_NE(nullptr, to);
+  EXPECT_TRUE(equals(to, make_data(to_, values)));
+
+  OuterValues empty = values;
+  empty.items.clear();
+  to = convert_serialized(make_data(from_, empty));
+  ASSERT_NE(nullptr, to);
+  EXPECT_TRUE(equals(to, make_data(to_, empty)));
+}
+
+
+TEST_F(TestTypeConverter, data_and_serialized_agree) {
+  auto from = make_data(from_, values);
+  auto to = make_data(to_);
+  ASSERT_EQ(RCUTILS_RET_OK, convert_data(from, to));
+  auto serialized_to = convert_serialized(from);
+  ASSERT_NE(nullptr, serialized_to);
+  EXPECT_TRUE(equals(to, serialized_to));
+}
+
+
+TEST_F(TestTypeConverter, changed_array_bounds_keep_default) {
+  // Same Item change, but three elements in the target array
+  TypeBuilder to_item(&support_, "test/msg/Item");
+  to_item.add(fastrtps__dynamic_type_builder_add_float64_member, "c");
+  to_item.add(fastrtps__dynamic_type_builder_add_int32_member, "a");
+  auto to_item_type = add_type(to_item);
+
+  Version to = to_;
+  TypeBuilder to_outer(&support_, "test/msg/Outer");
+  to.items = to_outer.add(
+    fastrtps__dynamic_type_builder_add_complex_unbounded_sequence_member, "items", to_item_type);
+  to.id = to_outer.add(fastrtps__dynamic_type_builder_add_int32_member, "id");
+  to.item = to_outer.add(fastrtps__dynamic_type_builder_add_complex_member, "item", to_item_type);
+  to.pair = to_outer.add(
+    fastrtps__dynamic_type_builder_add_complex_array_member, "pair", to_item_type, 3);
+  to.type = add_type(to_outer);
+
+  rosidl_dynamic_typesupport_fastrtps_type_converter_fini(&converter_);
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rosidl_dynamic_typesupport_fastrtps_type_converter_init(
+      &support_.impl, from_.type, to.type, &support_.allocator, &converter_));
+
+  auto converted = make_data(to);
+  ASSERT_EQ(RCUTILS_RET_OK, convert_data(make_data(from_, values), converted));
+
+  auto expected = make_data(to);
+  auto impl = &support_.impl;
+  check(fastrtps__dynamic_data_set_int32_value(impl, expected, to.id, values.id), "set");
+  fill_item(to, expected, to.item, values.item);
+  rosidl_dynamic_typesupport_dynamic_data_impl_t items;
+  check(
+    fastrtps__dynamic_data_loan_value(impl, expected, to.items, &support_.allocator, &items),
+    "loan");
+  for (const auto & item : values.items) {
+    rosidl_dynamic_typesupport_member_id_t id;
+    check(fastrtps__dynamic_data_insert_sequence_data(impl, &items, &id), "insert");
+    fill_item(to, &items, id, item);
+  }
+  check(fastrtps__dynamic_data_return_loaned_value(impl, expected, &items), "return");
+  EXPECT_TRUE(equals(converted, expected));
+}